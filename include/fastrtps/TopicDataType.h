@@ -85,6 +85,15 @@ class  TopicDataType {
          */
         RTPS_DllAPI virtual bool getKey(void* data, InstanceHandle_t* ihandle){ (void) data; (void) ihandle; return false; }
 
+        /**
+         * Tells whether the type is plain: its objects have a fixed size of m_typeSize minus the 4 bytes of the
+         * encapsulation, and their memory layout is already their CDR representation with the native endianness.
+         * Objects of plain types can be filled and read in place inside a payload, after the encapsulation, so
+         * their members must need an alignment of at most 4 bytes.
+         * @return True if the type is plain.
+         */
+        RTPS_DllAPI virtual bool is_plain() const { return false; }
+
         /**
          * Set topic data type name
          * @param nam Topic data type name
@@ -46,6 +46,7 @@ class SubscriberAttributes {
             m_entityID = -1;
             expectsInlineQos = false;
             historyMemoryPolicy = PREALLOCATED_MEMORY_MODE;
+            fragmentReassemblyArenaSize = 16 * 1024 * 1024;
         };
         virtual ~SubscriberAttributes(){};
         //!Topic Attributes
@@ -64,6 +65,8 @@ class SubscriberAttributes {
         bool expectsInlineQos;
         //!Underlying History memory policy
         MemoryManagementPolicy_t historyMemoryPolicy;
+        //!Maximum memory of the buffers where fragmented samples are reassembled. Zero reassembles them in the history.
+        uint32_t fragmentReassemblyArenaSize;
         PropertyPolicy properties;
 
         /**
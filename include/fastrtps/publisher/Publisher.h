@@ -68,6 +68,36 @@ public:
 	 */
 	bool write(void*Data, WriteParams &wparams);
 
+	/**
+	 * Loan a sample of the topic type, to be filled and then written with write_loaned.
+	 * For plain types the sample is placed inside the payload of a change reserved in the history,
+	 * so writing it neither copies nor serializes the data.
+	 * @return Pointer to the sample, or nullptr if it couldn't be loaned.
+	 */
+	void* loan_sample();
+
+	/**
+	 * Write a sample obtained from loan_sample. The loan finishes whatever the result.
+	 * @param sample Pointer to the loaned sample
+	 * @return True if correct
+	 */
+	bool write_loaned(void* sample);
+
+	/**
+	 * Write with params a sample obtained from loan_sample. The loan finishes whatever the result.
+	 * @param sample Pointer to the loaned sample
+	 * @param wparams Extra write parameters.
+	 * @return True if correct
+	 */
+	bool write_loaned(void* sample, WriteParams &wparams);
+
+	/**
+	 * Give back a sample obtained from loan_sample without writing it.
+	 * @param sample Pointer to the loaned sample
+	 * @return True if the sample was loaned by this publisher
+	 */
+	bool discard_loan(void* sample);
+
 	/**
 	 * Dispose of a previously written data.
 	 * @param Data Pointer to the data.
@@ -25,6 +25,10 @@
 
 #include "../rtps/history/WriterHistory.h"
 #include "../qos/QosPolicies.h"
+#include "../utils/RingBuffer.h"
+
+#include <list>
+#include <unordered_map>
 
 using namespace eprosima::fastrtps::rtps;
 
@@ -41,8 +45,19 @@ class PublisherImpl;
 class PublisherHistory:public WriterHistory
 {
 public:
-	typedef std::pair<InstanceHandle_t,std::vector<CacheChange_t*>> t_p_I_Change;
-	typedef std::vector<t_p_I_Change> t_v_Inst_Caches;
+	//!Changes of an instance, ordered by sequence number.
+	struct KeyedChanges
+	{
+		KeyedChanges(size_t capacity) : cache_changes(capacity) {}
+
+		RingBuffer<CacheChange_t*> cache_changes;
+		//!Position in the list of empty instances. Only valid while the instance has no changes.
+		std::list<InstanceHandle_t>::iterator empty_it;
+	};
+	typedef std::unordered_map<InstanceHandle_t, KeyedChanges> t_m_Inst_Caches;
+	//!Former name of t_m_Inst_Caches, kept so that code naming its iterators still builds.
+	typedef t_m_Inst_Caches t_v_Inst_Caches;
+
 	/**
 	* Constructor of the PublisherHistory.
 	* @param pimpl Pointer to the PublisherImpl.
@@ -81,16 +96,28 @@ public:
 	/**
 	* Remove a change by the publisher History.
 	* @param change Pointer to the CacheChange_t.
-	* @param vit Pointer to the iterator of the Keyed history vector.
+	* @param vit Pointer to the iterator of the instance of the change.
 	* @return True if removed.
 	*/
-	bool remove_change_pub(CacheChange_t* change,t_v_Inst_Caches::iterator* vit=nullptr);
+	bool remove_change_pub(CacheChange_t* change,t_m_Inst_Caches::iterator* vit=nullptr);
 
     virtual bool remove_change_g(CacheChange_t* a_change);
 
+protected:
+	/**
+	* Add a change restored from the persistence log, applying the HistoryQos and ResourceLimits.
+	* No reader is matched yet, so the oldest changes make room for it when the history is full.
+	* @param a_change Pointer to the change.
+	* @return True if added.
+	*/
+	virtual bool add_restored_change(CacheChange_t* a_change);
+
 private:
-	//!Vector of pointer to the CacheChange_t divided by key.
-	t_v_Inst_Caches m_keyedChanges;
+	//!Changes of each instance.
+	t_m_Inst_Caches m_keyedChanges;
+	//!Instances without changes, least recently used first. They are evicted in this order when
+	//!max_instances is reached.
+	std::list<InstanceHandle_t> m_emptyInstances;
 	//!HistoryQosPolicy values.
 	HistoryQosPolicy m_historyQos;
 	//!ResourceLimitsQosPolicy values.
@@ -98,7 +125,7 @@ private:
 	//!Publisher Pointer
 	PublisherImpl* mp_pubImpl;
 
-	bool find_Key(CacheChange_t* a_change,t_v_Inst_Caches::iterator* vecPairIterrator);
+	bool find_Key(CacheChange_t* a_change,t_m_Inst_Caches::iterator* vit_out);
 };
 
 } /* namespace fastrtps */
@@ -58,8 +58,8 @@ class QosPolicy{
 typedef enum DurabilityQosPolicyKind: octet{
     VOLATILE_DURABILITY_QOS  ,      //!< Volatile Durability (default for Subscribers).
     TRANSIENT_LOCAL_DURABILITY_QOS ,//!< Transient Local Durability (default for Publishers).
-    TRANSIENT_DURABILITY_QOS ,      //!< NOT IMPLEMENTED.
-    PERSISTENT_DURABILITY_QOS       //!< NOT IMPLEMENTED.
+    TRANSIENT_DURABILITY_QOS ,      //!< Transient Durability. Only for Publishers, whose history is kept in a persistence log.
+    PERSISTENT_DURABILITY_QOS       //!< Persistent Durability. Only for Publishers, as Transient Durability.
 }DurabilityQosPolicyKind_t;
 
 #define PARAMETER_KIND_LENGTH 4
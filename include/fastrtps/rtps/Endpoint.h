@@ -21,6 +21,7 @@
 #ifndef ENDPOINT_H_
 #define ENDPOINT_H_
 #include <mutex>
+#include <vector>
 #include "common/Types.h"
 #include "common/Locator.h"
 #include "common/Guid.h"
@@ -33,6 +34,7 @@ namespace rtps {
 
 class RTPSParticipantImpl;
 class ResourceEvent;
+class SenderResource;
 
 
 /**
@@ -90,6 +92,13 @@ class Endpoint
 
     Endpoint& operator=(const Endpoint&)NON_COPYABLE_CXX11;
 
+    //!Sender resources of the participant matching the output locators, resolved when they change.
+    std::vector<SenderResource*> send_route_;
+    //!Generation of the participant sender resources send_route_ was resolved against. 0 means not resolved.
+    uint32_t send_route_generation_;
+    //!Guards the route while the endpoint sends through it.
+    std::mutex send_route_mutex_;
+
 #if HAVE_SECURITY
     bool supports_rtps_protection_;
 
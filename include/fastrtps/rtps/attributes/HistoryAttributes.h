@@ -42,7 +42,8 @@ class RTPS_DllAPI HistoryAttributes
             memoryPolicy(PREALLOCATED_MEMORY_MODE),
             payloadMaxSize(500),
             initialReservedCaches(500),
-            maximumReservedCaches(0)
+            maximumReservedCaches(0),
+            threadCachedCaches(0)
     {}
 
         /** Constructor
@@ -55,7 +56,7 @@ class RTPS_DllAPI HistoryAttributes
          */
         HistoryAttributes(MemoryManagementPolicy_t memoryPolicy, uint32_t payload, int32_t initial, int32_t maxRes):
             memoryPolicy(memoryPolicy), payloadMaxSize(payload),initialReservedCaches(initial),
-            maximumReservedCaches(maxRes){}
+            maximumReservedCaches(maxRes), threadCachedCaches(0){}
 
         virtual ~HistoryAttributes(){}
 
@@ -70,6 +71,10 @@ class RTPS_DllAPI HistoryAttributes
 
         //!Maximum number of reserved caches. Default value is 0 that indicates to keep reserving until something breaks.
         int32_t maximumReservedCaches;
+
+        //!Number of free caches each thread may keep for itself, to avoid contention when the same thread reserves and
+        //!releases them. Default value is 0 that indicates all free caches are shared.
+        uint32_t threadCachedCaches;
 };
 
 }
@@ -195,10 +195,12 @@ class RTPSParticipantAttributes
             setName("RTPSParticipant");
             sendSocketBufferSize = 65536;
             listenSocketBufferSize = 65536;
+            listenBufferPoolSize = 16 * 1024 * 1024;
             use_IP4_to_send = true;
             use_IP6_to_send = false;
             participantID = -1;
             useBuiltinTransports = true;
+            useIntraprocessDelivery = false;
         }
 
         virtual ~RTPSParticipantAttributes(){};
@@ -231,6 +233,11 @@ class RTPSParticipantAttributes
         uint32_t sendSocketBufferSize;
         //!Listen socket buffer for all listen resources, default value 65536.
         uint32_t listenSocketBufferSize;
+        /**
+         * Maximum memory of the buffers kept by received payloads that reference them, for each listen resource,
+         * default value 16 MB. When it is reached, received payloads are copied. Zero always copies them.
+         */
+        uint32_t listenBufferPoolSize;
         //! Builtin parameters.
         BuiltinAttributes builtin;
         //!Port Parameters
@@ -253,6 +260,12 @@ class RTPSParticipantAttributes
         std::vector<std::shared_ptr<TransportDescriptorInterface> > userTransports;
         //!Set as false to disable the default UDPv4 implementation.
         bool useBuiltinTransports;
+        /**
+         * Set as true to let writers hand their changes directly to matched readers of the same process,
+         * when both participants enable it. Control messages still go through the transports.
+         * Listeners of those readers are then called from the thread that sends the data.
+         */
+        bool useIntraprocessDelivery;
 
         //! Property policies
         PropertyPolicy properties;
@@ -60,6 +60,7 @@ public:
 		endpoint.durabilityKind = VOLATILE;
 		endpoint.reliabilityKind = BEST_EFFORT;
 		expectsInlineQos = false;
+		fragmentReassemblyArenaSize = 16 * 1024 * 1024;
 	};
 	virtual ~ReaderAttributes(){};
 	//!Attributes of the associated endpoint.
@@ -68,6 +69,9 @@ public:
 	ReaderTimes times;
 	//!Indicates if the reader expects Inline qos, default value 0.
 	bool expectsInlineQos;
+	//!Maximum memory of the buffers where fragmented samples are reassembled, default value 16 MB.
+	//!Zero reassembles them in the payloads of the history.
+	uint32_t fragmentReassemblyArenaSize;
 };
 
 /**
@@ -27,6 +27,7 @@
 #include <fastrtps/rtps/common/FragmentNumber.h>
 
 #include <vector>
+#include <cstdint>
 
 namespace eprosima
 {
@@ -88,7 +89,8 @@ namespace eprosima
                     isRead(false),
                     is_untyped_(true),
                     dataFragments_(new std::vector<uint32_t>()),
-                    fragment_size_(0)
+                    fragment_size_(0),
+                    pool_slot_(UINT32_MAX)
                 {
                 }
 
@@ -106,7 +108,8 @@ namespace eprosima
                     isRead(false),
                     is_untyped_(is_untyped),
                     dataFragments_(new std::vector<uint32_t>()),
-                    fragment_size_(0)
+                    fragment_size_(0),
+                    pool_slot_(UINT32_MAX)
                 {
                 }
 
@@ -186,11 +189,16 @@ namespace eprosima
 
                 private:
 
+                friend class CacheChangePool;
+
                 // Data fragments
                 std::vector<uint32_t>* dataFragments_;
 
                 // Fragment size
                 uint16_t fragment_size_;
+
+                // Slot of the CacheChangePool which owns this change
+                uint32_t pool_slot_;
             };
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS_PUBLIC
@@ -316,7 +324,8 @@ namespace eprosima
                     return change_ != nullptr;
                 }
 
-                FragmentNumberSet_t getUnsentFragments() const
+                //! Fragments still to send. It isn't a FragmentNumberSet_t because it may span more than 256 fragments.
+                const std::set<FragmentNumber_t>& getUnsentFragments() const
                 {
                     return unsent_fragments_;
                 }
@@ -335,8 +344,8 @@ namespace eprosima
 
                 void markFragmentsAsUnsent(const FragmentNumberSet_t& unsentFragments)
                 {
-                    for(auto element : unsentFragments.set)
-                        unsent_fragments_.insert(element);
+                    for(auto it = unsentFragments.get_begin(); it != unsentFragments.get_end(); ++it)
+                        unsent_fragments_.insert(*it);
                 }
 
                 private:
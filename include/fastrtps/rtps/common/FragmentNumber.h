@@ -20,6 +20,7 @@
 #define RPTS_ELEM_FRAGNUM_H_
 #include "../../fastrtps_dll.h"
 #include "Types.h"
+#include "NumberSetBitmap.h"
 
 #include <set>
 #include <cmath>
@@ -32,33 +33,35 @@ namespace rtps{
 typedef uint32_t FragmentNumber_t;
 
 //!Structure FragmentNumberSet_t, contains a group of fragmentnumbers.
+//!The fragment numbers are kept in a bitmap of offsets from the base, as they are sent.
 //!@ingroup COMMON_MODULE
 class FragmentNumberSet_t
 {
     public:
 
+        //!Iterator through the fragment numbers of the set, in increasing order.
+        typedef NumberSetIterator<FragmentNumber_t> const_iterator;
+
+        //!Maximum distance from the base of the fragment numbers the set can hold.
+        static const uint32_t max_offset = NumberSetBitmap::max_bits - 1;
+
         //!Base fragment number
         FragmentNumber_t base;
 
+        FragmentNumberSet_t(): base(0) {}
+
         /**
-         * Assignment operator
-         * @param set2 FragmentNumberSet_t to copy the data from
+         * Builds the set from the lowest fragment numbers of a std::set, which becomes the base.
+         * Those that don't fit in the bitmap are left out.
          */
-        FragmentNumberSet_t& operator=(const FragmentNumberSet_t& set2)
-        {
-            base = set2.base;
-            set = set2.set;
-            return *this;
-        }
-
-        FragmentNumberSet_t(): base(0), set() {}
-
         FragmentNumberSet_t(const std::set<FragmentNumber_t>& set2) : base(0)
         {
-            set = set2;
-            auto min = set.begin();
-            if (min != set.end())
+            auto min = set2.begin();
+            if (min != set2.end())
                 base = *min;
+            for (auto element : set2)
+                if (!add(element))
+                    break;
         }
 
         /**
@@ -66,11 +69,11 @@ class FragmentNumberSet_t
          * @param other FragmentNumberSet_t to compare
          * @return True if equal
          */
-        bool operator==(const FragmentNumberSet_t& other) {
+        bool operator==(const FragmentNumberSet_t& other) const {
 
             if (base != other.base)
                 return false;
-            return other.set == set;	
+            return other.bitmap_ == bitmap_;
         }
 
 
@@ -81,83 +84,126 @@ class FragmentNumberSet_t
          */
         bool add(FragmentNumber_t in)
         {
-            if (in >= base && in <= base + 255)
-                set.insert(in);
+            if (in >= base && in - base <= max_offset)
+                bitmap_.set(in - base);
             else
                 return false;
             return true;
         }
 
+        /**
+         * Check if a fragment number is in the set
+         * @param in Fragment number to look for
+         * @return True if it is in the set
+         */
+        bool contains(FragmentNumber_t in) const
+        {
+            return in >= base && in - base <= max_offset && bitmap_.test(in - base);
+        }
+
+        /**
+         * Get the maximum fragment number in the set
+         * @return maximum fragment number in the set
+         */
+        FragmentNumber_t get_maxFragNum() const
+        {
+            uint32_t num_bits = bitmap_.num_bits();
+            return num_bits == 0 ? base : base + (num_bits - 1);
+        }
+
         /**
          * Check if the set is empty
          * @return True if the set is empty
          */
         bool isSetEmpty() const
         {
-            return set.empty();
+            return bitmap_.empty();
         }
 
         /**
          * Get the begin of the set
-         * @return Vector iterator pointing to the begin of the set
+         * @return Iterator pointing to the lowest fragment number of the set
          */
-        std::set<FragmentNumber_t>::const_iterator get_begin() const
+        const_iterator get_begin() const
         {
-            return set.begin();
+            return const_iterator(base, &bitmap_, 0);
         }
 
         /**
          * Get the end of the set
-         * @return Vector iterator pointing to the end of the set
+         * @return Iterator pointing past the highest fragment number of the set
          */
-        std::set<FragmentNumber_t>::const_iterator get_end() const
+        const_iterator get_end() const
         {
-            return set.end();
+            return const_iterator(base, &bitmap_, NumberSetBitmap::max_bits);
         }
 
         /**
          * Get the number of FragmentNumbers in the set
          * @return Size of the set
          */
-        size_t get_size()
+        size_t get_size() const
+        {
+            return bitmap_.count();
+        }
+
+        //!Bitmap of the set, with the layout it has on the wire.
+        const NumberSetBitmap& bitmap() const
         {
-            return set.size();
+            return bitmap_;
+        }
+
+        //!Bitmap of the set, with the layout it has on the wire.
+        NumberSetBitmap& bitmap()
+        {
+            return bitmap_;
         }
 
         /**
          * Get a string representation of the set
          * @return string representation of the set
          */
-        std::string print()
+        std::string print() const
         {
             std::stringstream ss;
             ss << base << ":";
-            for (auto it = set.begin(); it != set.end(); ++it)
+            for (auto it = get_begin(); it != get_end(); ++it)
                 ss << *it << "-";
             return ss.str();
         }
 
         FragmentNumberSet_t& operator-=(const FragmentNumberSet_t& rhs)
         {
-            for ( auto element : rhs.set)
-                set.erase(element);
+            if (rhs.base == base)
+                bitmap_.subtract(rhs.bitmap_);
+            else
+                for (auto it = rhs.get_begin(); it != rhs.get_end(); ++it)
+                    *this -= *it;
             return *this;
         }
 
         FragmentNumberSet_t& operator-=(const FragmentNumber_t& fragment_number)
         {
-            set.erase(fragment_number);
+            if (contains(fragment_number))
+                bitmap_.reset(fragment_number - base);
             return *this;
         }
 
         FragmentNumberSet_t& operator+=(const FragmentNumberSet_t& rhs)
         {
-            for ( auto element : rhs.set )
-                add(element);
+            if (rhs.base == base)
+                bitmap_ |= rhs.bitmap_;
+            else if (rhs.base > base && rhs.base - base + rhs.bitmap_.num_bits() <= max_offset + 1)
+                bitmap_.merge_shifted(rhs.bitmap_, rhs.base - base);
+            else
+                for (auto it = rhs.get_begin(); it != rhs.get_end(); ++it)
+                    add(*it);
             return *this;
         }
 
-        std::set<FragmentNumber_t> set;
+    private:
+
+        NumberSetBitmap bitmap_;
 };
 
 /**
@@ -166,21 +212,19 @@ class FragmentNumberSet_t
  * @param sns SequenceNumber set
  * @return OStream.
  */
-inline std::ostream& operator<<(std::ostream& output, FragmentNumberSet_t& sns){
+inline std::ostream& operator<<(std::ostream& output, const FragmentNumberSet_t& sns){
     return output << sns.print();
 }
 
 inline FragmentNumberSet_t operator-(FragmentNumberSet_t lhs, const FragmentNumberSet_t& rhs)
 {
-    for ( auto element : rhs.set)
-        lhs.set.erase(element);
+    lhs -= rhs;
     return lhs;
 }
 
 inline FragmentNumberSet_t operator+(FragmentNumberSet_t lhs, const FragmentNumberSet_t& rhs)
 {
-    for ( auto element : rhs.set)
-        lhs.add(element);
+    lhs += rhs;
     return lhs;
 }
 
@@ -22,6 +22,9 @@
 #include "Types.h"
 #include "Guid.h"
 
+#include <cstddef>
+#include <functional>
+
 namespace eprosima{
 namespace fastrtps{
 namespace rtps{
@@ -168,4 +171,28 @@ inline std::ostream& operator<<(std::ostream& output,const InstanceHandle_t& iHa
 }
 }
 
+namespace std
+{
+
+/**
+ * Hash of an InstanceHandle_t, so instances can be the keys of unordered containers.
+ * Keys shorter than the handle leave the remaining bytes to zero, so all of them are mixed (FNV-1a).
+ */
+template<>
+struct hash<eprosima::fastrtps::rtps::InstanceHandle_t>
+{
+	size_t operator()(const eprosima::fastrtps::rtps::InstanceHandle_t& ihandle) const
+	{
+		uint64_t value = 14695981039346656037ULL;
+		for(uint8_t i = 0; i < 16; ++i)
+		{
+			value ^= ihandle.value[i];
+			value *= 1099511628211ULL;
+		}
+		return static_cast<size_t>(value);
+	}
+};
+
+}
+
 #endif /* INSTANCEHANDLE_H_ */
@@ -0,0 +1,246 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file NumberSetBitmap.h
+ */
+
+#ifndef RTPS_ELEM_NUMBERSETBITMAP_H_
+#define RTPS_ELEM_NUMBERSETBITMAP_H_
+
+#include "../../utils/BitOperations.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+/**
+ * Bitmap with the numbers of a SequenceNumberSet_t or a FragmentNumberSet_t, as offsets from their base.
+ * Words keep the order and bit layout of the wire (offset 0 is the highest bit of the first word),
+ * so they are serialized without conversion.
+ * @ingroup COMMON_MODULE
+ */
+class NumberSetBitmap
+{
+    public:
+
+        //! Maximum number of bits of the bitmap.
+        static const uint32_t max_bits = 256;
+
+        //! Number of 32 bit words of the bitmap.
+        static const uint32_t max_words = max_bits / 32;
+
+        NumberSetBitmap()
+        {
+            clear();
+        }
+
+        //! Removes all the offsets.
+        void clear()
+        {
+            memset(words_, 0, sizeof(words_));
+        }
+
+        void set(uint32_t offset)
+        {
+            words_[offset / 32] |= bit(offset);
+        }
+
+        void reset(uint32_t offset)
+        {
+            words_[offset / 32] &= ~bit(offset);
+        }
+
+        bool test(uint32_t offset) const
+        {
+            return offset < max_bits && (words_[offset / 32] & bit(offset)) != 0;
+        }
+
+        bool empty() const
+        {
+            for(uint32_t i = 0; i < max_words; ++i)
+                if(words_[i] != 0)
+                    return false;
+            return true;
+        }
+
+        //! Number of offsets in the bitmap.
+        uint32_t count() const
+        {
+            uint32_t total = 0;
+            for(uint32_t i = 0; i < max_words; ++i)
+                total += bit_count(words_[i]);
+            return total;
+        }
+
+        //! Number of bits needed to represent the bitmap, that is the highest offset plus one. Zero when empty.
+        uint32_t num_bits() const
+        {
+            for(uint32_t i = max_words; i > 0; --i)
+                if(words_[i - 1] != 0)
+                    return i * 32 - lowest_bit(words_[i - 1]);
+            return 0;
+        }
+
+        //! Returns the first offset in the bitmap not lower than the given one, or max_bits if there is none.
+        uint32_t next(uint32_t offset) const
+        {
+            if(offset >= max_bits)
+                return max_bits;
+
+            uint32_t index = offset / 32;
+            uint32_t word = words_[index] & (0xFFFFFFFFu >> (offset % 32));
+
+            while(word == 0)
+            {
+                if(++index == max_words)
+                    return max_bits;
+                word = words_[index];
+            }
+
+            return index * 32 + leading_zeros(word);
+        }
+
+        NumberSetBitmap& operator|=(const NumberSetBitmap& other)
+        {
+            for(uint32_t i = 0; i < max_words; ++i)
+                words_[i] |= other.words_[i];
+            return *this;
+        }
+
+        //! Removes the offsets present in other bitmap.
+        void subtract(const NumberSetBitmap& other)
+        {
+            for(uint32_t i = 0; i < max_words; ++i)
+                words_[i] &= ~other.words_[i];
+        }
+
+        /**
+         * Adds the offsets of other bitmap, moved up by some positions.
+         * @return False if some offset didn't fit in the bitmap.
+         */
+        bool merge_shifted(const NumberSetBitmap& other, uint32_t shift)
+        {
+            bool all_fit = true;
+
+            for(uint32_t i = 0; i < max_words; ++i)
+            {
+                uint64_t word = static_cast<uint64_t>(other.words_[i]) << 32 >> (shift % 32);
+                uint32_t index = i + shift / 32;
+
+                if(index < max_words)
+                    words_[index] |= static_cast<uint32_t>(word >> 32);
+                else if(word >> 32 != 0)
+                    all_fit = false;
+
+                if(index + 1 < max_words)
+                    words_[index + 1] |= static_cast<uint32_t>(word);
+                else if(static_cast<uint32_t>(word) != 0)
+                    all_fit = false;
+            }
+
+            return all_fit;
+        }
+
+        bool operator==(const NumberSetBitmap& other) const
+        {
+            return memcmp(words_, other.words_, sizeof(words_)) == 0;
+        }
+
+        //! Word of the bitmap as it is sent.
+        uint32_t word(uint32_t index) const
+        {
+            return words_[index];
+        }
+
+        //! Sets a word of the bitmap as it is received.
+        void set_word(uint32_t index, uint32_t value)
+        {
+            words_[index] = value;
+        }
+
+    private:
+
+        static uint32_t bit(uint32_t offset)
+        {
+            return 0x80000000u >> (offset % 32);
+        }
+
+        uint32_t words_[max_words];
+};
+
+/**
+ * Iterator through the numbers of a set based on a NumberSetBitmap.
+ * @ingroup COMMON_MODULE
+ */
+template<typename T>
+class NumberSetIterator
+{
+    public:
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef T reference;
+
+        NumberSetIterator(const T& base, const NumberSetBitmap* bitmap, uint32_t offset) :
+            base_(base), bitmap_(bitmap), offset_(bitmap->next(offset))
+        {
+        }
+
+        T operator*() const
+        {
+            return base_ + offset_;
+        }
+
+        NumberSetIterator& operator++()
+        {
+            offset_ = bitmap_->next(offset_ + 1);
+            return *this;
+        }
+
+        NumberSetIterator operator++(int)
+        {
+            NumberSetIterator previous(*this);
+            ++(*this);
+            return previous;
+        }
+
+        bool operator==(const NumberSetIterator& other) const
+        {
+            return bitmap_ == other.bitmap_ && offset_ == other.offset_;
+        }
+
+        bool operator!=(const NumberSetIterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+
+        T base_;
+        const NumberSetBitmap* bitmap_;
+        uint32_t offset_;
+};
+
+}
+}
+}
+
+#endif /* RTPS_ELEM_NUMBERSETBITMAP_H_ */
@@ -0,0 +1,101 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file PayloadAllocator.h
+ */
+
+#ifndef PAYLOADALLOCATOR_H_
+#define PAYLOADALLOCATOR_H_
+
+#include "../../fastrtps_dll.h"
+#include "Types.h"
+
+#include <cstdint>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+/**
+ * Statistics reported by a PayloadAllocator.
+ * @ingroup COMMON_MODULE
+ */
+struct RTPS_DllAPI PayloadAllocatorStats
+{
+    PayloadAllocatorStats() : system_bytes(0), used_bytes(0), high_water_bytes(0), buffers(0),
+        total_allocations(0), total_requested_bytes(0), total_allocated_bytes(0) {}
+
+    //! Memory taken from the system.
+    uint64_t system_bytes;
+    //! Capacity of the buffers currently in use.
+    uint64_t used_bytes;
+    //! Highest value reached by used_bytes.
+    uint64_t high_water_bytes;
+    //! Number of buffers currently in use.
+    uint64_t buffers;
+    //! Number of buffers allocated since the allocator was created.
+    uint64_t total_allocations;
+    //! Sum of the sizes requested on every allocation.
+    uint64_t total_requested_bytes;
+    //! Sum of the capacities given on every allocation.
+    uint64_t total_allocated_bytes;
+
+    //! Fraction of the allocated capacity that was not requested, due to rounding sizes up.
+    double internal_fragmentation() const
+    {
+        return total_allocated_bytes == 0 ? 0.0 : 1.0 - (double)total_requested_bytes / (double)total_allocated_bytes;
+    }
+
+    //! Fraction of the memory taken from the system that is not in use.
+    double external_fragmentation() const
+    {
+        return system_bytes == 0 ? 0.0 : 1.0 - (double)used_bytes / (double)system_bytes;
+    }
+};
+
+/**
+ * Interface of the allocators that provide the buffers of SerializedPayload_t.
+ * Implementations must be threadsafe.
+ * @ingroup COMMON_MODULE
+ */
+class RTPS_DllAPI PayloadAllocator
+{
+    public:
+
+        virtual ~PayloadAllocator() {}
+
+        /**
+         * Allocates a buffer. Its contents are not initialized.
+         * @param[in,out] size Requested size. On return, the capacity of the buffer, which can be bigger.
+         * @return Pointer to the buffer. Throws std::bad_alloc when it can't be allocated.
+         */
+        virtual octet* allocate(uint32_t& size) = 0;
+
+        /**
+         * Gives back a buffer returned by allocate.
+         * @param buffer Pointer to the buffer.
+         * @param capacity Capacity of the buffer, as returned by allocate.
+         */
+        virtual void release(octet* buffer, uint32_t capacity) = 0;
+
+        //! Reports the statistics of the allocator.
+        virtual PayloadAllocatorStats get_stats() const = 0;
+};
+
+}
+}
+}
+
+#endif /* PAYLOADALLOCATOR_H_ */
@@ -43,11 +43,11 @@ class Property
 
         Property(const std::string& name,
                 const std::string& value) :
-            name_(name), value_(value) {}
+            name_(name), value_(value), propagate_(false) {}
 
         Property(std::string&& name,
                 std::string&& value) :
-            name_(std::move(name)), value_(std::move(value)) {}
+            name_(std::move(name)), value_(std::move(value)), propagate_(false) {}
 
         Property& operator=(const Property& property)
         {
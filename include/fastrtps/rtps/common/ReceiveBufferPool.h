@@ -0,0 +1,176 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file ReceiveBufferPool.h
+ */
+
+#ifndef RECEIVEBUFFERPOOL_H_
+#define RECEIVEBUFFERPOOL_H_
+
+#include "../../fastrtps_dll.h"
+#include "Types.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+class ReceiveBufferPool;
+
+/**
+ * Buffer where a message is received, shared by the payloads that reference parts of it.
+ * It goes back to its pool when the last reference is removed.
+ * @ingroup COMMON_MODULE
+ */
+class RTPS_DllAPI ReceiveBuffer
+{
+    friend class ReceiveBufferPool;
+
+    public:
+
+        //! Start of the buffer.
+        octet* buffer() const { return buffer_; }
+
+        //! Capacity of the buffer.
+        uint32_t capacity() const { return capacity_; }
+
+        //! Number of references to the buffer.
+        uint32_t references() const { return references_.load(std::memory_order_acquire); }
+
+        /**
+         * Reports whether a payload of the given size should reference the buffer instead of being copied.
+         * Payloads smaller than half the buffer are copied, so that they don't keep a much bigger buffer out of the
+         * pool.
+         */
+        bool should_reference(uint32_t size) const { return size >= capacity_ / 2; }
+
+        //! Adds a reference to the buffer. Only the holder of another reference can call it.
+        void add_reference() { references_.fetch_add(1, std::memory_order_relaxed); }
+
+        //! Removes a reference. The buffer goes back to its pool when it was the last one.
+        inline void remove_reference();
+
+    private:
+
+        ReceiveBuffer(octet* buffer, uint32_t capacity) : buffer_(buffer), capacity_(capacity), references_(0) {}
+
+        ~ReceiveBuffer() { free(buffer_); }
+
+        ReceiveBuffer(const ReceiveBuffer&) = delete;
+        ReceiveBuffer& operator=(const ReceiveBuffer&) = delete;
+
+        octet* buffer_;
+        uint32_t capacity_;
+        std::atomic<uint32_t> references_;
+        //! Pool the buffer goes back to. Only set while the buffer is taken, so the pool outlives it.
+        std::shared_ptr<ReceiveBufferPool> pool_;
+};
+
+/**
+ * Pool of the buffers where messages are received. Buffers taken from it can outlive the pool's owner, because the
+ * pool is only destroyed when the last shared pointer to it is gone, and each taken buffer holds one.
+ * Buffers bigger than the default size can be taken too, and the memory of all the buffers can be limited.
+ * @ingroup COMMON_MODULE
+ */
+class RTPS_DllAPI ReceiveBufferPool : public std::enable_shared_from_this<ReceiveBufferPool>
+{
+    friend class ReceiveBuffer;
+
+    public:
+
+        /**
+         * @param buffer_size Default capacity of the buffers.
+         * @param max_free_buffers Number of released buffers kept for later use. The rest are freed.
+         * @param max_bytes Maximum memory of all the buffers, taken or free. Zero means no limit.
+         */
+        ReceiveBufferPool(uint32_t buffer_size, uint32_t max_free_buffers, uint64_t max_bytes = 0);
+
+        ~ReceiveBufferPool();
+
+        /**
+         * Takes a buffer of the default capacity from the pool, allocating a new one when there are no free buffers.
+         * @return Buffer with a single reference, owned by the caller, or nullptr when the memory limit is reached.
+         * Throws std::bad_alloc when it can't be allocated.
+         */
+        ReceiveBuffer* take() { return take(buffer_size_); }
+
+        /**
+         * Takes a buffer of at least the given size. The smallest free one that fits is reused. Otherwise a new one is
+         * allocated, doubling the default capacity until the size fits.
+         * @return Buffer with a single reference, owned by the caller, or nullptr when the memory limit is reached.
+         * Throws std::bad_alloc when it can't be allocated.
+         */
+        ReceiveBuffer* take(uint32_t size);
+
+        //! Default capacity of the buffers.
+        uint32_t buffer_size() const { return buffer_size_; }
+
+        //! Number of free buffers kept by the pool.
+        uint32_t free_buffers() const;
+
+        //! Memory of all the buffers, taken or free.
+        uint64_t allocated_bytes() const;
+
+    private:
+
+        ReceiveBufferPool(const ReceiveBufferPool&) = delete;
+        ReceiveBufferPool& operator=(const ReceiveBufferPool&) = delete;
+
+        //! Called when the last reference of a buffer is removed.
+        void recycle(ReceiveBuffer* buffer)
+        {
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                if(free_buffers_.size() < max_free_buffers_)
+                {
+                    free_buffers_.push_back(buffer);
+                    return;
+                }
+                allocated_bytes_ -= buffer->capacity_;
+            }
+
+            delete(buffer);
+        }
+
+        uint32_t buffer_size_;
+        uint32_t max_free_buffers_;
+        uint64_t max_bytes_;
+        uint64_t allocated_bytes_;
+        mutable std::mutex mutex_;
+        std::vector<ReceiveBuffer*> free_buffers_;
+};
+
+void ReceiveBuffer::remove_reference()
+{
+    if(references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        // The buffer can be reused or deleted as soon as it is recycled, and the pool itself can be destroyed
+        // when this last pointer to it goes away.
+        std::shared_ptr<ReceiveBufferPool> pool(std::move(pool_));
+        pool->recycle(this);
+    }
+}
+
+}
+}
+}
+
+#endif /* RECEIVEBUFFERPOOL_H_ */
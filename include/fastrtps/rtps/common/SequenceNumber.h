@@ -20,6 +20,7 @@
 #define RPTS_ELEM_SEQNUM_H_
 #include "../../fastrtps_dll.h"
 #include "Types.h"
+#include "NumberSetBitmap.h"
 
 #include <vector>
 #include <algorithm>
@@ -353,24 +354,21 @@ struct SequenceNumberHash
 #endif
 
 //!Structure SequenceNumberSet_t, contains a group of sequencenumbers.
+//!The sequence numbers are kept in a bitmap of offsets from the base, as they are sent.
 //!@ingroup COMMON_MODULE
 class SequenceNumberSet_t
 {
     public:
+
+        //!Iterator through the sequence numbers of the set, in increasing order.
+        typedef NumberSetIterator<SequenceNumber_t> const_iterator;
+
+        //!Maximum distance from the base of the sequence numbers the set can hold.
+        static const uint32_t max_offset = NumberSetBitmap::max_bits - 1;
+
         //!Base sequence number
         SequenceNumber_t base;
 
-        /**
-         * Assignment operator
-         * @param set2 SequenceNumberSet_t to copy the data from
-         */
-        SequenceNumberSet_t& operator=(const SequenceNumberSet_t& set2)
-        {
-            base = set2.base;
-            set = set2.set;
-            return *this;
-        }
-
         /**
          * Add a sequence number to the set
          * @param in SequenceNumberSet_t to add
@@ -378,21 +376,33 @@ class SequenceNumberSet_t
          */
         bool add(const SequenceNumber_t& in)
         {
-            if(in >= base && in < base + 255)
-                set.push_back(in);
-            else
+            uint32_t offset;
+            if(!offset_of(in, offset))
                 return false;
 
+            bitmap_.set(offset);
             return true;
         }
 
+        /**
+         * Check if a sequence number is in the set
+         * @param in Sequence number to look for
+         * @return True if it is in the set
+         */
+        bool contains(const SequenceNumber_t& in) const
+        {
+            uint32_t offset;
+            return offset_of(in, offset) && bitmap_.test(offset);
+        }
+
         /**
          * Get the maximum sequence number in the set
          * @return maximum sequence number in the set
          */
         SequenceNumber_t get_maxSeqNum() const
         {
-            return *std::max_element(set.begin(),set.end(),sort_seqNum);
+            uint32_t num_bits = bitmap_.num_bits();
+            return num_bits == 0 ? base : base + (num_bits - 1);
         }
 
         /**
@@ -401,50 +411,84 @@ class SequenceNumberSet_t
          */
         bool isSetEmpty() const
         {
-            return set.empty();
+            return bitmap_.empty();
         }
 
         /**
          * Get the begin of the set
-         * @return Vector iterator pointing to the begin of the set
+         * @return Iterator pointing to the lowest sequence number of the set
          */
-        std::vector<SequenceNumber_t>::const_iterator get_begin() const
+        const_iterator get_begin() const
         {
-            return set.begin();
+            return const_iterator(base, &bitmap_, 0);
         }
 
         /**
          * Get the end of the set
-         * @return Vector iterator pointing to the end of the set
+         * @return Iterator pointing past the highest sequence number of the set
          */
-        std::vector<SequenceNumber_t>::const_iterator get_end() const
+        const_iterator get_end() const
         {
-            return set.end();
+            return const_iterator(base, &bitmap_, NumberSetBitmap::max_bits);
         }
 
         /**
          * Get the number of SequenceNumbers in the set
          * @return Size of the set
          */
-        size_t get_size()
+        size_t get_size() const
         {
-            return set.size();
+            return bitmap_.count();
         }
 
         /**
          * Get the set of SequenceNumbers 
          * @return Set of SequenceNumbers
          */
-        std::vector<SequenceNumber_t> get_set()
+        std::vector<SequenceNumber_t> get_set() const
         {
-            return set;
+            return std::vector<SequenceNumber_t>(get_begin(), get_end());
+        }
+
+        /**
+         * Adds the sequence numbers of other set.
+         * @return False if some of them didn't fit in this set.
+         */
+        bool add(const SequenceNumberSet_t& other)
+        {
+            if(other.base == base)
+            {
+                bitmap_ |= other.bitmap_;
+                return true;
+            }
+
+            uint32_t shift;
+            if(offset_of(other.base, shift) && shift + other.bitmap_.num_bits() <= max_offset + 1)
+                return bitmap_.merge_shifted(other.bitmap_, shift);
+
+            bool all_added = true;
+            for(auto it = other.get_begin(); it != other.get_end(); ++it)
+                all_added &= add(*it);
+            return all_added;
+        }
+
+        //!Bitmap of the set, with the layout it has on the wire.
+        const NumberSetBitmap& bitmap() const
+        {
+            return bitmap_;
+        }
+
+        //!Bitmap of the set, with the layout it has on the wire.
+        NumberSetBitmap& bitmap()
+        {
+            return bitmap_;
         }
 
         /**
          * Get a string representation of the set
          * @return string representation of the set
          */
-        std::string print()
+        std::string print() const
         {
             std::stringstream ss;
 
@@ -453,19 +497,33 @@ class SequenceNumberSet_t
 #else
             ss << "{high: " << base.high << ", low: " << base.low << "} :";
 #endif
-            for(std::vector<SequenceNumber_t>::iterator it = set.begin(); it != set.end(); ++it)
+            for(auto it = get_begin(); it != get_end(); ++it)
             {
 #ifdef LLONG_MAX
-                ss << it->to64long() << "-";
+                ss << (*it).to64long() << "-";
 #else
-                ss << "{high: " << it->high << ", low: " << it->low << "} -";
+                ss << "{high: " << (*it).high << ", low: " << (*it).low << "} -";
 #endif
             }
             return ss.str();
         }
 
     private:
-        std::vector<SequenceNumber_t> set;
+
+        bool offset_of(const SequenceNumber_t& in, uint32_t& offset) const
+        {
+            if(in < base)
+                return false;
+
+            SequenceNumber_t distance = in - base;
+            if(distance.high != 0 || distance.low > max_offset)
+                return false;
+
+            offset = distance.low;
+            return true;
+        }
+
+        NumberSetBitmap bitmap_;
 };
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS_PUBLIC
@@ -476,7 +534,7 @@ class SequenceNumberSet_t
  * @param sns SequenceNumber set
  * @return OStream.
  */
-inline std::ostream& operator<<(std::ostream& output, SequenceNumberSet_t& sns)
+inline std::ostream& operator<<(std::ostream& output, const SequenceNumberSet_t& sns)
 {
     return output << sns.print();
 }
@@ -20,6 +20,8 @@
 #define SERIALIZEDPAYLOAD_H_
 #include "../../fastrtps_dll.h"
 #include "Types.h"
+#include "PayloadAllocator.h"
+#include "ReceiveBufferPool.h"
 #include <cstring>
 #include <new>
 #include <stdexcept>
@@ -56,11 +58,20 @@ namespace eprosima{
                 uint32_t max_size;
                 //!Position when reading
                 uint32_t pos;
+                //!Allocator of the data. If null, the data is allocated with calloc. Only set it while the payload is empty.
+                PayloadAllocator* allocator;
+                //!Receive buffer the data points into. If not null, the payload doesn't own the data, but references part of a received message.
+                ReceiveBuffer* receive_buffer;
+                //!Own buffer of the payload, kept aside while it references a received message.
+                octet* own_data;
+                //!Maximum size of the own buffer, kept aside while the payload references a received message.
+                uint32_t own_max_size;
 
                 //!Default constructor
                 SerializedPayload_t() : encapsulation(CDR_BE),
                 length(0), data(nullptr), max_size(0),
-                pos(0)
+                pos(0), allocator(nullptr), receive_buffer(nullptr),
+                own_data(nullptr), own_max_size(0)
                 {
                 }
 
@@ -80,12 +91,23 @@ namespace eprosima{
 
                 /*!
                  * Copy another structure (including allocating new space for the data.)
+                 * When the other payload references a received message, this one can reference it too instead.
                  * @param[in] serData Pointer to the structure to copy
                  * @param with_limit if true, the function will fail when providing a payload too big
                  * @return True if correct
                  */
                 bool copy(const SerializedPayload_t* serData, bool with_limit = true)
                 {
+                    release_reference();
+
+                    if(serData->receive_buffer != nullptr && serData->receive_buffer->should_reference(serData->length) &&
+                            (serData->length <= max_size || !with_limit))
+                    {
+                        reference(serData->receive_buffer, serData->data, serData->length);
+                        encapsulation = serData->encapsulation;
+                        return true;
+                    }
+
                     length = serData->length;
 
                     if(serData->length > max_size)
@@ -108,21 +130,38 @@ namespace eprosima{
                  */
                 bool reserve_fragmented(SerializedPayload_t* serData)
                 {
+                    release_reference();
+                    if(data != nullptr)
+                    {
+                        if(allocator != nullptr)
+                            allocator->release(data, max_size);
+                        else
+                            free(data);
+                    }
                     length = serData->length;
                     max_size = serData->length;
                     encapsulation = serData->encapsulation;
-                    data = (octet*)calloc(length, sizeof(octet));
+                    if(allocator != nullptr)
+                        data = allocator->allocate(max_size);
+                    else
+                        data = (octet*)calloc(length, sizeof(octet));
                     return true;
                 }
 
                 //! Empty the payload
                 void empty()
                 {
+                    release_reference();
                     length= 0;
                     encapsulation = CDR_BE;
-                    max_size = 0;
                     if(data!=nullptr)
-                        free(data);
+                    {
+                        if(allocator != nullptr)
+                            allocator->release(data, max_size);
+                        else
+                            free(data);
+                    }
+                    max_size = 0;
                     data = nullptr;
                 }
 
@@ -131,7 +170,36 @@ namespace eprosima{
                     if (new_size <= this->max_size) {
                         return;
                     }
-                    if(data == nullptr)
+                    if(receive_buffer != nullptr)
+                    {
+                        // Go back to the own buffer, keeping the referenced contents.
+                        ReceiveBuffer* buffer = receive_buffer;
+                        octet* referenced = data;
+                        uint32_t referenced_length = length;
+                        receive_buffer = nullptr;
+                        data = own_data;
+                        max_size = own_max_size;
+                        own_data = nullptr;
+                        own_max_size = 0;
+                        length = 0;
+                        reserve(new_size);
+                        memcpy(data, referenced, referenced_length);
+                        length = referenced_length;
+                        buffer->remove_reference();
+                        return;
+                    }
+                    if(allocator != nullptr)
+                    {
+                        // The allocator doesn't initialize the buffer, only the current contents are kept.
+                        octet* new_data = allocator->allocate(new_size);
+                        if(data != nullptr)
+                        {
+                            memcpy(new_data, data, length < max_size ? length : max_size);
+                            allocator->release(data, max_size);
+                        }
+                        data = new_data;
+                    }
+                    else if(data == nullptr)
                     {
                         data = (octet*)calloc(new_size, sizeof(octet));
                         if (!data)
@@ -152,6 +220,41 @@ namespace eprosima{
                     max_size = new_size;
                 }
 
+                /*!
+                 * Makes the payload reference part of a received message instead of copying it. The own buffer of
+                 * the payload is kept aside until release_reference is called.
+                 * @param buffer Buffer where the message was received. A reference to it is added.
+                 * @param referenced_data Start of the payload in the buffer.
+                 * @param referenced_length Length of the payload.
+                 */
+                void reference(ReceiveBuffer* buffer, octet* referenced_data, uint32_t referenced_length)
+                {
+                    release_reference();
+                    buffer->add_reference();
+                    own_data = data;
+                    own_max_size = max_size;
+                    receive_buffer = buffer;
+                    data = referenced_data;
+                    length = referenced_length;
+                    max_size = referenced_length;
+                }
+
+                //! Stops referencing a received message and goes back to the own buffer. The contents are lost.
+                void release_reference()
+                {
+                    if(receive_buffer != nullptr)
+                    {
+                        ReceiveBuffer* buffer = receive_buffer;
+                        receive_buffer = nullptr;
+                        data = own_data;
+                        max_size = own_max_size;
+                        own_data = nullptr;
+                        own_max_size = 0;
+                        length = 0;
+                        buffer->remove_reference();
+                    }
+                }
+
             };
         }
     }
@@ -0,0 +1,90 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file SlabPayloadAllocator.h
+ */
+
+#ifndef SLABPAYLOADALLOCATOR_H_
+#define SLABPAYLOADALLOCATOR_H_
+
+#include "PayloadAllocator.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+/**
+ * PayloadAllocator that rounds the sizes up to powers of two, from 64 bytes to 1 MB, and carves the buffers of each
+ * size out of slabs. Released buffers are kept for the next allocation of the same size, and the slabs are only
+ * given back to the system when the allocator is destroyed. Bigger buffers are allocated directly from the system.
+ * @ingroup COMMON_MODULE
+ */
+class RTPS_DllAPI SlabPayloadAllocator : public PayloadAllocator
+{
+    public:
+
+        /**
+         * @param slab_size Size of the slabs. Size classes bigger than this get a slab of a single buffer.
+         */
+        SlabPayloadAllocator(uint32_t slab_size = 65536);
+
+        virtual ~SlabPayloadAllocator();
+
+        virtual octet* allocate(uint32_t& size);
+
+        virtual void release(octet* buffer, uint32_t capacity);
+
+        virtual PayloadAllocatorStats get_stats() const;
+
+    private:
+
+        SlabPayloadAllocator(const SlabPayloadAllocator&) = delete;
+        SlabPayloadAllocator& operator=(const SlabPayloadAllocator&) = delete;
+
+        struct SizeClass
+        {
+            SizeClass() : free_list(nullptr) {}
+
+            std::mutex mutex;
+            //! Free buffers. Each one stores the pointer to the next one on its first bytes.
+            octet* free_list;
+            std::vector<octet*> slabs;
+        };
+
+        static const uint32_t c_min_class_bits = 6;
+        static const uint32_t c_max_class_bits = 20;
+
+        void account_allocation(uint32_t requested, uint32_t capacity);
+
+        uint32_t slab_size_;
+        SizeClass classes_[c_max_class_bits - c_min_class_bits + 1];
+        std::atomic<uint64_t> system_bytes_;
+        std::atomic<uint64_t> used_bytes_;
+        std::atomic<uint64_t> high_water_bytes_;
+        std::atomic<uint64_t> buffers_;
+        std::atomic<uint64_t> total_allocations_;
+        std::atomic<uint64_t> total_requested_bytes_;
+        std::atomic<uint64_t> total_allocated_bytes_;
+};
+
+}
+}
+}
+
+#endif /* SLABPAYLOADALLOCATOR_H_ */
@@ -54,7 +54,9 @@ typedef enum ReliabilityKind_t{
 typedef enum DurabilityKind_t
 {
     VOLATILE,
-    TRANSIENT_LOCAL
+    TRANSIENT_LOCAL,
+    TRANSIENT,      //!< The history of the writer is kept in a persistence log and restored when it is created again.
+    PERSISTENT      //!< As TRANSIENT.
 }DurabilityKind_t;
 
 //!Endpoint kind
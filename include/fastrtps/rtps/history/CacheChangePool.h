@@ -23,12 +23,14 @@
 #define CACHECHANGEPOOL_H_
 
 #include "../resources/ResourceManagement.h"
+#include "../common/SlabPayloadAllocator.h"
 
 #include <vector>
 #include <functional>
 #include <cstdint>
 #include <cstddef>
 #include <mutex>
+#include <atomic>
 
 
 namespace eprosima {
@@ -39,6 +41,11 @@ struct CacheChange_t;
 
 /**
  * Class CacheChangePool, used by the HistoryCache to pre-reserve a number of CacheChange_t to avoid dynamically reserving memory in the middle of execution loops.
+ * Reserving and releasing a CacheChange_t doesn't take any lock: free changes are kept in a lock-free list, and a mutex is only
+ * taken when the pool has to grow. Optionally each thread can keep a few free changes for itself, so that threads which
+ * both reserve and release changes don't contend on the shared list.
+ * On PREALLOCATED_WITH_REALLOC_MEMORY_MODE and DYNAMIC_RESERVE_MEMORY_MODE the payloads are taken from a PayloadAllocator,
+ * by default a SlabPayloadAllocator owned by the pool.
  * @ingroup COMMON_MODULE
  */
 class CacheChangePool {
@@ -50,8 +57,13 @@ class CacheChangePool {
          * @param payload_size The initial payload size associated with the pool.
          * @param max_pool_size Maximum payload size. If set to 0 the pool will keep reserving until something breaks.
          * @param memoryPolicy Memory management policy.
+         * @param thread_cache_size Number of free changes each thread may keep for itself. If set to 0 all free changes
+         * are shared. Changes kept by a thread can't be reserved by other threads. It is not used on DYNAMIC_RESERVE_MEMORY_MODE.
+         * @param payload_allocator Allocator of the payloads. It must outlive the pool. If null, the pool uses its own
+         * SlabPayloadAllocator. It is not used on PREALLOCATED_MEMORY_MODE.
          */
-        CacheChangePool(int32_t pool_size, uint32_t payload_size, int32_t max_pool_size, MemoryManagementPolicy_t memoryPolicy);
+        CacheChangePool(int32_t pool_size, uint32_t payload_size, int32_t max_pool_size, MemoryManagementPolicy_t memoryPolicy,
+                uint32_t thread_cache_size = 0, PayloadAllocator* payload_allocator = nullptr);
 
         /*!
          * @brief Reserves a CacheChange from the pool.
@@ -75,20 +87,47 @@ class CacheChangePool {
         //!Release a Cache back to the pool.
         void release_Cache(CacheChange_t*);
         //!Get the size of the cache vector; all of them (reserved and not reserved).
-        size_t get_allCachesSize(){return m_allCaches.size();}
-        //!Get the number of frre caches.
-        size_t get_freeCachesSize(){return m_freeCaches.size();}
+        size_t get_allCachesSize(){return m_pool_size.load(std::memory_order_relaxed);}
+        //!Get the number of free caches. Those kept by the threads for themselves are not counted.
+        size_t get_freeCachesSize(){return m_free_size.load(std::memory_order_relaxed);}
         //!Get the initial payload size associated with the Pool.
         inline uint32_t getInitialPayloadSize(){return m_initial_payload_size;};
+        //!Get the statistics of the allocator of the payloads.
+        PayloadAllocatorStats get_payloadAllocatorStats() const {return mp_payload_allocator->get_stats();}
     private:
+
+        struct Slot;
+        struct ThreadCaches;
+
         uint32_t m_initial_payload_size;
         uint32_t m_payload_size;
-        uint32_t m_pool_size;
+        std::atomic<uint32_t> m_pool_size;
         uint32_t m_max_pool_size;
-        std::vector<CacheChange_t*> m_freeCaches;
-        std::vector<CacheChange_t*> m_allCaches;
-        bool allocateGroup(uint32_t pool_size);
+        //!Number of changes in the free list.
+        std::atomic<uint32_t> m_free_size;
+        //!Head of the free list. Holds the index of the first free slot plus one, and a tag on the upper half to avoid ABA.
+        std::atomic<uint64_t> m_free_head;
+        //!Number of slots created. Slots are never destroyed until the pool is.
+        std::atomic<uint32_t> m_slot_count;
+        //!Slots are stored in segments of growing size, so that they never move.
+        std::atomic<Slot*> m_segments[27];
+        uint32_t m_thread_cache_size;
+        uint64_t m_id;
+        SlabPayloadAllocator m_payload_allocator;
+        //!Allocator of the payloads. Not used on PREALLOCATED_MEMORY_MODE.
+        PayloadAllocator* mp_payload_allocator;
+        CacheChange_t* new_change(uint32_t payload_size);
+        bool allocateGroup(uint32_t pool_size, CacheChange_t** chan);
         CacheChange_t* allocateSingle(uint32_t dataSize);
+        Slot* slot(uint32_t index) const;
+        uint32_t new_slot();
+        void push_free(uint32_t first, uint32_t last);
+        bool pop_free(uint32_t& index);
+        bool reserve_free(CacheChange_t** chan);
+        void release_free(CacheChange_t* ch);
+        void push_cached(std::vector<CacheChange_t*>& cache, size_t count);
+        bool owns(CacheChange_t* ch) const;
+        static ThreadCaches& thread_caches();
         std::mutex* mp_mutex;
         MemoryManagementPolicy_t memoryMode;
 };
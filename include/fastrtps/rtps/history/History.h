@@ -69,6 +69,12 @@ class History
          */
         RTPS_DllAPI inline void release_Cache(CacheChange_t* ch) { return m_changePool.release_Cache(ch); }
 
+        /**
+         * Get the statistics of the allocator of the payloads of the CacheChange_t.
+         * @return Statistics of the allocator.
+         */
+        RTPS_DllAPI inline PayloadAllocatorStats getPayloadAllocatorStats() const { return m_changePool.get_payloadAllocatorStats(); }
+
         /**
          * Check if the history is full
          * @return true if the History is full.
@@ -78,7 +84,7 @@ class History
          * Get the History size.
          * @return Size of the history.
          */
-        RTPS_DllAPI size_t getHistorySize(){ return m_changes.size(); }
+        RTPS_DllAPI size_t getHistorySize(){ return m_changes.size() - m_changesHead; }
         /**
          * Remove all changes from the History
          * @return True if everything was correctly removed.
@@ -99,7 +105,7 @@ class History
          * Get the beginning of the changes history iterator.
          * @return Iterator to the beginning of the vector.
          */
-        RTPS_DllAPI std::vector<CacheChange_t*>::iterator changesBegin(){ return m_changes.begin(); }
+        RTPS_DllAPI std::vector<CacheChange_t*>::iterator changesBegin(){ return m_changes.begin() + m_changesHead; }
         /**
          * Get the end of the changes history iterator.
          * @return Iterator to the end of the vector.
@@ -134,8 +140,26 @@ class History
         RTPS_DllAPI bool get_change(SequenceNumber_t& seq, GUID_t& guid,CacheChange_t** change);
 
     protected:
+        /**
+         * Insert a change before the given position of m_changes. The changes before it are moved back into the
+         * room of the removed ones when they are fewer than the changes after it, and that room is reused before
+         * the vector has to grow.
+         * @param position Iterator to the change that will follow it.
+         * @param a_change Pointer to the change.
+         */
+        void insert_change_at(std::vector<CacheChange_t*>::iterator position, CacheChange_t* a_change);
+
+        /**
+         * Remove the given position from m_changes. The first change is removed by moving the beginning of the
+         * history forward, without moving the rest of them.
+         * @param position Iterator to the change.
+         */
+        void remove_change_at(std::vector<CacheChange_t*>::iterator position);
+
         //!Vector of pointers to the CacheChange_t.
         std::vector<CacheChange_t*> m_changes;
+        //!Number of removed changes still at the beginning of m_changes. They are skipped by changesBegin().
+        size_t m_changesHead;
         //!Variable to know if the history is full without needing to block the History mutex.
         bool m_isHistoryFull;
         //!Pointer to and invalid cacheChange used to return the maximum and minimum when no changes are stored in the history.
@@ -74,6 +74,14 @@ public:
 	 */
 	RTPS_DllAPI bool remove_change(CacheChange_t* a_change);
 
+	/**
+	 * Remove a CacheChange_t from the ReaderHistory without giving it back to the pool, so its payload
+	 * stays valid. It must be released later with release_Cache.
+	 * @param a_change Pointer to the CacheChange to take.
+	 * @return True if taken.
+	 */
+	RTPS_DllAPI bool take_change(CacheChange_t* a_change);
+
 	/**
 	 * Remove all changes from the History that have a certain guid.
 	 * @param a_guid Pointer to the target guid to search for.
@@ -82,6 +90,7 @@ public:
 	RTPS_DllAPI bool remove_changes_with_guid(GUID_t* a_guid);
 	/**
 	 * Sort the CacheChange_t from the History.
+	 * Changes added with add_change are already kept in order, so it is only needed if they were modified.
 	 */
 	RTPS_DllAPI void sortCacheChanges();
 	/**
@@ -99,6 +108,9 @@ protected:
 	RTPSReader* mp_reader;
 	//!Pointer to the semaphore, used to halt execution until new message arrives.
 	Semaphore* mp_semaphore;
+
+private:
+	bool detach_change(CacheChange_t* a_change, bool release);
 };
 
 }
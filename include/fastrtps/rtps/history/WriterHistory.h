@@ -27,6 +27,8 @@ namespace fastrtps{
 namespace rtps {
 
 class RTPSWriter;
+class RTPSParticipantImpl;
+class MappedChangeLog;
 
 /**
  * Class WriterHistory, container of the different CacheChanges of a writer
@@ -35,6 +37,7 @@ class RTPSWriter;
 class WriterHistory : public History
 {
     friend class RTPSWriter;
+    friend class RTPSParticipantImpl;
 
     public:
 
@@ -76,10 +79,43 @@ class WriterHistory : public History
     RTPS_DllAPI SequenceNumber_t next_sequence_number() const { return m_lastCacheChangeSeqNum + 1; }
 
     protected:
+    /**
+     * Find the change with the given sequence number.
+     * Changes are stored in order and without gaps in their sequence numbers, unless some of them were removed,
+     * so its position is usually the distance from the first one.
+     * @param sequence_number SequenceNumber_t of the change.
+     * @return Iterator to the change, or to the end of the history if it is not found.
+     */
+    std::vector<CacheChange_t*>::iterator find_change(const SequenceNumber_t& sequence_number);
+
+    /**
+     * Remove the given position from the history and from its persistence log.
+     * @param position Iterator to the change.
+     */
+    void erase_change(std::vector<CacheChange_t*>::iterator position);
+
+    /**
+     * Restore the changes kept by a persistence log, and keep in it the changes added and removed from now on.
+     * Changes that the history can't take are removed from the log.
+     * @param log Log, not opened yet. The history owns it from now on.
+     * @return False if the log can't be opened.
+     */
+    bool restore_persistent_changes(MappedChangeLog* log);
+
+    /**
+     * Add a change restored from the persistence log. Its sequence number is the next one of the history.
+     * Derived histories override it to apply their own limits.
+     * @param a_change Pointer to the change.
+     * @return True if added.
+     */
+    virtual bool add_restored_change(CacheChange_t* a_change) { return add_change(a_change); }
+
     //!Last CacheChange Sequence Number added to the History.
     SequenceNumber_t m_lastCacheChangeSeqNum;
     //!Pointer to the associated RTPSWriter;
     RTPSWriter* mp_writer;
+    //!Log where the changes are kept when the durability is TRANSIENT or PERSISTENT.
+    MappedChangeLog* mp_persistence;
 };
 
 }
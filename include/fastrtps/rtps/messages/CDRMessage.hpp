@@ -159,23 +159,22 @@ inline bool CDRMessage::readSequenceNumberSet(CDRMessage_t* msg,SequenceNumberSe
     valid &=CDRMessage::readSequenceNumber(msg,&sns->base);
     uint32_t numBits;
     valid &=CDRMessage::readUInt32(msg,&numBits);
-    int32_t bitmap;
-    SequenceNumber_t seqNum;
+    if(numBits > NumberSetBitmap::max_bits)
+        return false;
+    // The words are copied as they come, as the bitmap keeps the layout of the wire.
+    NumberSetBitmap& bitmap = sns->bitmap();
+    bitmap.clear();
+    uint32_t word;
     for(uint32_t i=0;i<(numBits+31)/32;++i)
     {
-        valid &= CDRMessage::readInt32(msg,&bitmap);
-        for(uint8_t bit=0;bit<32;++bit)
-        {
-            if((bitmap & (1<<(31-bit%32)))==(1<<(31-bit%32)))
-            {
-                seqNum = sns->base+(i*32+bit);
-                if(!sns->add(seqNum))
-                {
-                    return false;
-                }
-            }
-        }
+        valid &= CDRMessage::readUInt32(msg,&word);
+        if(i == numBits/32)
+            word &= ~(0xFFFFFFFFu >> (numBits%32));
+        bitmap.set_word(i, word);
     }
+    // Sequence numbers too far from the base are not accepted.
+    if(bitmap.num_bits() > SequenceNumberSet_t::max_offset + 1)
+        return false;
     return valid;
 }
 
@@ -185,22 +184,17 @@ inline bool CDRMessage::readFragmentNumberSet(CDRMessage_t* msg, FragmentNumberS
     valid &= CDRMessage::readUInt32(msg, &fns->base);
     uint32_t numBits;
     valid &= CDRMessage::readUInt32(msg, &numBits);
-    int32_t bitmap;
-    FragmentNumber_t fragNum;
+    if(numBits > NumberSetBitmap::max_bits)
+        return false;
+    NumberSetBitmap& bitmap = fns->bitmap();
+    bitmap.clear();
+    uint32_t word;
     for (uint32_t i = 0; i<(numBits + 31) / 32; ++i)
     {
-        valid &= CDRMessage::readInt32(msg, &bitmap);
-        for (uint8_t bit = 0; bit<32; ++bit)
-        {
-            if ((bitmap & (1 << (31 - bit % 32))) == (1 << (31 - bit % 32)))
-            {
-                fragNum = fns->base + (i * 32 + bit);
-                if (!fns->add(fragNum))
-                {
-                    return false;
-                }
-            }
-        }
+        valid &= CDRMessage::readUInt32(msg, &word);
+        if(i == numBits / 32)
+            word &= ~(0xFFFFFFFFu >> (numBits % 32));
+        bitmap.set_word(i, word);
     }
     return valid;
 }
@@ -521,44 +515,15 @@ inline bool CDRMessage::addSequenceNumberSet(CDRMessage_t* msg,
 {
     CDRMessage::addSequenceNumber(msg, &sns->base);
 
-    //Add set
-    if(sns->isSetEmpty())
-    {
-        addUInt32(msg,0); //numbits 0
-        return true;
-    }
-
-    SequenceNumber_t maxseqNum = sns->get_maxSeqNum();
-
-    uint32_t numBits = (maxseqNum - sns->base + 1).low;
-    assert((maxseqNum - sns->base + 1).high == 0);
-
-    if(numBits >= 256)
-        numBits = 255;
+    // The bitmap already has the layout of the wire, so the words are written as they are.
+    const NumberSetBitmap& bitmap = sns->bitmap();
+    uint32_t numBits = bitmap.num_bits();
+    assert(numBits <= SequenceNumberSet_t::max_offset + 1);
 
     addUInt32(msg, numBits);
-    uint8_t n_longs = (uint8_t)((numBits + 31) / 32);
-    int32_t* bitmap = new int32_t[n_longs];
-
-    for(uint32_t i = 0; i < n_longs; i++)
-        bitmap[i] = 0;
-
-    uint32_t deltaN = 0;
-    for(auto it = sns->get_begin();
-            it != sns->get_end(); ++it)
-    {
-        deltaN = (*it - sns->base).low;
-        assert((*it - sns->base).high == 0);
-        if(deltaN < 256)
-            bitmap[(uint32_t)(deltaN/32)] = (bitmap[(uint32_t)(deltaN/32)] | (1<<(31-deltaN%32)));
-        else
-            break;
-    }
-
-    for(uint32_t i= 0;i<n_longs;i++)
-        addInt32(msg,bitmap[i]);
+    for(uint32_t i = 0; i < (numBits + 31) / 32; i++)
+        addUInt32(msg, bitmap.word(i));
 
-    delete[] bitmap;
     return true;
 }
 
@@ -570,40 +535,12 @@ inline bool CDRMessage::addFragmentNumberSet(CDRMessage_t* msg,
 
     CDRMessage::addUInt32(msg, fns->base);
 
-    //Add set
-    if (fns->isSetEmpty())
-    {
-        addUInt32(msg, 0); //numbits 0
-        return true;
-    }
-
-    FragmentNumber_t maxfragNum = *(std::prev(fns->set.end()));
-
-    uint32_t numBits = (uint32_t)(maxfragNum - fns->base + 1);
-
-    if (numBits > 256)
-        return false;
+    const NumberSetBitmap& bitmap = fns->bitmap();
+    uint32_t numBits = bitmap.num_bits();
 
     addUInt32(msg, numBits);
-    uint8_t n_longs = (uint8_t)((numBits + 31) / 32);
-    int32_t* bitmap = new int32_t[n_longs];
-
-    for (uint32_t i = 0; i<n_longs; i++)
-        bitmap[i] = 0;
-
-    uint32_t deltaN = 0;
-
-    for (auto it = fns->get_begin();
-            it != fns->get_end(); ++it)
-    {
-        deltaN = (uint32_t)(*it - fns->base);
-        bitmap[(uint32_t)(deltaN / 32)] = (bitmap[(uint32_t)(deltaN / 32)] | (1 << (31 - deltaN % 32)));
-    }
-
-    for (uint32_t i = 0; i<n_longs; i++)
-        addInt32(msg, bitmap[i]);
-
-    delete[] bitmap;
+    for (uint32_t i = 0; i < (numBits + 31) / 32; i++)
+        addUInt32(msg, bitmap.word(i));
 
     return true;
 }
@@ -26,6 +26,9 @@
 #include <fastrtps/rtps/writer/StatelessWriter.h>
 #include <fastrtps/rtps/writer/StatefulWriter.h>
 
+#include <map>
+#include <unordered_map>
+
 using namespace eprosima::fastrtps;
 namespace eprosima {
 namespace fastrtps{
@@ -62,13 +65,12 @@ class MessageReceiver
          * @param[in] RTPSParticipantguidprefix RTPSParticipant Guid Prefix
          * @param[in] loc Locator indicating the sending address.
          * @param[in] msg Pointer to the message
+         * @param[in] buffer Receive buffer the message is stored in, if any. The payloads of the message are
+         * referenced from it instead of copied.
          */
-        void processCDRMsg(const GuidPrefix_t& RTPSParticipantguidprefix,Locator_t* loc, CDRMessage_t*msg);
-
-        //!Pointer to the Listen Resource that contains this MessageReceiver.
+        void processCDRMsg(const GuidPrefix_t& RTPSParticipantguidprefix,Locator_t* loc, CDRMessage_t*msg,
+                ReceiveBuffer* buffer = nullptr);
 
-        //!Received message
-        CDRMessage_t m_rec_msg;
 #if HAVE_SECURITY
         CDRMessage_t m_crypto_msg;
 #endif
@@ -82,8 +84,44 @@ class MessageReceiver
         std::vector<RTPSWriter *> AssociatedWriters;
         std::vector<RTPSReader *> AssociatedReaders;
         std::mutex mtx;
+
+        struct EntityIdHash
+        {
+            std::size_t operator()(const EntityId_t& id) const
+            {
+                return (static_cast<std::size_t>(id.value[0]) << 24) | (static_cast<std::size_t>(id.value[1]) << 16) |
+                    (static_cast<std::size_t>(id.value[2]) << 8) | static_cast<std::size_t>(id.value[3]);
+            }
+        };
+
+        //!Associated writers, indexed by their EntityId.
+        std::unordered_map<EntityId_t, RTPSWriter*, EntityIdHash> writers_by_id_;
+        //!Associated readers, indexed by their EntityId.
+        std::unordered_map<EntityId_t, RTPSReader*, EntityIdHash> readers_by_id_;
+        //!Associated readers that accept the messages of each remote writer, for submessages sent to ENTITYID_UNKNOWN.
+        std::map<GUID_t, std::vector<RTPSReader*>> readers_by_writer_;
+        //!Value of the matched writers generation of the participant when readers_by_writer_ was filled.
+        uint32_t readers_by_writer_generation_;
+        //!Holds the result of find_readers for submessages directed to a single reader.
+        std::vector<RTPSReader*> directed_readers_;
+
+        /**
+         * Finds the associated readers that have to process a submessage. Must be called with mtx locked.
+         * @param readerId EntityId the submessage is directed to. It may be ENTITYID_UNKNOWN.
+         * @param writerGUID GUID of the writer that sent the submessage.
+         * @return Readers to give the submessage to. Valid until the next call.
+         */
+        const std::vector<RTPSReader*>& find_readers(const EntityId_t& readerId, const GUID_t& writerGUID);
+
+        /**
+         * Finds the associated writer with the given GUID. Must be called with mtx locked.
+         * @return nullptr if no associated writer has this GUID.
+         */
+        RTPSWriter* find_writer(const GUID_t& writerGUID) const;
         //ReceiverControlBlock* receiver_resources;
         CacheChange_t* mp_change;
+        //!Receive buffer of the message being processed.
+        ReceiveBuffer* mp_receive_buffer;
         //!Protocol version of the message
         ProtocolVersion_t sourceVersion;
         //!VendorID that created the message
@@ -91,14 +91,18 @@ class RTPSMessageCreator
 
         static bool addMessageData(CDRMessage_t* msg, GuidPrefix_t& guidprefix, const CacheChange_t* change,
                 TopicKind_t topicKind, const EntityId_t& readerId, bool expectsInlineQos, ParameterList_t* inlineQos);
+        // When copyPayload is false, the DATA and DATA_FRAG submessage headers account for the serialized payload
+        // and its alignment padding, but neither is added to msg. The caller sends the payload followed by
+        // (4 - length % 4) & 3 zero octets right after the submessage.
         static bool addSubmessageData(CDRMessage_t* msg, const CacheChange_t* change,
-                TopicKind_t topicKind, const EntityId_t& readerId, bool expectsInlineQos, ParameterList_t* inlineQos);
+                TopicKind_t topicKind, const EntityId_t& readerId, bool expectsInlineQos, ParameterList_t* inlineQos,
+                bool copyPayload = true);
 
         static bool addMessageDataFrag(CDRMessage_t* msg, GuidPrefix_t& guidprefix, const CacheChange_t* change, uint32_t fragment_number,
                 TopicKind_t topicKind, const EntityId_t& readerId, bool expectsInlineQos, ParameterList_t* inlineQos);
         static bool addSubmessageDataFrag(CDRMessage_t* msg, const CacheChange_t* change, uint32_t fragment_number,
                 uint32_t sample_size, TopicKind_t topicKind, const EntityId_t& readerId, bool expectsInlineQos,
-                ParameterList_t* inlineQos);
+                ParameterList_t* inlineQos, bool copyPayload = true);
 
         static bool addMessageGap(CDRMessage_t* msg, const GuidPrefix_t& guidprefix, const GuidPrefix_t& remoteGuidPrefix,
                 const SequenceNumber_t& seqNumFirst, const SequenceNumberSet_t& seqNumList,const EntityId_t& readerId,const EntityId_t& writerId);
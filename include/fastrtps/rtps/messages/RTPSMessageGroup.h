@@ -123,6 +123,12 @@ class RTPSMessageGroup
 
         bool insert_submessage(const std::vector<GUID_t>& remote_endpoints);
 
+        bool insert_submessage(const std::vector<GUID_t>& remote_endpoints, const SerializedPayload_t* payload);
+
+        bool append_submessage(const SerializedPayload_t* payload);
+
+        bool can_reference_payload(const CacheChange_t& change, uint32_t length) const;
+
         bool add_info_dst_in_buffer(CDRMessage_t* buffer, const std::vector<GUID_t>& remote_endpoints);
 
         bool add_info_ts_in_buffer(const std::vector<GUID_t>& remote_readers);
@@ -146,6 +152,20 @@ class RTPSMessageGroup
         GuidPrefix_t current_dst_;
 
         std::vector<GuidPrefix_t> current_remote_participants_;
+
+        //! Serialized payload sent straight from the change, instead of being copied into full_msg_.
+        struct PayloadReference
+        {
+            //! Position of full_msg_ the payload is sent at.
+            uint32_t position;
+            const octet* data;
+            uint32_t length;
+        };
+
+        std::vector<PayloadReference> payload_references_;
+
+        //! Octets of the message that are not in full_msg_ but in payload_references_.
+        uint32_t referenced_length_;
 };
 
 } /* namespace rtps */
@@ -51,6 +51,17 @@ public:
    bool Receive(octet* receiveBuffer, uint32_t receiveBufferCapacity, uint32_t& receiveBufferSize,
                 Locator_t& originLocator);
 
+  /**
+   * Performs a blocking receive of several messages through the channel managed by this resource.
+   * @param slots Array of buffers to fill, each one notifying about its origin locator.
+   * @param slotCount Number of elements of the previous array.
+   * @return Number of received messages.
+   */
+   uint32_t ReceiveBatch(ReceiveBufferSlot* slots, uint32_t slotCount);
+
+   //! Maximum number of messages the managed channel can return in a single ReceiveBatch call.
+   uint32_t MaxBatchSize() const { return mMaxBatchSize; }
+
   /**
    * Reports whether this resource supports the given local locator (i.e., said locator
    * maps to the transport channel managed by this resource).
@@ -75,9 +86,13 @@ private:
    ReceiverResource& operator=(const ReceiverResource&) = delete;
 
    ReceiverResource(TransportInterface&, const Locator_t&);
+   //! Resource reading one more shard of a channel already opened by another resource.
+   ReceiverResource(TransportInterface&, const Locator_t&, uint32_t shard);
    std::function<void()> Cleanup;
    std::function<bool(octet*, uint32_t, uint32_t&, Locator_t&)> ReceiveFromAssociatedChannel;
+   std::function<uint32_t(ReceiveBufferSlot*, uint32_t)> ReceiveBatchFromAssociatedChannel;
    std::function<bool(const Locator_t&)> LocatorMapsToManagedChannel;
+   uint32_t mMaxBatchSize;
    bool mValid; // Post-construction validity check for the NetworkFactory
 };
 
@@ -48,6 +48,15 @@ public:
     */
    bool Send(const octet* data, uint32_t dataLength, const Locator_t& destinationLocator);
 
+   /**
+    * Sends a message made of several slices to a destination locator, through the channel managed by this resource.
+    * @param slices Slices of the message, in order.
+    * @param sliceCount Number of slices.
+    * @param destinationLocator Locator describing the destination endpoint.
+    * @return Success of the send operation.
+    */
+   bool SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& destinationLocator);
+
    /** 
    * Reports whether this resource supports the given local locator (i.e., said locator
    * maps to the transport channel managed by this resource).
@@ -74,6 +83,7 @@ private:
    SenderResource(TransportInterface&, Locator_t&);
    std::function<void()> Cleanup;
    std::function<bool(const octet* data, uint32_t dataLength, const Locator_t&)> SendThroughAssociatedChannel;
+   std::function<bool(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t&)> SendGatherThroughAssociatedChannel;
    std::function<bool(const Locator_t&)> LocatorMapsToManagedChannel;
    std::function<bool(const Locator_t&)> ManagedChannelMapsToRemote;
    bool mValid; // Post-construction validity check for the NetworkFactory
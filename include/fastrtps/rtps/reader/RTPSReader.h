@@ -84,6 +84,13 @@ namespace eprosima
                  */
                 RTPS_DllAPI bool acceptMsgDirectedTo(EntityId_t& entityId);
 
+                /**
+                 * Returns false if the reader surely discards the messages sent by the writer.
+                 * The MessageReceiver uses it to skip the readers not matched with the writer.
+                 * @param writerGUID GUID of the remote writer.
+                 */
+                RTPS_DllAPI virtual bool is_writer_accepted(const GUID_t& writerGUID) = 0;
+
                 /**
                  * Processes a new DATA message. Previously the message must have been accepted by function acceptMsgDirectedTo.
                  *
@@ -162,6 +169,15 @@ namespace eprosima
                  */
                 RTPS_DllAPI virtual bool nextUntakenCache(CacheChange_t** change, WriterProxy** wp) = 0;
 
+                /**
+                 * Check if a CacheChange_t of the history can be given to the user, because no change of its writer
+                 * is missing before it.
+                 * @param change Pointer to the CacheChange_t.
+                 * @param wp Pointer to pointer to the WriterProxy.
+                 * @return True if available.
+                 */
+                RTPS_DllAPI virtual bool isChangeAvailable(CacheChange_t* change, WriterProxy** wp) = 0;
+
                 /**
                  * @return True if the reader expects Inline QOS.
                  */
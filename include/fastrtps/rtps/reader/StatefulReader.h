@@ -72,6 +72,12 @@ class StatefulReader:public RTPSReader
          * @return True if it is matched.
          */
         bool matched_writer_is_matched(RemoteWriterAttributes& wdata);
+        /**
+         * Tells us if the messages of a writer can be processed by this reader.
+         * @param writerGUID GUID of the remote writer.
+         * @return True if the writer is matched or trusted.
+         */
+        bool is_writer_accepted(const GUID_t& writerGUID);
         /**
          * Look for a specific WriterProxy.
          * @param writerGUID GUID_t of the writer we are looking for.
@@ -146,6 +152,15 @@ class StatefulReader:public RTPSReader
          */
         bool nextUntakenCache(CacheChange_t** change,WriterProxy** wpout=nullptr);
 
+        /**
+         * Check if a CacheChange_t of the history can be given to the user, because no change of its writer
+         * is missing before it.
+         * @param change Pointer to the CacheChange_t.
+         * @param wpout Pointer to pointer the matched writer proxy
+         * @return True if available.
+         */
+        bool isChangeAvailable(CacheChange_t* change,WriterProxy** wpout=nullptr);
+
 
         /**
          * Update the times parameters of the Reader.
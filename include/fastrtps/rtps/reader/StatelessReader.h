@@ -64,6 +64,13 @@ public:
      */
     bool matched_writer_is_matched(RemoteWriterAttributes& wdata);
 
+    /**
+     * Tells us if the messages of a writer can be processed by this reader.
+     * @param writerGUID GUID of the remote writer.
+     * @return True if the writer is matched, trusted, or no writer has been matched yet.
+     */
+    bool is_writer_accepted(const GUID_t& writerGUID);
+
     /**
      * Method to indicate the reader that some change has been removed due to HistoryQos requirements.
      * @param change Pointer to the CacheChange_t.
@@ -122,6 +129,14 @@ public:
      */
     bool nextUntakenCache(CacheChange_t** change,WriterProxy** wpout=nullptr);
 
+    /**
+     * Check if a CacheChange_t of the history can be given to the user. All of them can.
+     * @param change Pointer to the CacheChange_t.
+     * @param wpout Pointer to pointer of the matched writer proxy
+     * @return True.
+     */
+    bool isChangeAvailable(CacheChange_t* change,WriterProxy** wpout=nullptr);
+
     /**
      * Get the number of matched writers
      * @return Number of matched writers
@@ -24,10 +24,12 @@
 
 #include "../common/Types.h"
 #include "../common/Locator.h"
+#include "../common/SequenceNumber.h"
 #include "../common/CacheChange.h"
 #include "../attributes/ReaderAttributes.h"
+#include "../../utils/RingBuffer.h"
 
-#include<set>
+#include <vector>
 
 // Testing purpose
 #ifndef TEST_FRIENDS
@@ -105,10 +107,12 @@ namespace eprosima
                     bool areThereMissing();
 
                     /**
-                     * The method returns a vector containing all missing changes.
-                     * @return Vector of missing changes..
+                     * Fills a SequenceNumberSet_t with the missing changes, based on the first change not yet
+                     * received or lost. Missing changes beyond the capacity of the set are left out.
+                     * @param[out] sns Set of missing changes.
+                     * @return True if there is some missing change, even when it didn't fit in the set.
                      */
-                    const std::vector<ChangeFromWriter_t>  missing_changes();
+                    bool missing_changes(SequenceNumberSet_t& sns);
 
                     size_t unknown_missing_changes_up_to(const SequenceNumber_t& seqNum);
 
@@ -168,6 +172,36 @@ namespace eprosima
 
                     bool change_was_received(const SequenceNumber_t& seq_num);
 
+                    /*!
+                     * @brief Keeps track of a change of this writer added to the reader history.
+                     * @param change Pointer to the CacheChange_t.
+                     * @remarks Protected by the reader mutex.
+                     */
+                    void history_change_added(CacheChange_t* change);
+
+                    /*!
+                     * @brief Stops tracking a change of this writer removed from the reader history.
+                     * @param change Pointer to the CacheChange_t.
+                     * @remarks Protected by the reader mutex.
+                     */
+                    void history_change_removed(CacheChange_t* change);
+
+                    /*!
+                     * @brief Returns the first change of this writer in the reader history that can be delivered,
+                     * because there are no changes missing before it.
+                     * @return Pointer to the CacheChange_t or nullptr if there isn't any.
+                     * @remarks Protected by the reader mutex.
+                     */
+                    CacheChange_t* next_available_change();
+
+                    /*!
+                     * @brief Returns the first change of this writer in the reader history that can be delivered and
+                     * was not read.
+                     * @return Pointer to the CacheChange_t or nullptr if there isn't any.
+                     * @remarks Protected by the reader mutex.
+                     */
+                    CacheChange_t* next_unread_available_change();
+
                 private:
 
                     /*!
@@ -182,6 +216,18 @@ namespace eprosima
 
                     bool received_change_set(const SequenceNumber_t& seqNum, bool is_relevance);
 
+                    /*!
+                     * @brief Adds a ChangeFromWriter_t after the last one. Its sequence number must be the next one.
+                     * @remarks No thread-safe.
+                     */
+                    void add_change_from_writer(const ChangeFromWriter_t& change);
+
+                    /*!
+                     * @brief Returns the state of a ChangeFromWriter_t managed currently by the WriterProxy.
+                     * @remarks No thread-safe.
+                     */
+                    ChangeFromWriter_t change_from_writer(const SequenceNumber_t& seqNum) const;
+
                     void cleanup();
 
                     //!Is the writer alive
@@ -192,23 +238,54 @@ namespace eprosima
                     //!Mutex Pointer
                     std::recursive_mutex* mp_mutex;
 
-                    //!Vector containing the ChangeFromWriter_t objects.
-                    std::set<ChangeFromWriter_t, ChangeFromWriterCmp> m_changesFromW;
+                    std::vector<uint64_t>* status_bits(ChangeFromWriterStatus_t status);
+
+                    ChangeFromWriterStatus_t status_at(uint32_t position) const;
+
+                    void set_status_at(uint32_t position, ChangeFromWriterStatus_t status);
+
+                    uint32_t position_of(const SequenceNumber_t& seqNum) const;
+
+                    template<typename Operation>
+                    void for_each_word(uint32_t first, uint32_t last, Operation operation);
+
+                    void reserve_changes(uint32_t count);
+
+                    void remove_first_changes(uint32_t count);
+
+                    /*!
+                     * The ChangeFromWriter_t after changesFromWLowMark_, one per sequence number, are kept in a ring of
+                     * bits. Its capacity is a power of two multiple of 64.
+                     */
+                    uint32_t capacity_;
+                    //! Position in the ring of the sequence number following changesFromWLowMark_.
+                    uint32_t head_;
+                    //! Number of ChangeFromWriter_t in the ring.
+                    uint32_t count_;
+                    //! One bit per position in the ring for each status. UNKNOWN changes have none of them set.
+                    std::vector<uint64_t> missing_bits_;
+                    std::vector<uint64_t> received_bits_;
+                    std::vector<uint64_t> lost_bits_;
+                    //! One bit per position in the ring set for changes that are not relevant.
+                    std::vector<uint64_t> irrelevant_bits_;
+                    //! Number of MISSING changes.
+                    uint32_t missing_count_;
+
                     SequenceNumber_t changesFromWLowMark_;
 
                     //! Store last ChacheChange_t notified.
                     SequenceNumber_t lastNotified_;
 
-                    void for_each_set_status_from(decltype(m_changesFromW)::iterator first,
-                            decltype(m_changesFromW)::iterator last,
-                            ChangeFromWriterStatus_t status,
-                            ChangeFromWriterStatus_t new_status);
+                    /*!
+                     * Changes of this writer in the reader history, ordered by sequence number. The ones up to
+                     * available_changes_max() can be delivered.
+                     */
+                    RingBuffer<CacheChange_t*> history_changes_;
+                    //! Position in history_changes_ before which all the changes were read.
+                    size_t first_unread_change_;
 
-                    void for_each_set_status_from_and_maybe_remove(decltype(m_changesFromW)::iterator first,
-                            decltype(m_changesFromW)::iterator last,
-                            ChangeFromWriterStatus_t status,
-                            ChangeFromWriterStatus_t orstatus,
-                            ChangeFromWriterStatus_t new_status);
+                    //! Position of the first change in history_changes_ whose sequence number is not lower.
+                    size_t history_change_position(const SequenceNumber_t& seqNum) const;
             };
 
         } /* namespace rtps */
@@ -201,6 +201,14 @@ class RTPSWriter : public Endpoint
      */
     virtual bool change_removed_by_history(CacheChange_t* a_change)=0;
 
+    /**
+     * Check whether the changes for a matched reader can be delivered to it inside this process,
+     * without going through the transports.
+     * @param reader_guid GUID of the matched reader.
+     * @return True if both participants enabled intra-process delivery and the reader lives in this process.
+     */
+    bool is_local_reader(const GUID_t& reader_guid);
+
     private:
 
     RTPSWriter& operator=(const RTPSWriter&) NON_COPYABLE_CXX11;
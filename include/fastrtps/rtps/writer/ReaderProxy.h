@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <mutex>
 #include <set>
+#include <vector>
 #include "../common/Types.h"
 #include "../common/Locator.h"
 #include "../common/SequenceNumber.h"
@@ -78,11 +79,11 @@ namespace eprosima
                 bool acked_changes_set(const SequenceNumber_t& seqNum);
 
                 /**
-                 * Mark all changes in the vector as requested.
-                 * @param seqNumSet Vector of sequenceNumbers
+                 * Mark all changes in the set as requested.
+                 * @param seqNumSet Set of sequenceNumbers
                  * @return False if any change was set REQUESTED.
                  */
-                bool requested_changes_set(std::vector<SequenceNumber_t>& seqNumSet);
+                bool requested_changes_set(const SequenceNumberSet_t& seqNumSet);
 
                 /*!
                  * @brief Lists all unsent changes. These changes are also relevants and valid.
@@ -113,6 +114,15 @@ namespace eprosima
                  */
                 void convert_status_on_all_changes(ChangeForReaderStatus_t previous, ChangeForReaderStatus_t next);
 
+                /*!
+                 * Reports whether an unsent change is sent again because the reader requested it, and not for the
+                 * first time.
+                 */
+                bool is_repair(const SequenceNumber_t& seq_num) const { return seq_num <= lastRepairSequenceNumber_; }
+
+                //! Locators of the messages sent to this reader alone: its unicast ones, or multicast ones if it has none.
+                const LocatorList_t& directed_locators();
+
                 //void setNotValid(const CacheChange_t* change);
                 void setNotValid(CacheChange_t* change);
 
@@ -163,6 +173,18 @@ namespace eprosima
                  */
                 void setLastNackfragCount(uint32_t lastNackfragCount) { lastNackfragCount_ = lastNackfragCount; }
 
+                /*!
+                 * @brief Returns whether the reader lives in this process and takes its data directly from the writer.
+                 * @return True if the data for this reader skips the transports.
+                 */
+                bool isLocal() const { return isLocal_; }
+
+                /*!
+                 * @brief Sets whether the reader lives in this process.
+                 * @param isLocal New value.
+                 */
+                void setLocal(bool isLocal) { isLocal_ = isLocal; }
+
                 //! Timed Event to manage the Acknack response delay.
                 NackResponseDelay* mp_nackResponse;
                 //! Timed Event to manage the delay to mark a change as UNACKED after sending it.
@@ -182,14 +204,50 @@ namespace eprosima
                 //!Mutex
                 std::recursive_mutex* mp_mutex;
 
-                std::set<ChangeForReader_t, ChangeForReaderCmp> m_changesForReader;
-
-                //!Set of the changes and its state.
                 private:
+
+                //! Number of values of ChangeForReaderStatus_t.
+                static const uint32_t c_status_count = 5;
+
+                ChangeForReader_t& change_at(uint32_t offset) { return m_changesForReader[(head_ + offset) & (m_changesForReader.size() - 1)]; }
+
+                ChangeForReader_t* find_change(const SequenceNumber_t& seq_num, uint32_t& offset);
+
+                bool next_change_with_status(ChangeForReaderStatus_t status, uint32_t& offset) const;
+
+                void set_status(uint32_t offset, ChangeForReaderStatus_t status);
+
+                void remove_first_changes(uint32_t count);
+
                 //! Last  NACKFRAG count.
                 uint32_t lastNackfragCount_;
 
                 SequenceNumber_t changesFromRLowMark_;
+
+                //! Greatest sequence number requested by the reader and made unsent again.
+                SequenceNumber_t lastRepairSequenceNumber_;
+
+                /*!
+                 * Changes after changesFromRLowMark_ and their state, in a ring ordered by sequence number.
+                 * Its size is a power of two. The offset of a change from the first one is usually the difference
+                 * of their sequence numbers, unless some sequence numbers are not tracked.
+                 */
+                std::vector<ChangeForReader_t> m_changesForReader;
+
+                //! Position of the first change in the ring.
+                uint32_t head_;
+
+                //! Number of changes in the ring.
+                uint32_t count_;
+
+                //! For each status, one bit per position of the ring telling whether the change there has that status.
+                std::vector<uint64_t> status_bits_[c_status_count];
+
+                //! Number of changes with each status.
+                uint32_t status_count_[c_status_count];
+
+                //! Whether the reader lives in this process.
+                bool isLocal_;
             };
         }
     } /* namespace rtps */
@@ -25,6 +25,7 @@
 #include "timedevent/PeriodicHeartbeat.h"
 #include <condition_variable>
 #include <mutex>
+#include <map>
 
 
 namespace eprosima
@@ -34,6 +35,7 @@ namespace eprosima
         namespace rtps
         {
             class ReaderProxy;
+            class RTPSMessageGroup;
 
             /**
              * Class StatefulWriter, specialization of RTPSWriter that maintains information of each matched Reader.
@@ -63,8 +65,29 @@ namespace eprosima
                 size_t m_readers_to_walk;
                 bool wrap_around_readers();
 
+                //! What a round of send_any_unsent_changes sends to one matched reader.
+                struct ReaderSendState
+                {
+                    ReaderProxy* proxy;
+                    //! Changes to send, with the fragments selected by the flow controllers for fragmented ones.
+                    std::map<CacheChange_t*, std::vector<uint32_t>> changes;
+                    std::vector<SequenceNumber_t> gaps;
+                };
+
+                //! Readers reached through the same locators.
+                struct DestinationGroup
+                {
+                    LocatorList_t locators;
+                    std::vector<ReaderSendState> readers;
+                };
+
+                //! Sends each pending change once to all the readers of the destination that need it.
+                void send_to_destination(RTPSMessageGroup& group, DestinationGroup& destination);
+
                 //! Vector containin all the associated ReaderProxies.
                 std::vector<ReaderProxy*> matched_readers;
+                //! Same ReaderProxies as matched_readers, indexed by the GUID of the remote reader.
+                std::map<GUID_t, ReaderProxy*> matched_readers_by_guid_;
                 //!EntityId used to send the HB.(only for builtin types performance)
                 EntityId_t m_HBReaderEntityId;
                 // TODO Join this mutex when main mutex would not be recursive.
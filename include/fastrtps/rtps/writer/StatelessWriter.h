@@ -26,6 +26,7 @@
 #include "ReaderLocator.h"
 
 #include <list>
+#include <map>
 
 namespace eprosima {
 namespace fastrtps{
@@ -127,6 +128,8 @@ class StatelessWriter : public RTPSWriter
     //Duration_t resendDataPeriod; //FIXME: Not used yet.
     std::vector<ReaderLocator> reader_locators;
     std::vector<RemoteReaderAttributes> m_matched_readers;
+    //!Matched readers living in this process, with the changes pending to be delivered to each of them.
+    std::map<GUID_t, std::vector<CacheChange_t*> > m_local_readers;
     std::vector<std::unique_ptr<FlowController> > m_controllers;
 };
 }
@@ -21,6 +21,7 @@
 #define SUBSCRIBER_H_
 
 #include "../rtps/common/Guid.h"
+#include "../rtps/common/InstanceHandle.h"
 #include "../attributes/SubscriberAttributes.h"
 
 using namespace eprosima::fastrtps::rtps;
@@ -28,6 +29,11 @@ using namespace eprosima::fastrtps::rtps;
 namespace eprosima {
 namespace fastrtps{
 
+namespace rtps
+{
+struct SerializedPayload_t;
+}
+
 class SubscriberImpl;
 class SampleInfo_t;
 
@@ -74,6 +80,71 @@ public:
 	 */
 	bool takeNextData(void* data,SampleInfo_t* info);
 
+	/**
+	 * Read up to max_samples unread Data from the Subscriber at once.
+	 * @param data Array of pointers to the objects where you want the data stored.
+	 * @param info Array of SampleInfo_t structures, one per object, or nullptr.
+	 * @param max_samples Size of the arrays.
+	 * @return Number of samples read.
+	 */
+	uint32_t readData(void** data,SampleInfo_t* info,uint32_t max_samples);
+
+	/**
+	 * Take up to max_samples Data from the Subscriber at once. The data is removed from the subscriber.
+	 * @param data Array of pointers to the objects where you want the data stored.
+	 * @param info Array of SampleInfo_t structures, one per object, or nullptr.
+	 * @param max_samples Size of the arrays.
+	 * @return Number of samples taken.
+	 */
+	uint32_t takeData(void** data,SampleInfo_t* info,uint32_t max_samples);
+
+	/**
+	 * Read up to max_samples unread Data of an instance from the Subscriber at once.
+	 * @param data Array of pointers to the objects where you want the data stored.
+	 * @param info Array of SampleInfo_t structures, one per object, or nullptr.
+	 * @param max_samples Size of the arrays.
+	 * @param handle Instance of the samples.
+	 * @return Number of samples read.
+	 */
+	uint32_t readInstanceData(void** data,SampleInfo_t* info,uint32_t max_samples,const InstanceHandle_t& handle);
+
+	/**
+	 * Take up to max_samples Data of an instance from the Subscriber at once. The data is removed from the subscriber.
+	 * @param data Array of pointers to the objects where you want the data stored.
+	 * @param info Array of SampleInfo_t structures, one per object, or nullptr.
+	 * @param max_samples Size of the arrays.
+	 * @param handle Instance of the samples.
+	 * @return Number of samples taken.
+	 */
+	uint32_t takeInstanceData(void** data,SampleInfo_t* info,uint32_t max_samples,const InstanceHandle_t& handle);
+
+	/**
+	 * Take next sample from the Subscriber without copying it. The sample is removed from the subscriber,
+	 * but its payload stays valid until the loan is returned with returnLoan.
+	 * @param payload Pointer where the address of the read-only payload is stored.
+	 * @param info Pointer to a SampleInfo_t structure that informs you about your sample.
+	 * @return True if a sample was taken.
+	 */
+	bool takeNextLoanedPayload(const SerializedPayload_t** payload,SampleInfo_t* info);
+
+	/**
+	 * Take next Data from the Subscriber as a loaned object, to be returned with returnLoan.
+	 * For plain types the object is read in place inside the received payload, without copying nor
+	 * deserializing it. Other types are deserialized into an object created by the type.
+	 * Samples which are not ALIVE have no data: the object is nullptr and there is no loan to return.
+	 * @param data Pointer where the address of the read-only object is stored.
+	 * @param info Pointer to a SampleInfo_t structure that informs you about your sample.
+	 * @return True if a sample was taken.
+	 */
+	bool takeNextLoanedData(const void** data,SampleInfo_t* info);
+
+	/**
+	 * Return a loan obtained with takeNextLoanedPayload or takeNextLoanedData.
+	 * @param loan Address of the loaned payload or object.
+	 * @return True if it was loaned by this subscriber.
+	 */
+	bool returnLoan(const void* loan);
+
 
 	/**
 	 * Update the Attributes of the subscriber;
@@ -24,8 +24,12 @@
 #include <fastrtps/rtps/resources/ResourceManagement.h>
 #include "../rtps/history/ReaderHistory.h"
 #include "../qos/QosPolicies.h"
+#include "../utils/RingBuffer.h"
 #include "SampleInfo.h"
 
+#include <list>
+#include <unordered_map>
+
 using namespace eprosima::fastrtps::rtps;
 
 namespace eprosima {
@@ -44,8 +48,18 @@ class SubscriberImpl;
  */
 class SubscriberHistory: public ReaderHistory {
 public:
-	typedef std::pair<InstanceHandle_t,std::vector<CacheChange_t*>> t_p_I_Change;
-	typedef std::vector<t_p_I_Change> t_v_Inst_Caches;
+	//!Changes of an instance, ordered by sequence number.
+	struct KeyedChanges
+	{
+		KeyedChanges(size_t capacity) : cache_changes(capacity) {}
+
+		RingBuffer<CacheChange_t*> cache_changes;
+		//!Position in the list of empty instances. Only valid while the instance has no changes.
+		std::list<InstanceHandle_t>::iterator empty_it;
+	};
+	typedef std::unordered_map<InstanceHandle_t, KeyedChanges> t_m_Inst_Caches;
+	//!Former name of t_m_Inst_Caches, kept so that code naming its iterators still builds.
+	typedef t_m_Inst_Caches t_v_Inst_Caches;
 	
 	/**
 	* Constructor. Requires information about the subscriner
@@ -77,6 +91,29 @@ public:
 	bool readNextData(void* data, SampleInfo_t* info);
 	bool takeNextData(void* data, SampleInfo_t* info);
 	///@}
+
+	/** @name Read or take several data methods.
+	 * Methods to read or take up to max_samples data from the History at once.
+	 * @param data Array of pointers to the objects where you want to read or take the information.
+	 * @param info Array of SampleInfo_t objects, one per object, or nullptr.
+	 * @param max_samples Size of the arrays.
+	 * @param handle Pointer to the instance the data must belong to, or nullptr for any instance.
+	 * @return Number of data read or taken.
+	 */
+	///@{
+	uint32_t readData(void** data, SampleInfo_t* info, uint32_t max_samples, const InstanceHandle_t* handle = nullptr);
+	uint32_t takeData(void** data, SampleInfo_t* info, uint32_t max_samples, const InstanceHandle_t* handle = nullptr);
+	///@}
+
+	/**
+	 * Takes the next change out of the history without deserializing it. The change is not given back
+	 * to the pool, so its payload stays valid until it is released with release_Cache.
+	 * @param[out] change Pointer where the taken change is stored.
+	 * @param info Pointer to a SampleInfo_t object where you want
+	 * to store the information about the retrieved data
+	 * @return True if a change was taken.
+	 */
+	bool takeNextChange(CacheChange_t** change, SampleInfo_t* info);
 	
 	/**
 	 * Method to know whether there are unread CacheChange_t.
@@ -87,10 +124,11 @@ public:
 	/**
 	* This method is called to remove a change from the SubscriberHistory.
 	* @param change Pointer to the CacheChange_t.
-	* @param vit Pointer to the iterator of the key-ordered cacheChange vector.
+	* @param vit Pointer to the iterator of the instance of the change.
+	* @param release Whether the change is given back to the pool. Otherwise it has to be released later.
 	* @return True if removed.
 	*/
-	bool remove_change_sub(CacheChange_t* change,t_v_Inst_Caches::iterator* vit=nullptr);
+	bool remove_change_sub(CacheChange_t* change,t_m_Inst_Caches::iterator* vit=nullptr, bool release = true);
 
 	//!Increase the unread count.
 	inline void increaseUnreadCount()
@@ -115,8 +153,11 @@ public:
 private:
 	//!Number of unread CacheChange_t.
 	uint64_t m_unreadCacheCount;
-	//!Vector of pointer to the CacheChange_t divided by key.
-	t_v_Inst_Caches m_keyedChanges;
+	//!Changes of each instance.
+	t_m_Inst_Caches m_keyedChanges;
+	//!Instances without changes, least recently used first. They are evicted in this order when
+	//!max_instances is reached.
+	std::list<InstanceHandle_t> m_emptyInstances;
 	//!HistoryQosPolicy values.
 	HistoryQosPolicy m_historyQos;
 	//!ResourceLimitsQosPolicy values.
@@ -128,7 +169,19 @@ private:
 	void * mp_getKeyObject;
 
 
-	bool find_Key(CacheChange_t* a_change,t_v_Inst_Caches::iterator* vecPairIterrator);
+	bool find_Key(CacheChange_t* a_change,t_m_Inst_Caches::iterator* vit_out);
+
+	//!Marks the change as read and gives its data.
+	void read_change(CacheChange_t* change, WriterProxy* wp, void* data, SampleInfo_t* info);
+
+	//!Gives the data of a change that is going to be taken.
+	void take_change_data(CacheChange_t* change, WriterProxy* wp, void* data, SampleInfo_t* info);
+
+	//!Deserializes the change into data and fills info, if not nullptr.
+	void deserialize_change(CacheChange_t* change, WriterProxy* wp, void* data, SampleInfo_t* info);
+
+	//!Adds the change to its instance, keeping the sequence number order.
+	void add_to_instance(CacheChange_t* a_change, t_m_Inst_Caches::iterator vit);
 
 };
 
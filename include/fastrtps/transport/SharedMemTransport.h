@@ -0,0 +1,151 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAREDMEM_TRANSPORT_H
+#define SHAREDMEM_TRANSPORT_H
+
+#include "TransportInterface.h"
+#include "SharedMemTransportDescriptor.h"
+#include <string>
+#include <memory>
+#include <map>
+#include <set>
+#include <mutex>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+/**
+ * Transport for participants running on the same host. RTPS messages are copied into POSIX shared
+ * memory segments instead of going through the network stack.
+ *    - An input channel corresponds to a port. Opening it creates a shared memory segment, named after
+ *       the port, holding a lock-free ring buffer of fixed size slots. Only one input channel in the
+ *       whole host can own a given port, so opening a port already owned by a live process fails.
+ *
+ *    - Output channels do not own any resource. Sending to a remote locator maps the segment of the
+ *       destination port (mappings are cached) and pushes the message into its ring. When the ring is
+ *       full the message is dropped, as a UDP socket would do.
+ *
+ *    - Locators use the LOCATOR_KIND_SHM kind. Their address identifies the host, so that locators
+ *       announced by participants on other hosts are never confused with local ports.
+ *
+ * This transport is only available on POSIX systems. On the rest, init() fails.
+ * @ingroup TRANSPORT_MODULE
+ */
+class SharedMemTransport : public TransportInterface
+{
+public:
+
+   RTPS_DllAPI SharedMemTransport(const SharedMemTransportDescriptor&);
+
+   virtual ~SharedMemTransport();
+
+   bool init();
+
+   //! Checks whether this transport owns the segment of the given port.
+   virtual bool IsInputChannelOpen(const Locator_t&) const;
+
+   //! Checks whether an output channel was opened on the given port.
+   virtual bool IsOutputChannelOpen(const Locator_t&) const;
+
+   //! Checks for SHM kind.
+   virtual bool IsLocatorSupported(const Locator_t&) const;
+
+   //! Reports whether Locators correspond to the same port.
+   virtual bool DoLocatorsMatch(const Locator_t&, const Locator_t&) const;
+
+   /**
+    * Converts a given remote locator to the main local locator whose channel can write to that
+    * destination. As output channels are not bound to ports, it returns the locator on port 0.
+    */
+   virtual Locator_t RemoteToMainLocal(const Locator_t&) const;
+
+   //! Creates the shared memory segment of the given port and takes its ownership.
+   virtual bool OpenInputChannel(const Locator_t&);
+
+   //! Marks the output channel as open. No resources are needed to send.
+   virtual bool OpenOutputChannel(Locator_t&);
+
+   //! Wakes up any thread blocked on the channel, and removes the segment of the given port.
+   virtual bool CloseInputChannel(const Locator_t&);
+
+   //! Marks the output channel as closed.
+   virtual bool CloseOutputChannel(const Locator_t&);
+
+   /**
+    * Copies the message into the ring buffer of the port described by the remote locator. It never blocks.
+    * @param sendBuffer Slice into the raw data to send.
+    * @param sendBufferSize Size of the raw data. It must not exceed the maxMessageSize of the descriptor.
+    * @param localLocator Locator mapping to the channel we're sending from.
+    * @param remoteLocator Locator describing the remote destination we're sending to.
+    */
+   virtual bool Send(const octet* sendBuffer, uint32_t sendBufferSize, const Locator_t& localLocator, const Locator_t& remoteLocator);
+
+   //! Copies the slices of the message, one after the other, into a single slot of the destination ring.
+   virtual bool SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& localLocator,
+                           const Locator_t& remoteLocator);
+
+   /**
+    * Blocking Receive from the ring buffer of the specified channel. Closing the channel wakes it up.
+    * @param receiveBuffer Buffer with enough capacity to accomodate a message of maxMessageSize.
+    * @param localLocator Locator mapping to the local channel we're listening to.
+    * @param[out] remoteLocator Locator of the host and the port the message came from.
+    */
+   virtual bool Receive(octet* receiveBuffer, uint32_t receiveBufferCapacity, uint32_t& receiveBufferSize,
+                        const Locator_t& localLocator, Locator_t& remoteLocator);
+
+   //! Fills the address of the locator with the identifier of this host.
+   virtual LocatorList_t NormalizeLocator(const Locator_t& locator);
+
+protected:
+   //! Shared memory segment of one port. Defined in the implementation file.
+   class PortSegment;
+
+   //! Returns the name of the shared memory segment of the given port.
+   std::string SegmentName(uint32_t port) const;
+
+   //! Returns true when the locator refers to a port on this host.
+   bool IsLocalHost(const Locator_t& locator) const;
+
+   //! Returns the cached mapping of a remote port, mapping it if needed.
+   std::shared_ptr<PortSegment> RemoteSegment(uint32_t port);
+
+   uint32_t mMaxMessageSize;
+   uint32_t mPortQueueCapacity;
+   std::string mSegmentNamePrefix;
+   uint32_t mSegmentPermissions;
+   //! Host identifier written in the address of the locators.
+   octet mHostId[8];
+
+   mutable std::mutex mOutputMapMutex;
+   mutable std::mutex mInputMapMutex;
+
+   //! Output channels, indexed by port.
+   std::set<uint32_t> mOutputChannels;
+   //! Mappings of the segments this transport sends to, indexed by port.
+   std::map<uint32_t, std::shared_ptr<PortSegment>> mRemoteSegments;
+
+   /**
+    * Segments owned by this transport, indexed by port. They are shared with the thread blocked on them,
+    * so that closing the channel cannot unmap a segment that is still being read.
+    */
+   std::map<uint32_t, std::shared_ptr<PortSegment>> mInputSegments;
+};
+
+} // namespace rtps
+} // namespace fastrtps
+} // namespace eprosima
+
+#endif
@@ -0,0 +1,54 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAREDMEM_TRANSPORT_DESCRIPTOR
+#define SHAREDMEM_TRANSPORT_DESCRIPTOR
+
+#include "TransportInterface.h"
+#include <string>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+/**
+ * Transport configuration
+ *
+ * - portQueueCapacity: number of messages the ring buffer of each input port
+ *                  can hold. Rounded up to a power of two.
+ *
+ * - segmentNamePrefix: prefix of the shared memory segment names. Only transports
+ *                  sharing the same prefix can reach each other.
+ *
+ * - segmentPermissions: access mode of the shared memory segments, as given to
+ *                  shm_open. By default only the user owning the segment can use it.
+ * @ingroup TRANSPORT_MODULE
+ */
+typedef struct SharedMemTransportDescriptor: public TransportDescriptorInterface {
+   //! Number of messages queued on each input port before senders start dropping them.
+   uint32_t portQueueCapacity;
+   //! Prefix of the names of the shared memory segments.
+   std::string segmentNamePrefix;
+   //! Permission bits of the shared memory segments created by input channels.
+   uint32_t segmentPermissions;
+
+   virtual ~SharedMemTransportDescriptor(){}
+   RTPS_DllAPI SharedMemTransportDescriptor();
+} SharedMemTransportDescriptor;
+
+} // namespace rtps
+} // namespace fastrtps
+} // namespace eprosima
+
+#endif
@@ -16,12 +16,45 @@
 #define TRANSPORT_INTERFACE_H
 
 #include <vector>
+#include <cstring>
 #include <fastrtps/rtps/common/Locator.h>
 
 namespace eprosima{
 namespace fastrtps{
 namespace rtps{
 
+/**
+ * Describes one of the buffers filled by a batched receive operation.
+ * @ingroup TRANSPORT_MODULE
+ */
+struct ReceiveBufferSlot
+{
+    ReceiveBufferSlot() : buffer(nullptr), capacity(0), size(0) {}
+
+    //! Buffer where the received message is stored.
+    octet* buffer;
+    //! Capacity of the buffer. Used as a bounds check.
+    uint32_t capacity;
+    //! Final size of the received message.
+    uint32_t size;
+    //! Address of the remote sender.
+    Locator_t remoteLocator;
+};
+
+/**
+ * Describes one of the slices of a message sent by a gathered send operation.
+ * @ingroup TRANSPORT_MODULE
+ */
+struct SendBufferSlice
+{
+    SendBufferSlice() : buffer(nullptr), size(0) {}
+    SendBufferSlice(const octet* sliceBuffer, uint32_t sliceSize) : buffer(sliceBuffer), size(sliceSize) {}
+
+    //! Start of the slice.
+    const octet* buffer;
+    //! Size of the slice.
+    uint32_t size;
+};
 
 /**
  * Interface against which to implement a transport layer, decoupled from FastRTPS internals.
@@ -93,6 +126,34 @@ public:
    */
    virtual bool Send(const octet* sendBuffer, uint32_t sendBufferSize, const Locator_t& localLocator, const Locator_t& remoteLocator) = 0;
 
+   /**
+    * Executes a blocking send of a message made of several slices, as Send does. The slices are sent in order as a
+    * single message, so that large payloads don't have to be copied next to their headers first. The default
+    * implementation copies the slices into a contiguous buffer and calls Send.
+    * @param slices Array of slices of the message.
+    * @param sliceCount Number of elements of the previous array.
+    * @param localLocator Locator mapping to the channel we're sending from.
+    * @param remoteLocator Locator describing the remote destination we're sending to.
+    */
+   virtual bool SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& localLocator,
+                           const Locator_t& remoteLocator)
+   {
+       uint32_t totalSize = 0;
+       for(uint32_t i = 0; i < sliceCount; ++i)
+           totalSize += slices[i].size;
+
+       std::vector<octet> message(totalSize);
+       uint32_t position = 0;
+       for(uint32_t i = 0; i < sliceCount; ++i)
+       {
+           if(slices[i].size > 0)
+               memcpy(&message[position], slices[i].buffer, slices[i].size);
+           position += slices[i].size;
+       }
+
+       return Send(message.data(), totalSize, localLocator, remoteLocator);
+   }
+
    /**
     * Must execute a blocking receive, on the inbound channel that maps to the localLocator, receiving from the
     * address that gets written to remoteLocator. Must be threadsafe between channels, but not necessarily
@@ -101,6 +162,44 @@ public:
    virtual bool Receive(octet* receiveBuffer, uint32_t receiveBufferCapacity, uint32_t& receiveBufferSize,
                         const Locator_t& localLocator, Locator_t& remoteLocator) = 0;
 
+   /**
+    * Executes a blocking receive of several messages, on the inbound channel that maps to the localLocator.
+    * It must block until at least one message is available and may then fill the remaining slots with the
+    * messages already queued on the channel, without blocking again. The default implementation performs
+    * a single Receive.
+    * @param slots Array of buffers to fill.
+    * @param slotCount Number of elements of the previous array.
+    * @param localLocator Locator mapping to the local channel we're listening to.
+    * @return Number of slots filled. Zero means the receive failed.
+    */
+   virtual uint32_t ReceiveBatch(ReceiveBufferSlot* slots, uint32_t slotCount, const Locator_t& localLocator)
+   {
+       if(slotCount == 0)
+           return 0;
+
+       return Receive(slots[0].buffer, slots[0].capacity, slots[0].size, localLocator, slots[0].remoteLocator) ? 1 : 0;
+   }
+
+   //! Reports the maximum number of messages a single ReceiveBatch call can return.
+   virtual uint32_t MaxReceiveBatchSize() const { return 1; }
+
+   /**
+    * Reports in how many shards the open inbound channel that maps to the localLocator is split.
+    * Each shard receives part of the messages of the channel, and has to be read by its own thread.
+    */
+   virtual uint32_t InputChannelShards(const Locator_t&) const { return 1; }
+
+   /**
+    * Same as ReceiveBatch, but reading one shard of the inbound channel. Shard 0 is the one read by
+    * Receive and ReceiveBatch.
+    * @param shard Index of the shard, lower than the value returned by InputChannelShards.
+    */
+   virtual uint32_t ReceiveBatchFromShard(ReceiveBufferSlot* slots, uint32_t slotCount, const Locator_t& localLocator,
+                                          uint32_t shard)
+   {
+       return shard == 0 ? ReceiveBatch(slots, slotCount, localLocator) : 0;
+   }
+
    virtual LocatorList_t NormalizeLocator(const Locator_t& locator) = 0;
 };
 
@@ -55,7 +55,7 @@ class UDPv6Transport : public TransportInterface
 
 #if defined(ASIO_HAS_MOVE)
             SocketInfo(asio::ip::udp::socket& socket) :
-                socket_(std::move(socket)), only_multicast_purpose_(false)
+                socket_(std::make_shared<asio::ip::udp::socket>(std::move(socket))), only_multicast_purpose_(false)
 #else
             SocketInfo(std::shared_ptr<asio::ip::udp::socket> socket) :
                 socket_(socket), only_multicast_purpose_(false)
@@ -64,22 +64,14 @@ class UDPv6Transport : public TransportInterface
             }
 
             SocketInfo(SocketInfo&& socketInfo) :
-#if defined(ASIO_HAS_MOVE)
                 socket_(std::move(socketInfo.socket_)),
-#else
-                socket_(socketInfo.socket_),
-#endif
                 only_multicast_purpose_(socketInfo.only_multicast_purpose_)
             {
             }
 
             SocketInfo& operator=(SocketInfo&& socketInfo)
             {
-#if defined(ASIO_HAS_MOVE)
                 socket_ = std::move(socketInfo.socket_);
-#else
-                socket_ = socketInfo.socket_;
-#endif
                 only_multicast_purpose_ = socketInfo.only_multicast_purpose_;
                 return *this;
             }
@@ -99,11 +91,8 @@ class UDPv6Transport : public TransportInterface
                 return only_multicast_purpose_;
             }
 
-#if defined(ASIO_HAS_MOVE)
-            asio::ip::udp::socket socket_;
-#else
+            //! Shared with the threads sending through it, so that closing the channel doesn't destroy it.
             std::shared_ptr<asio::ip::udp::socket> socket_;
-#endif
             bool only_multicast_purpose_;
 
         private:
@@ -168,8 +157,21 @@ public:
     * @param remoteLocator Locator describing the remote destination we're sending to.
     */
    virtual bool Send(const octet* sendBuffer, uint32_t sendBufferSize, const Locator_t& localLocator, const Locator_t& remoteLocator);
+
    /**
-    * Blocking Receive from the specified channel.
+    * Blocking Send of a message made of several slices, through the specified channel. The slices are handed
+    * to the socket as a single gathered datagram, so they are not copied into a contiguous buffer.
+    * @param slices Array of slices of the message. Their total size must not exceed the sendBufferSize fed to
+    * this class during construction.
+    * @param sliceCount Number of elements of the previous array.
+    * @param localLocator Locator mapping to the channel we're sending from.
+    * @param remoteLocator Locator describing the remote destination we're sending to.
+    */
+   virtual bool SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& localLocator,
+                           const Locator_t& remoteLocator);
+   /**
+    * Blocking Receive from the specified channel. The read is performed directly by the calling thread,
+    * and closing the channel wakes it up.
     * @param receiveBuffer vector with enough capacity (not size) to accomodate a full receive buffer. That
     * capacity must not be less than the receiveBufferSize supplied to this class during construction.
     * @param localLocator Locator mapping to the local channel we're listening to.
@@ -178,6 +180,30 @@ public:
    virtual bool Receive(octet* receiveBuffer, uint32_t receiveBufferCapacity, uint32_t& receiveBufferSize,
                         const Locator_t& localLocator, Locator_t& remoteLocator);
 
+   /**
+    * Blocking Receive of several datagrams from the specified channel. It waits for the first datagram like
+    * Receive does, and then drains without blocking up to slotCount - 1 datagrams already queued on the socket.
+    * @param slots Array of buffers to fill. Each capacity must not be less than the receiveBufferSize supplied
+    * to this class during construction.
+    * @param slotCount Number of elements of the previous array.
+    * @param localLocator Locator mapping to the local channel we're listening to.
+    * @return Number of datagrams received.
+    */
+   virtual uint32_t ReceiveBatch(ReceiveBufferSlot* slots, uint32_t slotCount, const Locator_t& localLocator);
+
+   //! Returns the receiveBatchSize supplied to this class during construction.
+   virtual uint32_t MaxReceiveBatchSize() const;
+
+   //! Returns the number of sockets bound to the port of the open channel. Multicast channels use a single one.
+   virtual uint32_t InputChannelShards(const Locator_t& localLocator) const;
+
+   /**
+    * Same as ReceiveBatch, reading one of the sockets bound to the port of the channel.
+    * @param shard Index of the socket, lower than the value returned by InputChannelShards.
+    */
+   virtual uint32_t ReceiveBatchFromShard(ReceiveBufferSlot* slots, uint32_t slotCount, const Locator_t& localLocator,
+                                          uint32_t shard);
+
    virtual LocatorList_t NormalizeLocator(const Locator_t& locator);
 
 private:
@@ -185,10 +211,11 @@ private:
    uint32_t mSendBufferSize;
    uint32_t mReceiveBufferSize;
    uint8_t mTTL;
+   uint32_t mReceiveBatchSize;
+   uint32_t mReceiveSocketsPerPort;
 
    // For UDPv6, the notion of channel corresponds to a port + direction tuple.
-	asio::io_service mService;
-   std::unique_ptr<std::thread> ioServiceThread;
+   asio::io_service mService;
 
    mutable std::recursive_mutex mOutputMapMutex;
    mutable std::recursive_mutex mInputMapMutex;
@@ -198,37 +225,49 @@ private:
    //! The notion of output channel corresponds to an address.
    struct LocatorCompare{ bool operator()(const Locator_t& lhs, const Locator_t& rhs) const
                         {return (memcmp(&lhs, &rhs, sizeof(Locator_t)) < 0); } };
-   //! For both modes, an input channel corresponds to a port.
-#if defined(ASIO_HAS_MOVE)
-   std::map<uint32_t, asio::ip::udp::socket> mInputSockets;
-#else
-   std::map<uint32_t, std::shared_ptr<asio::ip::udp::socket>> mInputSockets;
-#endif
+   /**
+    * For both modes, an input channel corresponds to a port, read through one socket, or through
+    * receiveSocketsPerPort sockets sharing the port for unicast channels. Input sockets are shared with
+    * the thread blocked on them, so that closing the channel cannot destroy a socket that is still being read.
+    */
+   std::map<uint32_t, std::vector<std::shared_ptr<asio::ip::udp::socket>>> mInputSockets;
 
    bool IsInterfaceAllowed(const asio::ip::address_v6& ip);
    std::vector<asio::ip::address_v6> mInterfaceWhiteList;
 
 
+   /**
+    * Returns the sockets of the output channel that send to the given kind of address. It is empty if the
+    * channel is not open.
+    */
+   std::vector<std::shared_ptr<asio::ip::udp::socket>> GetOutputSockets(const Locator_t& localLocator,
+           bool is_multicast_remote_address) const;
+
+   //! Returns the given input socket of the channel, or nullptr if the channel is not open.
+   std::shared_ptr<asio::ip::udp::socket> GetInputSocket(const Locator_t& localLocator, uint32_t shard) const;
+
+   //! Blocking receive of a single datagram through the given input socket.
+   bool ReceiveThroughSocket(asio::ip::udp::socket& socket, ReceiveBufferSlot& slot);
+
+   //! Reads, without blocking, the datagrams already queued on the given input socket.
+   uint32_t DrainInputSocket(ReceiveBufferSlot* slots, uint32_t slotCount, asio::ip::udp::socket& socket);
+
    bool OpenAndBindOutputSockets(Locator_t& locator);
    bool OpenAndBindInputSockets(uint32_t port, bool is_multicast);
 
 #if defined(ASIO_HAS_MOVE)
    asio::ip::udp::socket OpenAndBindUnicastOutputSocket(const asio::ip::address_v6&, uint32_t& port);
-   asio::ip::udp::socket OpenAndBindInputSocket(uint32_t port, bool is_multicast);
-
-   bool SendThroughSocket(const octet* sendBuffer,
-                          uint32_t sendBufferSize,
-                          const Locator_t& remoteLocator,
-                          asio::ip::udp::socket& socket);
+   asio::ip::udp::socket OpenAndBindInputSocket(uint32_t port, bool is_multicast, bool share_port);
 #else
    std::shared_ptr<asio::ip::udp::socket> OpenAndBindUnicastOutputSocket(const asio::ip::address_v6&, uint32_t& port);
-   std::shared_ptr<asio::ip::udp::socket> OpenAndBindInputSocket(uint32_t port, bool is_multicast);
+   std::shared_ptr<asio::ip::udp::socket> OpenAndBindInputSocket(uint32_t port, bool is_multicast, bool share_port);
+#endif
 
-   bool SendThroughSocket(const octet* sendBuffer,
+   template<typename ConstBufferSequence>
+   bool SendThroughSocket(const ConstBufferSequence& buffers,
                           uint32_t sendBufferSize,
                           const Locator_t& remoteLocator,
-                          std::shared_ptr<asio::ip::udp::socket> socket);
-#endif
+                          asio::ip::udp::socket& socket);
 };
 
 } // namespace rtps
@@ -29,6 +29,13 @@ namespace rtps{
  *                  fail.
  *
  * - interfaceWhiteList: Lists the allowed interfaces.
+ *
+ * - receiveBatchSize: maximum number of datagrams drained from a socket on
+ *                  each wakeup of the listening thread.
+ *
+ * - receiveSocketsPerPort: number of sockets bound with SO_REUSEPORT to each
+ *                  unicast input port. The kernel spreads the incoming flows
+ *                  among them, and each one is read by its own thread.
  * @ingroup TRANSPORT_MODULE
  */
 typedef struct UDPv6TransportDescriptor: public TransportDescriptorInterface {
@@ -40,6 +47,10 @@ typedef struct UDPv6TransportDescriptor: public TransportDescriptorInterface {
    std::vector<std::string> interfaceWhiteList;
    //! Specified time to live (8bit - 255 max TTL)
    uint8_t TTL = 1;
+   //! Maximum number of datagrams read per wakeup of a listening thread. 1 disables batching.
+   uint32_t receiveBatchSize;
+   //! Number of sockets, and listening threads, sharing each unicast input port. 1 disables sharding.
+   uint32_t receiveSocketsPerPort;
 
    virtual ~UDPv6TransportDescriptor(){}
    RTPS_DllAPI UDPv6TransportDescriptor();
@@ -36,6 +36,10 @@ public:
    RTPS_DllAPI test_UDPv4Transport(const test_UDPv4TransportDescriptor& descriptor);
 
    virtual bool Send(const octet* sendBuffer, uint32_t sendBufferSize, const Locator_t& localLocator, const Locator_t& remoteLocator);
+
+   //! Coalesces the slices and sends them through Send, so the drop criteria are applied to them.
+   virtual bool SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& localLocator,
+                           const Locator_t& remoteLocator);
   
    // Handle to a persistent log of dropped packets. Defaults to length 0 (no logging) to prevent wasted resources.
    RTPS_DllAPI static std::vector<std::vector<octet> > DropLog;
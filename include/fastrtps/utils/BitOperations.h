@@ -0,0 +1,100 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file BitOperations.h
+ *
+ */
+
+#ifndef BITOPERATIONS_H_
+#define BITOPERATIONS_H_
+#ifndef DOXYGEN_SHOULD_SKIP_THIS_PUBLIC
+#include <cstdint>
+
+namespace eprosima {
+namespace fastrtps{
+namespace rtps {
+
+/**
+ * Returns the index of the lowest bit set in a word.
+ * @param word Word with at least one bit set.
+ * @ingroup UTILITIESMODULE
+ */
+inline uint32_t lowest_bit(uint64_t word)
+{
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_ctzll(word));
+#else
+    uint32_t bit = 0;
+    while((word & 1) == 0)
+    {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * Returns the number of zero bits above the highest bit set in a word.
+ * @param word Word with at least one bit set.
+ * @ingroup UTILITIESMODULE
+ */
+inline uint32_t leading_zeros(uint32_t word)
+{
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_clz(word));
+#else
+    uint32_t zeros = 0;
+    while((word & 0x80000000u) == 0)
+    {
+        word <<= 1;
+        ++zeros;
+    }
+    return zeros;
+#endif
+}
+
+/**
+ * Returns the number of bits set in a word.
+ * @ingroup UTILITIESMODULE
+ */
+inline uint32_t bit_count(uint64_t word)
+{
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_popcountll(word));
+#else
+    uint32_t count = 0;
+    for(; word != 0; word &= word - 1)
+        ++count;
+    return count;
+#endif
+}
+
+/**
+ * Returns a mask with the bits [first, first + count) of a word set.
+ * @param first First bit, lower than 64.
+ * @param count Number of bits, from 1 to 64 - first.
+ * @ingroup UTILITIESMODULE
+ */
+inline uint64_t bit_range(uint32_t first, uint32_t count)
+{
+    return (count == 64 ? ~uint64_t(0) : ((uint64_t(1) << count) - 1)) << first;
+}
+
+}
+} /* namespace rtps */
+} /* namespace eprosima */
+#endif
+#endif /* BITOPERATIONS_H_ */
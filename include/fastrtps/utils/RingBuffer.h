@@ -0,0 +1,155 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace eprosima {
+namespace fastrtps{
+
+/**
+ * Sequence kept in a circular buffer. Elements are added and removed at both ends in constant time, and the
+ * storage is only reallocated when it is full, doubling its capacity.
+ * Elements can also be inserted or erased in the middle, moving the ones of the shorter side.
+ */
+template<class T>
+class RingBuffer
+{
+public:
+    //! Creates the buffer with room for the given number of elements.
+    explicit RingBuffer(size_t capacity = 0) :
+        storage_(capacity),
+        head_(0),
+        size_(0)
+    {}
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    size_t capacity() const { return storage_.size(); }
+
+    //! Element at the given position, counting from the front.
+    T& operator[](size_t index) { return storage_[wrap(head_ + index)]; }
+
+    const T& operator[](size_t index) const { return storage_[wrap(head_ + index)]; }
+
+    T& front() { return (*this)[0]; }
+
+    const T& front() const { return (*this)[0]; }
+
+    T& back() { return (*this)[size_ - 1]; }
+
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    void push_back(const T& item)
+    {
+        if(size_ == storage_.size())
+            grow();
+        storage_[wrap(head_ + size_)] = item;
+        ++size_;
+    }
+
+    void push_front(const T& item)
+    {
+        if(size_ == storage_.size())
+            grow();
+        head_ = wrap(head_ + storage_.size() - 1);
+        storage_[head_] = item;
+        ++size_;
+    }
+
+    void pop_front()
+    {
+        storage_[head_] = T();
+        head_ = wrap(head_ + 1);
+        --size_;
+    }
+
+    void pop_back()
+    {
+        --size_;
+        storage_[wrap(head_ + size_)] = T();
+    }
+
+    //! Inserts the item before the given position.
+    void insert(size_t index, const T& item)
+    {
+        if(index < size_ / 2)
+        {
+            push_front(item);
+            for(size_t i = 0; i < index; ++i)
+                (*this)[i] = (*this)[i + 1];
+        }
+        else
+        {
+            push_back(item);
+            for(size_t i = size_ - 1; i > index; --i)
+                (*this)[i] = (*this)[i - 1];
+        }
+        (*this)[index] = item;
+    }
+
+    //! Removes the element at the given position.
+    void erase(size_t index)
+    {
+        if(index < size_ / 2)
+        {
+            for(size_t i = index; i > 0; --i)
+                (*this)[i] = (*this)[i - 1];
+            pop_front();
+        }
+        else
+        {
+            for(size_t i = index; i + 1 < size_; ++i)
+                (*this)[i] = (*this)[i + 1];
+            pop_back();
+        }
+    }
+
+    void clear()
+    {
+        while(size_ > 0)
+            pop_back();
+        head_ = 0;
+    }
+
+private:
+    size_t wrap(size_t position) const
+    {
+        return position >= storage_.size() ? position - storage_.size() : position;
+    }
+
+    //! Doubles the storage, leaving the elements at its start.
+    void grow()
+    {
+        std::vector<T> storage(storage_.empty() ? 1 : storage_.size() * 2);
+        for(size_t i = 0; i < size_; ++i)
+            storage[i] = (*this)[i];
+        storage_.swap(storage);
+        head_ = 0;
+    }
+
+    std::vector<T> storage_;
+    size_t head_;
+    size_t size_;
+};
+
+} // namespace fastrtps
+} // namespace eprosima
+
+#endif /* RINGBUFFER_H_ */
@@ -35,6 +35,7 @@
 #include <fastrtps/subscriber/Subscriber.h>
 
 #include <fastrtps/rtps/RTPSDomain.h>
+#include <fastrtps/rtps/attributes/PropertyPolicy.h>
 
 #include <fastrtps/transport/UDPv4Transport.h>
 #include <fastrtps/transport/UDPv6Transport.h>
@@ -42,6 +43,8 @@
 
 #include <fastrtps/log/Log.h>
 
+#include <algorithm>
+
 using namespace eprosima::fastrtps::rtps;
 
 namespace eprosima {
@@ -165,7 +168,13 @@ Publisher* ParticipantImpl::createPublisher(PublisherAttributes& att,
 
     WriterAttributes watt;
     watt.throughputController = att.throughputController;
-    watt.endpoint.durabilityKind = att.qos.m_durability.kind == VOLATILE_DURABILITY_QOS ? VOLATILE : TRANSIENT_LOCAL;
+    switch(att.qos.m_durability.kind)
+    {
+        case VOLATILE_DURABILITY_QOS: watt.endpoint.durabilityKind = VOLATILE; break;
+        case TRANSIENT_DURABILITY_QOS: watt.endpoint.durabilityKind = TRANSIENT; break;
+        case PERSISTENT_DURABILITY_QOS: watt.endpoint.durabilityKind = PERSISTENT; break;
+        default: watt.endpoint.durabilityKind = TRANSIENT_LOCAL; break;
+    }
     watt.endpoint.endpointKind = WRITER;
     watt.endpoint.multicastLocatorList = att.multicastLocatorList;
     watt.endpoint.reliabilityKind = att.qos.m_reliability.kind == RELIABLE_RELIABILITY_QOS ? RELIABLE : BEST_EFFORT;
@@ -174,6 +183,14 @@ Publisher* ParticipantImpl::createPublisher(PublisherAttributes& att,
     watt.endpoint.outLocatorList = att.outLocatorList;
     watt.mode = att.qos.m_publishMode.kind == eprosima::fastrtps::SYNCHRONOUS_PUBLISH_MODE ? SYNCHRONOUS_WRITER : ASYNCHRONOUS_WRITER;
     watt.endpoint.properties = att.properties;
+    // The persistence log of the publisher is named after its topic by default.
+    if(watt.endpoint.durabilityKind >= TRANSIENT &&
+            PropertyPolicyHelper::find_property(watt.endpoint.properties, "dds.persistence.name") == nullptr)
+    {
+        std::string name = att.topic.getTopicName();
+        std::replace(name.begin(), name.end(), '/', '_');
+        watt.endpoint.properties.properties().emplace_back("dds.persistence.name", name);
+    }
     if(att.getEntityID()>0)
         watt.endpoint.setEntityID((uint8_t)att.getEntityID());
     if(att.getUserDefinedID()>0)
@@ -298,6 +315,7 @@ Subscriber* ParticipantImpl::createSubscriber(SubscriberAttributes& att,
     ratt.endpoint.unicastLocatorList = att.unicastLocatorList;
     ratt.endpoint.outLocatorList = att.outLocatorList;
     ratt.expectsInlineQos = att.expectsInlineQos;
+    ratt.fragmentReassemblyArenaSize = att.fragmentReassemblyArenaSize;
     ratt.endpoint.properties = att.properties;
     if(att.getEntityID()>0)
         ratt.endpoint.setEntityID((uint8_t)att.getEntityID());
@@ -47,6 +47,30 @@ bool Publisher::write(void* Data, WriteParams &wparams) {
 	return mp_impl->create_new_change_with_params(ALIVE, Data, wparams);
 }
 
+void* Publisher::loan_sample()
+{
+	logInfo(PUBLISHER,"Loaning sample");
+	return mp_impl->loan_sample();
+}
+
+bool Publisher::write_loaned(void* sample)
+{
+	logInfo(PUBLISHER,"Writing loaned sample");
+	return mp_impl->write_loaned(sample);
+}
+
+bool Publisher::write_loaned(void* sample, WriteParams &wparams)
+{
+	logInfo(PUBLISHER,"Writing loaned sample with WriteParams");
+	return mp_impl->write_loaned(sample, wparams);
+}
+
+bool Publisher::discard_loan(void* sample)
+{
+	logInfo(PUBLISHER,"Discarding loaned sample");
+	return mp_impl->discard_loan(sample);
+}
+
 bool Publisher::dispose(void* Data)
 {
 	logInfo(PUBLISHER,"Disposing of Data");
@@ -75,13 +75,13 @@ bool PublisherHistory::add_pub_change(CacheChange_t* change, WriteParams &wparam
         {
             if(m_historyQos.kind == KEEP_ALL_HISTORY_QOS)
             {
-                if((int32_t)m_changes.size()>=m_resourceLimitsQos.max_samples)
+                if((int32_t)getHistorySize()>=m_resourceLimitsQos.max_samples)
                     m_isHistoryFull = true;
             }
             else
             {
                 //KEEP_LAST_HISTORY_QoS
-                if((int32_t)m_changes.size()>=m_historyQos.depth)
+                if((int32_t)getHistorySize()>=m_historyQos.depth)
                     m_isHistoryFull = true;
             }
 
@@ -91,14 +91,15 @@ bool PublisherHistory::add_pub_change(CacheChange_t* change, WriteParams &wparam
     //HISTORY WITH KEY
     else if(mp_pubImpl->getAttributes().topic.getTopicKind() == WITH_KEY)
     {
-        t_v_Inst_Caches::iterator vit;
+        t_m_Inst_Caches::iterator vit;
         if(find_Key(change,&vit))
         {
             logInfo(RTPS_HISTORY,"Found key: "<< vit->first);
+            RingBuffer<CacheChange_t*>& instance_changes = vit->second.cache_changes;
             bool add = false;
             if(m_historyQos.kind == KEEP_ALL_HISTORY_QOS)
             {
-                if((int32_t)vit->second.size() < m_resourceLimitsQos.max_samples_per_instance)
+                if((int32_t)instance_changes.size() < m_resourceLimitsQos.max_samples_per_instance)
                 {
                     add = true;
                 }
@@ -107,13 +108,13 @@ bool PublisherHistory::add_pub_change(CacheChange_t* change, WriteParams &wparam
             }
             else if (m_historyQos.kind == KEEP_LAST_HISTORY_QOS)
             {
-                if(vit->second.size()< (size_t)m_historyQos.depth)
+                if(instance_changes.size()< (size_t)m_historyQos.depth)
                 {
                     add = true;
                 }
                 else
                 {
-                    if(remove_change_pub(vit->second.front(),&vit))
+                    if(remove_change_pub(instance_changes.front(),&vit))
                     {
                         add = true;
                     }
@@ -128,15 +129,18 @@ bool PublisherHistory::add_pub_change(CacheChange_t* change, WriteParams &wparam
                     logInfo(RTPS_HISTORY,this->mp_pubImpl->getGuid().entityId <<" Change "
                             << change->sequenceNumber << " added with key: "<<change->instanceHandle
                             << " and "<<change->serializedPayload.length<< " bytes");
-                    vit->second.push_back(change);
+                    // Sequence numbers are assigned in order, so the change always goes to the back.
+                    if(instance_changes.empty())
+                        m_emptyInstances.erase(vit->second.empty_it);
+                    instance_changes.push_back(change);
                     if(m_historyQos.kind == KEEP_ALL_HISTORY_QOS)
                     {
-                        if((int32_t)m_changes.size()==m_resourceLimitsQos.max_samples)
+                        if((int32_t)getHistorySize()==m_resourceLimitsQos.max_samples)
                             m_isHistoryFull = true;
                     }
                     else
                     {
-                        if((int32_t)m_changes.size()==m_historyQos.depth*m_resourceLimitsQos.max_instances)
+                        if((int32_t)getHistorySize()==m_historyQos.depth*m_resourceLimitsQos.max_instances)
                             m_isHistoryFull = true;
                     }
 
@@ -157,46 +161,35 @@ bool PublisherHistory::add_pub_change(CacheChange_t* change, WriteParams &wparam
     return returnedValue;
 }
 
-bool PublisherHistory::find_Key(CacheChange_t* a_change,t_v_Inst_Caches::iterator* vit_out)
+bool PublisherHistory::find_Key(CacheChange_t* a_change,t_m_Inst_Caches::iterator* vit_out)
 {
-    t_v_Inst_Caches::iterator vit;
-    bool found = false;
-    for(vit= m_keyedChanges.begin();vit!=m_keyedChanges.end();++vit)
+    t_m_Inst_Caches::iterator vit = m_keyedChanges.find(a_change->instanceHandle);
+    if(vit != m_keyedChanges.end())
     {
-        if(a_change->instanceHandle == vit->first)
-        {
-            *vit_out = vit;
-            return true;
-        }
+        *vit_out = vit;
+        return true;
     }
-    if(!found)
+
+    if((int)m_keyedChanges.size() >= m_resourceLimitsQos.max_instances)
     {
-        if((int)m_keyedChanges.size() < m_resourceLimitsQos.max_instances)
+        if(m_emptyInstances.empty())
         {
-            t_p_I_Change newpair;
-            newpair.first = a_change->instanceHandle;
-            m_keyedChanges.push_back(newpair);
-            *vit_out = m_keyedChanges.end()-1;
-            return true;
-        }
-        else
-        {
-            for (vit = m_keyedChanges.begin(); vit != m_keyedChanges.end(); ++vit)
-            {
-                if (vit->second.size() == 0)
-                {
-                    m_keyedChanges.erase(vit);
-                    t_p_I_Change newpair;
-                    newpair.first = a_change->instanceHandle;
-                    m_keyedChanges.push_back(newpair);
-                    *vit_out = m_keyedChanges.end() - 1;
-                    return true;
-                }
-            }
             logWarning(SUBSCRIBER, "History has reached the maximum number of instances" << endl;)
+            return false;
         }
+
+        // Evict the least recently used instance without changes.
+        m_keyedChanges.erase(m_emptyInstances.front());
+        m_emptyInstances.pop_front();
     }
-    return false;
+
+    // KEEP_LAST instances never hold more than depth changes.
+    size_t capacity = m_historyQos.kind == KEEP_LAST_HISTORY_QOS && m_historyQos.depth > 0 ?
+        (size_t)m_historyQos.depth : 0;
+    vit = m_keyedChanges.emplace(a_change->instanceHandle, KeyedChanges(capacity)).first;
+    vit->second.empty_it = m_emptyInstances.insert(m_emptyInstances.end(), a_change->instanceHandle);
+    *vit_out = vit;
+    return true;
 }
 
 
@@ -206,9 +199,9 @@ bool PublisherHistory::removeAllChange(size_t* removed)
     size_t rem = 0;
     std::lock_guard<std::recursive_mutex> guard(*this->mp_mutex);
 
-    while(m_changes.size()>0)
+    while(getHistorySize()>0)
     {
-        if(remove_change_pub(m_changes.front()))
+        if(remove_change_pub(*changesBegin()))
             ++rem;
         else
             break;
@@ -230,12 +223,12 @@ bool PublisherHistory::removeMinChange()
     }
 
     std::lock_guard<std::recursive_mutex> guard(*this->mp_mutex);
-    if(m_changes.size()>0)
-        return remove_change_pub(m_changes.front());
+    if(getHistorySize()>0)
+        return remove_change_pub(*changesBegin());
     return false;
 }
 
-bool PublisherHistory::remove_change_pub(CacheChange_t* change,t_v_Inst_Caches::iterator* vit_in)
+bool PublisherHistory::remove_change_pub(CacheChange_t* change,t_m_Inst_Caches::iterator* vit_in)
 {
 
     if(mp_writer == nullptr || mp_mutex == nullptr)
@@ -257,24 +250,32 @@ bool PublisherHistory::remove_change_pub(CacheChange_t* change,t_v_Inst_Caches::
     }
     else
     {
-        t_v_Inst_Caches::iterator vit;
+        t_m_Inst_Caches::iterator vit;
         if(vit_in!=nullptr)
             vit = *vit_in;
-        else if(this->find_Key(change,&vit))
+        else
         {
-
+            vit = m_keyedChanges.find(change->instanceHandle);
+            if(vit == m_keyedChanges.end())
+            {
+                logError(PUBLISHER,"Instance of the change not found, something is wrong");
+                return false;
+            }
         }
-        else
-            return false;
-        for(auto chit = vit->second.begin();
-                chit!= vit->second.end();++chit)
+
+        // The oldest changes are usually the ones removed, so the instance is searched from the front.
+        RingBuffer<CacheChange_t*>& instance_changes = vit->second.cache_changes;
+        for(size_t i = 0; i < instance_changes.size(); ++i)
         {
-            if( ((*chit)->sequenceNumber == change->sequenceNumber)
-                    && ((*chit)->writerGUID == change->writerGUID) )
+            CacheChange_t* instance_change = instance_changes[i];
+            if( (instance_change->sequenceNumber == change->sequenceNumber)
+                    && (instance_change->writerGUID == change->writerGUID) )
             {
                 if(remove_change(change))
                 {
-                    vit->second.erase(chit);
+                    instance_changes.erase(i);
+                    if(instance_changes.empty())
+                        vit->second.empty_it = m_emptyInstances.insert(m_emptyInstances.end(), vit->first);
                     m_isHistoryFull = false;
                     return true;
                 }
@@ -290,6 +291,14 @@ bool PublisherHistory::remove_change_g(CacheChange_t* a_change)
     return remove_change_pub(a_change);
 }
 
+bool PublisherHistory::add_restored_change(CacheChange_t* a_change)
+{
+    if(m_isHistoryFull && !removeMinChange())
+        return false;
+
+    return add_pub_change(a_change, WRITE_PARAM_DEFAULT);
+}
+
 
 } /* namespace pubsub */
 } /* namespace eprosima */
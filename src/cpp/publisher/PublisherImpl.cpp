@@ -62,6 +62,16 @@ PublisherImpl::~PublisherImpl()
         logInfo(PUBLISHER, this->getGuid().entityId << " in topic: " << this->m_att.topic.topicName);
     }
 
+    // Samples still loaned are given back.
+    for(auto& loan : m_loans)
+    {
+        if(loan.second != nullptr)
+            m_history.release_Cache(loan.second);
+        else
+            mp_type->deleteData(loan.first);
+    }
+    m_loans.clear();
+
     RTPSDomain::removeRTPSWriter(mp_writer);
     delete(this->mp_userPublisher);
 }
@@ -113,57 +123,165 @@ bool PublisherImpl::create_new_change_with_params(ChangeKind_t changeKind, void*
             }
         }
 
-        //TODO(Ricardo) This logic in a class. Then a user of rtps layer can use it.
-        if(high_mark_for_frag_ == 0)
+        return add_new_change(ch, wparams);
+    }
+
+    return false;
+}
+
+bool PublisherImpl::add_new_change(CacheChange_t* ch, WriteParams &wparams)
+{
+    //TODO(Ricardo) This logic in a class. Then a user of rtps layer can use it.
+    if(high_mark_for_frag_ == 0)
+    {
+        uint32_t max_data_size = mp_writer->getMaxDataSize();
+        uint32_t writer_throughput_controller_bytes =
+            mp_writer->calculateMaxDataSize(m_att.throughputController.bytesPerPeriod);
+        uint32_t participant_throughput_controller_bytes =
+            mp_writer->calculateMaxDataSize(mp_rtpsParticipant->getRTPSParticipantAttributes().throughputController.bytesPerPeriod);
+
+        high_mark_for_frag_ =
+            max_data_size > writer_throughput_controller_bytes ?
+            writer_throughput_controller_bytes :
+            (max_data_size > participant_throughput_controller_bytes ?
+             participant_throughput_controller_bytes :
+             max_data_size);
+    }
+
+    // If it is big data, fragment it.
+    if(ch->serializedPayload.length > high_mark_for_frag_)
+    {
+        // Check ASYNCHRONOUS_PUBLISH_MODE is being used, but it is an error case.
+        if( m_att.qos.m_publishMode.kind != ASYNCHRONOUS_PUBLISH_MODE)
         {
-            uint32_t max_data_size = mp_writer->getMaxDataSize();
-            uint32_t writer_throughput_controller_bytes =
-                mp_writer->calculateMaxDataSize(m_att.throughputController.bytesPerPeriod);
-            uint32_t participant_throughput_controller_bytes =
-                mp_writer->calculateMaxDataSize(mp_rtpsParticipant->getRTPSParticipantAttributes().throughputController.bytesPerPeriod);
-
-            high_mark_for_frag_ =
-                max_data_size > writer_throughput_controller_bytes ?
-                writer_throughput_controller_bytes :
-                (max_data_size > participant_throughput_controller_bytes ?
-                 participant_throughput_controller_bytes :
-                 max_data_size);
+            logError(PUBLISHER, "Data cannot be sent. It's serialized size is " <<
+                    ch->serializedPayload.length << "' which exceeds the maximum payload size of '" <<
+                    high_mark_for_frag_ << "' and therefore ASYNCHRONOUS_PUBLISH_MODE must be used.");
+            m_history.release_Cache(ch);
+            return false;
         }
 
-        // If it is big data, fragment it.
-        if(ch->serializedPayload.length > high_mark_for_frag_)
-        {
-            // Check ASYNCHRONOUS_PUBLISH_MODE is being used, but it is an error case.
-            if( m_att.qos.m_publishMode.kind != ASYNCHRONOUS_PUBLISH_MODE)
-            {
-                logError(PUBLISHER, "Data cannot be sent. It's serialized size is " <<
-                        ch->serializedPayload.length << "' which exceeds the maximum payload size of '" <<
-                        high_mark_for_frag_ << "' and therefore ASYNCHRONOUS_PUBLISH_MODE must be used.");
-                m_history.release_Cache(ch);
-                return false;
-            }
+        /// Fragment the data.
+        // Set the fragment size to the cachechange.
+        // Note: high_mark will always be a value that can be casted to uint16_t)
+        ch->setFragmentSize((uint16_t)high_mark_for_frag_);
+    }
 
-            /// Fragment the data.
-            // Set the fragment size to the cachechange.
-            // Note: high_mark will always be a value that can be casted to uint16_t)
-            ch->setFragmentSize((uint16_t)high_mark_for_frag_);
-        }
+    if(&wparams != &WRITE_PARAM_DEFAULT)
+    {
+        ch->write_params = wparams;
+    }
+
+    if(!this->m_history.add_pub_change(ch, wparams))
+    {
+        m_history.release_Cache(ch);
+        return false;
+    }
 
-        if(&wparams != &WRITE_PARAM_DEFAULT)
+    return true;
+}
+
+void* PublisherImpl::loan_sample()
+{
+    void* sample = nullptr;
+    CacheChange_t* ch = nullptr;
+
+    if(mp_type->is_plain())
+    {
+        if(mp_type->m_typeSize <= 4)
         {
-            ch->write_params = wparams;
+            logError(PUBLISHER, "Plain type " << mp_type->getName() << " has no size");
+            return nullptr;
         }
 
-        if(!this->m_history.add_pub_change(ch, wparams))
+        // The whole sample is reserved, so it can be filled in place.
+        uint32_t size = mp_type->m_typeSize;
+        if(!m_history.reserve_Cache(&ch, [size]() -> uint32_t { return size; }))
         {
-            m_history.release_Cache(ch);
-            return false;
+            logWarning(PUBLISHER, "Problem reserving Cache from the History");
+            return nullptr;
         }
 
-        return true;
+        // The payload starts with the encapsulation. The sample follows it with the native endianness.
+        uint16_t encapsulation = DEFAULT_ENDIAN == BIGEND ? CDR_BE : CDR_LE;
+        ch->serializedPayload.data[0] = (octet)(encapsulation >> 8);
+        ch->serializedPayload.data[1] = (octet)encapsulation;
+        ch->serializedPayload.data[2] = 0;
+        ch->serializedPayload.data[3] = 0;
+        ch->serializedPayload.encapsulation = encapsulation;
+        ch->serializedPayload.length = size;
+        sample = ch->serializedPayload.data + 4;
+    }
+    else
+    {
+        // Other types are serialized when written, so the sample is a separate object.
+        sample = mp_type->createData();
+        if(sample == nullptr)
+            return nullptr;
     }
 
-    return false;
+    std::lock_guard<std::mutex> guard(m_loansMutex);
+    m_loans[sample] = ch;
+    return sample;
+}
+
+bool PublisherImpl::write_loaned(void* sample)
+{
+    return write_loaned(sample, WRITE_PARAM_DEFAULT);
+}
+
+bool PublisherImpl::write_loaned(void* sample, WriteParams &wparams)
+{
+    CacheChange_t* ch = nullptr;
+    if(!finish_loan(sample, &ch))
+    {
+        logError(PUBLISHER, "Sample was not loaned by this publisher");
+        return false;
+    }
+
+    if(ch == nullptr)
+    {
+        bool returnedValue = create_new_change_with_params(ALIVE, sample, wparams);
+        mp_type->deleteData(sample);
+        return returnedValue;
+    }
+
+    InstanceHandle_t handle;
+    if(m_att.topic.topicKind == WITH_KEY)
+    {
+        mp_type->getKey(sample, &handle);
+    }
+
+    ch->kind = ALIVE;
+    ch->instanceHandle = handle;
+    ch->writerGUID = mp_writer->getGuid();
+    return add_new_change(ch, wparams);
+}
+
+bool PublisherImpl::discard_loan(void* sample)
+{
+    CacheChange_t* ch = nullptr;
+    if(!finish_loan(sample, &ch))
+        return false;
+
+    if(ch != nullptr)
+        m_history.release_Cache(ch);
+    else
+        mp_type->deleteData(sample);
+
+    return true;
+}
+
+bool PublisherImpl::finish_loan(void* sample, CacheChange_t** change)
+{
+    std::lock_guard<std::mutex> guard(m_loansMutex);
+    auto loan = m_loans.find(sample);
+    if(loan == m_loans.end())
+        return false;
+
+    *change = loan->second;
+    m_loans.erase(loan);
+    return true;
 }
 
 
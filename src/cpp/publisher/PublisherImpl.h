@@ -31,6 +31,9 @@
 
 #include <fastrtps/rtps/writer/WriterListener.h>
 
+#include <map>
+#include <mutex>
+
 namespace eprosima {
 namespace fastrtps{
 namespace rtps
@@ -82,6 +85,34 @@ class PublisherImpl
      */
     bool create_new_change_with_params(ChangeKind_t kind, void* Data, WriteParams &wparams);
 
+    /**
+     * Loans a sample of the topic type. For plain types it is placed inside the payload of a reserved change.
+     * @return Pointer to the sample, or nullptr on error.
+     */
+    void* loan_sample();
+
+    /**
+     * Writes a loaned sample and finishes its loan.
+     * @param sample Pointer to the loaned sample
+     * @return True if correct.
+     */
+    bool write_loaned(void* sample);
+
+    /**
+     * Writes with params a loaned sample and finishes its loan.
+     * @param sample Pointer to the loaned sample
+     * @param wparams
+     * @return True if correct.
+     */
+    bool write_loaned(void* sample, WriteParams &wparams);
+
+    /**
+     * Finishes the loan of a sample without writing it.
+     * @param sample Pointer to the loaned sample
+     * @return True if the sample was loaned.
+     */
+    bool discard_loan(void* sample);
+
     /**
      * Removes the cache change with the minimum sequence number
      * @return True if correct.
@@ -130,6 +161,21 @@ class PublisherImpl
     bool wait_for_all_acked(const Time_t& max_wait);
 
     private:
+
+    /**
+     * Fragments the change if needed and adds it to the history. The change is released on error.
+     * @return True if correct.
+     */
+    bool add_new_change(CacheChange_t* ch, WriteParams &wparams);
+
+    /**
+     * Takes the loan of a sample out of the list of loans.
+     * @param sample Pointer to the loaned sample
+     * @param[out] change Change reserved for the sample. Null for types that are not plain.
+     * @return True if the sample was loaned.
+     */
+    bool finish_loan(void* sample, CacheChange_t** change);
+
     ParticipantImpl* mp_participant;
     //! Pointer to the associated Data Writer.
     RTPSWriter* mp_writer;
@@ -156,6 +202,11 @@ class PublisherImpl
     RTPSParticipant* mp_rtpsParticipant;
 
     uint32_t high_mark_for_frag_;
+
+    //!Loaned samples, with the change reserved for each of them.
+    std::map<void*, CacheChange_t*> m_loans;
+    //!Protects the loaned samples.
+    std::mutex m_loansMutex;
 };
 
 
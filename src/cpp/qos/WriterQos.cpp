@@ -136,16 +136,6 @@ void WriterQos::setQos( WriterQos& qos, bool first_time)
 
 bool WriterQos::checkQos()
 {
-	if(m_durability.kind == TRANSIENT_DURABILITY_QOS)
-	{
-		logError(RTPS_QOS_CHECK,"TRANSIENT Durability not supported");
-		return false;
-	}
-	if(m_durability.kind == PERSISTENT_DURABILITY_QOS)
-	{
-		logError(RTPS_QOS_CHECK,"PERSISTENT Durability not supported");
-		return false;
-	}
 	if(m_destinationOrder.kind == BY_SOURCE_TIMESTAMP_DESTINATIONORDER_QOS)
 	{
 		logError(RTPS_QOS_CHECK,"BY SOURCE TIMESTAMP DestinationOrder not supported");
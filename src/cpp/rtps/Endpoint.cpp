@@ -30,7 +30,8 @@ Endpoint::Endpoint(RTPSParticipantImpl* pimpl,GUID_t& guid,EndpointAttributes& a
     mp_RTPSParticipant(pimpl),
     m_guid(guid),
     m_att(att),
-    mp_mutex(new std::recursive_mutex())
+    mp_mutex(new std::recursive_mutex()),
+    send_route_generation_(0)
 #if HAVE_SECURITY
     ,supports_rtps_protection_(true),
     is_submessage_protected_(false),
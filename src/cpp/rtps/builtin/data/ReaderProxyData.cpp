@@ -420,7 +420,7 @@ RemoteReaderAttributes& ReaderProxyData::toRemoteReaderAttributes()
 {
     m_remoteAtt.guid = m_guid;
     m_remoteAtt.expectsInlineQos = this->m_expectsInlineQos;
-    m_remoteAtt.endpoint.durabilityKind = m_qos.m_durability.kind == TRANSIENT_LOCAL_DURABILITY_QOS ? TRANSIENT_LOCAL : VOLATILE;
+    m_remoteAtt.endpoint.durabilityKind = m_qos.m_durability.kind >= TRANSIENT_LOCAL_DURABILITY_QOS ? TRANSIENT_LOCAL : VOLATILE;
     m_remoteAtt.endpoint.endpointKind = READER;
     m_remoteAtt.endpoint.topicKind = m_topicKind;
     m_remoteAtt.endpoint.reliabilityKind = m_qos.m_reliability.kind == RELIABLE_RELIABILITY_QOS ? RELIABLE : BEST_EFFORT;
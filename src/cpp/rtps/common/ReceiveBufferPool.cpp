@@ -0,0 +1,113 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file ReceiveBufferPool.cpp
+ */
+
+#include <fastrtps/rtps/common/ReceiveBufferPool.h>
+
+#include <cstdlib>
+#include <new>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+ReceiveBufferPool::ReceiveBufferPool(uint32_t buffer_size, uint32_t max_free_buffers, uint64_t max_bytes) :
+    buffer_size_(buffer_size), max_free_buffers_(max_free_buffers), max_bytes_(max_bytes), allocated_bytes_(0)
+{
+}
+
+ReceiveBufferPool::~ReceiveBufferPool()
+{
+    for(ReceiveBuffer* buffer : free_buffers_)
+        delete(buffer);
+}
+
+ReceiveBuffer* ReceiveBufferPool::take(uint32_t size)
+{
+    ReceiveBuffer* buffer = nullptr;
+    uint32_t capacity = buffer_size_ > 0 ? buffer_size_ : size;
+    while(capacity < size && capacity <= UINT32_MAX / 2)
+        capacity *= 2;
+    if(capacity < size)
+        capacity = size;
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+
+        // Smallest free buffer that fits.
+        auto best = free_buffers_.end();
+        for(auto it = free_buffers_.begin(); it != free_buffers_.end(); ++it)
+        {
+            if((*it)->capacity_ >= size && (best == free_buffers_.end() || (*it)->capacity_ < (*best)->capacity_))
+                best = it;
+        }
+
+        if(best != free_buffers_.end())
+        {
+            buffer = *best;
+            *best = free_buffers_.back();
+            free_buffers_.pop_back();
+        }
+        else
+        {
+            // The free buffers are too small. They are given back to make room for the new one.
+            while(max_bytes_ != 0 && allocated_bytes_ + capacity > max_bytes_ && !free_buffers_.empty())
+            {
+                allocated_bytes_ -= free_buffers_.back()->capacity_;
+                delete(free_buffers_.back());
+                free_buffers_.pop_back();
+            }
+
+            if(max_bytes_ != 0 && allocated_bytes_ + capacity > max_bytes_)
+                return nullptr;
+
+            allocated_bytes_ += capacity;
+        }
+    }
+
+    if(buffer == nullptr)
+    {
+        octet* memory = (octet*)malloc(capacity);
+        if(memory == nullptr)
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            allocated_bytes_ -= capacity;
+            throw std::bad_alloc();
+        }
+        buffer = new ReceiveBuffer(memory, capacity);
+    }
+
+    buffer->pool_ = shared_from_this();
+    buffer->references_.store(1, std::memory_order_relaxed);
+    return buffer;
+}
+
+uint32_t ReceiveBufferPool::free_buffers() const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    return static_cast<uint32_t>(free_buffers_.size());
+}
+
+uint64_t ReceiveBufferPool::allocated_bytes() const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    return allocated_bytes_;
+}
+
+}
+}
+}
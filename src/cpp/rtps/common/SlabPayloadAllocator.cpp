@@ -0,0 +1,151 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file SlabPayloadAllocator.cpp
+ */
+
+#include <fastrtps/rtps/common/SlabPayloadAllocator.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+SlabPayloadAllocator::SlabPayloadAllocator(uint32_t slab_size) : slab_size_(slab_size), system_bytes_(0),
+    used_bytes_(0), high_water_bytes_(0), buffers_(0), total_allocations_(0), total_requested_bytes_(0),
+    total_allocated_bytes_(0)
+{
+}
+
+SlabPayloadAllocator::~SlabPayloadAllocator()
+{
+    for(SizeClass& size_class : classes_)
+    {
+        for(octet* slab : size_class.slabs)
+            free(slab);
+    }
+}
+
+octet* SlabPayloadAllocator::allocate(uint32_t& size)
+{
+    uint32_t requested = size;
+    uint32_t bits = c_min_class_bits;
+    while(bits <= c_max_class_bits && (1u << bits) < requested)
+        ++bits;
+
+    // Too big for any size class.
+    if(bits > c_max_class_bits)
+    {
+        octet* buffer = (octet*)malloc(requested);
+        if(buffer == nullptr)
+            throw std::bad_alloc();
+
+        system_bytes_.fetch_add(requested, std::memory_order_relaxed);
+        account_allocation(requested, requested);
+        return buffer;
+    }
+
+    uint32_t capacity = 1u << bits;
+    SizeClass& size_class = classes_[bits - c_min_class_bits];
+    octet* buffer = nullptr;
+
+    {
+        std::lock_guard<std::mutex> guard(size_class.mutex);
+
+        if(size_class.free_list == nullptr)
+        {
+            uint32_t slab_size = capacity < slab_size_ ? slab_size_ - slab_size_ % capacity : capacity;
+            octet* slab = (octet*)malloc(slab_size);
+            if(slab == nullptr)
+                throw std::bad_alloc();
+
+            size_class.slabs.push_back(slab);
+            system_bytes_.fetch_add(slab_size, std::memory_order_relaxed);
+
+            // Link the buffers of the new slab.
+            for(uint32_t offset = 0; offset < slab_size; offset += capacity)
+            {
+                octet* next = offset + capacity < slab_size ? slab + offset + capacity : nullptr;
+                memcpy(slab + offset, &next, sizeof(next));
+            }
+            size_class.free_list = slab;
+        }
+
+        buffer = size_class.free_list;
+        memcpy(&size_class.free_list, buffer, sizeof(buffer));
+    }
+
+    size = capacity;
+    account_allocation(requested, capacity);
+    return buffer;
+}
+
+void SlabPayloadAllocator::release(octet* buffer, uint32_t capacity)
+{
+    if(buffer == nullptr)
+        return;
+
+    used_bytes_.fetch_sub(capacity, std::memory_order_relaxed);
+    buffers_.fetch_sub(1, std::memory_order_relaxed);
+
+    if(capacity > (1u << c_max_class_bits))
+    {
+        system_bytes_.fetch_sub(capacity, std::memory_order_relaxed);
+        free(buffer);
+        return;
+    }
+
+    uint32_t bits = c_min_class_bits;
+    while((1u << bits) < capacity)
+        ++bits;
+
+    SizeClass& size_class = classes_[bits - c_min_class_bits];
+    std::lock_guard<std::mutex> guard(size_class.mutex);
+    memcpy(buffer, &size_class.free_list, sizeof(buffer));
+    size_class.free_list = buffer;
+}
+
+PayloadAllocatorStats SlabPayloadAllocator::get_stats() const
+{
+    PayloadAllocatorStats stats;
+    stats.system_bytes = system_bytes_.load(std::memory_order_relaxed);
+    stats.used_bytes = used_bytes_.load(std::memory_order_relaxed);
+    stats.high_water_bytes = high_water_bytes_.load(std::memory_order_relaxed);
+    stats.buffers = buffers_.load(std::memory_order_relaxed);
+    stats.total_allocations = total_allocations_.load(std::memory_order_relaxed);
+    stats.total_requested_bytes = total_requested_bytes_.load(std::memory_order_relaxed);
+    stats.total_allocated_bytes = total_allocated_bytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SlabPayloadAllocator::account_allocation(uint32_t requested, uint32_t capacity)
+{
+    uint64_t used = used_bytes_.fetch_add(capacity, std::memory_order_relaxed) + capacity;
+    uint64_t high_water = high_water_bytes_.load(std::memory_order_relaxed);
+    while(used > high_water &&
+            !high_water_bytes_.compare_exchange_weak(high_water, used, std::memory_order_relaxed));
+
+    buffers_.fetch_add(1, std::memory_order_relaxed);
+    total_allocations_.fetch_add(1, std::memory_order_relaxed);
+    total_requested_bytes_.fetch_add(requested, std::memory_order_relaxed);
+    total_allocated_bytes_.fetch_add(capacity, std::memory_order_relaxed);
+}
+
+}
+}
+}
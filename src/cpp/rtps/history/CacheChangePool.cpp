@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+
 /**
  * @file CacheChangePool.cpp
  *
@@ -22,28 +23,154 @@
 #include <fastrtps/log/Log.h>
 
 #include <mutex>
+#include <set>
 
 #include <cassert>
+#include <cmath>
 
 
 namespace eprosima {
 namespace fastrtps{
 namespace rtps {
 
+//!Number of slots of the first segment. Each following segment doubles the size of the previous one.
+static const uint32_t c_first_segment_size = 64;
+
+struct CacheChangePool::Slot
+{
+    Slot() : change(nullptr), next(0) {}
+
+    //!Change stored in the slot. On DYNAMIC_RESERVE_MEMORY_MODE it is null while the slot is free.
+    std::atomic<CacheChange_t*> change;
+    //!Index plus one of the next slot in the free list. Zero marks the end of the list.
+    std::atomic<uint32_t> next;
+};
+
+/*
+ * Free changes kept by a thread, one vector for each pool it has used. A pool is identified by its id, which is never
+ * reused, so the vectors of pools already destroyed are never used again. Ids of the living pools are registered, so
+ * the changes of a finishing thread are only returned to pools that still exist.
+ */
+struct CacheChangePool::ThreadCaches
+{
+    struct Entry
+    {
+        uint64_t pool_id;
+        CacheChangePool* pool;
+        std::vector<CacheChange_t*> changes;
+    };
+
+    ThreadCaches() : last(0) {}
+
+    ~ThreadCaches()
+    {
+        std::lock_guard<std::mutex> guard(registry_mutex());
+
+        for(Entry& entry : entries)
+        {
+            if(!entry.changes.empty() && live_pools().count(entry.pool_id) != 0)
+                entry.pool->push_cached(entry.changes, entry.changes.size());
+        }
+    }
+
+    std::vector<CacheChange_t*>& cache_for(CacheChangePool* pool)
+    {
+        if(last < entries.size() && entries[last].pool_id == pool->m_id)
+            return entries[last].changes;
+
+        for(last = 0; last < entries.size(); ++last)
+        {
+            if(entries[last].pool_id == pool->m_id)
+                return entries[last].changes;
+        }
+
+        // First time this thread uses the pool. Forget the pools destroyed since.
+        {
+            std::lock_guard<std::mutex> guard(registry_mutex());
+            std::vector<Entry>::iterator it = entries.begin();
+            while(it != entries.end())
+            {
+                if(live_pools().count(it->pool_id) == 0)
+                    it = entries.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        Entry entry;
+        entry.pool_id = pool->m_id;
+        entry.pool = pool;
+        entry.changes.reserve(pool->m_thread_cache_size);
+        entries.push_back(std::move(entry));
+        last = entries.size() - 1;
+        return entries[last].changes;
+    }
+
+    static std::mutex& registry_mutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::set<uint64_t>& live_pools()
+    {
+        static std::set<uint64_t> pools;
+        return pools;
+    }
+
+    std::vector<Entry> entries;
+    size_t last;
+};
+
+CacheChangePool::ThreadCaches& CacheChangePool::thread_caches()
+{
+    static thread_local ThreadCaches caches;
+    return caches;
+}
 
 CacheChangePool::~CacheChangePool()
 {
     logInfo(RTPS_UTILS,"ChangePool destructor");
+
+    if(m_thread_cache_size > 0)
+    {
+        std::lock_guard<std::mutex> guard(ThreadCaches::registry_mutex());
+        ThreadCaches::live_pools().erase(m_id);
+    }
+
     //Deletion process does not depend on the memory management policy
-    for(std::vector<CacheChange_t*>::iterator it = m_allCaches.begin();it!=m_allCaches.end();++it)
+    uint32_t slot_count = m_slot_count.load(std::memory_order_acquire);
+    for(uint32_t index = 0; index < slot_count; ++index)
+    {
+        delete(slot(index)->change.load(std::memory_order_relaxed));
+    }
+    for(std::atomic<Slot*>& segment : m_segments)
     {
-        delete(*it);
+        delete[](segment.load(std::memory_order_relaxed));
     }
     delete(mp_mutex);
 }
 
-CacheChangePool::CacheChangePool(int32_t pool_size, uint32_t payload_size, int32_t max_pool_size, MemoryManagementPolicy_t memoryPolicy) : mp_mutex(new std::mutex()), memoryMode(memoryPolicy)
+CacheChangePool::CacheChangePool(int32_t pool_size, uint32_t payload_size, int32_t max_pool_size, MemoryManagementPolicy_t memoryPolicy,
+        uint32_t thread_cache_size, PayloadAllocator* payload_allocator) : m_pool_size(0), m_free_size(0), m_free_head(0),
+    m_slot_count(0), m_thread_cache_size(memoryPolicy == DYNAMIC_RESERVE_MEMORY_MODE ? 0 : thread_cache_size),
+    mp_payload_allocator(payload_allocator != nullptr ? payload_allocator : &m_payload_allocator),
+    mp_mutex(new std::mutex()), memoryMode(memoryPolicy)
 {
+    static std::atomic<uint64_t> next_id(0);
+    m_id = ++next_id;
+
+    for(std::atomic<Slot*>& segment : m_segments)
+    {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+
+    if(m_thread_cache_size > 0)
+    {
+        std::lock_guard<std::mutex> guard(ThreadCaches::registry_mutex());
+        ThreadCaches::live_pools().insert(m_id);
+    }
+
     std::lock_guard<std::mutex> guard(*this->mp_mutex);
 
     //Common for all modes: Set the payload size (maximum allowed), size and size limit
@@ -51,7 +178,6 @@ CacheChangePool::CacheChangePool(int32_t pool_size, uint32_t payload_size, int32
 
     m_payload_size = payload_size;
     m_initial_payload_size = payload_size;
-    m_pool_size = 0;
     if(max_pool_size > 0)
     {
         if (pool_size > max_pool_size)
@@ -68,11 +194,11 @@ CacheChangePool::CacheChangePool(int32_t pool_size, uint32_t payload_size, int32
     {
         case PREALLOCATED_MEMORY_MODE:
             logInfo(RTPS_UTILS,"Static Mode is active, preallocating memory for pool_size elements");
-            allocateGroup(pool_size);
+            allocateGroup(pool_size, nullptr);
             break;
         case PREALLOCATED_WITH_REALLOC_MEMORY_MODE:
             logInfo(RTPS_UTILS,"Semi-Dynamic Mode is active, preallocating memory for pool_size. Size of the cachechanges can be increased");
-            allocateGroup(pool_size);
+            allocateGroup(pool_size, nullptr);
             break;
         case DYNAMIC_RESERVE_MEMORY_MODE:
             logInfo(RTPS_UTILS,"Dynamic Mode is active, CacheChanges are allocated on request");
@@ -92,45 +218,43 @@ bool CacheChangePool::reserve_Cache(CacheChange_t** chan, const std::function<ui
 
 bool CacheChangePool::reserve_Cache(CacheChange_t** chan, uint32_t dataSize)
 {
-    std::lock_guard<std::mutex> guard(*this->mp_mutex);
-
     switch(memoryMode)
     {
         case PREALLOCATED_MEMORY_MODE:
-            if(m_freeCaches.empty())
+        case PREALLOCATED_WITH_REALLOC_MEMORY_MODE:
+            if(!reserve_free(chan))
             {
-                if (!allocateGroup((uint16_t)(ceil((float)m_pool_size / 10) + 10)))
+                std::lock_guard<std::mutex> guard(*this->mp_mutex);
+
+                // Another thread could have grown the pool while we were waiting.
+                uint32_t index = 0;
+                if(pop_free(index))
+                {
+                    m_free_size.fetch_sub(1, std::memory_order_relaxed);
+                    *chan = slot(index)->change.load(std::memory_order_relaxed);
+                }
+                else if (!allocateGroup((uint16_t)(ceil((float)m_pool_size.load(std::memory_order_relaxed) / 10) + 10), chan))
                 {
                     return false;
                 }
             }
-            *chan = m_freeCaches.back();
-            m_freeCaches.erase(m_freeCaches.end()-1);
-            break;
 
-        case PREALLOCATED_WITH_REALLOC_MEMORY_MODE:
-            if(m_freeCaches.empty())
+            if(memoryMode == PREALLOCATED_WITH_REALLOC_MEMORY_MODE)
             {
-                if (!allocateGroup((uint16_t)(ceil((float)m_pool_size / 10) + 10)))
+                // TODO(Ricardo) Improve reallocation.
+                try
                 {
+                    (*chan)->serializedPayload.reserve(dataSize);
+                }
+                catch(std::bad_alloc& ex)
+                {
+                    logError(RTPS_HISTORY, "Failed to allocate memory for the serializedPayload, exception caught: " << ex.what());
+                    push_free((*chan)->pool_slot_, (*chan)->pool_slot_);
+                    m_free_size.fetch_add(1, std::memory_order_relaxed);
+                    *chan = nullptr;
                     return false;
                 }
             }
-            *chan = m_freeCaches.back();
-            m_freeCaches.erase(m_freeCaches.end()-1);
-
-            // TODO(Ricardo) Improve reallocation.
-            try
-            {
-                (*chan)->serializedPayload.reserve(dataSize);
-            }
-            catch(std::bad_alloc& ex)
-            {
-                logError(RTPS_HISTORY, "Failed to allocate memory for the serializedPayload, exception caught: " << ex.what());
-                delete(*chan);
-                *chan = nullptr;
-                return false;
-            }
 
             break;
 
@@ -145,29 +269,22 @@ bool CacheChangePool::reserve_Cache(CacheChange_t** chan, uint32_t dataSize)
 
 void CacheChangePool::release_Cache(CacheChange_t* ch)
 {
-    std::lock_guard<std::mutex> guard(*this->mp_mutex);
+    if(!owns(ch))
+    {
+        logInfo(RTPS_UTILS,"Tried to release a CacheChange that is not logged in the Pool");
+        return;
+    }
 
     switch(memoryMode)
     {
         case PREALLOCATED_MEMORY_MODE:
-            ch->kind = ALIVE;
-            ch->sequenceNumber.high = 0;
-            ch->sequenceNumber.low = 0;
-            ch->writerGUID = c_Guid_Unknown;
-            ch->serializedPayload.length = 0;
-            ch->serializedPayload.pos = 0;
-            for(uint8_t i=0;i<16;++i)
-                ch->instanceHandle.value[i] = 0;
-            ch->isRead = 0;
-            ch->sourceTimestamp.seconds = 0;
-            ch->sourceTimestamp.fraction = 0;
-            m_freeCaches.push_back(ch);
-            break;
         case PREALLOCATED_WITH_REALLOC_MEMORY_MODE:
             ch->kind = ALIVE;
             ch->sequenceNumber.high = 0;
             ch->sequenceNumber.low = 0;
             ch->writerGUID = c_Guid_Unknown;
+            // Gives back the received message the payload could be referencing.
+            ch->serializedPayload.release_reference();
             ch->serializedPayload.length = 0;
             ch->serializedPayload.pos = 0;
             for(uint8_t i=0;i<16;++i)
@@ -175,59 +292,84 @@ void CacheChangePool::release_Cache(CacheChange_t* ch)
             ch->isRead = 0;
             ch->sourceTimestamp.seconds = 0;
             ch->sourceTimestamp.fraction = 0;
-            m_freeCaches.push_back(ch);
+            release_free(ch);
             break;
         case DYNAMIC_RESERVE_MEMORY_MODE:
-            // Find pointer in CacheChange vector, remove element, then delete it
-            std::vector<CacheChange_t*>::iterator target = m_allCaches.begin();	
-            target = find(m_allCaches.begin(),m_allCaches.end(), ch);
-            if(target != m_allCaches.end())
             {
-                m_allCaches.erase(target);
-            }else{
-                logInfo(RTPS_UTILS,"Tried to release a CacheChange that is not logged in the Pool");
-                break;
+                // The slot is freed along with the change.
+                uint32_t index = ch->pool_slot_;
+                slot(index)->change.store(nullptr, std::memory_order_relaxed);
+                delete(ch);
+                push_free(index, index);
+                m_pool_size.fetch_sub(1, std::memory_order_relaxed);
             }
-            delete(ch);
-            --m_pool_size;
             break;
 
     }
 }
 
-bool CacheChangePool::allocateGroup(uint32_t group_size)
+bool CacheChangePool::allocateGroup(uint32_t group_size, CacheChange_t** chan)
 {
-    // This method should only called from within PREALLOCATED_MEMORY_MODE
+    // This method should only called from within PREALLOCATED_MEMORY_MODE, with the mutex taken
     assert(memoryMode != DYNAMIC_RESERVE_MEMORY_MODE);
 
     logInfo(RTPS_UTILS,"Allocating group of cache changes of size: "<< group_size);
-    bool added = false;
+    uint32_t pool_size = m_pool_size.load(std::memory_order_relaxed);
     uint32_t reserved = 0;
     if (m_max_pool_size == 0)
         reserved = group_size;
     else
     {
-        if (m_pool_size + group_size > m_max_pool_size)
+        if (pool_size + group_size > m_max_pool_size)
         {
-            reserved = m_max_pool_size - m_pool_size;
+            reserved = m_max_pool_size - pool_size;
         }
         else
         {
             reserved = group_size;
         }
     }
+
+    if(reserved == 0)
+    {
+        logWarning(RTPS_HISTORY, "Maximum number of allowed reserved caches reached");
+        return false;
+    }
+
+    // The new slots are linked among them, and pushed at once into the free list.
+    uint32_t first = 0;
+    uint32_t last = 0;
+    uint32_t pushed = 0;
     for(uint32_t i = 0;i<reserved;i++)
     {
-        CacheChange_t* ch = new CacheChange_t(m_payload_size);
-        m_allCaches.push_back(ch);
-        m_freeCaches.push_back(ch);
-        ++m_pool_size;
-        added = true;
+        CacheChange_t* ch = new_change(m_payload_size);
+        uint32_t index = new_slot();
+        ch->pool_slot_ = index;
+        slot(index)->change.store(ch, std::memory_order_relaxed);
+
+        if(i == 0 && chan != nullptr)
+        {
+            *chan = ch;
+            continue;
+        }
+
+        if(pushed == 0)
+            first = index;
+        else
+            slot(last)->next.store(index + 1, std::memory_order_relaxed);
+        last = index;
+        ++pushed;
     }
-    if (!added)
-        logWarning(RTPS_HISTORY, "Maximum number of allowed reserved caches reached");
+    m_pool_size.fetch_add(reserved, std::memory_order_relaxed);
+
+    if(pushed > 0)
+    {
+        push_free(first, last);
+        m_free_size.fetch_add(pushed, std::memory_order_relaxed);
+    }
+
     //logInfo(RTPS_UTILS,"Finish allocating CacheChange_t");
-    return added;
+    return true;
 }
 
 CacheChange_t* CacheChangePool::allocateSingle(uint32_t dataSize)
@@ -238,33 +380,182 @@ CacheChange_t* CacheChangePool::allocateSingle(uint32_t dataSize)
      *   When the change is released and comes back to the pool, it is deallocated correspondingly.
      *
      *   In Preallocated mode, changes are allocated with a static maximum size and then they are dealt as
-     *   they are needed. In Dynamic mode, they are only allocated when they are needed. In Dynamic mode only
-     *   the m_allCaches vector is used, in order to keep track of all the changes that are dealt for destruction
-     *   purposes.
+     *   they are needed. In Dynamic mode, they are only allocated when they are needed. In Dynamic mode the
+     *   free list holds the empty slots, and the slots only keep track of the changes that are dealt for
+     *   destruction purposes.
      *
      */
-    bool added = false;
-    CacheChange_t*ch = nullptr;
 
     // This method should only be called from within DYNAMIC_RESERVE_MEMORY_MODE
     assert(memoryMode == DYNAMIC_RESERVE_MEMORY_MODE);
 
-    if((m_max_pool_size == 0) | (m_pool_size < m_max_pool_size)) { //If no limit or curren changes < max changes
-        ++m_pool_size;
-        ch = new CacheChange_t(dataSize);
-        m_allCaches.push_back(ch);
-        added = true;
+    uint32_t pool_size = m_pool_size.load(std::memory_order_relaxed);
+    do
+    {
+        if((m_max_pool_size != 0) && (pool_size >= m_max_pool_size))
+        {
+            logWarning(RTPS_HISTORY, "Maximum number of allowed reserved caches reached");
+            return NULL;
+        }
     }
+    while(!m_pool_size.compare_exchange_weak(pool_size, pool_size + 1, std::memory_order_relaxed));
 
-    if(!added)
+    CacheChange_t* ch = new_change(dataSize);
+
+    uint32_t index = 0;
+    if(!pop_free(index))
     {
-        logWarning(RTPS_HISTORY, "Maximum number of allowed reserved caches reached");
-        return NULL;
+        std::lock_guard<std::mutex> guard(*this->mp_mutex);
+        index = new_slot();
     }
 
+    ch->pool_slot_ = index;
+    slot(index)->change.store(ch, std::memory_order_relaxed);
+
     return ch;
 }
 
+CacheChange_t* CacheChangePool::new_change(uint32_t payload_size)
+{
+    if(memoryMode == PREALLOCATED_MEMORY_MODE)
+        return new CacheChange_t(payload_size);
+
+    CacheChange_t* ch = new CacheChange_t(0);
+    ch->serializedPayload.allocator = mp_payload_allocator;
+    ch->serializedPayload.reserve(payload_size);
+    return ch;
+}
+
+CacheChangePool::Slot* CacheChangePool::slot(uint32_t index) const
+{
+    // Segment k starts at index c_first_segment_size * (2^k - 1).
+    uint32_t segment = 0;
+    for(uint32_t n = index / c_first_segment_size + 1; n > 1; n >>= 1)
+        ++segment;
+
+    uint32_t offset = index - c_first_segment_size * ((1u << segment) - 1);
+    return m_segments[segment].load(std::memory_order_acquire) + offset;
+}
+
+uint32_t CacheChangePool::new_slot()
+{
+    // Called with the mutex taken.
+    uint32_t index = m_slot_count.load(std::memory_order_relaxed);
+
+    uint32_t segment = 0;
+    for(uint32_t n = index / c_first_segment_size + 1; n > 1; n >>= 1)
+        ++segment;
+
+    if(m_segments[segment].load(std::memory_order_relaxed) == nullptr)
+        m_segments[segment].store(new Slot[c_first_segment_size << segment], std::memory_order_release);
+
+    m_slot_count.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+void CacheChangePool::push_free(uint32_t first, uint32_t last)
+{
+    Slot* last_slot = slot(last);
+    uint64_t head = m_free_head.load(std::memory_order_relaxed);
+    uint64_t new_head = 0;
+
+    do
+    {
+        last_slot->next.store((uint32_t)head, std::memory_order_relaxed);
+        new_head = ((head >> 32) + 1) << 32 | (first + 1);
+    }
+    while(!m_free_head.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool CacheChangePool::pop_free(uint32_t& index)
+{
+    uint64_t head = m_free_head.load(std::memory_order_acquire);
+
+    while((uint32_t)head != 0)
+    {
+        // If the slot is taken by another thread meanwhile, the tag changes and the exchange fails.
+        uint32_t next = slot((uint32_t)head - 1)->next.load(std::memory_order_relaxed);
+        uint64_t new_head = ((head >> 32) + 1) << 32 | next;
+
+        if(m_free_head.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire))
+        {
+            index = (uint32_t)head - 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool CacheChangePool::reserve_free(CacheChange_t** chan)
+{
+    uint32_t index = 0;
+
+    if(m_thread_cache_size == 0)
+    {
+        if(!pop_free(index))
+            return false;
+
+        m_free_size.fetch_sub(1, std::memory_order_relaxed);
+        *chan = slot(index)->change.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    std::vector<CacheChange_t*>& cache = thread_caches().cache_for(this);
+
+    if(cache.empty())
+    {
+        // Take half a cache from the free list.
+        while(cache.size() < (m_thread_cache_size + 1) / 2 && pop_free(index))
+            cache.push_back(slot(index)->change.load(std::memory_order_relaxed));
+        m_free_size.fetch_sub((uint32_t)cache.size(), std::memory_order_relaxed);
+
+        if(cache.empty())
+            return false;
+    }
+
+    *chan = cache.back();
+    cache.pop_back();
+    return true;
+}
+
+void CacheChangePool::release_free(CacheChange_t* ch)
+{
+    if(m_thread_cache_size == 0)
+    {
+        push_free(ch->pool_slot_, ch->pool_slot_);
+        m_free_size.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::vector<CacheChange_t*>& cache = thread_caches().cache_for(this);
+
+    if(cache.size() >= m_thread_cache_size)
+    {
+        // Give half the cache back to the free list.
+        push_cached(cache, (cache.size() + 1) / 2);
+    }
+
+    cache.push_back(ch);
+}
+
+void CacheChangePool::push_cached(std::vector<CacheChange_t*>& cache, size_t count)
+{
+    size_t first = cache.size() - count;
+    for(size_t i = first; i + 1 < cache.size(); ++i)
+        slot(cache[i]->pool_slot_)->next.store(cache[i + 1]->pool_slot_ + 1, std::memory_order_relaxed);
+
+    push_free(cache[first]->pool_slot_, cache.back()->pool_slot_);
+    m_free_size.fetch_add((uint32_t)count, std::memory_order_relaxed);
+    cache.resize(first);
+}
+
+bool CacheChangePool::owns(CacheChange_t* ch) const
+{
+    return ch->pool_slot_ < m_slot_count.load(std::memory_order_acquire) &&
+        slot(ch->pool_slot_)->change.load(std::memory_order_relaxed) == ch;
+}
+
 }
 } /* namespace rtps */
 } /* namespace eprosima */
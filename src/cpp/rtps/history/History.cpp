@@ -25,6 +25,7 @@
 
 #include <fastrtps/log/Log.h>
 
+#include <algorithm>
 #include <mutex>
 
 namespace eprosima {
@@ -37,9 +38,11 @@ namespace eprosima {
 
             History::History(const HistoryAttributes & att):
                 m_att(att),
+                m_changesHead(0),
                 m_isHistoryFull(false),
                 mp_invalidCache(nullptr),
-                m_changePool(att.initialReservedCaches,att.payloadMaxSize,att.maximumReservedCaches,att.memoryPolicy),
+                m_changePool(att.initialReservedCaches,att.payloadMaxSize,att.maximumReservedCaches,att.memoryPolicy,
+                        att.threadCachedCaches),
                 mp_minSeqCacheChange(nullptr),
                 mp_maxSeqCacheChange(nullptr),
                 mp_mutex(nullptr)
@@ -72,13 +75,14 @@ namespace eprosima {
                 }
 
                 std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-                if(!m_changes.empty())
+                if(getHistorySize() > 0)
                 {
-                    while(!m_changes.empty())
+                    while(getHistorySize() > 0)
 		    {
-		        remove_change(m_changes.front());
+		        remove_change(*changesBegin());
 		    }
                     m_changes.clear();
+                    m_changesHead = 0;
                     m_isHistoryFull = false;
                     updateMaxMinSeqNum();
                     return true;
@@ -86,6 +90,50 @@ namespace eprosima {
                 return false;
             }
 
+            void History::insert_change_at(std::vector<CacheChange_t*>::iterator position, CacheChange_t* a_change)
+            {
+                size_t before = position - changesBegin();
+                if(m_changesHead > 0 && before <= static_cast<size_t>(changesEnd() - position))
+                {
+                    std::move(changesBegin(), position, changesBegin() - 1);
+                    --m_changesHead;
+                    *(changesBegin() + before) = a_change;
+                    return;
+                }
+
+                // Reuse the room of the removed changes before the vector has to grow, when it is enough to pay for
+                // moving the rest. Otherwise a full vector would move all its changes for each one added.
+                if(m_changesHead * 4 >= m_changes.size() && m_changes.size() == m_changes.capacity())
+                {
+                    m_changes.erase(m_changes.begin(), changesBegin());
+                    m_changesHead = 0;
+                }
+                m_changes.insert(changesBegin() + before, a_change);
+            }
+
+            void History::remove_change_at(std::vector<CacheChange_t*>::iterator position)
+            {
+                if(position != changesBegin())
+                {
+                    m_changes.erase(position);
+                    return;
+                }
+
+                *position = nullptr;
+                ++m_changesHead;
+                if(m_changesHead == m_changes.size())
+                {
+                    m_changes.clear();
+                    m_changesHead = 0;
+                }
+                else if(m_changesHead * 2 >= m_changes.size())
+                {
+                    // Once half of the vector is removed changes, moving the rest is paid by the removals.
+                    m_changes.erase(m_changes.begin(), changesBegin());
+                    m_changesHead = 0;
+                }
+            }
+
             //bool History::remove_change(CacheChange_t* ch)
             //{
             //	std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
@@ -155,16 +203,19 @@ namespace eprosima {
                 }
 
                 std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-                for(std::vector<CacheChange_t*>::iterator it = m_changes.begin();
-                        it!=m_changes.end();++it)
+                // Changes are ordered by sequence number. Only the ones with the same number are compared.
+                for(std::vector<CacheChange_t*>::iterator it = std::lower_bound(changesBegin(), m_changes.end(), seq,
+                            [](const CacheChange_t* a_change, const SequenceNumber_t& a_seq)
+                            {
+                                return a_change->sequenceNumber < a_seq;
+                            });
+                        it!=m_changes.end() && (*it)->sequenceNumber == seq;++it)
                 {
-                    if((*it)->sequenceNumber == seq && (*it)->writerGUID == guid)
+                    if((*it)->writerGUID == guid)
                     {
                         *change = *it;
                         return true;
                     }
-                    else if((*it)->sequenceNumber > seq)
-                        break;
                 }
                 return false;
             }
@@ -183,7 +234,7 @@ namespace eprosima{
             void History::print_changes_seqNum2()
             {
                 std::stringstream ss;
-                for(std::vector<CacheChange_t*>::iterator it = m_changes.begin();
+                for(std::vector<CacheChange_t*>::iterator it = changesBegin();
                         it!=m_changes.end();++it)
                 {
                     ss << (*it)->sequenceNumber << "-";
@@ -24,6 +24,7 @@
 #include <fastrtps/rtps/reader/RTPSReader.h>
 #include <fastrtps/rtps/reader/ReaderListener.h>
 
+#include <algorithm>
 #include <mutex>
 
 namespace eprosima {
@@ -81,8 +82,13 @@ bool ReaderHistory::add_change(CacheChange_t* a_change)
         logError(RTPS_HISTORY,"The Writer GUID_t must be defined");
     }
 
-    m_changes.push_back(a_change);
-    sortCacheChanges();
+    // Changes usually arrive in order and are appended. Otherwise their position is searched, so the history
+    // stays ordered by sequence number without sorting it.
+    if(getHistorySize() == 0 || !sort_ReaderHistoryCache(a_change, m_changes.back()))
+        insert_change_at(changesEnd(), a_change);
+    else
+        insert_change_at(std::upper_bound(changesBegin(), changesEnd(), a_change, sort_ReaderHistoryCache),
+                a_change);
     updateMaxMinSeqNum();
     logInfo(RTPS_HISTORY, "Change " << a_change->sequenceNumber << " added with " << a_change->serializedPayload.length << " bytes");
 
@@ -90,6 +96,16 @@ bool ReaderHistory::add_change(CacheChange_t* a_change)
 }
 
 bool ReaderHistory::remove_change(CacheChange_t* a_change)
+{
+    return detach_change(a_change, true);
+}
+
+bool ReaderHistory::take_change(CacheChange_t* a_change)
+{
+    return detach_change(a_change, false);
+}
+
+bool ReaderHistory::detach_change(CacheChange_t* a_change, bool release)
 {
 
     if(mp_reader == nullptr || mp_mutex == nullptr)
@@ -104,17 +120,18 @@ bool ReaderHistory::remove_change(CacheChange_t* a_change)
         logError(RTPS_HISTORY,"Pointer is not valid")
         return false;
     }
-    for(std::vector<CacheChange_t*>::iterator chit = m_changes.begin();
-            chit!=m_changes.end();++chit)
+    // Only the changes with the same sequence number, from other writers, are compared.
+    for(std::vector<CacheChange_t*>::iterator chit = std::lower_bound(changesBegin(), changesEnd(), a_change,
+                sort_ReaderHistoryCache);
+            chit!=changesEnd() && (*chit)->sequenceNumber == a_change->sequenceNumber;++chit)
     {
-        if((*chit)->sequenceNumber == a_change->sequenceNumber &&
-                (*chit)->writerGUID == a_change->writerGUID)
+        if((*chit)->writerGUID == a_change->writerGUID)
         {
             logInfo(RTPS_HISTORY,"Removing change "<< a_change->sequenceNumber);
             mp_reader->change_removed_by_history(a_change);
-            m_changePool.release_Cache(a_change);
-            m_changes.erase(chit);
-            sortCacheChanges();
+            if(release)
+                m_changePool.release_Cache(a_change);
+            remove_change_at(chit);
             updateMaxMinSeqNum();
             return true;
         }
@@ -140,7 +157,7 @@ bool ReaderHistory::remove_changes_with_guid(GUID_t* a_guid)
             logError(RTPS_HISTORY, "Target Guid for Cachechange deletion is not valid");
             return false;
         }
-        for(std::vector<CacheChange_t*>::iterator chit = m_changes.begin(); chit!=m_changes.end();++chit)
+        for(std::vector<CacheChange_t*>::iterator chit = changesBegin(); chit!=changesEnd();++chit)
         {
             bool matches = true;
             unsigned int size = a_guid->guidPrefix.size;
@@ -164,19 +181,19 @@ bool ReaderHistory::remove_changes_with_guid(GUID_t* a_guid)
 
 void ReaderHistory::sortCacheChanges()
 {
-    std::sort(m_changes.begin(),m_changes.end(),sort_ReaderHistoryCache);
+    std::sort(changesBegin(),changesEnd(),sort_ReaderHistoryCache);
 }
 
 void ReaderHistory::updateMaxMinSeqNum()
 {
-    if(m_changes.size()==0)
+    if(getHistorySize()==0)
     {
         mp_minSeqCacheChange = mp_invalidCache;
         mp_maxSeqCacheChange = mp_invalidCache;
     }
     else
     {
-        mp_minSeqCacheChange = m_changes.front();
+        mp_minSeqCacheChange = *changesBegin();
         mp_maxSeqCacheChange = m_changes.back();
     }
 }
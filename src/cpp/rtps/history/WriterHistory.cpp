@@ -20,7 +20,10 @@
 
 #include <fastrtps/log/Log.h>
 #include <fastrtps/rtps/writer/RTPSWriter.h>
+#include "../persistence/MappedChangeLog.h"
 
+#include <algorithm>
+#include <cstring>
 #include <mutex>
 
 namespace eprosima {
@@ -34,14 +37,15 @@ typedef std::vector<t_pairKeyChanges> t_vectorPairKeyChanges;
 
 WriterHistory::WriterHistory(const HistoryAttributes& att):
     History(att),
-    mp_writer(nullptr)
+    mp_writer(nullptr),
+    mp_persistence(nullptr)
     {
 
     }
 
 WriterHistory::~WriterHistory()
 {
-    // TODO Auto-generated destructor stub
+    delete(mp_persistence);
 }
 
 bool WriterHistory::add_change(CacheChange_t* a_change)
@@ -68,8 +72,10 @@ bool WriterHistory::add_change(CacheChange_t* a_change)
     }
     ++m_lastCacheChangeSeqNum;
     a_change->sequenceNumber = m_lastCacheChangeSeqNum;
-    m_changes.push_back(a_change);
+    insert_change_at(changesEnd(), a_change);
     logInfo(RTPS_HISTORY,"Change "<< a_change->sequenceNumber << " added with "<<a_change->serializedPayload.length<< " bytes");
+    if(mp_persistence != nullptr && !mp_persistence->add(*a_change))
+        logWarning(RTPS_HISTORY,"Change "<< a_change->sequenceNumber << " could not be added to the persistence log");
     updateMaxMinSeqNum();
 
     mp_writer->unsent_change_added_to_history(a_change);
@@ -100,17 +106,14 @@ bool WriterHistory::remove_change(CacheChange_t* a_change)
         return false;
     }
 
-    for(std::vector<CacheChange_t*>::iterator chit = m_changes.begin();
-            chit!=m_changes.end();++chit)
+    std::vector<CacheChange_t*>::iterator chit = find_change(a_change->sequenceNumber);
+    if(chit != m_changes.end())
     {
-        if((*chit)->sequenceNumber == a_change->sequenceNumber)
-        {
-            mp_writer->change_removed_by_history(a_change);
-            m_changePool.release_Cache(a_change);
-            m_changes.erase(chit);
-            updateMaxMinSeqNum();
-            return true;
-        }
+        mp_writer->change_removed_by_history(a_change);
+        erase_change(chit);
+        m_changePool.release_Cache(a_change);
+        updateMaxMinSeqNum();
+        return true;
     }
     logWarning(RTPS_HISTORY,"SequenceNumber "<<a_change->sequenceNumber << " not found");
     return false;
@@ -131,17 +134,15 @@ bool WriterHistory::remove_change(const SequenceNumber_t& sequence_number)
 
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
-    for(std::vector<CacheChange_t*>::iterator chit = m_changes.begin();
-            chit!=m_changes.end();++chit)
+    std::vector<CacheChange_t*>::iterator chit = find_change(sequence_number);
+    if(chit != m_changes.end())
     {
-        if((*chit)->sequenceNumber == sequence_number)
-        {
-            mp_writer->change_removed_by_history(*chit);
-            m_changePool.release_Cache(*chit);
-            m_changes.erase(chit);
-            updateMaxMinSeqNum();
-            return true;
-        }
+        CacheChange_t* change = *chit;
+        mp_writer->change_removed_by_history(change);
+        erase_change(chit);
+        m_changePool.release_Cache(change);
+        updateMaxMinSeqNum();
+        return true;
     }
 
     logWarning(RTPS_HISTORY,"SequenceNumber " <<  sequence_number << " not found");
@@ -158,17 +159,14 @@ CacheChange_t* WriterHistory::remove_change_and_reuse(const SequenceNumber_t& se
 
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
-    for(std::vector<CacheChange_t*>::iterator chit = m_changes.begin();
-            chit!=m_changes.end();++chit)
+    std::vector<CacheChange_t*>::iterator chit = find_change(sequence_number);
+    if(chit != m_changes.end())
     {
-        if((*chit)->sequenceNumber == sequence_number)
-        {
-            CacheChange_t* change = *chit;
-            mp_writer->change_removed_by_history(change);
-            m_changes.erase(chit);
-            updateMaxMinSeqNum();
-            return change;
-        }
+        CacheChange_t* change = *chit;
+        mp_writer->change_removed_by_history(change);
+        erase_change(chit);
+        updateMaxMinSeqNum();
+        return change;
     }
 
     logWarning(RTPS_HISTORY,"SequenceNumber " <<  sequence_number << " not found");
@@ -177,14 +175,14 @@ CacheChange_t* WriterHistory::remove_change_and_reuse(const SequenceNumber_t& se
 
 void WriterHistory::updateMaxMinSeqNum()
 {
-    if(m_changes.size()==0)
+    if(getHistorySize()==0)
     {
         mp_minSeqCacheChange = mp_invalidCache;
         mp_maxSeqCacheChange = mp_invalidCache;
     }
     else
     {
-        mp_minSeqCacheChange = m_changes.front();
+        mp_minSeqCacheChange = *changesBegin();
         mp_maxSeqCacheChange = m_changes.back();
     }
 }
@@ -200,7 +198,7 @@ bool WriterHistory::remove_min_change()
     }
 
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-    if(m_changes.size() > 0 && remove_change_g(mp_minSeqCacheChange))
+    if(getHistorySize() > 0 && remove_change_g(mp_minSeqCacheChange))
     {
         updateMaxMinSeqNum();
         return true;
@@ -209,6 +207,93 @@ bool WriterHistory::remove_min_change()
         return false;
 }
 
+std::vector<CacheChange_t*>::iterator WriterHistory::find_change(const SequenceNumber_t& sequence_number)
+{
+    std::vector<CacheChange_t*>::iterator begin = changesBegin();
+    if(begin == m_changes.end() || sequence_number < (*begin)->sequenceNumber)
+        return m_changes.end();
+
+    // Each removed change in the middle moves the following ones one position back, so the change can't be
+    // further than its distance from the first one.
+    uint64_t distance = (sequence_number - (*begin)->sequenceNumber).to64long();
+    std::vector<CacheChange_t*>::iterator end = m_changes.end();
+    if(distance < static_cast<uint64_t>(end - begin))
+    {
+        if(begin[distance]->sequenceNumber == sequence_number)
+            return begin + distance;
+        end = begin + distance;
+    }
+
+    std::vector<CacheChange_t*>::iterator it = std::lower_bound(begin, end, sequence_number,
+            [](const CacheChange_t* a_change, const SequenceNumber_t& a_seq)
+            {
+                return a_change->sequenceNumber < a_seq;
+            });
+    if(it != end && (*it)->sequenceNumber == sequence_number)
+        return it;
+    return m_changes.end();
+}
+
+void WriterHistory::erase_change(std::vector<CacheChange_t*>::iterator position)
+{
+    if(mp_persistence != nullptr && !mp_persistence->remove((*position)->sequenceNumber))
+        logWarning(RTPS_HISTORY,"Change "<< (*position)->sequenceNumber << " could not be removed from the persistence log");
+
+    remove_change_at(position);
+}
+
+bool WriterHistory::restore_persistent_changes(MappedChangeLog* log)
+{
+    std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
+    delete(mp_persistence);
+    mp_persistence = log;
+
+    size_t restored = 0;
+    bool opened = log->open([&](const LoggedChange& logged)
+    {
+        CacheChange_t* change = nullptr;
+        if(!reserve_Cache(&change, logged.length) || change->serializedPayload.max_size < logged.length)
+        {
+            if(change != nullptr)
+                release_Cache(change);
+            logWarning(RTPS_HISTORY,"Change "<< logged.sequenceNumber << " of the persistence log doesn't fit in the history");
+            log->remove(logged.sequenceNumber);
+            return;
+        }
+
+        change->kind = logged.kind;
+        change->writerGUID = mp_writer->getGuid();
+        change->instanceHandle = logged.instanceHandle;
+        change->sourceTimestamp = logged.sourceTimestamp;
+        change->serializedPayload.encapsulation = logged.encapsulation;
+        change->serializedPayload.length = logged.length;
+        if(logged.length > 0)
+            memcpy(change->serializedPayload.data, logged.data, logged.length);
+
+        // The change keeps its sequence number.
+        m_lastCacheChangeSeqNum = logged.sequenceNumber - 1;
+        if(add_restored_change(change))
+            ++restored;
+        else
+        {
+            release_Cache(change);
+            log->remove(logged.sequenceNumber);
+        }
+    });
+
+    if(!opened)
+    {
+        mp_persistence = nullptr;
+        delete(log);
+        return false;
+    }
+
+    if(m_lastCacheChangeSeqNum < log->last_sequence_number())
+        m_lastCacheChangeSeqNum = log->last_sequence_number();
+    logInfo(RTPS_HISTORY,restored << " changes restored from the persistence log");
+    return true;
+}
+
 //TODO Hacer metodos de remove_all_changes. y hacer los metodos correspondientes en los writers y publishers.
 
 }
@@ -50,16 +50,21 @@ namespace fastrtps{
 namespace rtps {
 
 
-MessageReceiver::MessageReceiver(RTPSParticipantImpl* participant) : mp_change(nullptr),
-    participant_(participant) {}
+MessageReceiver::MessageReceiver(RTPSParticipantImpl* participant) : readers_by_writer_generation_(0),
+    mp_change(nullptr), mp_receive_buffer(nullptr), participant_(participant) {}
 MessageReceiver::MessageReceiver(RTPSParticipantImpl* participant, uint32_t rec_buffer_size) :
-    m_rec_msg(rec_buffer_size),
 #if HAVE_SECURITY
     m_crypto_msg(rec_buffer_size),
 #endif
+    readers_by_writer_generation_(0),
     mp_change(nullptr),
+    mp_receive_buffer(nullptr),
     participant_(participant)
     {
+#if !HAVE_SECURITY
+        // The messages are received in the buffers of the ReceiverControlBlock.
+        (void)rec_buffer_size;
+#endif
     }
 
 void MessageReceiver::init(uint32_t rec_buffer_size){
@@ -74,7 +79,7 @@ void MessageReceiver::init(uint32_t rec_buffer_size){
     defUniLoc.kind = LOCATOR_KIND_UDPv4;
     LOCATOR_ADDRESS_INVALID(defUniLoc.address);
     defUniLoc.port = LOCATOR_PORT_INVALID;
-    logInfo(RTPS_MSG_IN,"Created with CDRMessage of size: "<<m_rec_msg.max_size);
+    logInfo(RTPS_MSG_IN,"Created with maximum payload size: "<<rec_buffer_size);
     uint16_t max_payload = ((uint32_t)std::numeric_limits<uint16_t>::max() < rec_buffer_size) ? std::numeric_limits<uint16_t>::max() : (uint16_t)rec_buffer_size;
     mp_change = new CacheChange_t(max_payload, true);
 }
@@ -96,7 +101,11 @@ void MessageReceiver::associateEndpoint(Endpoint *to_add){
                 break;
             }
         }
-        if(!found) AssociatedWriters.push_back((RTPSWriter*)to_add);
+        if(!found)
+        {
+            AssociatedWriters.push_back((RTPSWriter*)to_add);
+            writers_by_id_[to_add->getGuid().entityId] = (RTPSWriter*)to_add;
+        }
     }else{
         for(auto it = AssociatedReaders.begin();it != AssociatedReaders.end(); ++it){
             if( (*it) == (RTPSReader*)to_add ){
@@ -104,7 +113,12 @@ void MessageReceiver::associateEndpoint(Endpoint *to_add){
                 break;
             }
         }
-        if(!found)	AssociatedReaders.push_back((RTPSReader*)to_add);
+        if(!found)
+        {
+            AssociatedReaders.push_back((RTPSReader*)to_add);
+            readers_by_id_[to_add->getGuid().entityId] = (RTPSReader*)to_add;
+            readers_by_writer_.clear();
+        }
     }
     return;
 }
@@ -116,6 +130,7 @@ void MessageReceiver::removeEndpoint(Endpoint *to_remove){
         for(auto it=AssociatedWriters.begin(); it !=AssociatedWriters.end(); ++it){
             if ((*it) == var){
                 AssociatedWriters.erase(it);
+                writers_by_id_.erase(var->getGuid().entityId);
                 break;
             }
         }
@@ -124,6 +139,8 @@ void MessageReceiver::removeEndpoint(Endpoint *to_remove){
         for(auto it=AssociatedReaders.begin(); it !=AssociatedReaders.end(); ++it){
             if ((*it) == var){
                 AssociatedReaders.erase(it);
+                readers_by_id_.erase(var->getGuid().entityId);
+                readers_by_writer_.clear();
                 break;
             }
         }
@@ -131,6 +148,48 @@ void MessageReceiver::removeEndpoint(Endpoint *to_remove){
     return;
 }
 
+const std::vector<RTPSReader*>& MessageReceiver::find_readers(const EntityId_t& readerId, const GUID_t& writerGUID)
+{
+    if(readerId == c_EntityId_Unknown)
+    {
+        // Readers match and unmatch writers without telling the receivers, so the cached readers
+        // are thrown away whenever any reader of the participant changes its matched writers.
+        uint32_t generation = participant_->matched_writers_generation();
+        if(generation != readers_by_writer_generation_)
+        {
+            readers_by_writer_.clear();
+            readers_by_writer_generation_ = generation;
+        }
+
+        auto it = readers_by_writer_.find(writerGUID);
+        if(it != readers_by_writer_.end())
+            return it->second;
+
+        EntityId_t unknownId(c_EntityId_Unknown);
+        std::vector<RTPSReader*>& readers = readers_by_writer_[writerGUID];
+        for(auto rit = AssociatedReaders.begin(); rit != AssociatedReaders.end(); ++rit)
+        {
+            if((*rit)->acceptMsgDirectedTo(unknownId) && (*rit)->is_writer_accepted(writerGUID))
+                readers.push_back(*rit);
+        }
+        return readers;
+    }
+
+    directed_readers_.clear();
+    auto it = readers_by_id_.find(readerId);
+    if(it != readers_by_id_.end())
+        directed_readers_.push_back(it->second);
+    return directed_readers_;
+}
+
+RTPSWriter* MessageReceiver::find_writer(const GUID_t& writerGUID) const
+{
+    auto it = writers_by_id_.find(writerGUID.entityId);
+    if(it != writers_by_id_.end() && it->second->getGuid() == writerGUID)
+        return it->second;
+    return nullptr;
+}
+
 
 void MessageReceiver::reset(){
     destVersion = c_ProtocolVersion;
@@ -164,8 +223,10 @@ void MessageReceiver::reset(){
 }
 
 void MessageReceiver::processCDRMsg(const GuidPrefix_t& RTPSParticipantguidprefix,
-        Locator_t* loc, CDRMessage_t*msg)
+        Locator_t* loc, CDRMessage_t*msg, ReceiveBuffer* buffer)
 {
+    mp_receive_buffer = buffer;
+
     if(msg->length < RTPSMESSAGE_HEADER_SIZE)
     {
         logWarning(RTPS_MSG_IN,IDSTRING"Received message too short, ignoring");
@@ -180,7 +241,7 @@ void MessageReceiver::processCDRMsg(const GuidPrefix_t& RTPSParticipantguidprefi
     uint8_t n_start = 0;
     if(loc->kind == 1)
         n_start = 12;
-    else if(loc->kind == 2)
+    else if(loc->kind == 2 || loc->kind == LOCATOR_KIND_SHM)
         n_start = 0;
     else
     {
@@ -473,23 +534,13 @@ bool MessageReceiver::proc_Submsg_Data(CDRMessage_t* msg,SubmessageHeader_t* smh
 
     //WE KNOW THE READER THAT THE MESSAGE IS DIRECTED TO SO WE LOOK FOR IT:
 
-    RTPSReader* firstReader = nullptr;
     if(AssociatedReaders.empty())
     {
         logWarning(RTPS_MSG_IN,IDSTRING"Data received when NO readers are listening");
         return false;
     }
 
-    for(std::vector<RTPSReader*>::iterator it=AssociatedReaders.begin();
-            it != AssociatedReaders.end(); ++it)
-    {
-        if((*it)->acceptMsgDirectedTo(readerID)) //add
-        {
-            firstReader = *it;
-            break;
-        }
-    }
-    if(firstReader == nullptr) //Reader not found
+    if(readerID != c_EntityId_Unknown && readers_by_id_.find(readerID) == readers_by_id_.end()) //Reader not found
     {
         logWarning(RTPS_MSG_IN, IDSTRING"No Reader accepts this message (directed to: " <<readerID << ")");
         return false;
@@ -548,12 +599,27 @@ bool MessageReceiver::proc_Submsg_Data(CDRMessage_t* msg,SubmessageHeader_t* smh
 
         if(dataFlag)
         {
+            // A message discarded halfway can leave the payload referencing its buffer.
+            ch->serializedPayload.release_reference();
+
             if(ch->serializedPayload.max_size >= payload_size && payload_size > 0)
             {
-                ch->serializedPayload.length = payload_size;
-                valid &= CDRMessage::readData(msg,ch->serializedPayload.data,ch->serializedPayload.length);
-                if (!valid){
-                    return false;
+                // The payload is referenced from the receive buffer, so the readers can keep it without a copy.
+                // It is not when the message was decoded into another buffer.
+                if(mp_receive_buffer != nullptr && msg->buffer == mp_receive_buffer->buffer())
+                {
+                    if(msg->pos + payload_size > msg->length)
+                        return false;
+                    ch->serializedPayload.reference(mp_receive_buffer, &msg->buffer[msg->pos], payload_size);
+                    msg->pos += payload_size;
+                }
+                else
+                {
+                    ch->serializedPayload.length = payload_size;
+                    valid &= CDRMessage::readData(msg,ch->serializedPayload.data,ch->serializedPayload.length);
+                    if (!valid){
+                        return false;
+                    }
                 }
                 ch->kind = ALIVE;
             }
@@ -595,17 +661,18 @@ bool MessageReceiver::proc_Submsg_Data(CDRMessage_t* msg,SubmessageHeader_t* smh
 
 
     //FIXME: DO SOMETHING WITH PARAMETERLIST CREATED.
-    logInfo(RTPS_MSG_IN,IDSTRING"from Writer " << ch->writerGUID << "; possible RTPSReaders: "<<AssociatedReaders.size());
-    //Look for the correct reader to add the change
-    for(std::vector<RTPSReader*>::iterator it = AssociatedReaders.begin();
-            it != AssociatedReaders.end(); ++it)
+    const std::vector<RTPSReader*>& readers = find_readers(readerID, ch->writerGUID);
+    logInfo(RTPS_MSG_IN,IDSTRING"from Writer " << ch->writerGUID << "; possible RTPSReaders: "<<readers.size());
+    //Give the change to the readers it is directed to
+    for(std::vector<RTPSReader*>::const_iterator it = readers.begin();
+            it != readers.end(); ++it)
     {
-        if((*it)->acceptMsgDirectedTo(readerID))
-        {
-            (*it)->processDataMsg(ch);
-        }
+        (*it)->processDataMsg(ch);
     }
 
+    // Only the readers that kept the payload go on referencing the receive buffer.
+    ch->serializedPayload.release_reference();
+
     logInfo(RTPS_MSG_IN,IDSTRING"Sub Message DATA processed");
     return true;
 }
@@ -653,18 +720,7 @@ bool MessageReceiver::proc_Submsg_DataFrag(CDRMessage_t* msg, SubmessageHeader_t
         return false;
     }
 
-    RTPSReader* firstReader = nullptr;
-    for (std::vector<RTPSReader*>::iterator it = AssociatedReaders.begin();
-            it != AssociatedReaders.end(); ++it)
-    {
-        if ((*it)->acceptMsgDirectedTo(readerID)) //add
-        {
-            firstReader = *it;
-            break;
-        }
-    }
-
-    if (firstReader == nullptr) //Reader not found
+    if (readerID != c_EntityId_Unknown && readers_by_id_.find(readerID) == readers_by_id_.end()) //Reader not found
     {
         logWarning(RTPS_MSG_IN, IDSTRING"No Reader accepts this message (directed to: " << readerID << ")");
         return false;
@@ -797,15 +853,13 @@ bool MessageReceiver::proc_Submsg_DataFrag(CDRMessage_t* msg, SubmessageHeader_t
         ch->sourceTimestamp = this->timestamp;
 
     //FIXME: DO SOMETHING WITH PARAMETERLIST CREATED.
-    logInfo(RTPS_MSG_IN, IDSTRING"from Writer " << ch->writerGUID << "; possible RTPSReaders: " << AssociatedReaders.size());
-    //Look for the correct reader to add the change
-    for (std::vector<RTPSReader*>::iterator it = AssociatedReaders.begin();
-            it != AssociatedReaders.end(); ++it)
+    const std::vector<RTPSReader*>& readers = find_readers(readerID, ch->writerGUID);
+    logInfo(RTPS_MSG_IN, IDSTRING"from Writer " << ch->writerGUID << "; possible RTPSReaders: " << readers.size());
+    //Give the fragment to the readers it is directed to
+    for (std::vector<RTPSReader*>::const_iterator it = readers.begin();
+            it != readers.end(); ++it)
     {
-        if ((*it)->acceptMsgDirectedTo(readerID))
-        {
-            (*it)->processDataFragMsg(ch, sampleSize, fragmentStartingNum);
-        }
+        (*it)->processDataFragMsg(ch, sampleSize, fragmentStartingNum);
     }
 
     logInfo(RTPS_MSG_IN, IDSTRING"Sub Message DATA_FRAG processed");
@@ -843,13 +897,11 @@ bool MessageReceiver::proc_Submsg_Heartbeat(CDRMessage_t* msg,SubmessageHeader_t
 
     std::lock_guard<std::mutex> guard(mtx);
     //Look for the correct reader and writers:
-    for (std::vector<RTPSReader*>::iterator it = AssociatedReaders.begin();
-            it != AssociatedReaders.end(); ++it)
+    const std::vector<RTPSReader*>& readers = find_readers(readerGUID.entityId, writerGUID);
+    for (std::vector<RTPSReader*>::const_iterator it = readers.begin();
+            it != readers.end(); ++it)
     {
-        if((*it)->acceptMsgDirectedTo(readerGUID.entityId))
-        {
-            (*it)->processHeartbeatMsg(writerGUID, HBCount, firstSN, lastSN, finalFlag, livelinessFlag);
-        }
+        (*it)->processHeartbeatMsg(writerGUID, HBCount, firstSN, lastSN, finalFlag, livelinessFlag);
     }
     //Is the final message?
     if(smh->submessageLength == 0)
@@ -884,69 +936,60 @@ bool MessageReceiver::proc_Submsg_Acknack(CDRMessage_t* msg,SubmessageHeader_t*
 
     std::lock_guard<std::mutex> guard(mtx);
     //Look for the correct writer to use the acknack
-    for (std::vector<RTPSWriter*>::iterator it = AssociatedWriters.begin();
-            it != AssociatedWriters.end(); ++it)
+    RTPSWriter* writer = find_writer(writerGUID);
+    if(writer == nullptr)
     {
-        //Look for the readerProxy the acknack is from
-        std::lock_guard<std::recursive_mutex> guardW(*(*it)->getMutex());
+        logInfo(RTPS_MSG_IN,IDSTRING"Acknack msg to UNKNOWN writer (" << AssociatedWriters.size()
+                << " writers in this ListenResource)");
+        return false;
+    }
+
+    if(writer->getAttributes()->reliabilityKind != RELIABLE)
+    {
+        logInfo(RTPS_MSG_IN,IDSTRING"Acknack msg to NOT stateful writer ");
+        return false;
+    }
+
+    StatefulWriter* SF = (StatefulWriter*)writer;
+    std::lock_guard<std::recursive_mutex> guardW(*SF->getMutex());
 
-        if((*it)->getGuid() == writerGUID)
+    //Look for the readerProxy the acknack is from
+    ReaderProxy* rp = nullptr;
+    if(SF->matched_reader_lookup(readerGUID, &rp))
+    {
+        std::lock_guard<std::recursive_mutex> guardReaderProxy(*rp->mp_mutex);
+
+        if(rp->m_lastAcknackCount < Ackcount)
         {
-            if((*it)->getAttributes()->reliabilityKind == RELIABLE)
+            rp->m_lastAcknackCount = Ackcount;
+            bool maybe_all_acks = rp->acked_changes_set(SNSet.base);
+            if (rp->requested_changes_set(SNSet))
+                rp->mp_nackResponse->restart_timer();
+            else if (!finalFlag)
             {
-                StatefulWriter* SF = (StatefulWriter*)(*it);
-
-                for(auto rit = SF->matchedReadersBegin();rit!=SF->matchedReadersEnd();++rit)
+                if(SNSet.base == SequenceNumber_t(0, 0) && SNSet.isSetEmpty())
                 {
-                    std::lock_guard<std::recursive_mutex> guardReaderProxy(*(*rit)->mp_mutex);
-
-                    if((*rit)->m_att.guid == readerGUID )
-                    {
-                        if((*rit)->m_lastAcknackCount < Ackcount)
-                        {
-                            (*rit)->m_lastAcknackCount = Ackcount;
-                            bool maybe_all_acks = (*rit)->acked_changes_set(SNSet.base);
-                            std::vector<SequenceNumber_t> set_vec = SNSet.get_set();
-                            if ((*rit)->requested_changes_set(set_vec))
-                                (*rit)->mp_nackResponse->restart_timer();
-                            else if (!finalFlag)
-                            {
-                                if(SNSet.base == SequenceNumber_t(0, 0) && SNSet.isSetEmpty())
-                                {
-                                    SF->send_heartbeat_to(**rit);
-                                }
-
-                                SF->mp_periodicHB->restart_timer();
-                            }
-
-                            if(SF->getAttributes()->durabilityKind == VOLATILE)
-                            {
-                                // Clean history.
-                                // TODO Change mechanism
-                                SF->clean_history();
-                            }
-
-                            // Check if all CacheChange are acknowledge, because a user could be waiting
-                            // for this.
-                            if(maybe_all_acks)
-                                SF->check_for_all_acked();
-
-                        }
-                        break;
-                    }
+                    SF->send_heartbeat_to(*rp);
                 }
-                return true;
+
+                SF->mp_periodicHB->restart_timer();
             }
-            else
+
+            if(SF->getAttributes()->durabilityKind == VOLATILE)
             {
-                logInfo(RTPS_MSG_IN,IDSTRING"Acknack msg to NOT stateful writer ");
-                return false;
+                // Clean history.
+                // TODO Change mechanism
+                SF->clean_history();
             }
+
+            // Check if all CacheChange are acknowledge, because a user could be waiting
+            // for this.
+            if(maybe_all_acks)
+                SF->check_for_all_acked();
         }
     }
-    logInfo(RTPS_MSG_IN,IDSTRING"Acknack msg to UNKNOWN writer (I loooked through "
-            << AssociatedWriters.size() << " writers in this ListenResource)");
-    return false;
+
+    return true;
 }
 
 
@@ -977,13 +1020,11 @@ bool MessageReceiver::proc_Submsg_Gap(CDRMessage_t* msg,SubmessageHeader_t* smh,
         return false;
 
     std::lock_guard<std::mutex> guard(mtx);
-    for (std::vector<RTPSReader*>::iterator it = AssociatedReaders.begin();
-            it != AssociatedReaders.end(); ++it)
+    const std::vector<RTPSReader*>& readers = find_readers(readerGUID.entityId, writerGUID);
+    for (std::vector<RTPSReader*>::const_iterator it = readers.begin();
+            it != readers.end(); ++it)
     {
-        if((*it)->acceptMsgDirectedTo(readerGUID.entityId))
-        {
-            (*it)->processGapMsg(writerGUID, gapStart, gapList);
-        }
+        (*it)->processGapMsg(writerGUID, gapStart, gapList);
     }
 
     return true;
@@ -1090,47 +1131,41 @@ bool MessageReceiver::proc_Submsg_NackFrag(CDRMessage_t*msg, SubmessageHeader_t*
 
     std::lock_guard<std::mutex> guard(mtx);
     //Look for the correct writer to use the acknack
-    for (std::vector<RTPSWriter*>::iterator it = AssociatedWriters.begin();
-            it != AssociatedWriters.end(); ++it)
+    RTPSWriter* writer = find_writer(writerGUID);
+    if (writer == nullptr)
     {
-        //Look for the readerProxy the acknack is from
-        std::lock_guard<std::recursive_mutex> guardW(*(*it)->getMutex());
-        if ((*it)->getGuid() == writerGUID)
-        {
-            if ((*it)->getAttributes()->reliabilityKind == RELIABLE)
-            {
-                StatefulWriter* SF = (StatefulWriter*)(*it);
+        logInfo(RTPS_MSG_IN, IDSTRING"Acknack msg to UNKNOWN writer (" << AssociatedWriters.size()
+                << " writers in this ListenResource)");
+        return false;
+    }
 
-                for (auto rit = SF->matchedReadersBegin(); rit != SF->matchedReadersEnd(); ++rit)
-                {
-                    std::lock_guard<std::recursive_mutex> guardReaderProxy(*(*rit)->mp_mutex);
+    if (writer->getAttributes()->reliabilityKind != RELIABLE)
+    {
+        logInfo(RTPS_MSG_IN, IDSTRING"Acknack msg to NOT stateful writer ");
+        return false;
+    }
 
-                    if ((*rit)->m_att.guid == readerGUID)
-                    {
-                        if ((*rit)->getLastNackfragCount() < Ackcount)
-                        {
-                            (*rit)->setLastNackfragCount(Ackcount);
-                            // TODO Not doing Acknowledged.
-                            if((*rit)->requested_fragment_set(writerSN, fnState))
-                            {
-                                (*rit)->mp_nackResponse->restart_timer();
-                            }
-                        }
-                        break;
-                    }
-                }
-                return true;
-            }
-            else
+    StatefulWriter* SF = (StatefulWriter*)writer;
+    std::lock_guard<std::recursive_mutex> guardW(*SF->getMutex());
+
+    //Look for the readerProxy the acknack is from
+    ReaderProxy* rp = nullptr;
+    if (SF->matched_reader_lookup(readerGUID, &rp))
+    {
+        std::lock_guard<std::recursive_mutex> guardReaderProxy(*rp->mp_mutex);
+
+        if (rp->getLastNackfragCount() < Ackcount)
+        {
+            rp->setLastNackfragCount(Ackcount);
+            // TODO Not doing Acknowledged.
+            if(rp->requested_fragment_set(writerSN, fnState))
             {
-                logInfo(RTPS_MSG_IN, IDSTRING"Acknack msg to NOT stateful writer ");
-                return false;
+                rp->mp_nackResponse->restart_timer();
             }
         }
     }
-    logInfo(RTPS_MSG_IN, IDSTRING"Acknack msg to UNKNOWN writer (I looked through "
-            << AssociatedWriters.size() << " writers in this ListenResource)");
-    return false;
+
+    return true;
 }
 
 bool MessageReceiver::proc_Submsg_HeartbeatFrag(CDRMessage_t*msg, SubmessageHeader_t* smh, bool*last) {
@@ -1159,18 +1194,16 @@ bool MessageReceiver::proc_Submsg_HeartbeatFrag(CDRMessage_t*msg, SubmessageHead
 
     // XXX TODO VALIDATE DATA?
 
+    /* XXX TODO PROCESS
     std::lock_guard<std::mutex> guard(mtx);
     //Look for the correct reader and writers:
-    for (std::vector<RTPSReader*>::iterator it = AssociatedReaders.begin();
-            it != AssociatedReaders.end(); ++it)
+    const std::vector<RTPSReader*>& readers = find_readers(readerGUID.entityId, writerGUID);
+    for (std::vector<RTPSReader*>::const_iterator it = readers.begin();
+            it != readers.end(); ++it)
     {
-        /* XXX TODO PROCESS
-           if ((*it)->acceptMsgDirectedTo(readerGUID.entityId))
-           {
-           (*it)->processHeartbeatMsg(writerGUID, HBCount, firstSN, lastSN, finalFlag, livelinessFlag);
-           }
-           */
+        (*it)->processHeartbeatMsg(writerGUID, HBCount, firstSN, lastSN, finalFlag, livelinessFlag);
     }
+    */
 
     //Is the final message?
     if (smh->submessageLength == 0)
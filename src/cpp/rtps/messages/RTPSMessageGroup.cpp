@@ -31,6 +31,9 @@ namespace eprosima {
 namespace fastrtps {
 namespace rtps {
 
+// Payloads smaller than this are copied into the message, as gathering them costs more than the copy.
+const uint32_t min_referenced_payload_length = 1024;
+
 bool sort_changes_group (CacheChange_t* c1,CacheChange_t* c2)
 {
     return(c1->sequenceNumber < c2->sequenceNumber);
@@ -47,9 +50,10 @@ void prepare_SequenceNumberSet(std::vector<SequenceNumber_t>& changesSeqNum,
         std::vector<pair_T>& sequences)
 {
     //First compute the number of GAP messages we need:
-    std::sort(changesSeqNum.begin(), changesSeqNum.end(), sort_SeqNum);
+    // Writers usually give them already in order.
+    if(!std::is_sorted(changesSeqNum.begin(), changesSeqNum.end(), sort_SeqNum))
+        std::sort(changesSeqNum.begin(), changesSeqNum.end(), sort_SeqNum);
     bool new_pair = true;
-    bool seqnumset_init = false;
     uint32_t count = 0;
     for(auto it = changesSeqNum.begin();
             it!=changesSeqNum.end();++it)
@@ -61,7 +65,6 @@ void prepare_SequenceNumberSet(std::vector<SequenceNumber_t>& changesSeqNum,
             pair_T pair(*it,seqset);
             sequences.push_back(pair);
             new_pair = false;
-            seqnumset_init = true;
             count = 1;
             continue;
         }
@@ -73,12 +76,8 @@ void prepare_SequenceNumberSet(std::vector<SequenceNumber_t>& changesSeqNum,
         }
         else
         {
-            if(seqnumset_init) //FIRST TIME SINCE it was continuous
-            {
-                sequences.back().second.base = *(it-1);
-                seqnumset_init = false;
-            }
-            // Try to add, If it fails the diference between *it and base is greater than 255.
+            // The base stays next to the last continuous number, so that the range [first, base) covers them all.
+            // Try to add, If it fails the diference between *it and base is greater than the maximum offset of the set.
             if(sequences.back().second.add((*it)))
                 continue;
             else
@@ -143,6 +142,7 @@ RTPSMessageGroup::RTPSMessageGroup(RTPSParticipantImpl* participant, Endpoint* e
 #if HAVE_SECURITY
     , type_(type), encrypt_msg_(&msg_group.rtpsmsg_encrypt_)
 #endif
+    , referenced_length_(0)
 {
     assert(participant);
     assert(endpoint);
@@ -168,6 +168,8 @@ void RTPSMessageGroup::reset_to_header()
     CDRMessage::initCDRMsg(full_msg_);
     full_msg_->pos = RTPSMESSAGE_HEADER_SIZE;
     full_msg_->length = RTPSMESSAGE_HEADER_SIZE;
+    payload_references_.clear();
+    referenced_length_ = 0;
 }
 
 bool RTPSMessageGroup::check_preconditions(const LocatorList_t& locator_list,
@@ -202,8 +204,28 @@ void RTPSMessageGroup::send()
         }
 #endif
 
-        for(const auto& lit : current_locators_)
-            participant_->sendSync(full_msg_, endpoint_, lit);
+        if(payload_references_.empty())
+        {
+            for(const auto& lit : current_locators_)
+                participant_->sendSync(full_msg_, endpoint_, lit);
+        }
+        else
+        {
+            // Interleave the chunks of full_msg_ with the referenced payloads.
+            std::vector<SendBufferSlice> slices;
+            slices.reserve(payload_references_.size() * 2 + 1);
+            uint32_t position = 0;
+            for(const auto& reference : payload_references_)
+            {
+                slices.emplace_back(full_msg_->buffer + position, reference.position - position);
+                slices.emplace_back(reference.data, reference.length);
+                position = reference.position;
+            }
+            slices.emplace_back(full_msg_->buffer + position, full_msg_->length - position);
+
+            for(const auto& lit : current_locators_)
+                participant_->sendSync(slices.data(), static_cast<uint32_t>(slices.size()), endpoint_, lit);
+        }
     }
 }
 
@@ -234,7 +256,13 @@ void RTPSMessageGroup::check_and_maybe_flush(const LocatorList_t& locator_list,
 
 bool RTPSMessageGroup::insert_submessage(const std::vector<GUID_t>& remote_endpoints)
 {
-    if(!CDRMessage::appendMsg(full_msg_, submessage_msg_))
+    return insert_submessage(remote_endpoints, nullptr);
+}
+
+bool RTPSMessageGroup::insert_submessage(const std::vector<GUID_t>& remote_endpoints,
+        const SerializedPayload_t* payload)
+{
+    if(!append_submessage(payload))
     {
         // Retry
         flush();
@@ -247,7 +275,7 @@ bool RTPSMessageGroup::insert_submessage(const std::vector<GUID_t>& remote_endpo
             return false;
         }
 
-        if(!CDRMessage::appendMsg(full_msg_, submessage_msg_))
+        if(!append_submessage(payload))
         {
             logError(RTPS_WRITER,"Cannot add RTPS submesage to the CDRMessage. Buffer too small");
             return false;
@@ -257,6 +285,46 @@ bool RTPSMessageGroup::insert_submessage(const std::vector<GUID_t>& remote_endpo
     return true;
 }
 
+bool RTPSMessageGroup::append_submessage(const SerializedPayload_t* payload)
+{
+    if(payload == nullptr)
+    {
+        return full_msg_->length + submessage_msg_->length + referenced_length_ <= full_msg_->max_size &&
+            CDRMessage::appendMsg(full_msg_, submessage_msg_);
+    }
+
+    // The payload is not in submessage_msg_. It is sent from the change, followed by its alignment padding.
+    uint32_t align = (4 - payload->length % 4) & 3;
+    if(full_msg_->length + submessage_msg_->length + align + referenced_length_ + payload->length >
+            full_msg_->max_size || !CDRMessage::appendMsg(full_msg_, submessage_msg_))
+        return false;
+
+    PayloadReference reference;
+    reference.position = full_msg_->length;
+    reference.data = payload->data;
+    reference.length = payload->length;
+    payload_references_.push_back(reference);
+    referenced_length_ += payload->length;
+
+    for(uint32_t count = 0; count < align; ++count)
+        CDRMessage::addOctet(full_msg_, 0);
+
+    return true;
+}
+
+bool RTPSMessageGroup::can_reference_payload(const CacheChange_t& change, uint32_t length) const
+{
+#if HAVE_SECURITY
+    // Protected messages are encoded in place, so they need the whole message in full_msg_.
+    if(endpoint_->is_payload_protected() || endpoint_->is_submessage_protected() ||
+            (participant_->is_rtps_protected() && endpoint_->supports_rtps_protection()))
+        return false;
+#endif
+
+    return change.kind == ALIVE && change.serializedPayload.data != nullptr &&
+        length >= min_referenced_payload_length;
+}
+
 bool RTPSMessageGroup::add_info_dst_in_buffer(CDRMessage_t* buffer, const std::vector<GUID_t>& remote_endpoints)
 {
     (void)remote_endpoints;
@@ -390,14 +458,15 @@ bool RTPSMessageGroup::add_data(const CacheChange_t& change, const std::vector<G
     }
 #endif
 
+    bool reference_payload = can_reference_payload(change, change_to_add.serializedPayload.length);
+
     if(!RTPSMessageCreator::addSubmessageData(submessage_msg_, &change_to_add, endpoint_->getAttributes()->topicKind,
-                readerId, expectsInlineQos, inlineQos))
+                readerId, expectsInlineQos, inlineQos, !reference_payload))
     {
         logError(RTPS_WRITER, "Cannot add DATA submsg to the CDRMessage. Buffer too small");
         change_to_add.serializedPayload.data = NULL;
         return false;
     }
-    change_to_add.serializedPayload.data = NULL;
 
 #if HAVE_SECURITY
     if(endpoint_->is_submessage_protected())
@@ -407,12 +476,15 @@ bool RTPSMessageGroup::add_data(const CacheChange_t& change, const std::vector<G
                     remote_readers))
         {
             logError(RTPS_WRITER, "Cannot encrypt DATA submessage for writer " << endpoint_->getGuid());
+            change_to_add.serializedPayload.data = NULL;
             return false;
         }
     }
 #endif
 
-    return insert_submessage(remote_readers);
+    bool inserted = insert_submessage(remote_readers, reference_payload ? &change_to_add.serializedPayload : nullptr);
+    change_to_add.serializedPayload.data = NULL;
+    return inserted;
 }
 
 bool RTPSMessageGroup::add_data_frag(const CacheChange_t& change, const uint32_t fragment_number,
@@ -468,15 +540,16 @@ bool RTPSMessageGroup::add_data_frag(const CacheChange_t& change, const uint32_t
     }
 #endif
 
+    bool reference_payload = can_reference_payload(change, fragment_size);
+
     if(!RTPSMessageCreator::addSubmessageDataFrag(submessage_msg_, &change_to_add, fragment_number,
                 change.serializedPayload.length, endpoint_->getAttributes()->topicKind, readerId,
-                expectsInlineQos, inlineQos))
+                expectsInlineQos, inlineQos, !reference_payload))
     {
         logError(RTPS_WRITER, "Cannot add DATA_FRAG submsg to the CDRMessage. Buffer too small");
         change_to_add.serializedPayload.data = NULL;
         return false;
     }
-    change_to_add.serializedPayload.data = NULL;
 
 #if HAVE_SECURITY
     if(endpoint_->is_submessage_protected())
@@ -486,12 +559,15 @@ bool RTPSMessageGroup::add_data_frag(const CacheChange_t& change, const uint32_t
                     remote_readers))
         {
             logError(RTPS_WRITER, "Cannot encrypt DATA submessage for writer " << endpoint_->getGuid());
+            change_to_add.serializedPayload.data = NULL;
             return false;
         }
     }
 #endif
 
-    return insert_submessage(remote_readers);
+    bool inserted = insert_submessage(remote_readers, reference_payload ? &change_to_add.serializedPayload : nullptr);
+    change_to_add.serializedPayload.data = NULL;
+    return inserted;
 }
 
 bool RTPSMessageGroup::add_heartbeat(const std::vector<GUID_t>& remote_readers, const SequenceNumber_t& firstSN,
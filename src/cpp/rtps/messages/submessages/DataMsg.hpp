@@ -48,7 +48,8 @@ bool RTPSMessageCreator::addMessageData(CDRMessage_t* msg,
 
 
 bool RTPSMessageCreator::addSubmessageData(CDRMessage_t* msg, const CacheChange_t* change,
-        TopicKind_t topicKind, const EntityId_t& readerId, bool expectsInlineQos, ParameterList_t* inlineQos) {
+        TopicKind_t topicKind, const EntityId_t& readerId, bool expectsInlineQos, ParameterList_t* inlineQos,
+        bool copyPayload) {
     CDRMessage_t& submsgElem = g_pool_submsg.reserve_CDRMsg((uint16_t)change->serializedPayload.length);
     CDRMessage::initCDRMsg(&submsgElem);
     //Create the two CDR msgs
@@ -159,8 +160,14 @@ bool RTPSMessageCreator::addSubmessageData(CDRMessage_t* msg, const CacheChange_
                 CDRMessage::addParameterSentinel(&submsgElem);
         }
         //Add Serialized Payload
+        uint32_t referencedLength = 0;
         if(dataFlag)
-            added_no_error &= CDRMessage::addData(&submsgElem, change->serializedPayload.data, change->serializedPayload.length);
+        {
+            if(copyPayload)
+                added_no_error &= CDRMessage::addData(&submsgElem, change->serializedPayload.data, change->serializedPayload.length);
+            else
+                referencedLength = change->serializedPayload.length;
+        }
 
         if(keyFlag)
         {
@@ -177,9 +184,14 @@ bool RTPSMessageCreator::addSubmessageData(CDRMessage_t* msg, const CacheChange_
         }
 
         // Align submessage to rtps alignment (4).
-        uint32_t align = (4 - submsgElem.pos % 4) & 3;
-        for(uint32_t count = 0; count < align; ++count)
-            added_no_error &= CDRMessage::addOctet(&submsgElem, 0);
+        uint32_t align = (4 - (submsgElem.pos + referencedLength) % 4) & 3;
+        if(referencedLength == 0)
+        {
+            for(uint32_t count = 0; count < align; ++count)
+                added_no_error &= CDRMessage::addOctet(&submsgElem, 0);
+        }
+        else
+            referencedLength += align;
 
         //if(align > 0)
         {
@@ -188,7 +200,8 @@ bool RTPSMessageCreator::addSubmessageData(CDRMessage_t* msg, const CacheChange_
         }
 
         //Once the submessage elements are added, the submessage header is created, assigning the correct size.
-        added_no_error &= RTPSMessageCreator::addSubmessageHeader(msg, DATA,flags, (uint16_t)submsgElem.length);
+        added_no_error &= RTPSMessageCreator::addSubmessageHeader(msg, DATA,flags,
+                (uint16_t)(submsgElem.length + referencedLength));
         //Append Submessage elements to msg
 
         added_no_error &= CDRMessage::appendMsg(msg, &submsgElem);
@@ -245,7 +258,7 @@ bool RTPSMessageCreator::addMessageDataFrag(CDRMessage_t* msg, GuidPrefix_t& gui
 
 bool RTPSMessageCreator::addSubmessageDataFrag(CDRMessage_t* msg, const CacheChange_t* change, uint32_t fragment_number,
         uint32_t sample_size, TopicKind_t topicKind, const EntityId_t& readerId, bool expectsInlineQos,
-        ParameterList_t* inlineQos)
+        ParameterList_t* inlineQos, bool copyPayload)
 {
     CDRMessage_t& submsgElem = g_pool_submsg.reserve_CDRMsg((uint16_t)change->serializedPayload.length);
     CDRMessage::initCDRMsg(&submsgElem);
@@ -362,10 +375,14 @@ bool RTPSMessageCreator::addSubmessageDataFrag(CDRMessage_t* msg, const CacheCha
         }
 
         //Add Serialized Payload XXX TODO
+        uint32_t referencedLength = 0;
         if (!keyFlag) // keyflag = 0 means that the serializedPayload SubmessageElement contains the serialized Data 
         {
-            added_no_error &= CDRMessage::addData(&submsgElem, change->serializedPayload.data,
-                    change->serializedPayload.length);
+            if (copyPayload)
+                added_no_error &= CDRMessage::addData(&submsgElem, change->serializedPayload.data,
+                        change->serializedPayload.length);
+            else
+                referencedLength = change->serializedPayload.length;
         }
         else
         {   // keyflag = 1 means that the serializedPayload SubmessageElement contains the serialized Key 
@@ -386,12 +403,18 @@ bool RTPSMessageCreator::addSubmessageDataFrag(CDRMessage_t* msg, const CacheCha
 
         // TODO(Ricardo) This should be on cachechange.
         // Align submessage to rtps alignment (4).
-        uint32_t align = (4 - submsgElem.pos % 4) & 3;
-        for (uint32_t count = 0; count < align; ++count)
-            added_no_error &= CDRMessage::addOctet(&submsgElem, 0);
+        uint32_t align = (4 - (submsgElem.pos + referencedLength) % 4) & 3;
+        if (referencedLength == 0)
+        {
+            for (uint32_t count = 0; count < align; ++count)
+                added_no_error &= CDRMessage::addOctet(&submsgElem, 0);
+        }
+        else
+            referencedLength += align;
 
         //Once the submessage elements are added, the submessage header is created, assigning the correct size.
-        added_no_error &= RTPSMessageCreator::addSubmessageHeader(msg, DATA_FRAG, flags, (uint16_t)submsgElem.length);
+        added_no_error &= RTPSMessageCreator::addSubmessageHeader(msg, DATA_FRAG, flags,
+                (uint16_t)(submsgElem.length + referencedLength));
 
         //Append Submessage elements to msg
         added_no_error &= CDRMessage::appendMsg(msg, &submsgElem);
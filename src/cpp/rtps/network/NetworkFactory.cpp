@@ -16,6 +16,7 @@
 #include <fastrtps/transport/UDPv4Transport.h>
 #include <fastrtps/transport/UDPv6Transport.h>
 #include <fastrtps/transport/test_UDPv4Transport.h>
+#include <fastrtps/transport/SharedMemTransport.h>
 #include <utility>
 using namespace std;
 
@@ -74,6 +75,11 @@ bool NetworkFactory::BuildReceiverResources (const Locator_t& local, std::vector
                 {
                     returned_resources_list.push_back(std::move(newReceiverResource));
                     returnedValue = true;
+
+                    // Each additional shard of the channel is read by its own resource.
+                    uint32_t shards = transport->InputChannelShards(local);
+                    for(uint32_t shard = 1; shard < shards; ++shard)
+                        returned_resources_list.push_back(ReceiverResource(*transport, local, shard));
                 }
             }
             else
@@ -104,6 +110,12 @@ void NetworkFactory::RegisterTransport(const TransportDescriptorInterface* descr
         if(transport->init())
             mRegisteredTransports.emplace_back(std::move(transport));
     }
+    if (auto concrete = dynamic_cast<const SharedMemTransportDescriptor*> (descriptor))
+    {
+        std::unique_ptr<SharedMemTransport> transport(new SharedMemTransport(*concrete));
+        if(transport->init())
+            mRegisteredTransports.emplace_back(std::move(transport));
+    }
 }
 
 void NetworkFactory::NormalizeLocators(LocatorList_t& locators)
@@ -20,7 +20,7 @@ namespace eprosima{
 namespace fastrtps{
 namespace rtps{
 
-ReceiverResource::ReceiverResource(TransportInterface& transport, const Locator_t& locator)
+ReceiverResource::ReceiverResource(TransportInterface& transport, const Locator_t& locator) : mMaxBatchSize(1)
 {
    // Internal channel is opened and assigned to this resource.
    mValid = transport.OpenInputChannel(locator);
@@ -31,6 +31,32 @@ ReceiverResource::ReceiverResource(TransportInterface& transport, const Locator_
    Cleanup = [&transport,locator](){ transport.CloseInputChannel(locator); };
    ReceiveFromAssociatedChannel = [&transport, locator](octet* receiveBuffer, uint32_t receiveBufferCapacity, uint32_t& receiveBufferSize, Locator_t& origin)-> bool
                                   { return transport.Receive(receiveBuffer, receiveBufferCapacity, receiveBufferSize, locator, origin); };
+   ReceiveBatchFromAssociatedChannel = [&transport, locator](ReceiveBufferSlot* slots, uint32_t slotCount) -> uint32_t
+                                       { return transport.ReceiveBatch(slots, slotCount, locator); };
+   mMaxBatchSize = transport.MaxReceiveBatchSize();
+   LocatorMapsToManagedChannel = [&transport, locator](const Locator_t& locatorToCheck) -> bool
+                                 { return transport.DoLocatorsMatch(locator, locatorToCheck); };
+}
+
+ReceiverResource::ReceiverResource(TransportInterface& transport, const Locator_t& locator, uint32_t shard) : mMaxBatchSize(1)
+{
+   // The channel was opened by the resource of shard 0. Closing it again is harmless, and wakes up this shard too.
+   mValid = true;
+   Cleanup = [&transport,locator](){ transport.CloseInputChannel(locator); };
+   ReceiveFromAssociatedChannel = [&transport, locator, shard](octet* receiveBuffer, uint32_t receiveBufferCapacity, uint32_t& receiveBufferSize, Locator_t& origin)-> bool
+                                  {
+                                     ReceiveBufferSlot slot;
+                                     slot.buffer = receiveBuffer;
+                                     slot.capacity = receiveBufferCapacity;
+                                     if (transport.ReceiveBatchFromShard(&slot, 1, locator, shard) == 0)
+                                        return false;
+                                     receiveBufferSize = slot.size;
+                                     origin = slot.remoteLocator;
+                                     return true;
+                                  };
+   ReceiveBatchFromAssociatedChannel = [&transport, locator, shard](ReceiveBufferSlot* slots, uint32_t slotCount) -> uint32_t
+                                       { return transport.ReceiveBatchFromShard(slots, slotCount, locator, shard); };
+   mMaxBatchSize = transport.MaxReceiveBatchSize();
    LocatorMapsToManagedChannel = [&transport, locator](const Locator_t& locatorToCheck) -> bool
                                  { return transport.DoLocatorsMatch(locator, locatorToCheck); };
 }
@@ -43,10 +69,18 @@ bool ReceiverResource::Receive(octet* receiveBuffer, uint32_t receiveBufferCapac
    return false;
 }
 
-ReceiverResource::ReceiverResource(ReceiverResource&& rValueResource)
+uint32_t ReceiverResource::ReceiveBatch(ReceiveBufferSlot* slots, uint32_t slotCount)
+{
+   if (ReceiveBatchFromAssociatedChannel)
+      return ReceiveBatchFromAssociatedChannel(slots, slotCount);
+   return 0;
+}
+
+ReceiverResource::ReceiverResource(ReceiverResource&& rValueResource) : mMaxBatchSize(rValueResource.mMaxBatchSize)
 {
    Cleanup.swap(rValueResource.Cleanup); 
    ReceiveFromAssociatedChannel.swap(rValueResource.ReceiveFromAssociatedChannel);
+   ReceiveBatchFromAssociatedChannel.swap(rValueResource.ReceiveBatchFromAssociatedChannel);
    LocatorMapsToManagedChannel.swap(rValueResource.LocatorMapsToManagedChannel);
 }
 
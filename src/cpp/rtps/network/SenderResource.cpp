@@ -30,6 +30,9 @@ SenderResource::SenderResource(TransportInterface& transport, Locator_t& locator
    Cleanup = [&transport,locator](){ transport.CloseOutputChannel(locator); };
    SendThroughAssociatedChannel = [&transport, locator](const octet* data, uint32_t dataSize, const Locator_t& destination)-> bool
                                   { return transport.Send(data,dataSize, locator, destination); };
+   SendGatherThroughAssociatedChannel = [&transport, locator](const SendBufferSlice* slices, uint32_t sliceCount,
+                                        const Locator_t& destination)-> bool
+                                        { return transport.SendGather(slices, sliceCount, locator, destination); };
    LocatorMapsToManagedChannel = [&transport, locator](const Locator_t& locatorToCheck) -> bool
                                  { return transport.DoLocatorsMatch(locator, locatorToCheck); };
    ManagedChannelMapsToRemote = [&transport, locator](const Locator_t& locatorToCheck) -> bool
@@ -43,11 +46,19 @@ bool SenderResource::Send(const octet* data, uint32_t dataLength, const Locator_
    return false;
 }
 
+bool SenderResource::SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& destinationLocator)
+{
+   if (SendGatherThroughAssociatedChannel)
+      return SendGatherThroughAssociatedChannel(slices, sliceCount, destinationLocator);
+   return false;
+}
+
 SenderResource::SenderResource(SenderResource&& rValueResource)
 {
     mValid = rValueResource.mValid;
     Cleanup.swap(rValueResource.Cleanup); 
     SendThroughAssociatedChannel.swap(rValueResource.SendThroughAssociatedChannel);
+    SendGatherThroughAssociatedChannel.swap(rValueResource.SendGatherThroughAssociatedChannel);
     LocatorMapsToManagedChannel.swap(rValueResource.LocatorMapsToManagedChannel);
     ManagedChannelMapsToRemote.swap(rValueResource.ManagedChannelMapsToRemote);
 }
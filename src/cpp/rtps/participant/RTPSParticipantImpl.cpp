@@ -20,6 +20,8 @@
 #include "RTPSParticipantImpl.h"
 
 #include "../flowcontrol/ThroughputController.h"
+#include "../reader/LocalReaderRegistry.h"
+#include "../persistence/MappedChangeLog.h"
 
 #include <fastrtps/rtps/resources/ResourceEvent.h>
 #include <fastrtps/rtps/resources/AsyncWriterThread.h>
@@ -28,6 +30,7 @@
 
 #include <fastrtps/rtps/writer/StatelessWriter.h>
 #include <fastrtps/rtps/writer/StatefulWriter.h>
+#include <fastrtps/rtps/history/WriterHistory.h>
 
 #include <fastrtps/rtps/reader/StatelessReader.h>
 #include <fastrtps/rtps/reader/StatefulReader.h>
@@ -81,6 +84,9 @@ Locator_t RTPSParticipantImpl::applyLocatorAdaptRule(Locator_t loc)
             //TODO - Define the rest of rules
             loc.port += m_att.port.participantIDGain;
             break;
+        case LOCATOR_KIND_SHM:
+            loc.port += m_att.port.participantIDGain;
+            break;
     }
     return loc;
 }
@@ -96,6 +102,8 @@ RTPSParticipantImpl::RTPSParticipantImpl(const RTPSParticipantAttributes& PParam
 #if HAVE_SECURITY
     m_security_manager(this),
 #endif
+    m_send_resources_generation(1),
+    m_matched_writers_generation(1),
     mp_participantListener(plisten),
     mp_userParticipant(par),
     mp_mutex(new std::recursive_mutex())
@@ -316,6 +324,7 @@ RTPSParticipantImpl::RTPSParticipantImpl(const RTPSParticipantAttributes& PParam
     for(auto mit=newSenders.begin(); mit!=newSenders.end();++mit){
         m_senderResource.push_back(std::move(*mit));
     }
+    ++m_send_resources_generation;
     m_send_resources_mutex.unlock();
     m_att.defaultOutLocatorList = defcopy;
 
@@ -351,11 +360,16 @@ const std::vector<RTPSReader*>& RTPSParticipantImpl::getAllReaders() const
 
 RTPSParticipantImpl::~RTPSParticipantImpl()
 {
-    // Safely abort threads.
+    // Safely abort threads. All the resources are aborted first, because closing a sharded channel
+    // wakes up the threads of all its shards.
     for (auto& block : m_receiverResourcelist)
     {
         block.resourceAlive = false;
         block.Receiver.Abort();
+    }
+
+    for (auto& block : m_receiverResourcelist)
+    {
         block.m_thread->join();
         delete block.m_thread;
     }
@@ -478,6 +492,18 @@ bool RTPSParticipantImpl::createWriter(RTPSWriter** WriterOut,
     if(SWriter==nullptr)
         return false;
 
+    // The history kept by a previous writer is restored before any reader is matched.
+    if(param.endpoint.durabilityKind >= TRANSIENT)
+    {
+        MappedChangeLog* log = MappedChangeLog::create(param.endpoint.properties);
+        if(log == nullptr || !hist->restore_persistent_changes(log))
+        {
+            logError(RTPS_PARTICIPANT,"Persistence log of the Writer could not be opened");
+            delete(SWriter);
+            return false;
+        }
+    }
+
 #if HAVE_SECURITY
     if(submessage_protection || payload_protection)
     {
@@ -643,7 +669,17 @@ bool RTPSParticipantImpl::createReader(RTPSReader** ReaderOut,
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
     m_allReaderList.push_back(SReader);
     if(!isBuiltin)
+    {
         m_userReaderList.push_back(SReader);
+
+        // Protected readers have to decode what they receive, so they always go through the network.
+#if HAVE_SECURITY
+        if(m_att.useIntraprocessDelivery && !is_rtps_protected() && !submessage_protection && !payload_protection)
+#else
+        if(m_att.useIntraprocessDelivery)
+#endif
+            LocalReaderRegistry::add(SReader);
+    }
     *ReaderOut = SReader;
     return true;
 }
@@ -760,16 +796,26 @@ bool RTPSParticipantImpl::createAndAssociateReceiverswithEndpoint(Endpoint * pen
 
 void RTPSParticipantImpl::performListenOperation(ReceiverControlBlock *receiver, Locator_t input_locator)
 {
+    for(auto& slot : receiver->batchSlots)
+        slot.remoteLocator = input_locator;
+
     while(receiver->resourceAlive)
     {
-        // Blocking receive.
-        auto& msg = receiver->mp_receiver->m_rec_msg;
-        CDRMessage::initCDRMsg(&msg);
-        if(!receiver->Receiver.Receive(msg.buffer, msg.max_size, msg.length, input_locator))
-            continue;
-
-        // Processes the data through the CDR Message interface.
-        receiver->mp_receiver->processCDRMsg(getGuid().guidPrefix, &input_locator, &receiver->mp_receiver->m_rec_msg);
+        // Blocking receive of all queued messages, up to the batch size.
+        uint32_t received = receiver->Receiver.ReceiveBatch(receiver->batchSlots.data(),
+                static_cast<uint32_t>(receiver->batchSlots.size()));
+
+        for(uint32_t i = 0; i < received; ++i)
+        {
+            auto& msg = receiver->batchMessages[i];
+            msg.pos = 0;
+            msg.length = receiver->batchSlots[i].size;
+            receiver->mp_receiver->processCDRMsg(getGuid().guidPrefix, &receiver->batchSlots[i].remoteLocator, &msg,
+                    receiver->referenceableBatchBuffer(i));
+
+            // The buffer can't be reused while the readers keep payloads that reference it.
+            receiver->renewBatchBuffer(i);
+        }
     }
 }
 
@@ -827,6 +873,7 @@ bool RTPSParticipantImpl::createSendResources(Endpoint *pend){
     for(auto mit = newSenders.begin();mit!=newSenders.end();++mit){
         m_senderResource.push_back(std::move(*mit));
     }
+    ++m_send_resources_generation;
 
     return true;
 }
@@ -858,6 +905,11 @@ void RTPSParticipantImpl::createReceiverResources(LocatorList_t& Locator_list, b
             m_receiverResourcelist.back().mp_receiver = new MessageReceiver(this, m_att.listenSocketBufferSize);
             m_receiverResourcelist.back().mp_receiver->init(m_att.listenSocketBufferSize);
 
+            //Preallocate the receive buffers, one for each message of a batch
+            uint32_t batch_size = m_receiverResourcelist.back().Receiver.MaxBatchSize();
+            m_receiverResourcelist.back().initBatchBuffers(batch_size > 0 ? batch_size : 1, m_att.listenSocketBufferSize,
+                    m_att.listenBufferPoolSize);
+
             //Init the thread
             m_receiverResourcelist.back().m_thread = new std::thread(&RTPSParticipantImpl::performListenOperation,this, &(m_receiverResourcelist.back()),(*it_loc));
         }
@@ -869,6 +921,10 @@ void RTPSParticipantImpl::createReceiverResources(LocatorList_t& Locator_list, b
 
 bool RTPSParticipantImpl::deleteUserEndpoint(Endpoint* p_endpoint)
 {
+    // Wait for the writers delivering to this reader from this process.
+    if(p_endpoint->getAttributes()->endpointKind == READER)
+        LocalReaderRegistry::remove((RTPSReader*)p_endpoint);
+
     for(auto it=m_receiverResourcelist.begin();it!=m_receiverResourcelist.end();++it){
         (*it).mp_receiver->removeEndpoint(p_endpoint);
     }
@@ -970,24 +1026,45 @@ std::vector<std::string> RTPSParticipantImpl::getParticipantNames(){
     return participant_names;
 }
 
-void RTPSParticipantImpl::sendSync(CDRMessage_t* msg, Endpoint *pend, const Locator_t& destination_loc)
+void RTPSParticipantImpl::update_send_route(Endpoint* pend)
 {
+    if(pend->send_route_generation_ == m_send_resources_generation.load())
+        return;
+
     std::lock_guard<std::mutex> guard(m_send_resources_mutex);
+    pend->send_route_.clear();
     for (auto it = m_senderResource.begin(); it != m_senderResource.end(); ++it)
     {
-        bool sendThroughResource = false;
         for (auto sit = pend->m_att.outLocatorList.begin(); sit != pend->m_att.outLocatorList.end(); ++sit)
         {
             if ((*it).SupportsLocator((*sit)))
             {
-                sendThroughResource = true;
+                pend->send_route_.push_back(&(*it));
                 break;
             }
         }
-
-        if (sendThroughResource)
-            (*it).Send(msg->buffer, msg->length, destination_loc);
     }
+    pend->send_route_generation_ = m_send_resources_generation.load();
+}
+
+void RTPSParticipantImpl::sendSync(CDRMessage_t* msg, Endpoint *pend, const Locator_t& destination_loc)
+{
+    // Only this endpoint's route is locked, so endpoints send in parallel.
+    std::lock_guard<std::mutex> guard(pend->send_route_mutex_);
+    update_send_route(pend);
+
+    for (auto* resource : pend->send_route_)
+        resource->Send(msg->buffer, msg->length, destination_loc);
+}
+
+void RTPSParticipantImpl::sendSync(const SendBufferSlice* slices, uint32_t sliceCount, Endpoint *pend,
+        const Locator_t& destination_loc)
+{
+    std::lock_guard<std::mutex> guard(pend->send_route_mutex_);
+    update_send_route(pend);
+
+    for (auto* resource : pend->send_route_)
+        resource->SendGather(slices, sliceCount, destination_loc);
 }
 
 void RTPSParticipantImpl::announceRTPSParticipantState()
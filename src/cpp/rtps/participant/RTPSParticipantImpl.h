@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <list>
+#include <atomic>
 #include <sys/types.h>
 #include <mutex>
 #include <fastrtps/utils/Semaphore.h>
@@ -40,6 +41,7 @@
 #include <fastrtps/rtps/network/ReceiverResource.h>
 #include <fastrtps/rtps/network/SenderResource.h>
 #include <fastrtps/rtps/messages/MessageReceiver.h>
+#include <fastrtps/rtps/common/ReceiveBufferPool.h>
 
 #if HAVE_SECURITY
 #include "../security/SecurityManager.h"
@@ -79,7 +81,7 @@ class FlowController;
    It contains:
    -A ReceiverResource (as produced by the NetworkFactory Element)
    -A list of associated wirters and readers
-   -A buffer for message storage
+   -The buffers for message storage, taken from a pool so that the received payloads can go on referencing them
    -A mutex for the lists
    The idea is to create the thread that performs blocking calllto ReceiverResource.Receive and processes the message
    from the Receiver, so the Transport Layer does not need to be aware of the existence of what is using it.
@@ -91,13 +93,78 @@ typedef struct ReceiverControlBlock{
     std::mutex mtx; //Fix declaration
     std::thread* m_thread;
     bool resourceAlive;
-    ReceiverControlBlock(ReceiverResource&& rec):Receiver(std::move(rec)), mp_receiver(nullptr), m_thread(nullptr), resourceAlive(true)
+    std::vector<CDRMessage_t> batchMessages; //Messages wrapping the receive buffers of the batch
+    std::vector<ReceiveBufferSlot> batchSlots;
+    std::vector<ReceiveBuffer*> batchBuffers; //Receive buffers of the batch, referenced by the payloads they hold
+    ReceiveBuffer* spareBuffer; //Taken in advance to replace a batch buffer still referenced by the payloads
+    std::shared_ptr<ReceiveBufferPool> bufferPool;
+    ReceiverControlBlock(ReceiverResource&& rec):Receiver(std::move(rec)), mp_receiver(nullptr), m_thread(nullptr), resourceAlive(true),
+        spareBuffer(nullptr)
     {
     }
-    ReceiverControlBlock(ReceiverControlBlock&& origen):Receiver(std::move(origen.Receiver)), mp_receiver(origen.mp_receiver), m_thread(origen.m_thread), resourceAlive(true)
+    ReceiverControlBlock(ReceiverControlBlock&& origen):Receiver(std::move(origen.Receiver)), mp_receiver(origen.mp_receiver), m_thread(origen.m_thread), resourceAlive(true),
+        batchMessages(std::move(origen.batchMessages)), batchSlots(std::move(origen.batchSlots)),
+        batchBuffers(std::move(origen.batchBuffers)), spareBuffer(origen.spareBuffer), bufferPool(std::move(origen.bufferPool))
     {
         origen.m_thread = nullptr;
         origen.mp_receiver = nullptr;
+        origen.batchBuffers.clear();
+        origen.spareBuffer = nullptr;
+    }
+    ~ReceiverControlBlock()
+    {
+        for(ReceiveBuffer* buffer : batchBuffers)
+            buffer->remove_reference();
+        if(spareBuffer != nullptr)
+            spareBuffer->remove_reference();
+    }
+
+    //! Preallocates the batch buffers. The payloads can keep other buffers of up to pool_size bytes in total.
+    void initBatchBuffers(uint32_t batch_size, uint32_t buffer_size, uint32_t pool_size)
+    {
+        bufferPool = std::make_shared<ReceiveBufferPool>(buffer_size, batch_size,
+                static_cast<uint64_t>(batch_size) * buffer_size + pool_size);
+        batchMessages.reserve(batch_size);
+        batchSlots.resize(batch_size);
+        batchBuffers.resize(batch_size);
+        for(uint32_t i = 0; i < batch_size; ++i)
+        {
+            batchMessages.emplace_back(0);
+            batchMessages[i].wraps = true;
+            setBatchBuffer(i, bufferPool->take());
+        }
+    }
+
+    /**
+     * Returns the buffer of the slot when the payloads received in it can reference it, because there is a spare
+     * buffer to replace it. When the pool is exhausted it returns nullptr, and the payloads have to be copied.
+     */
+    ReceiveBuffer* referenceableBatchBuffer(uint32_t index)
+    {
+        if(spareBuffer == nullptr)
+            spareBuffer = bufferPool->take();
+        return spareBuffer != nullptr ? batchBuffers[index] : nullptr;
+    }
+
+    //! Replaces the buffer of the slot by the spare one when the payloads received in it still reference it.
+    void renewBatchBuffer(uint32_t index)
+    {
+        if(batchBuffers[index]->references() > 1)
+        {
+            batchBuffers[index]->remove_reference();
+            setBatchBuffer(index, spareBuffer);
+            spareBuffer = nullptr;
+        }
+    }
+
+    private:
+    void setBatchBuffer(uint32_t index, ReceiveBuffer* buffer)
+    {
+        batchBuffers[index] = buffer;
+        batchMessages[index].buffer = buffer->buffer();
+        batchMessages[index].max_size = buffer->capacity();
+        batchSlots[index].buffer = buffer->buffer();
+        batchSlots[index].capacity = buffer->capacity();
     }
 
     private:
@@ -169,6 +236,8 @@ class RTPSParticipantImpl
         ResourceEvent& getEventResource();
         //!Send Method - Deprecated - Stays here for reference purposes
         void sendSync(CDRMessage_t* msg, Endpoint *pend, const Locator_t& destination_loc);
+        //!Send a message made of several slices, without coalescing them first
+        void sendSync(const SendBufferSlice* slices, uint32_t sliceCount, Endpoint *pend, const Locator_t& destination_loc);
         //!Get the participant Mutex
         std::recursive_mutex* getParticipantMutex() const {return mp_mutex;};
         /**
@@ -217,6 +286,12 @@ class RTPSParticipantImpl
 
         PDPSimple* pdpsimple();
 
+        //!Called by the readers of this participant each time they match or unmatch a writer.
+        void matched_writers_changed() { ++m_matched_writers_generation; }
+
+        //!Increased each time a reader of this participant matches or unmatches a writer.
+        uint32_t matched_writers_generation() const { return m_matched_writers_generation.load(); }
+
     private:
         //!Attributes of the RTPSParticipant
         RTPSParticipantAttributes m_att;
@@ -252,9 +327,17 @@ class RTPSParticipantImpl
 
         //!ReceiverControlBlock list - encapsulates all associated resources on a Receiving element
         std::list<ReceiverControlBlock> m_receiverResourcelist;
-        //!SenderResource List
+        //!SenderResource List. Endpoints keep pointers to its elements, so they must not be moved.
         std::mutex m_send_resources_mutex;
-        std::vector<SenderResource> m_senderResource;
+        std::list<SenderResource> m_senderResource;
+        //!Increased each time m_senderResource changes, so endpoints resolve their send routes again.
+        std::atomic<uint32_t> m_send_resources_generation;
+
+        //!Resolves again the send route of the endpoint, if the sender resources changed. Called with its route locked.
+        void update_send_route(Endpoint* pend);
+
+        //!Lets the MessageReceivers know when the readers they cached for a remote writer may be outdated.
+        std::atomic<uint32_t> m_matched_writers_generation;
 
         //!Participant Listener
         RTPSParticipantListener* mp_participantListener;
@@ -0,0 +1,648 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file MappedChangeLog.cpp
+ */
+
+#include "MappedChangeLog.h"
+
+#include <fastrtps/log/Log.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace eprosima {
+namespace fastrtps {
+namespace rtps {
+
+namespace {
+
+const char c_SegmentMagic[4] = {'F', 'R', 'C', 'L'};
+const uint32_t c_SegmentVersion = 1;
+const uint32_t c_DefaultSegmentSize = 4 * 1024 * 1024;
+const uint32_t c_MinSegmentSize = 4096;
+
+struct SegmentHeader
+{
+    char magic[4];
+    uint32_t version;
+};
+
+enum RecordType : uint8_t
+{
+    RECORD_ADD = 1,
+    RECORD_REMOVE = 2
+};
+
+}
+
+//! Header of each record. The payload of added changes follows it, padded to 8 bytes.
+struct LogRecordHeader
+{
+    //! Size of the whole record. Zero marks the end of the log.
+    uint32_t size;
+    uint8_t type;
+    uint8_t kind;
+    uint16_t encapsulation;
+    int32_t sequence_high;
+    uint32_t sequence_low;
+    int32_t timestamp_seconds;
+    uint32_t timestamp_fraction;
+    octet instance[16];
+    uint32_t length;
+    uint32_t padding;
+};
+
+namespace {
+
+static_assert(sizeof(SegmentHeader) == 8, "Segment header must be packed");
+static_assert(sizeof(LogRecordHeader) == 48, "Record header must be packed");
+
+inline uint32_t record_size(uint32_t length)
+{
+    return (static_cast<uint32_t>(sizeof(LogRecordHeader)) + length + 7) & ~7u;
+}
+
+inline LogRecordHeader read_header(const octet* position)
+{
+    LogRecordHeader header;
+    memcpy(&header, position, sizeof(header));
+    return header;
+}
+
+}
+
+MappedChangeLog::MappedChangeLog(const std::string& path, uint32_t segment_size, SyncKind sync) :
+    path_(path), segment_size_(std::max(segment_size, c_MinSegmentSize)), sync_(sync), restoring_(false), lock_fd_(-1)
+{
+}
+
+MappedChangeLog::~MappedChangeLog()
+{
+    if(sync_ != SYNC_NONE)
+        sync();
+
+    for(Segment& segment : segments_)
+        unmap_segment(segment, false);
+
+#if !defined(_WIN32)
+    if(lock_fd_ >= 0)
+        ::close(lock_fd_);
+#endif
+}
+
+MappedChangeLog* MappedChangeLog::create(const PropertyPolicy& properties)
+{
+    const std::string* directory = PropertyPolicyHelper::find_property(properties, "dds.persistence.directory");
+    const std::string* name = PropertyPolicyHelper::find_property(properties, "dds.persistence.name");
+    if(directory == nullptr || name == nullptr || name->empty() || name->find('/') != std::string::npos)
+    {
+        logError(RTPS_PERSISTENCE, "Persistent durability needs the properties dds.persistence.directory "
+                "and dds.persistence.name, without directory separators");
+        return nullptr;
+    }
+
+    uint32_t segment_size = c_DefaultSegmentSize;
+    const std::string* value = PropertyPolicyHelper::find_property(properties, "dds.persistence.segment_size");
+    if(value != nullptr)
+    {
+        char* end = nullptr;
+        unsigned long size = strtoul(value->c_str(), &end, 10);
+        if(end == value->c_str() || *end != '\0' || size < c_MinSegmentSize || size > UINT32_MAX / 2)
+        {
+            logError(RTPS_PERSISTENCE, "Invalid dds.persistence.segment_size: " << *value);
+            return nullptr;
+        }
+        segment_size = static_cast<uint32_t>(size);
+    }
+
+    SyncKind sync = SYNC_SEGMENT;
+    value = PropertyPolicyHelper::find_property(properties, "dds.persistence.sync");
+    if(value != nullptr)
+    {
+        if(value->compare("NONE") == 0)
+            sync = SYNC_NONE;
+        else if(value->compare("CHANGE") == 0)
+            sync = SYNC_CHANGE;
+        else if(value->compare("SEGMENT") != 0)
+        {
+            logError(RTPS_PERSISTENCE, "Invalid dds.persistence.sync: " << *value);
+            return nullptr;
+        }
+    }
+
+    return new MappedChangeLog(*directory + "/" + *name, segment_size, sync);
+}
+
+std::string MappedChangeLog::segment_path(uint32_t index) const
+{
+    return path_ + "." + std::to_string(index) + ".log";
+}
+
+#if defined(_WIN32)
+
+bool MappedChangeLog::open(const std::function<void(const LoggedChange&)>&)
+{
+    logError(RTPS_PERSISTENCE, "Persistent durability is not supported on this platform");
+    return false;
+}
+
+bool MappedChangeLog::map_segment(uint32_t, uint32_t, bool, Segment&)
+{
+    return false;
+}
+
+void MappedChangeLog::unmap_segment(Segment&, bool)
+{
+}
+
+void MappedChangeLog::sync_range(Segment&, uint32_t, uint32_t)
+{
+}
+
+void MappedChangeLog::sync_directory()
+{
+}
+
+#else
+
+bool MappedChangeLog::open(const std::function<void(const LoggedChange&)>& restore)
+{
+    // Released by the system if the process dies.
+    std::string lock_path = path_ + ".lock";
+    lock_fd_ = ::open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(lock_fd_ < 0 || flock(lock_fd_, LOCK_EX | LOCK_NB) != 0)
+    {
+        if(lock_fd_ >= 0 && errno == EWOULDBLOCK)
+        {
+            logError(RTPS_PERSISTENCE, "Log " << path_ << " is already used by another writer");
+        }
+        else
+        {
+            logError(RTPS_PERSISTENCE, "Cannot lock " << lock_path << ": " << strerror(errno));
+        }
+        if(lock_fd_ >= 0)
+            ::close(lock_fd_);
+        lock_fd_ = -1;
+        return false;
+    }
+
+    std::string directory = ".";
+    std::string name = path_;
+    size_t separator = path_.rfind('/');
+    if(separator != std::string::npos)
+    {
+        directory = separator == 0 ? "/" : path_.substr(0, separator);
+        name = path_.substr(separator + 1);
+    }
+
+    DIR* dir = opendir(directory.c_str());
+    if(dir == nullptr)
+    {
+        logError(RTPS_PERSISTENCE, "Cannot open directory " << directory << ": " << strerror(errno));
+        return false;
+    }
+
+    std::vector<uint32_t> indexes;
+    std::string prefix = name + ".";
+    while(struct dirent* entry = readdir(dir))
+    {
+        std::string file(entry->d_name);
+        if(file.size() <= prefix.size() + 4 || file.compare(0, prefix.size(), prefix) != 0 ||
+                file.compare(file.size() - 4, 4, ".log") != 0)
+            continue;
+
+        std::string index = file.substr(prefix.size(), file.size() - prefix.size() - 4);
+        if(index.find_first_not_of("0123456789") == std::string::npos)
+            indexes.push_back(static_cast<uint32_t>(strtoul(index.c_str(), nullptr, 10)));
+    }
+    closedir(dir);
+    std::sort(indexes.begin(), indexes.end());
+
+    for(uint32_t index : indexes)
+    {
+        Segment segment;
+        if(!map_segment(index, 0, false, segment))
+            return false;
+        segments_.push_back(segment);
+        load_segment(segments_.back());
+    }
+
+    if(segments_.empty())
+    {
+        Segment segment;
+        if(!map_segment(0, segment_size_, true, segment))
+            return false;
+        segments_.push_back(segment);
+    }
+
+    remove_dead_segments();
+    logInfo(RTPS_PERSISTENCE, "Log " << path_ << " opened with " << changes_.size() << " changes in "
+            << segments_.size() << " segments");
+
+    // The segments are not deleted while the changes are restored, so their payloads stay mapped.
+    std::vector<LoggedChange> logged;
+    logged.reserve(changes_.size());
+    for(auto& change : changes_)
+    {
+        const octet* position = find_segment(change.second.segment)->data + change.second.offset;
+        LogRecordHeader header = read_header(position);
+        LoggedChange logged_change;
+        logged_change.kind = static_cast<ChangeKind_t>(header.kind);
+        logged_change.sequenceNumber = change.first;
+        memcpy(logged_change.instanceHandle.value, header.instance, sizeof(header.instance));
+        logged_change.sourceTimestamp.seconds = header.timestamp_seconds;
+        logged_change.sourceTimestamp.fraction = header.timestamp_fraction;
+        logged_change.encapsulation = header.encapsulation;
+        logged_change.length = header.length;
+        logged_change.data = position + sizeof(LogRecordHeader);
+        logged.push_back(logged_change);
+    }
+
+    restoring_ = true;
+    for(const LoggedChange& logged_change : logged)
+        restore(logged_change);
+    restoring_ = false;
+
+    remove_dead_segments();
+    return true;
+}
+
+bool MappedChangeLog::map_segment(uint32_t index, uint32_t size, bool create, Segment& segment)
+{
+    std::string path = segment_path(index);
+    int fd = ::open(path.c_str(), create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0644);
+    if(fd < 0)
+    {
+        logError(RTPS_PERSISTENCE, "Cannot open " << path << ": " << strerror(errno));
+        return false;
+    }
+
+    bool ok = true;
+    if(create)
+    {
+        // The blocks are allocated now, so a full disk is reported here instead of when the mapping is written.
+#if defined(__linux__)
+        ok = posix_fallocate(fd, 0, size) == 0;
+#else
+        ok = ftruncate(fd, size) == 0;
+#endif
+    }
+    else
+    {
+        struct stat status;
+        ok = fstat(fd, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(SegmentHeader)) &&
+            static_cast<uint64_t>(status.st_size) <= UINT32_MAX;
+        size = ok ? static_cast<uint32_t>(status.st_size) : 0;
+    }
+
+    void* data = ok ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if(data == MAP_FAILED)
+    {
+        logError(RTPS_PERSISTENCE, "Cannot map " << path << ": " << strerror(errno));
+        ::close(fd);
+        if(create)
+            unlink(path.c_str());
+        return false;
+    }
+    ::close(fd);
+
+    segment.index = index;
+    segment.data = static_cast<octet*>(data);
+    segment.size = size;
+    segment.used = sizeof(SegmentHeader);
+    segment.records_end = sizeof(SegmentHeader);
+    segment.changes = 0;
+    segment.change_bytes = 0;
+
+    if(create)
+    {
+        SegmentHeader header;
+        memcpy(header.magic, c_SegmentMagic, sizeof(header.magic));
+        header.version = c_SegmentVersion;
+        memcpy(segment.data, &header, sizeof(header));
+
+        if(sync_ != SYNC_NONE)
+        {
+            sync_range(segment, 0, sizeof(header));
+            // The new file is only durable once its directory entry is.
+            sync_directory();
+        }
+    }
+    else
+    {
+        SegmentHeader header;
+        memcpy(&header, segment.data, sizeof(header));
+        if(memcmp(header.magic, c_SegmentMagic, sizeof(header.magic)) != 0 || header.version != c_SegmentVersion)
+        {
+            logError(RTPS_PERSISTENCE, path << " is not a change log");
+            unmap_segment(segment, false);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void MappedChangeLog::unmap_segment(Segment& segment, bool unlink_file)
+{
+    munmap(segment.data, segment.size);
+    segment.data = nullptr;
+    if(unlink_file)
+        unlink(segment_path(segment.index).c_str());
+}
+
+void MappedChangeLog::sync_range(Segment& segment, uint32_t offset, uint32_t size)
+{
+    static const uint32_t page_size = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+    uint32_t start = offset - offset % page_size;
+    if(msync(segment.data + start, offset + size - start, MS_SYNC) != 0)
+        logWarning(RTPS_PERSISTENCE, "Cannot flush " << segment_path(segment.index) << ": " << strerror(errno));
+}
+
+void MappedChangeLog::sync_directory()
+{
+    std::string directory = path_.rfind('/') != std::string::npos ?
+        path_.substr(0, std::max<size_t>(path_.rfind('/'), 1)) : ".";
+    int dir_fd = ::open(directory.c_str(), O_RDONLY);
+    if(dir_fd >= 0)
+    {
+        fsync(dir_fd);
+        ::close(dir_fd);
+    }
+}
+
+#endif
+
+void MappedChangeLog::load_segment(Segment& segment)
+{
+    uint32_t offset = segment.used;
+    while(segment.size - offset >= sizeof(LogRecordHeader))
+    {
+        LogRecordHeader header = read_header(segment.data + offset);
+        if(header.size == 0)
+            break;
+
+        if(header.size < sizeof(LogRecordHeader) || header.size > segment.size - offset ||
+                (header.type == RECORD_ADD && header.size < record_size(header.length)) ||
+                (header.type != RECORD_ADD && header.type != RECORD_REMOVE))
+        {
+            logWarning(RTPS_PERSISTENCE, "Corrupted record in " << segment_path(segment.index) << " at offset "
+                    << offset << ". The rest of the segment is ignored");
+            // Nothing else is appended to it.
+            segment.used = segment.size;
+            segment.records_end = offset;
+            return;
+        }
+
+        SequenceNumber_t sequence_number(header.sequence_high, header.sequence_low);
+        auto change = changes_.find(sequence_number);
+        if(change != changes_.end())
+            forget(change);
+
+        if(header.type == RECORD_ADD)
+        {
+            // A change can be added twice when its copy to the end of the log was interrupted.
+            ChangeRecord record = {segment.index, offset};
+            changes_[sequence_number] = record;
+            ++segment.changes;
+            segment.change_bytes += header.size;
+            if(last_sequence_number_ < sequence_number)
+                last_sequence_number_ = sequence_number;
+        }
+
+        offset += header.size;
+    }
+
+    segment.used = offset;
+    segment.records_end = offset;
+}
+
+MappedChangeLog::Segment* MappedChangeLog::find_segment(uint32_t index)
+{
+    auto segment = std::lower_bound(segments_.begin(), segments_.end(), index,
+            [](const Segment& a_segment, uint32_t an_index)
+            {
+                return a_segment.index < an_index;
+            });
+    return segment != segments_.end() && segment->index == index ? &*segment : nullptr;
+}
+
+bool MappedChangeLog::add(const CacheChange_t& change)
+{
+    if(segments_.empty())
+        return false;
+
+    if(changes_.find(change.sequenceNumber) != changes_.end())
+        return true;
+
+    LogRecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = record_size(change.serializedPayload.length);
+    header.type = RECORD_ADD;
+    header.kind = static_cast<uint8_t>(change.kind);
+    header.encapsulation = change.serializedPayload.encapsulation;
+    header.sequence_high = change.sequenceNumber.high;
+    header.sequence_low = change.sequenceNumber.low;
+    header.timestamp_seconds = change.sourceTimestamp.seconds;
+    header.timestamp_fraction = change.sourceTimestamp.fraction;
+    memcpy(header.instance, change.instanceHandle.value, sizeof(header.instance));
+    header.length = change.serializedPayload.length;
+
+    if(!reserve(header.size))
+        return false;
+
+    Segment& tail = segments_.back();
+    ChangeRecord record = {tail.index, append(header, change.serializedPayload.data)};
+    changes_[change.sequenceNumber] = record;
+    ++tail.changes;
+    tail.change_bytes += header.size;
+    if(last_sequence_number_ < change.sequenceNumber)
+        last_sequence_number_ = change.sequenceNumber;
+    return true;
+}
+
+bool MappedChangeLog::remove(const SequenceNumber_t& sequence_number)
+{
+    if(segments_.empty() || changes_.find(sequence_number) == changes_.end())
+        return true;
+
+    LogRecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = sizeof(LogRecordHeader);
+    header.type = RECORD_REMOVE;
+    header.sequence_high = sequence_number.high;
+    header.sequence_low = sequence_number.low;
+
+    if(!reserve(header.size))
+        return false;
+
+    append(header, nullptr);
+    // Making room can have moved the change.
+    forget(changes_.find(sequence_number));
+    if(!restoring_)
+        remove_dead_segments();
+    return true;
+}
+
+void MappedChangeLog::sync()
+{
+#if !defined(_WIN32)
+    if(!segments_.empty())
+        sync_range(segments_.back(), 0, segments_.back().used);
+#endif
+}
+
+bool MappedChangeLog::reserve(uint32_t size)
+{
+    Segment& tail = segments_.back();
+    if(tail.size - tail.used >= size)
+        return true;
+
+    if(sync_ == SYNC_SEGMENT)
+        sync();
+
+    Segment segment;
+    if(!map_segment(tail.index + 1, std::max<uint32_t>(segment_size_, sizeof(SegmentHeader) + size), true, segment))
+        return false;
+    segments_.push_back(segment);
+
+    if(!restoring_)
+    {
+        remove_dead_segments();
+        compact_oldest_segment();
+    }
+
+    return true;
+}
+
+uint32_t MappedChangeLog::append(const LogRecordHeader& header, const octet* data)
+{
+    Segment& tail = segments_.back();
+    uint32_t offset = tail.used;
+    octet* position = tail.data + offset;
+
+    memcpy(position + sizeof(uint32_t), reinterpret_cast<const octet*>(&header) + sizeof(uint32_t),
+            sizeof(LogRecordHeader) - sizeof(uint32_t));
+    if(header.type == RECORD_ADD && header.length > 0)
+        memcpy(position + sizeof(LogRecordHeader), data, header.length);
+    memcpy(position, &header.size, sizeof(uint32_t));
+    tail.used += header.size;
+    tail.records_end = tail.used;
+
+#if !defined(_WIN32)
+    if(sync_ == SYNC_CHANGE)
+        sync_range(tail, offset, header.size);
+#endif
+
+    return offset;
+}
+
+void MappedChangeLog::forget(std::map<SequenceNumber_t, ChangeRecord>::iterator change)
+{
+    Segment* segment = find_segment(change->second.segment);
+    if(segment != nullptr)
+    {
+        --segment->changes;
+        segment->change_bytes -= read_header(segment->data + change->second.offset).size;
+    }
+    changes_.erase(change);
+}
+
+void MappedChangeLog::remove_dead_segments()
+{
+    while(segments_.size() > 1 && segments_.front().changes == 0)
+    {
+        unmap_segment(segments_.front(), true);
+        segments_.pop_front();
+    }
+}
+
+void MappedChangeLog::compact_oldest_segment()
+{
+    // The copies must leave room in the last segment, so the log doesn't roll again because of them.
+    Segment& tail = segments_.back();
+    if(segments_.size() < 3 || segments_.front().change_bytes > (tail.size - tail.used) / 2)
+        return;
+
+    Segment& oldest = segments_.front();
+    uint32_t copies_offset = tail.used;
+    uint32_t copied = 0;
+    uint32_t copied_bytes = 0;
+    for(uint32_t offset = sizeof(SegmentHeader); offset < oldest.records_end;)
+    {
+        LogRecordHeader header = read_header(oldest.data + offset);
+        // The records were checked when the segment was loaded or appended, unless the file was changed since.
+        if(header.size < sizeof(LogRecordHeader) || header.size > oldest.records_end - offset)
+        {
+            logWarning(RTPS_PERSISTENCE, "Corrupted record in " << segment_path(oldest.index) << " at offset "
+                    << offset);
+            break;
+        }
+
+        if(header.type == RECORD_ADD)
+        {
+            auto change = changes_.find(SequenceNumber_t(header.sequence_high, header.sequence_low));
+            if(change != changes_.end() && change->second.segment == oldest.index &&
+                    change->second.offset == offset)
+            {
+                change->second.segment = tail.index;
+                change->second.offset = append(header, oldest.data + offset + sizeof(LogRecordHeader));
+                ++tail.changes;
+                tail.change_bytes += header.size;
+                ++copied;
+                copied_bytes += header.size;
+            }
+        }
+        offset += header.size;
+    }
+    oldest.changes -= copied;
+    oldest.change_bytes -= copied_bytes;
+
+    // The copies must be on disk before the segment holding the originals is deleted.
+    if(sync_ != SYNC_NONE && tail.used > copies_offset)
+    {
+        sync_range(tail, copies_offset, tail.used - copies_offset);
+        sync_directory();
+    }
+
+    if(oldest.changes > 0)
+    {
+        logWarning(RTPS_PERSISTENCE, oldest.changes << " changes of " << segment_path(oldest.index)
+                << " could not be copied. The segment is kept");
+        return;
+    }
+
+    logInfo(RTPS_PERSISTENCE, copied << " changes of " << segment_path(oldest.index)
+            << " copied to the end of the log");
+    unmap_segment(oldest, true);
+    segments_.pop_front();
+}
+
+} // namespace rtps
+} // namespace fastrtps
+} // namespace eprosima
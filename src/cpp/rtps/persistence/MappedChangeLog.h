@@ -0,0 +1,210 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file MappedChangeLog.h
+ */
+#ifndef _RTPS_PERSISTENCE_MAPPEDCHANGELOG_H_
+#define _RTPS_PERSISTENCE_MAPPEDCHANGELOG_H_
+
+#include <fastrtps/rtps/common/CacheChange.h>
+#include <fastrtps/rtps/attributes/PropertyPolicy.h>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace eprosima {
+namespace fastrtps {
+namespace rtps {
+
+//! Header of the records of a MappedChangeLog, defined in its source.
+struct LogRecordHeader;
+
+/**
+ * Change kept by a MappedChangeLog. The payload points into the mapped log.
+ */
+struct LoggedChange
+{
+    ChangeKind_t kind;
+    SequenceNumber_t sequenceNumber;
+    InstanceHandle_t instanceHandle;
+    Time_t sourceTimestamp;
+    uint16_t encapsulation;
+    uint32_t length;
+    const octet* data;
+};
+
+/**
+ * Persistent log of the changes of a writer history, kept in memory mapped files.
+ * Added and removed changes are appended to the last segment of the log. When it is full, a new segment is
+ * created. Segments whose changes were all removed are deleted, and the changes still alive in the oldest one are
+ * copied to the end of the log when it doesn't have many of them, so a change that is never removed doesn't keep all
+ * the following segments.
+ * When the log is opened, its segments are mapped and the changes are taken directly from them.
+ * Segments are named "<path>.<index>.log". An open log is locked through "<path>.lock", so a single writer uses it.
+ * @remarks This class is non thread-safe. It is only supported on POSIX systems.
+ */
+class MappedChangeLog
+{
+    public:
+
+        //! When the log is flushed to disk.
+        enum SyncKind
+        {
+            //! The system decides when the mapped segments are written.
+            SYNC_NONE,
+            //! Each segment is flushed when it is full and when the log is closed.
+            SYNC_SEGMENT,
+            //! Each added or removed change is flushed before returning.
+            SYNC_CHANGE
+        };
+
+        /**
+         * @param path Directory and name of the log. The segment index and extension are appended to it.
+         * @param segment_size Size of each segment. Bigger changes get a segment of their own size.
+         * @param sync When the log is flushed to disk.
+         */
+        MappedChangeLog(const std::string& path, uint32_t segment_size, SyncKind sync);
+
+        ~MappedChangeLog();
+
+        /**
+         * Creates a log configured by the properties of a writer:
+         * - "dds.persistence.directory": Directory of the log. Required.
+         * - "dds.persistence.name": Name of the log in the directory. Required here. Publishers set it to their topic
+         *   name when it is missing, so publishers of the same topic sharing a directory must give it. A writer
+         *   whose log is already open by another one is not created.
+         * - "dds.persistence.segment_size": Size in bytes of each segment. 4 MiB by default.
+         * - "dds.persistence.sync": "NONE", "SEGMENT" or "CHANGE". "SEGMENT" by default.
+         * @return The log, not opened yet, or nullptr if the properties are not valid.
+         */
+        static MappedChangeLog* create(const PropertyPolicy& properties);
+
+        /**
+         * Locks the log and maps its segments, creating the first one when there are none, and gives the changes that
+         * were added and not removed, ordered by sequence number.
+         * The function can add and remove changes from the log while it is called.
+         * @param restore Function called with each change.
+         * @return False if the log can't be opened, or another writer has it open.
+         */
+        bool open(const std::function<void(const LoggedChange&)>& restore);
+
+        /**
+         * Appends a change to the log. Changes already in the log are not added again.
+         * @return False if it can't be written.
+         */
+        bool add(const CacheChange_t& change);
+
+        /**
+         * Appends the removal of a change to the log.
+         * @return False if it can't be written.
+         */
+        bool remove(const SequenceNumber_t& sequence_number);
+
+        //! Flushes the mapped segments to disk.
+        void sync();
+
+        //! Greatest sequence number ever added to the log.
+        SequenceNumber_t last_sequence_number() const { return last_sequence_number_; }
+
+        //! Number of segments in the log.
+        size_t segments() const { return segments_.size(); }
+
+        //! Number of changes alive in the log.
+        size_t changes() const { return changes_.size(); }
+
+    private:
+
+        MappedChangeLog(const MappedChangeLog&) = delete;
+        MappedChangeLog& operator=(const MappedChangeLog&) = delete;
+
+        struct Segment
+        {
+            uint32_t index;
+            octet* data;
+            uint32_t size;
+            //! Bytes written, including the header of the segment. Set to its size to stop appending to it.
+            uint32_t used;
+            //! End of the last valid record. Differs from used when a corrupted record was found.
+            uint32_t records_end;
+            //! Changes of the segment that were not removed.
+            uint32_t changes;
+            //! Bytes of the changes of the segment that were not removed.
+            uint32_t change_bytes;
+        };
+
+        //! Record of a change alive in the log.
+        struct ChangeRecord
+        {
+            uint32_t segment;
+            uint32_t offset;
+        };
+
+        std::string segment_path(uint32_t index) const;
+
+        //! Maps a segment, creating it with the given size when it doesn't exist.
+        bool map_segment(uint32_t index, uint32_t size, bool create, Segment& segment);
+
+        void unmap_segment(Segment& segment, bool unlink_file);
+
+        //! Reads the records of a segment, updating the changes alive.
+        void load_segment(Segment& segment);
+
+        //! Position of a segment in segments_.
+        Segment* find_segment(uint32_t index);
+
+        //! Makes room for a record of the given size at the end of the log.
+        bool reserve(uint32_t size);
+
+        /**
+         * Appends a record. Its size is written last, so an interrupted append is ignored when the log is read.
+         * @return Offset of the record in the last segment.
+         */
+        uint32_t append(const LogRecordHeader& header, const octet* data);
+
+        //! Forgets a change alive in the log.
+        void forget(std::map<SequenceNumber_t, ChangeRecord>::iterator change);
+
+        //! Deletes the oldest segments while their changes were all removed.
+        void remove_dead_segments();
+
+        //! Copies the changes alive in the oldest segment to the end of the log, and deletes it.
+        void compact_oldest_segment();
+
+        void sync_range(Segment& segment, uint32_t offset, uint32_t size);
+
+        //! Flushes the entries of the directory of the log, so created and deleted segments are durable.
+        void sync_directory();
+
+        std::string path_;
+        uint32_t segment_size_;
+        SyncKind sync_;
+        //! Mapped segments, oldest first. The last one is where records are appended.
+        std::deque<Segment> segments_;
+        //! Changes alive in the log.
+        std::map<SequenceNumber_t, ChangeRecord> changes_;
+        SequenceNumber_t last_sequence_number_;
+        //! Segments are not deleted while the changes are restored, because their payloads are still used.
+        bool restoring_;
+        //! Descriptor of the lock file, held while the log is open.
+        int lock_fd_;
+};
+
+} // namespace rtps
+} // namespace fastrtps
+} // namespace eprosima
+
+#endif // _RTPS_PERSISTENCE_MAPPEDCHANGELOG_H_
@@ -18,6 +18,53 @@
 
 using namespace eprosima::fastrtps::rtps;
 
+//! Capacity of the smallest buffer of the arena. Bigger ones double it.
+static const uint32_t c_arena_buffer_size = 65536;
+//! Number of released buffers the arena keeps for the next samples.
+static const uint32_t c_arena_free_buffers = 8;
+
+CacheChange_t* FragmentedChangePitStop::reserve(uint32_t sampleSize)
+{
+    CacheChange_t* change = nullptr;
+    ReceiveBuffer* buffer = nullptr;
+
+    if(arena_size_ > 0)
+    {
+        if(!arena_)
+            arena_ = std::make_shared<ReceiveBufferPool>(c_arena_buffer_size, c_arena_free_buffers, arena_size_);
+
+        try
+        {
+            buffer = arena_->take(sampleSize);
+        }
+        catch(std::bad_alloc&)
+        {
+            buffer = nullptr;
+        }
+    }
+
+    if(buffer == nullptr)
+    {
+        // No room in the arena. The payload of the change grows to hold the sample.
+        if(!parent_->reserveCache(&change, sampleSize))
+            return nullptr;
+
+        change->serializedPayload.reserve(sampleSize);
+        return change;
+    }
+
+    if(!parent_->reserveCache(&change, 0))
+    {
+        buffer->remove_reference();
+        return nullptr;
+    }
+
+    // The reference of the arena buffer goes to the payload, which keeps it until the change is released.
+    change->serializedPayload.reference(buffer, buffer->buffer(), sampleSize);
+    buffer->remove_reference();
+    return change;
+}
+
 CacheChange_t* FragmentedChangePitStop::process(CacheChange_t* incoming_change, uint32_t sampleSize, uint32_t fragmentStartingNum)
 {
     CacheChange_t* returnedValue = nullptr;
@@ -42,23 +89,22 @@ CacheChange_t* FragmentedChangePitStop::process(CacheChange_t* incoming_change,
     // If not found an existing CacheChange_t, reserve one and insert.
     if(original_change_cit == range.second)
     {
-        CacheChange_t* original_change = nullptr;
+        CacheChange_t* original_change = reserve(sampleSize);
 
-        if(!parent_->reserveCache(&original_change, sampleSize))
+        if(original_change == nullptr)
             return nullptr;
 
         //Change comes preallocated (size sampleSize)
         original_change->copy_not_memcpy(incoming_change);
         // The length of the serialized payload has to be sample size.
         original_change->serializedPayload.length = sampleSize;
-        original_change->serializedPayload.reserve(sampleSize);
         original_change->setFragmentSize(incoming_change->getFragmentSize());
 
         // Insert
         original_change_cit = changes_.insert(ChangeInPit(original_change));
     }
 
-    bool was_updated = false;
+    bool is_completed = false;
     for (uint32_t count = (fragmentStartingNum - 1); count < (fragmentStartingNum - 1) + incoming_change->getFragmentCount(); ++count)
     {
         if(original_change_cit->getChange()->getDataFragments()->at(count) == ChangeFragmentStatus_t::NOT_PRESENT)
@@ -78,26 +124,15 @@ CacheChange_t* FragmentedChangePitStop::process(CacheChange_t* incoming_change,
 
             original_change_cit->getChange()->getDataFragments()->at(count) = ChangeFragmentStatus_t::PRESENT;
 
-            was_updated = true;
+            is_completed = original_change_cit->fragmentReceived();
         }
     }
 
-    // If was updated, check if it is completed.
-    if(was_updated)
+    // If it is completed, return CacheChange_t and remove information.
+    if(is_completed)
     {
-        auto fit = original_change_cit->getChange()->getDataFragments()->begin();
-        for(; fit != original_change_cit->getChange()->getDataFragments()->end(); ++fit)
-        {
-            if(*fit == ChangeFragmentStatus_t::NOT_PRESENT)
-                break;
-        }
-
-        // If it is completed, return CacheChange_t and remove information.
-        if(fit == original_change_cit->getChange()->getDataFragments()->end())
-        {
-            returnedValue = original_change_cit->getChange();
-            changes_.erase(original_change_cit);
-        }
+        returnedValue = original_change_cit->getChange();
+        changes_.erase(original_change_cit);
     }
 
     return returnedValue;
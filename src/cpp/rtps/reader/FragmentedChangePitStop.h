@@ -20,7 +20,9 @@
 
 #include <fastrtps/fastrtps_dll.h>
 #include <fastrtps/rtps/common/CacheChange.h>
+#include <fastrtps/rtps/common/ReceiveBufferPool.h>
 
+#include <memory>
 #include <unordered_set>
 
 namespace eprosima
@@ -50,19 +52,29 @@ namespace eprosima
                          * This constructor has to be used if the ChangeInPit will be used to be stored in a container.
                          * @param change Related CacheChange_t.
                          */
-                        ChangeInPit(CacheChange_t* change) : sequence_number_(change->sequenceNumber), change_(change) {};
+                        ChangeInPit(CacheChange_t* change) : sequence_number_(change->sequenceNumber), change_(change),
+                            missing_fragments_(change->getFragmentCount()) {};
 
                         /*!
                          * @brief Constructor used to generated a simple key for searching in a container.
                          * @param sequence_number SequenceNumber_t used as key.
                          * @remarks Not use this constructor if the object will be stored in a container.
                          */
-                        ChangeInPit(const SequenceNumber_t &sequence_number) : sequence_number_(sequence_number), change_(nullptr) {};
+                        ChangeInPit(const SequenceNumber_t &sequence_number) : sequence_number_(sequence_number), change_(nullptr),
+                            missing_fragments_(0) {};
 
-                        ChangeInPit(const ChangeInPit& cip) : sequence_number_(cip.sequence_number_), change_(cip.change_) {};
+                        ChangeInPit(const ChangeInPit& cip) : sequence_number_(cip.sequence_number_), change_(cip.change_),
+                            missing_fragments_(cip.missing_fragments_) {};
 
                         CacheChange_t* getChange() const { return change_; }
 
+                        /*!
+                         * @brief Records that a fragment was received. It is not part of the key, so it can be
+                         * called on the objects stored in a container.
+                         * @return true if it was the last fragment not present.
+                         */
+                        bool fragmentReceived() const { return --missing_fragments_ == 0; }
+
                         bool operator==(const ChangeInPit& cip) const
                         {
                             return sequence_number_ == cip.sequence_number_;
@@ -74,6 +86,8 @@ namespace eprosima
 
                         const SequenceNumber_t sequence_number_;
                         CacheChange_t* change_;
+                        //! Number of fragments of the change not present yet.
+                        mutable uint32_t missing_fragments_;
 
                     public:
                         /*!
@@ -94,8 +108,11 @@ namespace eprosima
                  * @brief Default constructor.
                  * @param parent RTPSReader managing this object.
                  * It is necessary the access to reserve a new CacheChange_t.
+                 * @param arena_size Maximum memory of the buffers where the samples are reassembled.
+                 * Zero means the samples are reassembled in the payloads of the reserved CacheChange_t.
                  */
-                FragmentedChangePitStop(RTPSReader *parent) : parent_(parent) {}
+                FragmentedChangePitStop(RTPSReader *parent, uint32_t arena_size = 0) : parent_(parent),
+                    arena_size_(arena_size) {}
 
                 /*!
                  * @brief Process incomming fragments.
@@ -138,10 +155,23 @@ namespace eprosima
 
                 private:
 
+                /*!
+                 * @brief Reserves a CacheChange_t for a new sample, whose payload references a buffer of the arena
+                 * when there is room for it.
+                 * @return nullptr if no CacheChange_t could be reserved.
+                 */
+                CacheChange_t* reserve(uint32_t sampleSize);
+
                 std::unordered_multiset<ChangeInPit, ChangeInPit::ChangeInPitHash> changes_;
 
                 RTPSReader* parent_;
 
+                //! Maximum memory of the arena.
+                uint32_t arena_size_;
+
+                //! Buffers where the samples are reassembled. They go back to it when the completed changes are released.
+                std::shared_ptr<ReceiveBufferPool> arena_;
+
                 FragmentedChangePitStop(const FragmentedChangePitStop&) NON_COPYABLE_CXX11;
 
                 FragmentedChangePitStop& operator=(const FragmentedChangePitStop&) NON_COPYABLE_CXX11;
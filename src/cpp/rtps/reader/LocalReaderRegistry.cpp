@@ -0,0 +1,105 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file LocalReaderRegistry.cpp
+ */
+
+#include "LocalReaderRegistry.h"
+#include <fastrtps/rtps/reader/RTPSReader.h>
+#include <fastrtps/rtps/common/CacheChange.h>
+#include <fastrtps/utils/eClock.h>
+
+#include <fastrtps/log/Log.h>
+
+using namespace eprosima::fastrtps::rtps;
+
+std::mutex LocalReaderRegistry::registry_mutex_;
+std::condition_variable LocalReaderRegistry::registry_cond_;
+std::map<GUID_t, LocalReaderRegistry::Entry> LocalReaderRegistry::readers_;
+
+void LocalReaderRegistry::add(RTPSReader* reader)
+{
+    std::lock_guard<std::mutex> guard(registry_mutex_);
+    Entry& entry = readers_[reader->getGuid()];
+    entry.reader = reader;
+    entry.users = 0;
+    entry.removing = false;
+    logInfo(RTPS_READER, "Reader " << reader->getGuid() << " accepts intra-process delivery");
+}
+
+void LocalReaderRegistry::remove(RTPSReader* reader)
+{
+    std::unique_lock<std::mutex> lock(registry_mutex_);
+    auto it = readers_.find(reader->getGuid());
+
+    if(it == readers_.end() || it->second.reader != reader)
+        return;
+
+    it->second.removing = true;
+    registry_cond_.wait(lock, [&it]() { return it->second.users == 0; });
+    readers_.erase(it);
+}
+
+bool LocalReaderRegistry::contains(const GUID_t& reader_guid)
+{
+    std::lock_guard<std::mutex> guard(registry_mutex_);
+    auto it = readers_.find(reader_guid);
+    return it != readers_.end() && !it->second.removing;
+}
+
+bool LocalReaderRegistry::deliver(const GUID_t& reader_guid, const CacheChange_t& change)
+{
+    RTPSReader* reader = nullptr;
+
+    {
+        std::lock_guard<std::mutex> guard(registry_mutex_);
+        auto it = readers_.find(reader_guid);
+
+        if(it == readers_.end() || it->second.removing)
+            return false;
+
+        reader = it->second.reader;
+        ++it->second.users;
+    }
+
+    // Build the same change the MessageReceiver would have parsed from the DATA message,
+    // but pointing to the payload of the writer. The reader copies it into its own cache.
+    CacheChange_t received;
+    received.kind = change.kind;
+    received.writerGUID = change.writerGUID;
+    received.instanceHandle = change.instanceHandle;
+    received.sequenceNumber = change.sequenceNumber;
+    received.write_params = change.write_params;
+    received.serializedPayload.encapsulation = change.serializedPayload.encapsulation;
+    received.serializedPayload.length = change.serializedPayload.length;
+    received.serializedPayload.max_size = change.serializedPayload.length;
+    received.serializedPayload.data = change.serializedPayload.data;
+    eClock clock;
+    clock.setTimeNow(&received.sourceTimestamp);
+
+    reader->processDataMsg(&received);
+
+    // The payload belongs to the writer.
+    received.serializedPayload.data = nullptr;
+
+    {
+        std::lock_guard<std::mutex> guard(registry_mutex_);
+        auto it = readers_.find(reader_guid);
+        if(--it->second.users == 0)
+            registry_cond_.notify_all();
+    }
+
+    return true;
+}
@@ -0,0 +1,83 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file LocalReaderRegistry.h
+ */
+
+#ifndef LOCAL_READER_REGISTRY_H
+#define LOCAL_READER_REGISTRY_H
+
+#include <fastrtps/rtps/common/Guid.h>
+
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+class RTPSReader;
+struct CacheChange_t;
+
+/**
+ * Process-wide registry of the user readers that accept intra-process delivery.
+ * Writers matched with one of these readers hand their changes directly to it, instead of
+ * building a DATA message and sending it through a transport.
+ * Removing a reader waits until every delivery in progress to it has finished, so a reader
+ * can be safely destroyed once it has been removed.
+ * @ingroup READER_MODULE
+ */
+class LocalReaderRegistry
+{
+    public:
+        //! Makes the reader available for intra-process delivery.
+        static void add(RTPSReader* reader);
+
+        //! Removes the reader, blocking while a delivery to it is in progress.
+        static void remove(RTPSReader* reader);
+
+        //! Returns true when the reader with the given GUID is registered.
+        static bool contains(const GUID_t& reader_guid);
+
+        /**
+         * Gives the change to the registered reader, as if it had been received in a DATA message.
+         * The payload is not copied until the reader stores it in its history.
+         * @param reader_guid GUID of the destination reader.
+         * @param change Change to deliver, owned by the writer.
+         * @return false if the reader is no longer registered, so the change has to be sent through the network.
+         */
+        static bool deliver(const GUID_t& reader_guid, const CacheChange_t& change);
+
+    private:
+        struct Entry
+        {
+            RTPSReader* reader;
+            //! Deliveries in progress to this reader.
+            uint32_t users;
+            //! Set when the reader is being removed. No new deliveries are started.
+            bool removing;
+        };
+
+        static std::mutex registry_mutex_;
+        static std::condition_variable registry_cond_;
+        static std::map<GUID_t, Entry> readers_;
+};
+
+} // namespace rtps
+} // namespace fastrtps
+} // namespace eprosima
+
+#endif
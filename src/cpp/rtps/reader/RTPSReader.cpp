@@ -44,7 +44,7 @@ RTPSReader::RTPSReader(RTPSParticipantImpl*pimpl,GUID_t& guid,
 {
 	mp_history->mp_reader = this;
     mp_history->mp_mutex = mp_mutex;
-    fragmentedChangePitStop_ = new FragmentedChangePitStop(this);
+    fragmentedChangePitStop_ = new FragmentedChangePitStop(this, att.fragmentReassemblyArenaSize);
 	logInfo(RTPS_READER,"RTPSReader created correctly");
 }
 
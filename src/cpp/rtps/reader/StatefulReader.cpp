@@ -78,6 +78,7 @@ bool StatefulReader::matched_writer_add(RemoteWriterAttributes& wdata)
     wp->mp_initialAcknack->restart_timer();
 
     matched_writers.push_back(wp);
+    mp_RTPSParticipant->matched_writers_changed();
     logInfo(RTPS_READER,"Writer Proxy " <<wp->m_att.guid <<" added to " <<m_guid.entityId);
     return true;
 }
@@ -97,6 +98,7 @@ bool StatefulReader::matched_writer_remove(RemoteWriterAttributes& wdata)
             logInfo(RTPS_READER,"Writer Proxy removed: " <<(*it)->m_att.guid);
             wproxy = *it;
             matched_writers.erase(it);
+            mp_RTPSParticipant->matched_writers_changed();
             break;
         }
     }
@@ -128,6 +130,7 @@ bool StatefulReader::matched_writer_remove(RemoteWriterAttributes& wdata,bool de
             logInfo(RTPS_READER,"Writer Proxy removed: " <<(*it)->m_att.guid);
             wproxy = *it;
             matched_writers.erase(it);
+            mp_RTPSParticipant->matched_writers_changed();
             break;
         }
     }
@@ -432,6 +435,23 @@ bool StatefulReader::processGapMsg(GUID_t &writerGUID, SequenceNumber_t &gapStar
     return true;
 }
 
+bool StatefulReader::is_writer_accepted(const GUID_t& writerGUID)
+{
+    std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
+
+    if(writerGUID.entityId == this->m_trustedWriterEntityId)
+        return true;
+
+    for(std::vector<WriterProxy*>::iterator it = this->matched_writers.begin();
+            it!=matched_writers.end();++it)
+    {
+        if((*it)->m_att.guid == writerGUID)
+            return true;
+    }
+
+    return false;
+}
+
 bool StatefulReader::acceptMsgFrom(GUID_t &writerId, WriterProxy **wp, bool checkTrusted)
 {
     assert(wp != nullptr);
@@ -459,6 +479,7 @@ bool StatefulReader::change_removed_by_history(CacheChange_t* a_change, WriterPr
     if(wp != nullptr || matched_writer_lookup(a_change->writerGUID,&wp))
     {
         wp->setNotValid(a_change->sequenceNumber);
+        wp->history_change_removed(a_change);
         return true;
     }
     else
@@ -490,6 +511,7 @@ bool StatefulReader::change_received(CacheChange_t* a_change, WriterProxy* prox,
     {
         if(this->mp_history->received_change(a_change, unknown_missing_changes_up_to))
         {
+            prox->history_change_added(a_change);
             GUID_t proxGUID = prox->m_att.guid;
             writerProxyLock.unlock();
 
@@ -548,117 +570,61 @@ bool StatefulReader::change_received(CacheChange_t* a_change, WriterProxy* prox,
 bool StatefulReader::nextUntakenCache(CacheChange_t** change,WriterProxy** wpout)
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-    std::vector<CacheChange_t*> toremove;
-    bool takeok = false;
-    for(std::vector<CacheChange_t*>::iterator it = mp_history->changesBegin();
-            it!=mp_history->changesEnd();++it)
+    CacheChange_t* next = nullptr;
+
+    // Each writer proxy knows its first change that can be delivered. The oldest one is taken.
+    for(std::vector<WriterProxy*>::iterator it = matched_writers.begin(); it != matched_writers.end(); ++it)
     {
-        WriterProxy* wp;
-        if(this->matched_writer_lookup((*it)->writerGUID, &wp))
-        {
-            // TODO Revisar la comprobacion
-            SequenceNumber_t seq = wp->available_changes_max();
-            if(seq >= (*it)->sequenceNumber)
-            {
-                *change = *it;
-                if(wpout !=nullptr)
-                    *wpout = wp;
-
-                takeok = true;
-                break;
-                //				if((*it)->kind == ALIVE)
-                //				{
-                //					this->mp_type->deserialize(&(*it)->serializedPayload,data);
-                //				}
-                //				(*it)->isRead = true;
-                //				if(info!=NULL)
-                //				{
-                //					info->sampleKind = (*it)->kind;
-                //					info->writerGUID = (*it)->writerGUID;
-                //					info->sourceTimestamp = (*it)->sourceTimestamp;
-                //					info->iHandle = (*it)->instanceHandle;
-                //					if(this->m_qos.m_ownership.kind == EXCLUSIVE_OWNERSHIP_QOS)
-                //						info->ownershipStrength = wp->m_data->m_qos.m_ownershipStrength.value;
-                //				}
-                //				m_reader_cache.decreaseUnreadCount();
-                //				logInfo(RTPS_READER,this->getGuid().entityId<<": reading change "<< (*it)->sequenceNumber.to64long());
-                //				readok = true;
-                //				break;
-            }
-        }
-        else
+        CacheChange_t* available = (*it)->next_available_change();
+        if(available != nullptr && (next == nullptr || available->sequenceNumber < next->sequenceNumber))
         {
-            toremove.push_back((*it));
+            next = available;
+            if(wpout != nullptr)
+                *wpout = *it;
         }
     }
 
-    for(std::vector<CacheChange_t*>::iterator it = toremove.begin();
-            it!=toremove.end();++it)
-    {
-        logWarning(RTPS_READER,"Removing change "<<(*it)->sequenceNumber << " from " << (*it)->writerGUID << " because is no longer paired");
-        mp_history->remove_change(*it);
-    }
-    return takeok;
+    if(next == nullptr)
+        return false;
+
+    *change = next;
+    return true;
 }
 
-// TODO Porque elimina aqui y no cuando hay unpairing
 bool StatefulReader::nextUnreadCache(CacheChange_t** change,WriterProxy** wpout)
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-    std::vector<CacheChange_t*> toremove;
-    bool readok = false;
-    for(std::vector<CacheChange_t*>::iterator it = mp_history->changesBegin();
-            it!=mp_history->changesEnd();++it)
+    CacheChange_t* next = nullptr;
+
+    for(std::vector<WriterProxy*>::iterator it = matched_writers.begin(); it != matched_writers.end(); ++it)
     {
-        if((*it)->isRead)
-            continue;
-        WriterProxy* wp;
-        if(this->matched_writer_lookup((*it)->writerGUID,&wp))
-        {
-            SequenceNumber_t seq;
-            seq = wp->available_changes_max();
-            if(seq >= (*it)->sequenceNumber)
-            {
-                *change = *it;
-                if(wpout !=nullptr)
-                    *wpout = wp;
-
-                readok = true;
-                break;
-                //				if((*it)->kind == ALIVE)
-                //				{
-                //					this->mp_type->deserialize(&(*it)->serializedPayload,data);
-                //				}
-                //				(*it)->isRead = true;
-                //				if(info!=NULL)
-                //				{
-                //					info->sampleKind = (*it)->kind;
-                //					info->writerGUID = (*it)->writerGUID;
-                //					info->sourceTimestamp = (*it)->sourceTimestamp;
-                //					info->iHandle = (*it)->instanceHandle;
-                //					if(this->m_qos.m_ownership.kind == EXCLUSIVE_OWNERSHIP_QOS)
-                //						info->ownershipStrength = wp->m_data->m_qos.m_ownershipStrength.value;
-                //				}
-                //				m_reader_cache.decreaseUnreadCount();
-                //				logInfo(RTPS_READER,this->getGuid().entityId<<": reading change "<< (*it)->sequenceNumber.to64long());
-                //				readok = true;
-                //				break;
-            }
-        }
-        else
+        CacheChange_t* available = (*it)->next_unread_available_change();
+        if(available != nullptr && (next == nullptr || available->sequenceNumber < next->sequenceNumber))
         {
-            toremove.push_back((*it));
+            next = available;
+            if(wpout != nullptr)
+                *wpout = *it;
         }
     }
 
-    for(std::vector<CacheChange_t*>::iterator it = toremove.begin();
-            it!=toremove.end();++it)
-    {
-        logWarning(RTPS_READER,"Removing change "<<(*it)->sequenceNumber << " from " << (*it)->writerGUID << " because is no longer paired");
-        mp_history->remove_change(*it);
-    }
+    if(next == nullptr)
+        return false;
+
+    *change = next;
+    return true;
+}
 
-    return readok;
+bool StatefulReader::isChangeAvailable(CacheChange_t* change,WriterProxy** wpout)
+{
+    std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
+    WriterProxy* wp;
+
+    if(!findWriterProxy(change->writerGUID, &wp) || change->sequenceNumber > wp->available_changes_max())
+        return false;
+
+    if(wpout != nullptr)
+        *wpout = wp;
+    return true;
 }
 
 //
@@ -61,6 +61,7 @@ bool StatelessReader::matched_writer_add(RemoteWriterAttributes& wdata)
     logInfo(RTPS_READER,"Writer " << wdata.guid << " added to "<<m_guid.entityId);
     m_matched_writers.push_back(wdata);
     m_acceptMessagesFromUnkownWriters = false;
+    mp_RTPSParticipant->matched_writers_changed();
     return true;
 }
 bool StatelessReader::matched_writer_remove(RemoteWriterAttributes& wdata)
@@ -73,6 +74,7 @@ bool StatelessReader::matched_writer_remove(RemoteWriterAttributes& wdata)
             logInfo(RTPS_READER,"Writer " <<wdata.guid<< " removed from "<<m_guid.entityId);
             m_matched_writers.erase(it);
             m_historyRecord.erase(wdata.guid);
+            mp_RTPSParticipant->matched_writers_changed();
             return true;
         }
     }
@@ -124,6 +126,11 @@ bool StatelessReader::nextUntakenCache(CacheChange_t** change,WriterProxy** /*wp
 }
 
 
+bool StatelessReader::isChangeAvailable(CacheChange_t* /*change*/,WriterProxy** /*wpout*/)
+{
+    return true;
+}
+
 bool StatelessReader::nextUnreadCache(CacheChange_t** change,WriterProxy** /*wpout*/)
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
@@ -299,6 +306,13 @@ bool StatelessReader::processGapMsg(GUID_t& /*writerGUID*/, SequenceNumber_t& /*
     return true;
 }
 
+bool StatelessReader::is_writer_accepted(const GUID_t& writerGUID)
+{
+    std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
+    GUID_t writer(writerGUID);
+    return acceptMsgFrom(writer);
+}
+
 bool StatelessReader::acceptMsgFrom(GUID_t& writerId)
 {
     if(this->m_acceptMessagesFromUnkownWriters)
@@ -22,7 +22,10 @@
 
 #include <fastrtps/log/Log.h>
 #include <fastrtps/utils/TimeConversion.h>
+#include <fastrtps/utils/BitOperations.h>
 
+#include <algorithm>
+#include <cassert>
 #include <mutex>
 
 #include <fastrtps/rtps/reader/timedevent/HeartbeatResponseDelay.h>
@@ -31,63 +34,156 @@
 
 using namespace eprosima::fastrtps::rtps;
 
+namespace
+{
+    //! Minimum capacity of the ring of changes. It must be a power of two multiple of 64.
+    const uint32_t c_min_changes_capacity = 64;
+}
+
+std::vector<uint64_t>* WriterProxy::status_bits(ChangeFromWriterStatus_t status)
+{
+    switch(status)
+    {
+        case MISSING:
+            return &missing_bits_;
+        case RECEIVED:
+            return &received_bits_;
+        case LOST:
+            return &lost_bits_;
+        default:
+            return nullptr;
+    }
+}
+
+ChangeFromWriterStatus_t WriterProxy::status_at(uint32_t position) const
+{
+    uint64_t bit = uint64_t(1) << (position % 64);
+
+    if(missing_bits_[position / 64] & bit)
+        return MISSING;
+    if(received_bits_[position / 64] & bit)
+        return RECEIVED;
+    if(lost_bits_[position / 64] & bit)
+        return LOST;
+
+    return UNKNOWN;
+}
+
+void WriterProxy::set_status_at(uint32_t position, ChangeFromWriterStatus_t status)
+{
+    uint64_t bit = uint64_t(1) << (position % 64);
+
+    if(missing_bits_[position / 64] & bit)
+        --missing_count_;
+    missing_bits_[position / 64] &= ~bit;
+    received_bits_[position / 64] &= ~bit;
+    lost_bits_[position / 64] &= ~bit;
+
+    std::vector<uint64_t>* bits = status_bits(status);
+    if(bits != nullptr)
+        (*bits)[position / 64] |= bit;
+    if(status == MISSING)
+        ++missing_count_;
+}
+
+uint32_t WriterProxy::position_of(const SequenceNumber_t& seqNum) const
+{
+    assert(seqNum > changesFromWLowMark_ && seqNum <= changesFromWLowMark_ + count_);
+    uint32_t offset = static_cast<uint32_t>(seqNum.to64long() - changesFromWLowMark_.to64long() - 1);
+    return (head_ + offset) & (capacity_ - 1);
+}
+
 /*!
- * @brief Auxiliary function to change status in a range.
+ * @brief Auxiliary function to visit the words of the ring covering a range of offsets from the first change.
+ * The operation receives the index of the word, the mask of the bits in the range and the offset of the
+ * first of them. It returns false to stop.
  */
-void WriterProxy::for_each_set_status_from(decltype(WriterProxy::m_changesFromW)::iterator first,
-        decltype(WriterProxy::m_changesFromW)::iterator last,
-        ChangeFromWriterStatus_t status,
-        ChangeFromWriterStatus_t new_status)
+template<typename Operation>
+void WriterProxy::for_each_word(uint32_t first, uint32_t last, Operation operation)
 {
-    auto it = first;
-    while(it != last)
+    while(first < last)
     {
-        if(it->getStatus() == status)
-        {
-            ChangeFromWriter_t newch(*it);
-            newch.setStatus(new_status);
+        uint32_t position = (head_ + first) & (capacity_ - 1);
+        uint32_t bits = std::min(64 - (position % 64), last - first);
 
-            auto hint = m_changesFromW.erase(it);
+        if(!operation(position / 64, bit_range(position % 64, bits), first))
+            return;
 
-            it = m_changesFromW.insert(hint, newch);
-        }
-
-        ++it;
+        first += bits;
     }
 }
 
-void WriterProxy::for_each_set_status_from_and_maybe_remove(decltype(WriterProxy::m_changesFromW)::iterator first,
-        decltype(WriterProxy::m_changesFromW)::iterator last,
-        ChangeFromWriterStatus_t status,
-        ChangeFromWriterStatus_t orstatus,
-        ChangeFromWriterStatus_t new_status)
+void WriterProxy::reserve_changes(uint32_t count)
 {
-    auto it = first;
-    while(it != last)
+    if(count <= capacity_)
+        return;
+
+    uint32_t capacity = capacity_ == 0 ? c_min_changes_capacity : capacity_;
+    while(capacity < count)
+        capacity *= 2;
+
+    // Move the first change to the first position.
+    auto relocate = [this, capacity](std::vector<uint64_t>& bits)
     {
-        if(it->getStatus() == status || it->getStatus() == orstatus)
+        std::vector<uint64_t> new_bits(capacity / 64, 0);
+        for(uint32_t offset = 0; offset < count_; ++offset)
         {
-            if(it != m_changesFromW.begin())
+            uint32_t position = (head_ + offset) & (capacity_ - 1);
+            if(bits[position / 64] & (uint64_t(1) << (position % 64)))
+                new_bits[offset / 64] |= uint64_t(1) << (offset % 64);
+        }
+        bits.swap(new_bits);
+    };
+
+    relocate(missing_bits_);
+    relocate(received_bits_);
+    relocate(lost_bits_);
+    relocate(irrelevant_bits_);
+    capacity_ = capacity;
+    head_ = 0;
+}
+
+void WriterProxy::remove_first_changes(uint32_t count)
+{
+    assert(count <= count_);
+
+    for_each_word(0, count, [this](uint32_t word, uint64_t mask, uint32_t)
             {
-                ChangeFromWriter_t newch(*it);
-                newch.setStatus(new_status);
+                missing_count_ -= bit_count(missing_bits_[word] & mask);
+                missing_bits_[word] &= ~mask;
+                received_bits_[word] &= ~mask;
+                lost_bits_[word] &= ~mask;
+                irrelevant_bits_[word] &= ~mask;
+                return true;
+            });
+
+    if(capacity_ != 0)
+        head_ = (head_ + count) & (capacity_ - 1);
+    count_ -= count;
+    changesFromWLowMark_ = changesFromWLowMark_ + count;
+}
 
-                auto hint = m_changesFromW.erase(it);
+void WriterProxy::add_change_from_writer(const ChangeFromWriter_t& change)
+{
+    assert(change.getSequenceNumber() == changesFromWLowMark_ + (count_ + 1));
 
-                it = m_changesFromW.insert(hint, newch);
-                ++it;
-                continue;
-            }
-        }
+    reserve_changes(count_ + 1);
+    uint32_t position = (head_ + count_) & (capacity_ - 1);
+    ++count_;
 
-        // UNKNOWN or MISSING at the beginning or
-        // LOST or RECEIVED at the beginning.
-        if(it == m_changesFromW.begin())
-        {
-            changesFromWLowMark_ = it->getSequenceNumber();
-            it = m_changesFromW.erase(it);
-        }
-    }
+    set_status_at(position, change.getStatus());
+    if(!change.isRelevant())
+        irrelevant_bits_[position / 64] |= uint64_t(1) << (position % 64);
+}
+
+ChangeFromWriter_t WriterProxy::change_from_writer(const SequenceNumber_t& seqNum) const
+{
+    uint32_t position = position_of(seqNum);
+
+    ChangeFromWriter_t change(seqNum);
+    change.setStatus(status_at(position));
+    change.setRelevance((irrelevant_bits_[position / 64] & (uint64_t(1) << (position % 64))) == 0);
+    return change;
 }
 
 static const int WRITERPROXY_LIVELINESS_PERIOD_MULTIPLIER = 1;
@@ -116,10 +212,13 @@ WriterProxy::WriterProxy(RemoteWriterAttributes& watt,
     mp_initialAcknack(nullptr),
     m_heartbeatFinalFlag(false),
     m_isAlive(true),
-    mp_mutex(new std::recursive_mutex())
-
+    mp_mutex(new std::recursive_mutex()),
+    capacity_(0),
+    head_(0),
+    count_(0),
+    missing_count_(0),
+    first_unread_change_(0)
 {
-    m_changesFromW.clear();
     //Create Events
     mp_writerProxyLiveliness = new WriterProxyLiveliness(this,TimeConv::Time_t2MilliSecondsDouble(m_att.livelinessLeaseDuration)*WRITERPROXY_LIVELINESS_PERIOD_MULTIPLIER);
     mp_heartbeatResponse = new HeartbeatResponseDelay(this,TimeConv::Time_t2MilliSecondsDouble(mp_SFR->getTimes().heartbeatResponseDelay));
@@ -137,12 +236,21 @@ void WriterProxy::missing_changes_update(const SequenceNumber_t& seqNum)
     // Check was not removed from container.
     if(seqNum > changesFromWLowMark_)
     {
-        if(m_changesFromW.size() == 0 || m_changesFromW.rbegin()->getSequenceNumber() < seqNum)
+        bool add_up_to_seq = count_ == 0 || changesFromWLowMark_ + count_ < seqNum;
+        uint32_t count = add_up_to_seq ? count_ :
+            static_cast<uint32_t>(seqNum.to64long() - changesFromWLowMark_.to64long());
+
+        // Set already values in container.
+        for_each_word(0, count, [this](uint32_t word, uint64_t mask, uint32_t)
+                {
+                    uint64_t unknown = mask & ~(missing_bits_[word] | received_bits_[word] | lost_bits_[word]);
+                    missing_bits_[word] |= unknown;
+                    missing_count_ += bit_count(unknown);
+                    return true;
+                });
+
+        if(add_up_to_seq)
         {
-            // Set already values in container.
-            for_each_set_status_from(m_changesFromW.begin(), m_changesFromW.end(),
-                    ChangeFromWriterStatus_t::UNKNOWN, ChangeFromWriterStatus_t::MISSING);
-
             // Changes only already inserted values.
             bool will_be_the_last = maybe_add_changes_from_writer_up_to(seqNum, ChangeFromWriterStatus_t::MISSING);
             (void)will_be_the_last;
@@ -151,15 +259,7 @@ void WriterProxy::missing_changes_update(const SequenceNumber_t& seqNum)
             // Add requetes sequence number.
             ChangeFromWriter_t newch(seqNum);
             newch.setStatus(ChangeFromWriterStatus_t::MISSING);
-            m_changesFromW.insert(m_changesFromW.end(), newch);
-        }
-        else
-        {
-            // Find it. Must be there.
-            auto last_it = m_changesFromW.find(ChangeFromWriter_t(seqNum));
-            assert(last_it != m_changesFromW.end());
-            for_each_set_status_from(m_changesFromW.begin(), ++last_it,
-                    ChangeFromWriterStatus_t::UNKNOWN, ChangeFromWriterStatus_t::MISSING);
+            add_change_from_writer(newch);
         }
     }
 
@@ -171,23 +271,30 @@ bool WriterProxy::maybe_add_changes_from_writer_up_to(const SequenceNumber_t& se
 {
     bool returnedValue = false;
     // Check if CacheChange_t is in the container or not.
-    SequenceNumber_t lastSeqNum = changesFromWLowMark_;
-
-    if(m_changesFromW.size() > 0)
-        lastSeqNum = m_changesFromW.rbegin()->getSequenceNumber();
+    SequenceNumber_t lastSeqNum = changesFromWLowMark_ + count_;
 
     if(sequence_number > lastSeqNum)
     {
         returnedValue = true;
 
         // If it is not in the container, create info up to its sequence number.
-        ++lastSeqNum;
-        for(; lastSeqNum < sequence_number; ++lastSeqNum)
+        uint32_t first = count_;
+        uint32_t last = count_ + static_cast<uint32_t>(sequence_number.to64long() - lastSeqNum.to64long() - 1);
+        reserve_changes(last);
+        count_ = last;
+
+        std::vector<uint64_t>* bits = status_bits(default_status);
+        if(bits != nullptr)
         {
-            ChangeFromWriter_t newch(lastSeqNum);
-            newch.setStatus(default_status);
-            m_changesFromW.insert(m_changesFromW.end(), newch);
+            for_each_word(first, last, [bits](uint32_t word, uint64_t mask, uint32_t)
+                    {
+                        (*bits)[word] |= mask;
+                        return true;
+                    });
         }
+
+        if(default_status == MISSING)
+            missing_count_ += last - first;
     }
 
     return returnedValue;
@@ -202,21 +309,17 @@ bool WriterProxy::lost_changes_update(const SequenceNumber_t& seqNum)
     // Check was not removed from container.
     if(seqNum > changesFromWLowMark_)
     {
-        if(m_changesFromW.size() == 0 || m_changesFromW.rbegin()->getSequenceNumber() < seqNum)
+        if(count_ == 0 || changesFromWLowMark_ + count_ < seqNum)
         {
             // Remove all because lost or received.
-            m_changesFromW.clear();
+            remove_first_changes(count_);
             // Any in container, then not insert new lost.
             changesFromWLowMark_ = seqNum - 1;
         }
         else
         {
-            // Find it. Must be there.
-            auto last_it = m_changesFromW.find(ChangeFromWriter_t(seqNum));
-            assert(last_it != m_changesFromW.end());
-            for_each_set_status_from_and_maybe_remove(m_changesFromW.begin(), last_it,
-                    ChangeFromWriterStatus_t::UNKNOWN, ChangeFromWriterStatus_t::MISSING,
-                    ChangeFromWriterStatus_t::LOST);
+            // All changes before it become LOST or were RECEIVED, so they are removed.
+            remove_first_changes(static_cast<uint32_t>(seqNum.to64long() - changesFromWLowMark_.to64long() - 1));
             // Next could need to be removed.
             cleanup();
         }
@@ -251,19 +354,19 @@ bool WriterProxy::received_change_set(const SequenceNumber_t& seqNum, bool is_re
         return false;
     }
 
-    // Maybe create information because it is not in the m_changesFromW container.
+    // Maybe create information because it is not in the container.
     bool will_be_the_last = maybe_add_changes_from_writer_up_to(seqNum);
 
     // If will be the last element, insert it at the end.
     if(will_be_the_last)
     {
         // There are others.
-        if(m_changesFromW.size() > 0)
+        if(count_ > 0)
         {
             ChangeFromWriter_t chfw(seqNum);
             chfw.setStatus(RECEIVED);
             chfw.setRelevance(is_relevance);
-            m_changesFromW.insert(m_changesFromW.end(), chfw);
+            add_change_from_writer(chfw);
         }
         // Else not insert
         else
@@ -272,31 +375,25 @@ bool WriterProxy::received_change_set(const SequenceNumber_t& seqNum, bool is_re
     // Else it has to be found and change state.
     else
     {
-        auto chit = m_changesFromW.find(ChangeFromWriter_t(seqNum));
-
-        // Has to be in the container.
-        assert(chit != m_changesFromW.end());
+        uint32_t position = position_of(seqNum);
 
-        if(chit != m_changesFromW.begin())
+        if(position != head_)
         {
-            if(chit->getStatus() != RECEIVED)
+            if(status_at(position) != RECEIVED)
             {
-                ChangeFromWriter_t newch(*chit);
-                newch.setStatus(RECEIVED);
-                newch.setRelevance(is_relevance);
-
-                auto hint = m_changesFromW.erase(chit);
-
-                m_changesFromW.insert(hint, newch);
+                set_status_at(position, RECEIVED);
+                if(is_relevance)
+                    irrelevant_bits_[position / 64] &= ~(uint64_t(1) << (position % 64));
+                else
+                    irrelevant_bits_[position / 64] |= uint64_t(1) << (position % 64);
             }
             else
                 return false;
         }
         else
         {
-            assert(chit->getStatus() != RECEIVED);
-            changesFromWLowMark_ = seqNum;
-            m_changesFromW.erase(chit);
+            assert(status_at(position) != RECEIVED);
+            remove_first_changes(1);
             cleanup();
         }
 
@@ -308,25 +405,40 @@ bool WriterProxy::received_change_set(const SequenceNumber_t& seqNum, bool is_re
 }
 
 
-const std::vector<ChangeFromWriter_t> WriterProxy::missing_changes()
+bool WriterProxy::missing_changes(SequenceNumberSet_t& sns)
 {
-    std::vector<ChangeFromWriter_t> returnedValue;
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
-    for(auto ch : m_changesFromW)
-    {
-        if(ch.getStatus() == MISSING)
-        {
-            // If MISSING, then is relevant.
-            assert(ch.isRelevant());
-            returnedValue.push_back(ch);
-        }
-    }
+    sns = SequenceNumberSet_t();
+    sns.base = changesFromWLowMark_ + 1;
 
+    if(missing_count_ == 0)
+        return false;
 
-    //print_changes_fromWriter_test2();
+    uint32_t added = 0;
+    for_each_word(0, std::min(count_, NumberSetBitmap::max_bits),
+            [this, &sns, &added](uint32_t word, uint64_t mask, uint32_t offset)
+            {
+                uint64_t missing = missing_bits_[word] & mask;
+                offset -= lowest_bit(mask);
 
-    return returnedValue;
+                while(missing != 0)
+                {
+                    sns.add(sns.base + (offset + lowest_bit(missing)));
+                    missing &= missing - 1;
+                    ++added;
+                }
+
+                return true;
+            });
+
+    if(added < missing_count_)
+    {
+        logInfo(RTPS_READER, missing_count_ - added << " missing changes exceeded bitmap limit of AckNack. SeqNumSet Base: "
+                << sns.base);
+    }
+
+    return true;
 }
 
 bool WriterProxy::change_was_received(const SequenceNumber_t& seq_num)
@@ -336,12 +448,10 @@ bool WriterProxy::change_was_received(const SequenceNumber_t& seq_num)
     if(seq_num <= changesFromWLowMark_)
         return true;
 
-    auto chit = m_changesFromW.find(ChangeFromWriter_t(seq_num));
-
-    if(chit != m_changesFromW.end() && chit->getStatus() == RECEIVED)
-        return true;
+    if(seq_num > changesFromWLowMark_ + count_)
+        return false;
 
-    return false;
+    return status_at(position_of(seq_num)) == RECEIVED;
 }
 
 const SequenceNumber_t WriterProxy::available_changes_max() const
@@ -355,9 +465,10 @@ void WriterProxy::print_changes_fromWriter_test2()
     std::stringstream ss;
     ss << this->m_att.guid.entityId<<": ";
 
-    for(auto it = m_changesFromW.begin(); it != m_changesFromW.end(); ++it)
+    for(SequenceNumber_t seq = changesFromWLowMark_ + 1; seq <= changesFromWLowMark_ + count_; ++seq)
     {
-        ss << it->getSequenceNumber() <<"("<<it->isRelevant()<<","<<it->getStatus()<<")-";
+        ChangeFromWriter_t change = change_from_writer(seq);
+        ss << change.getSequenceNumber() <<"("<<change.isRelevant()<<","<<change.getStatus()<<")-";
     }
 
     std::string auxstr = ss.str();
@@ -385,52 +496,44 @@ void WriterProxy::setNotValid(const SequenceNumber_t& seqNum)
     if(seqNum <= changesFromWLowMark_)
         return;
 
-    auto chit = m_changesFromW.find(ChangeFromWriter_t(seqNum));
-
     // Element must be in the container. In other case, bug.
-    assert(chit != m_changesFromW.end());
+    assert(seqNum <= changesFromWLowMark_ + count_);
+    uint32_t position = position_of(seqNum);
     // If the element will be set not valid, element must be received.
     // In other case, bug.
-    assert(chit->getStatus() == RECEIVED);
+    assert(status_at(position) == RECEIVED);
 
     // Cannot be in the beginning because process of cleanup
-    assert(chit != m_changesFromW.begin());
-
-    ChangeFromWriter_t newch(*chit);
-    newch.notValid();
-
-    auto hint = m_changesFromW.erase(chit);
+    assert(position != head_);
 
-    m_changesFromW.insert(hint, newch);
+    irrelevant_bits_[position / 64] |= uint64_t(1) << (position % 64);
 }
 
 void WriterProxy::cleanup()
 {
-    auto chit = m_changesFromW.begin();
+    // Remove the RECEIVED or LOST changes at the beginning.
+    uint32_t count = count_;
 
-    while(chit != m_changesFromW.end() &&
-            (chit->getStatus() == RECEIVED || chit->getStatus() == LOST))
-    {
-        changesFromWLowMark_ = chit->getSequenceNumber();
-        chit = m_changesFromW.erase(chit);
-    }
+    for_each_word(0, count_, [this, &count](uint32_t word, uint64_t mask, uint32_t offset)
+            {
+                uint64_t pending = mask & ~(received_bits_[word] | lost_bits_[word]);
+
+                if(pending != 0)
+                {
+                    count = offset + lowest_bit(pending) - lowest_bit(mask);
+                    return false;
+                }
+
+                return true;
+            });
+
+    remove_first_changes(count);
 }
 
 bool WriterProxy::areThereMissing()
 {
-    bool returnedValue = false;
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-
-    for(auto ch : m_changesFromW)
-    {
-        if(ch.getStatus() == ChangeFromWriterStatus_t::MISSING)
-        {
-            returnedValue = true;
-            break;
-        }
-    }
-
-    return returnedValue;
+    return missing_count_ != 0;
 }
 
 size_t WriterProxy::unknown_missing_changes_up_to(const SequenceNumber_t& seqNum)
@@ -440,12 +543,14 @@ size_t WriterProxy::unknown_missing_changes_up_to(const SequenceNumber_t& seqNum
 
     if(seqNum > changesFromWLowMark_)
     {
-        for(auto ch = m_changesFromW.begin(); ch != m_changesFromW.end() && ch->getSequenceNumber() < seqNum; ++ch)
-        {
-            if(ch->getStatus() == ChangeFromWriterStatus_t::UNKNOWN ||
-                    ch->getStatus() == ChangeFromWriterStatus_t::MISSING)
-                ++returnedValue;
-        }
+        uint32_t count = static_cast<uint32_t>(std::min<int64_t>(count_,
+                    seqNum.to64long() - changesFromWLowMark_.to64long() - 1));
+
+        for_each_word(0, count, [this, &returnedValue](uint32_t word, uint64_t mask, uint32_t)
+                {
+                    returnedValue += bit_count(mask & ~(received_bits_[word] | lost_bits_[word]));
+                    return true;
+                });
     }
 
     return returnedValue;
@@ -454,7 +559,7 @@ size_t WriterProxy::unknown_missing_changes_up_to(const SequenceNumber_t& seqNum
 size_t WriterProxy::numberOfChangeFromWriter() const
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-    return m_changesFromW.size();
+    return count_;
 }
 
 SequenceNumber_t WriterProxy::nextCacheChangeToBeNotified()
@@ -469,3 +574,73 @@ SequenceNumber_t WriterProxy::nextCacheChangeToBeNotified()
 
     return SequenceNumber_t::unknown();
 }
+
+size_t WriterProxy::history_change_position(const SequenceNumber_t& seqNum) const
+{
+    size_t first = 0, last = history_changes_.size();
+
+    while(first < last)
+    {
+        size_t middle = first + (last - first) / 2;
+
+        if(history_changes_[middle]->sequenceNumber < seqNum)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    return first;
+}
+
+void WriterProxy::history_change_added(CacheChange_t* change)
+{
+    // Changes are usually received in order.
+    size_t position = history_changes_.size();
+
+    if(position > 0 && change->sequenceNumber < history_changes_.back()->sequenceNumber)
+        position = history_change_position(change->sequenceNumber);
+
+    history_changes_.insert(position, change);
+
+    if(position < first_unread_change_)
+        first_unread_change_ = position;
+}
+
+void WriterProxy::history_change_removed(CacheChange_t* change)
+{
+    // Changes are usually taken in order.
+    size_t position = 0;
+
+    if(history_changes_.empty() || history_changes_.front() != change)
+    {
+        position = history_change_position(change->sequenceNumber);
+
+        if(position == history_changes_.size() || history_changes_[position] != change)
+            return;
+    }
+
+    history_changes_.erase(position);
+
+    if(position < first_unread_change_)
+        --first_unread_change_;
+}
+
+CacheChange_t* WriterProxy::next_available_change()
+{
+    if(!history_changes_.empty() && history_changes_.front()->sequenceNumber <= available_changes_max())
+        return history_changes_.front();
+
+    return nullptr;
+}
+
+CacheChange_t* WriterProxy::next_unread_available_change()
+{
+    while(first_unread_change_ < history_changes_.size() && history_changes_[first_unread_change_]->isRead)
+        ++first_unread_change_;
+
+    if(first_unread_change_ < history_changes_.size() &&
+            history_changes_[first_unread_change_]->sequenceNumber <= available_changes_max())
+        return history_changes_[first_unread_change_];
+
+    return nullptr;
+}
@@ -62,7 +62,8 @@ void HeartbeatResponseDelay::event(EventCode code, const char* msg)
         // Protect reader
         std::lock_guard<std::recursive_mutex> guard(*mp_WP->mp_SFR->getMutex());
 
-        const std::vector<ChangeFromWriter_t> missing_changes = mp_WP->missing_changes();
+        SequenceNumberSet_t missing_changes;
+        bool are_there_missing = mp_WP->missing_changes(missing_changes);
         // Stores missing changes but there is some fragments received.
         std::vector<CacheChange_t*> uncompleted_changes;
 
@@ -70,29 +71,20 @@ void HeartbeatResponseDelay::event(EventCode code, const char* msg)
         LocatorList_t locators(mp_WP->m_att.endpoint.unicastLocatorList);
         locators.push_back(mp_WP->m_att.endpoint.multicastLocatorList);
 
-        if(!missing_changes.empty() || !mp_WP->m_heartbeatFinalFlag)
+        if(are_there_missing || !mp_WP->m_heartbeatFinalFlag)
         {
             SequenceNumberSet_t sns;
-            sns.base = mp_WP->available_changes_max();
-            sns.base++;
+            sns.base = missing_changes.base;
 
-            for(auto ch : missing_changes)
+            for(auto seq = missing_changes.get_begin(); seq != missing_changes.get_end(); ++seq)
             {
                 // Check if the CacheChange_t is uncompleted.
-                CacheChange_t* uncomplete_change = mp_WP->mp_SFR->findCacheInFragmentedCachePitStop(ch.getSequenceNumber(), mp_WP->m_att.guid);
+                CacheChange_t* uncomplete_change = mp_WP->mp_SFR->findCacheInFragmentedCachePitStop(*seq, mp_WP->m_att.guid);
 
                 if(uncomplete_change == nullptr)
-                {
-                    if(!sns.add(ch.getSequenceNumber()))
-                    {
-                        logInfo(RTPS_READER,"Sequence number " << ch.getSequenceNumber()
-                                << " exceeded bitmap limit of AckNack. SeqNumSet Base: " << sns.base);
-                    }
-                }
+                    sns.add(*seq);
                 else
-                {
                     uncompleted_changes.push_back(uncomplete_change);
-                }
             }
 
             // TODO Protect
@@ -130,11 +122,11 @@ void HeartbeatResponseDelay::event(EventCode code, const char* msg)
                 // Store FragmentNumberSet_t base.
                 frag_sns.base = frag_num;
 
-                // Fill the FragmentNumberSet_t bitmap.
+                // Fill the FragmentNumberSet_t bitmap. The rest of fragments will be asked in next NACK_FRAGs.
                 for(; fit != cit->getDataFragments()->end(); ++fit)
                 {
-                    if(*fit == ChangeFragmentStatus_t::NOT_PRESENT)
-                        frag_sns.add(frag_num);
+                    if(*fit == ChangeFragmentStatus_t::NOT_PRESENT && !frag_sns.add(frag_num))
+                        break;
 
                     ++frag_num;
                 }
@@ -23,6 +23,7 @@
 #include <fastrtps/log/Log.h>
 #include "../participant/RTPSParticipantImpl.h"
 #include "../flowcontrol/FlowController.h"
+#include "../reader/LocalReaderRegistry.h"
 
 #include <mutex>
 
@@ -157,3 +158,17 @@ uint32_t RTPSWriter::calculateMaxDataSize(uint32_t length)
 
     return maxDataSize;
 }
+
+bool RTPSWriter::is_local_reader(const GUID_t& reader_guid)
+{
+    if(!mp_RTPSParticipant->getRTPSParticipantAttributes().useIntraprocessDelivery)
+        return false;
+
+#if HAVE_SECURITY
+    // Protected data has to be encoded for the reader.
+    if(mp_RTPSParticipant->is_rtps_protected() || is_submessage_protected() || is_payload_protected())
+        return false;
+#endif
+
+    return LocalReaderRegistry::contains(reader_guid);
+}
@@ -26,6 +26,7 @@
 #include <fastrtps/rtps/writer/timedevent/InitialHeartbeat.h>
 #include <fastrtps/log/Log.h>
 #include <fastrtps/rtps/resources/AsyncWriterThread.h>
+#include <fastrtps/utils/BitOperations.h>
 
 #include <mutex>
 
@@ -37,8 +38,11 @@ using namespace eprosima::fastrtps::rtps;
 ReaderProxy::ReaderProxy(RemoteReaderAttributes& rdata,const WriterTimes& times,StatefulWriter* SW) :
     m_att(rdata), mp_SFW(SW),
     mp_nackResponse(nullptr), mp_nackSupression(nullptr), mp_initialHeartbeat(nullptr), m_lastAcknackCount(0),
-    mp_mutex(new std::recursive_mutex()), lastNackfragCount_(0)
+    mp_mutex(new std::recursive_mutex()), lastNackfragCount_(0), head_(0), count_(0), isLocal_(false)
 {
+    for(uint32_t status = 0; status < c_status_count; ++status)
+        status_count_[status] = 0;
+
     if(rdata.endpoint.reliabilityKind == RELIABLE)
     {
         mp_nackResponse = new NackResponseDelay(this,TimeConv::Time_t2MilliSecondsDouble(times.nackResponseDelay));
@@ -77,22 +81,141 @@ void ReaderProxy::destroy_timers()
     }
 }
 
+namespace
+{
+    //! Minimum capacity of the ring of changes. It must be a power of two multiple of 64.
+    const uint32_t c_min_changes_capacity = 64;
+}
+
+ChangeForReader_t* ReaderProxy::find_change(const SequenceNumber_t& seq_num, uint32_t& offset)
+{
+    if(count_ == 0)
+        return nullptr;
+
+    const SequenceNumber_t first = change_at(0).getSequenceNumber();
+
+    if(seq_num < first || seq_num > change_at(count_ - 1).getSequenceNumber())
+        return nullptr;
+
+    // Without holes the offset is the distance to the first change. Holes can only move the change closer.
+    uint64_t distance = static_cast<uint64_t>(seq_num.to64long() - first.to64long());
+    uint32_t high = distance < count_ ? static_cast<uint32_t>(distance) : count_ - 1;
+
+    if(change_at(high).getSequenceNumber() == seq_num)
+    {
+        offset = high;
+        return &change_at(high);
+    }
+
+    uint32_t low = 0;
+    while(low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if(change_at(middle).getSequenceNumber() < seq_num)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if(change_at(low).getSequenceNumber() != seq_num)
+        return nullptr;
+
+    offset = low;
+    return &change_at(low);
+}
+
+bool ReaderProxy::next_change_with_status(ChangeForReaderStatus_t status, uint32_t& offset) const
+{
+    const std::vector<uint64_t>& bits = status_bits_[status];
+    const uint32_t mask = static_cast<uint32_t>(m_changesForReader.size()) - 1;
+
+    while(offset < count_)
+    {
+        uint32_t position = (head_ + offset) & mask;
+        uint64_t word = bits[position / 64] >> (position % 64);
+
+        if(word != 0)
+        {
+            uint32_t found = offset + lowest_bit(word);
+            if(found >= count_)
+                return false;
+            offset = found;
+            return true;
+        }
+
+        offset += 64 - (position % 64);
+    }
+
+    return false;
+}
+
+void ReaderProxy::set_status(uint32_t offset, ChangeForReaderStatus_t status)
+{
+    uint32_t position = (head_ + offset) & (static_cast<uint32_t>(m_changesForReader.size()) - 1);
+    ChangeForReader_t& change = m_changesForReader[position];
+    uint64_t bit = uint64_t(1) << (position % 64);
+
+    status_bits_[change.getStatus()][position / 64] &= ~bit;
+    --status_count_[change.getStatus()];
+    status_bits_[status][position / 64] |= bit;
+    ++status_count_[status];
+    change.setStatus(status);
+}
+
+void ReaderProxy::remove_first_changes(uint32_t count)
+{
+    assert(count <= count_);
+    const uint32_t mask = static_cast<uint32_t>(m_changesForReader.size()) - 1;
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        ChangeForReader_t& change = m_changesForReader[head_];
+        status_bits_[change.getStatus()][head_ / 64] &= ~(uint64_t(1) << (head_ % 64));
+        --status_count_[change.getStatus()];
+        change = ChangeForReader_t();
+        head_ = (head_ + 1) & mask;
+    }
+
+    count_ -= count;
+}
+
 void ReaderProxy::addChange(const ChangeForReader_t& change)
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
     assert(change.getSequenceNumber() > changesFromRLowMark_);
-    assert(m_changesForReader.rbegin() != m_changesForReader.rend() ?
-            change.getSequenceNumber() > m_changesForReader.rbegin()->getSequenceNumber() :
+    assert(count_ != 0 ?
+            change.getSequenceNumber() > change_at(count_ - 1).getSequenceNumber() :
             true);
 
-    if(m_changesForReader.size() == 0 && change.getStatus() == ACKNOWLEDGED)
+    if(count_ == 0 && change.getStatus() == ACKNOWLEDGED)
     {
         changesFromRLowMark_ = change.getSequenceNumber();
         return;
     }
 
-    m_changesForReader.insert(change);
+    if(count_ == m_changesForReader.size())
+    {
+        // Grow the ring, moving the first change to the first position.
+        uint32_t capacity = count_ == 0 ? c_min_changes_capacity : count_ * 2;
+        std::vector<ChangeForReader_t> changes(capacity);
+        for(uint32_t offset = 0; offset < count_; ++offset)
+            changes[offset] = change_at(offset);
+        m_changesForReader.swap(changes);
+        head_ = 0;
+
+        for(uint32_t status = 0; status < c_status_count; ++status)
+            status_bits_[status].assign(capacity / 64, 0);
+        for(uint32_t offset = 0; offset < count_; ++offset)
+            status_bits_[m_changesForReader[offset].getStatus()][offset / 64] |= uint64_t(1) << (offset % 64);
+    }
+
+    uint32_t position = (head_ + count_) & (static_cast<uint32_t>(m_changesForReader.size()) - 1);
+    m_changesForReader[position] = change;
+    status_bits_[change.getStatus()][position / 64] |= uint64_t(1) << (position % 64);
+    ++status_count_[change.getStatus()];
+    ++count_;
+
     //TODO (Ricardo) Remove this functionality from here. It is not his place.
     if (change.getStatus() == UNSENT)
         AsyncWriterThread::wakeUp(mp_SFW);
@@ -101,7 +224,7 @@ void ReaderProxy::addChange(const ChangeForReader_t& change)
 size_t ReaderProxy::countChangesForReader() const
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-    return m_changesForReader.size();
+    return count_;
 }
 
 bool ReaderProxy::change_is_acked(const SequenceNumber_t& sequence_number)
@@ -111,10 +234,11 @@ bool ReaderProxy::change_is_acked(const SequenceNumber_t& sequence_number)
     if(sequence_number <= changesFromRLowMark_)
         return true;
 
-    auto chit = m_changesForReader.find(ChangeForReader_t(sequence_number));
-    assert(chit != m_changesForReader.end());
+    uint32_t offset = 0;
+    ChangeForReader_t* change = find_change(sequence_number, offset);
+    assert(change != nullptr);
 
-    return !chit->isRelevant() || chit->getStatus() == ACKNOWLEDGED;
+    return change == nullptr || !change->isRelevant() || change->getStatus() == ACKNOWLEDGED;
 }
 
 bool ReaderProxy::acked_changes_set(const SequenceNumber_t& seqNum)
@@ -123,33 +247,30 @@ bool ReaderProxy::acked_changes_set(const SequenceNumber_t& seqNum)
 
     if(seqNum > changesFromRLowMark_)
     {
-        auto chit = m_changesForReader.find(seqNum);
-        m_changesForReader.erase(m_changesForReader.begin(), chit);
+        uint32_t count = 0;
+        while(count < count_ && change_at(count).getSequenceNumber() < seqNum)
+            ++count;
+        remove_first_changes(count);
         changesFromRLowMark_ = seqNum - 1;
     }
 
-    return m_changesForReader.size() == 0;
+    return count_ == 0;
 }
 
-bool ReaderProxy::requested_changes_set(std::vector<SequenceNumber_t>& seqNumSet)
+bool ReaderProxy::requested_changes_set(const SequenceNumberSet_t& seqNumSet)
 {
     bool isSomeoneWasSetRequested = false;
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
-    for(std::vector<SequenceNumber_t>::iterator sit=seqNumSet.begin();sit!=seqNumSet.end();++sit)
+    for(auto sit = seqNumSet.get_begin(); sit != seqNumSet.get_end(); ++sit)
     {
-        auto chit = m_changesForReader.find(ChangeForReader_t(*sit));
+        uint32_t offset = 0;
+        ChangeForReader_t* change = find_change(*sit, offset);
 
-        if(chit != m_changesForReader.end() && chit->isValid())
+        if(change != nullptr && change->isValid())
         {
-            ChangeForReader_t newch(*chit);
-            newch.setStatus(REQUESTED);
-            newch.markAllFragmentsAsUnsent();
-
-            auto hint = m_changesForReader.erase(chit);
-
-            m_changesForReader.insert(hint, newch);
-
+            set_status(offset, REQUESTED);
+            change->markAllFragmentsAsUnsent();
             isSomeoneWasSetRequested = true;
         }
     }
@@ -170,9 +291,9 @@ std::vector<ChangeForReader_t*> ReaderProxy::get_unsent_changes()
     std::vector<ChangeForReader_t*> unsent_changes;
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
-    for(auto &change_for_reader : m_changesForReader)
-        if(change_for_reader.getStatus() == UNSENT)
-            unsent_changes.push_back(const_cast<ChangeForReader_t*>(&change_for_reader));
+    unsent_changes.reserve(status_count_[UNSENT]);
+    for(uint32_t offset = 0; next_change_with_status(UNSENT, offset); ++offset)
+        unsent_changes.push_back(&change_at(offset));
 
     return unsent_changes;
 }
@@ -182,10 +303,10 @@ std::vector<const ChangeForReader_t*> ReaderProxy::get_requested_changes() const
     std::vector<const ChangeForReader_t*> unsent_changes;
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
-    auto it = m_changesForReader.begin();
-    for (; it!= m_changesForReader.end(); ++it)
-        if(it->getStatus() == REQUESTED)
-            unsent_changes.push_back(&(*it));
+    const uint32_t mask = static_cast<uint32_t>(m_changesForReader.size()) - 1;
+    unsent_changes.reserve(status_count_[REQUESTED]);
+    for(uint32_t offset = 0; next_change_with_status(REQUESTED, offset); ++offset)
+        unsent_changes.push_back(&m_changesForReader[(head_ + offset) & mask]);
 
     return unsent_changes;
 }
@@ -195,23 +316,20 @@ void ReaderProxy::set_change_to_status(const SequenceNumber_t& seq_num, ChangeFo
     if(seq_num <= changesFromRLowMark_)
         return;
 
-    auto it = m_changesForReader.find(ChangeForReader_t(seq_num));
+    uint32_t offset = 0;
     bool mustWakeUpAsyncThread = false;
 
-    if(it != m_changesForReader.end())
+    if(find_change(seq_num, offset) != nullptr)
     {
-        if(status == ACKNOWLEDGED && it == m_changesForReader.begin())
+        if(status == ACKNOWLEDGED && offset == 0)
         {
-            m_changesForReader.erase(it);
+            remove_first_changes(1);
             changesFromRLowMark_ = seq_num;
         }
         else
         {
-            ChangeForReader_t newch(*it);
-            newch.setStatus(status);
+            set_status(offset, status);
             if (status == UNSENT) mustWakeUpAsyncThread = true;
-            auto hint = m_changesForReader.erase(it);
-            m_changesForReader.insert(hint, newch);
         }
     }
 
@@ -224,20 +342,18 @@ void ReaderProxy::mark_fragment_as_sent_for_change(const CacheChange_t* change,
     if(change->sequenceNumber <= changesFromRLowMark_)
         return;
 
-    auto it = m_changesForReader.find(ChangeForReader_t(change->sequenceNumber));
+    uint32_t offset = 0;
+    ChangeForReader_t* change_for_reader = find_change(change->sequenceNumber, offset);
 
     bool mustWakeUpAsyncThread = false; 
 
-    if(it != m_changesForReader.end())
+    if(change_for_reader != nullptr)
     {
-        ChangeForReader_t newch(*it);
-        newch.markFragmentsAsSent(fragment);
-        if (newch.getUnsentFragments().isSetEmpty())
-            newch.setStatus(UNDERWAY); //TODO (Ricardo) Check
+        change_for_reader->markFragmentsAsSent(fragment);
+        if (change_for_reader->getUnsentFragments().empty())
+            set_status(offset, UNDERWAY); //TODO (Ricardo) Check
         else
             mustWakeUpAsyncThread = true;
-        auto hint = m_changesForReader.erase(it);
-        m_changesForReader.insert(hint, newch);
     }
 
     if (mustWakeUpAsyncThread)
@@ -249,36 +365,38 @@ void ReaderProxy::convert_status_on_all_changes(ChangeForReaderStatus_t previous
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
     bool mustWakeUpAsyncThread = false;
 
-    auto it = m_changesForReader.begin();
-    while(it != m_changesForReader.end())
+    uint32_t offset = 0;
+    while(next_change_with_status(previous, offset))
     {
-        if(it->getStatus() == previous)
+        if(next == ACKNOWLEDGED && offset == 0)
         {
-            if(next == ACKNOWLEDGED && it == m_changesForReader.begin())
-            {
-                changesFromRLowMark_ = it->getSequenceNumber();
-                it = m_changesForReader.erase(it);
-                continue;
-            }
-            else
-            {
-                ChangeForReader_t newch(*it);
-                newch.setStatus(next);
-                if (next == UNSENT && previous != UNSENT)
-                    mustWakeUpAsyncThread = true;
-                auto hint = m_changesForReader.erase(it);
-
-                it = m_changesForReader.insert(hint, newch);
-            }
+            // The next change becomes the first one, at the same offset.
+            changesFromRLowMark_ = change_at(0).getSequenceNumber();
+            remove_first_changes(1);
+            continue;
         }
 
-        ++it;
+        if (previous == REQUESTED && next == UNSENT && lastRepairSequenceNumber_ < change_at(offset).getSequenceNumber())
+            lastRepairSequenceNumber_ = change_at(offset).getSequenceNumber();
+
+        set_status(offset, next);
+        if (next == UNSENT && previous != UNSENT)
+            mustWakeUpAsyncThread = true;
+        ++offset;
     }
 
     if (mustWakeUpAsyncThread)
         AsyncWriterThread::wakeUp(mp_SFW);
 }
 
+const LocatorList_t& ReaderProxy::directed_locators()
+{
+    if(m_att.endpoint.unicastLocatorList.empty())
+        return m_att.endpoint.multicastLocatorList;
+
+    return m_att.endpoint.unicastLocatorList;
+}
+
 //TODO(Ricardo)
 //void ReaderProxy::setNotValid(const CacheChange_t* change)
 void ReaderProxy::setNotValid(CacheChange_t* change)
@@ -286,58 +404,31 @@ void ReaderProxy::setNotValid(CacheChange_t* change)
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
     // Check sequence number is in the container, because it was not clean up.
-    if(m_changesForReader.size() == 0 || change->sequenceNumber < m_changesForReader.begin()->getSequenceNumber())
+    if(count_ == 0 || change->sequenceNumber < change_at(0).getSequenceNumber())
         return;
 
-    auto chit = m_changesForReader.find(ChangeForReader_t(change));
+    uint32_t offset = 0;
+    ChangeForReader_t* change_for_reader = find_change(change->sequenceNumber, offset);
 
     // Element must be in the container. In other case, bug.
-    assert(chit != m_changesForReader.end());
-
-    if(chit == m_changesForReader.begin())
-    {
-        assert(chit->getStatus() != ACKNOWLEDGED);
-
-        // if it is the first element, set state to unacknowledge because from now reader has to confirm
-        // it will not be expecting it.
-        ChangeForReader_t newch(*chit);
-        newch.setStatus(UNACKNOWLEDGED);
-        newch.notValid();
-
-        auto hint = m_changesForReader.erase(chit);
-
-        m_changesForReader.insert(hint, newch);
-    }
-    else
-    {
-        // In case its state is not ACKNOWLEDGED, set it to UNACKNOWLEDGE because from now reader has to confirm
-        // it will not be expecting it.
-        ChangeForReader_t newch(*chit);
-        if (chit->getStatus() != ACKNOWLEDGED)
-            newch.setStatus(UNACKNOWLEDGED);
-        newch.notValid();
+    assert(change_for_reader != nullptr);
+    if(change_for_reader == nullptr)
+        return;
 
-        auto hint = m_changesForReader.erase(chit);
+    // The first element is never ACKNOWLEDGED, because it would have been removed.
+    assert(offset != 0 || change_for_reader->getStatus() != ACKNOWLEDGED);
 
-        m_changesForReader.insert(hint, newch);
-    }
+    // In case its state is not ACKNOWLEDGED, set it to UNACKNOWLEDGE because from now reader has to confirm
+    // it will not be expecting it.
+    if (change_for_reader->getStatus() != ACKNOWLEDGED)
+        set_status(offset, UNACKNOWLEDGED);
+    change_for_reader->notValid();
 }
 
 bool ReaderProxy::thereIsUnacknowledged() const
 {
-    bool returnedValue = false;
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-
-    for(auto it = m_changesForReader.begin(); it!=m_changesForReader.end(); ++it)
-    {
-        if(it->getStatus() == UNACKNOWLEDGED)
-        {
-            returnedValue = true;
-            break;
-        }
-    }
-
-    return returnedValue;
+    return status_count_[UNACKNOWLEDGED] != 0;
 }
 
 bool change_min(const ChangeForReader_t* ch1, const ChangeForReader_t* ch2)
@@ -363,20 +454,16 @@ bool ReaderProxy::requested_fragment_set(SequenceNumber_t sequence_number, const
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
     // Locate the outbound change referenced by the NACK_FRAG
-    auto changeIter = std::find_if(m_changesForReader.begin(), m_changesForReader.end(), 
-            [sequence_number](const ChangeForReader_t& change)
-            {return change.getSequenceNumber() == sequence_number;});
-    if (changeIter == m_changesForReader.end())
+    uint32_t offset = 0;
+    ChangeForReader_t* change = find_change(sequence_number, offset);
+    if (change == nullptr)
         return false;
 
-    ChangeForReader_t newch(*changeIter);
-    auto hint = m_changesForReader.erase(changeIter);
-    newch.markFragmentsAsUnsent(frag_set);
+    change->markFragmentsAsUnsent(frag_set);
 
     // If it was UNSENT, we shouldn't switch back to REQUESTED to prevent stalling.
-    if (newch.getStatus() != UNSENT)
-        newch.setStatus(REQUESTED);
-    m_changesForReader.insert(hint, newch);
+    if (change->getStatus() != UNSENT)
+        set_status(offset, REQUESTED);
 
     return true;
 }
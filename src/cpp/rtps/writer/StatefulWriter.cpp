@@ -23,6 +23,7 @@
 
 #include "../participant/RTPSParticipantImpl.h"
 #include "../flowcontrol/FlowController.h"
+#include "../reader/LocalReaderRegistry.h"
 
 #include <fastrtps/rtps/messages/RTPSMessageCreator.h>
 #include <fastrtps/rtps/messages/RTPSMessageGroup.h>
@@ -40,9 +41,29 @@
 #include <fastrtps/utils/TimeConversion.h>
 
 #include <mutex>
+#include <map>
+#include <set>
+#include <algorithm>
 
 using namespace eprosima::fastrtps::rtps;
 
+// Readers announcing multicast locators receive the changes sent for the first time through one of them, shared with
+// the other readers listening on it, so each change is sent once to all of them. The one already chosen for another
+// reader is preferred. Readers without multicast locators, and the repairs, gaps and heartbeats directed to a single
+// reader, use its directed locators.
+static LocatorList_t data_locator(ReaderProxy* proxy, LocatorList_t& chosen)
+{
+    LocatorList_t& multicast = proxy->m_att.endpoint.multicastLocatorList;
+    if(multicast.empty())
+        return proxy->directed_locators();
+
+    LocatorList_t locator;
+    auto shared = std::find_if(multicast.begin(), multicast.end(),
+            [&chosen](const Locator_t& candidate) { return chosen.contains(candidate); });
+    locator.push_back(shared != multicast.end() ? *shared : *multicast.begin());
+    return locator;
+}
+
 
 StatefulWriter::StatefulWriter(RTPSParticipantImpl* pimpl,GUID_t& guid,
         WriterAttributes& att,WriterHistory* hist,WriterListener* listen):
@@ -127,24 +148,32 @@ void StatefulWriter::unsent_change_added_to_history(CacheChange_t* change)
                 else
                     changeForReader.setStatus(UNACKNOWLEDGED);
 
+                // Readers of this process take the change directly.
+                bool delivered = (*it)->isLocal() && LocalReaderRegistry::deliver((*it)->m_att.guid, *change);
+
                 (*it)->mp_mutex->lock();
                 changeForReader.setRelevance((*it)->rtps_is_relevant(change));
                 (*it)->addChange(changeForReader);
-                locators.push_back((*it)->m_att.endpoint.unicastLocatorList);
-                locators.push_back((*it)->m_att.endpoint.multicastLocatorList);
-                expectsInlineQos |= (*it)->m_att.expectsInlineQos;
-                remote_participants.push_back((*it)->m_att.guid.guidPrefix);
-                remote_readers.push_back((*it)->m_att.guid);
+                if(!delivered)
+                {
+                    locators.push_back(data_locator(*it, locators));
+                    expectsInlineQos |= (*it)->m_att.expectsInlineQos;
+                    remote_participants.push_back((*it)->m_att.guid.guidPrefix);
+                    remote_readers.push_back((*it)->m_att.guid);
+                }
                 (*it)->mp_mutex->unlock();
 
                 if((*it)->mp_nackSupression != nullptr) // It is reliable
                     (*it)->mp_nackSupression->restart_timer();
             }
 
-            RTPSMessageGroup group(mp_RTPSParticipant, this,  RTPSMessageGroup::WRITER, m_cdrmessages);
-            if(!group.add_data(*change, remote_readers, locators, expectsInlineQos))
+            if(!remote_readers.empty())
             {
-                logError(RTPS_WRITER, "Error sending change " << change->sequenceNumber);
+                RTPSMessageGroup group(mp_RTPSParticipant, this,  RTPSMessageGroup::WRITER, m_cdrmessages);
+                if(!group.add_data(*change, remote_readers, locators, expectsInlineQos))
+                {
+                    logError(RTPS_WRITER, "Error sending change " << change->sequenceNumber);
+                }
             }
 
             this->mp_periodicHB->restart_timer();
@@ -208,6 +237,21 @@ void StatefulWriter::send_any_unsent_changes()
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
+    // Readers are grouped by destination, so that a change is sent once to all the readers sharing it.
+    std::vector<DestinationGroup> destinations;
+    LocatorList_t multicast_locators;
+    auto destination_for = [&destinations](const LocatorList_t& locators) -> DestinationGroup&
+    {
+        auto destination = std::find_if(destinations.begin(), destinations.end(),
+                [&locators](const DestinationGroup& group) { return group.locators == locators; });
+        if(destination != destinations.end())
+            return *destination;
+
+        destinations.emplace_back();
+        destinations.back().locators = locators;
+        return destinations.back();
+    };
+
     // TODO(Ricardo) Change this while when implement Collector class.
     // Collector needs to know about fragments too.
     m_readers_to_walk = matched_readers.size();
@@ -235,9 +279,9 @@ void StatefulWriter::send_any_unsent_changes()
                 {
                     (*cit)->getChange()->getDataFragments()->assign((*cit)->getChange()->getDataFragments()->size(),
                             NOT_PRESENT);
-                    FragmentNumberSet_t frag_sns = (*cit)->getUnsentFragments();
+                    const std::set<FragmentNumber_t>& frag_sns = (*cit)->getUnsentFragments();
 
-                    for(auto sn = frag_sns.get_begin(); sn != frag_sns.get_end(); ++sn)
+                    for(auto sn = frag_sns.begin(); sn != frag_sns.end(); ++sn)
                     {
                         assert(*sn <= (*cit)->getChange()->getDataFragments()->size());
                         (*cit)->getChange()->getDataFragments()->at(*sn - 1) = PRESENT;
@@ -253,6 +297,26 @@ void StatefulWriter::send_any_unsent_changes()
 
         if(m_pushMode)
         {
+            // Readers of this process take the changes directly. They don't consume bandwidth,
+            // so flow controllers don't apply to them.
+            if((*m_reader_iterator)->isLocal())
+            {
+                auto cit = relevant_changes.begin();
+                for(; cit != relevant_changes.end(); ++cit)
+                {
+                    if(!LocalReaderRegistry::deliver((*m_reader_iterator)->m_att.guid, **cit))
+                        break;
+
+                    if((*m_reader_iterator)->m_att.endpoint.reliabilityKind == RELIABLE)
+                        (*m_reader_iterator)->set_change_to_status((*cit)->sequenceNumber, UNDERWAY);
+                    else
+                        (*m_reader_iterator)->set_change_to_status((*cit)->sequenceNumber, ACKNOWLEDGED);
+                }
+
+                // The reader is being removed. Remaining changes go through the network.
+                relevant_changes.erase(relevant_changes.begin(), cit);
+            }
+
             // Clear all relevant changes through the local controllers first
             for (auto& controller : m_controllers)
                 (*controller)(relevant_changes);
@@ -261,61 +325,55 @@ void StatefulWriter::send_any_unsent_changes()
             for (auto& controller : mp_RTPSParticipant->getFlowControllers())
                 (*controller)(relevant_changes);
 
-            // TODO Temporal
-            LocatorList_t locators((*m_reader_iterator)->m_att.endpoint.unicastLocatorList);
-            locators.push_back((*m_reader_iterator)->m_att.endpoint.multicastLocatorList);
-
-            RTPSMessageGroup group(mp_RTPSParticipant, this,  RTPSMessageGroup::WRITER, m_cdrmessages);
-
-            if(!relevant_changes.empty())
+            if(!relevant_changes.empty() || !not_relevant_changes.empty())
             {
-                //TODO (Ricardo) Temporal.
-                std::vector<GuidPrefix_t> remote_participants{(*m_reader_iterator)->m_att.guid.guidPrefix};
-                std::vector<GUID_t> remote_readers{(*m_reader_iterator)->m_att.guid};
+                ReaderSendState state;
+                state.proxy = *m_reader_iterator;
+                state.gaps.swap(not_relevant_changes);
 
                 for (auto* change : relevant_changes)
                 {
-                    // TODO(Ricardo) Flowcontroller has to be used in RTPSMessageGroup. Study.
-                    // And controllers are notified about the changes being sent
-                    FlowController::NotifyControllersChangeSent(change);
-
+                    // The fragments selected for this reader are kept, as the next reader overwrites them.
+                    std::vector<uint32_t>& fragments = state.changes[change];
                     if(change->getFragmentSize() != 0)
                     {
                         for(uint32_t fragment  = 0; fragment < change->getDataFragments()->size(); ++fragment)
                         {
                             if(change->getDataFragments()->at(fragment) == PRESENT)
-                            {
-                                if(group.add_data_frag(*change, fragment+1, remote_readers,
-                                            locators, (*m_reader_iterator)->m_att.expectsInlineQos))
-                                    (*m_reader_iterator)->mark_fragment_as_sent_for_change(change, fragment + 1);
-                                else
-                                {
-                                    logError(RTPS_WRITER, "Error sending fragment (" << change->sequenceNumber <<
-                                            ", " << fragment + 1 << ")");
-                                }
-                            }
+                                fragments.push_back(fragment + 1);
                         }
                     }
-                    else
+                }
+
+                // Repairs and gaps only go to this reader.
+                ReaderSendState directed;
+                directed.proxy = state.proxy;
+                directed.gaps.swap(state.gaps);
+                if(!state.proxy->m_att.endpoint.multicastLocatorList.empty())
+                {
+                    for(auto it = state.changes.begin(); it != state.changes.end();)
                     {
-                        if(group.add_data(*change, remote_readers,
-                                locators, (*m_reader_iterator)->m_att.expectsInlineQos))
+                        if(state.proxy->is_repair(it->first->sequenceNumber))
                         {
-                            if((*m_reader_iterator)->m_att.endpoint.reliabilityKind == RELIABLE)
-                                (*m_reader_iterator)->set_change_to_status(change->sequenceNumber, UNDERWAY);
-                            else
-                                (*m_reader_iterator)->set_change_to_status(change->sequenceNumber, ACKNOWLEDGED);
+                            directed.changes.insert(std::move(*it));
+                            it = state.changes.erase(it);
                         }
                         else
-                        {
-                            logError(RTPS_WRITER, "Error sending change " << change->sequenceNumber);
-                        }
+                            ++it;
                     }
                 }
-            }
 
-            if(!not_relevant_changes.empty())
-                group.add_gap(not_relevant_changes, (*m_reader_iterator)->m_att.guid, locators);
+                if(!state.changes.empty())
+                {
+                    LocatorList_t locators = data_locator(state.proxy, multicast_locators);
+                    if(!state.proxy->m_att.endpoint.multicastLocatorList.empty())
+                        multicast_locators.push_back(locators);
+                    destination_for(locators).readers.push_back(std::move(state));
+                }
+
+                if(!directed.changes.empty() || !directed.gaps.empty())
+                    destination_for(directed.proxy->directed_locators()).readers.push_back(std::move(directed));
+            }
 
             if((*m_reader_iterator)->m_att.endpoint.reliabilityKind == RELIABLE)
             {
@@ -334,8 +392,7 @@ void StatefulWriter::send_any_unsent_changes()
             SequenceNumber_t firstSeq = this->get_seq_num_min();
             SequenceNumber_t lastSeq = this->get_seq_num_max();
 
-            LocatorList_t locators((*m_reader_iterator)->m_att.endpoint.unicastLocatorList);
-            locators.push_back((*m_reader_iterator)->m_att.endpoint.multicastLocatorList);
+            const LocatorList_t& locators = (*m_reader_iterator)->directed_locators();
 
             if(firstSeq != c_SequenceNumber_Unknown && lastSeq != c_SequenceNumber_Unknown && lastSeq >= firstSeq)
             {
@@ -349,9 +406,122 @@ void StatefulWriter::send_any_unsent_changes()
         }
     }
 
+    if(!destinations.empty())
+    {
+        RTPSMessageGroup group(mp_RTPSParticipant, this, RTPSMessageGroup::WRITER, m_cdrmessages);
+
+        for(auto& destination : destinations)
+            send_to_destination(group, destination);
+    }
+
     logInfo(RTPS_WRITER, "Finish sending unsent changes");
 }
 
+void StatefulWriter::send_to_destination(RTPSMessageGroup& group, DestinationGroup& destination)
+{
+    // Every change is sent once, in order, addressed to the readers of the destination that need it.
+    std::map<SequenceNumber_t, CacheChange_t*> changes;
+    for(auto& reader : destination.readers)
+    {
+        for(auto& change : reader.changes)
+            changes[change.first->sequenceNumber] = change.first;
+    }
+
+    std::vector<ReaderSendState*> receivers;
+    std::vector<GUID_t> remote_readers;
+
+    for(auto& change_entry : changes)
+    {
+        CacheChange_t* change = change_entry.second;
+
+        // TODO(Ricardo) Flowcontroller has to be used in RTPSMessageGroup. Study.
+        // And controllers are notified about the changes being sent
+        FlowController::NotifyControllersChangeSent(change);
+
+        if(change->getFragmentSize() != 0)
+        {
+            std::set<uint32_t> fragments;
+            for(auto& reader : destination.readers)
+            {
+                auto it = reader.changes.find(change);
+                if(it != reader.changes.end())
+                    fragments.insert(it->second.begin(), it->second.end());
+            }
+
+            for(uint32_t fragment : fragments)
+            {
+                receivers.clear();
+                remote_readers.clear();
+                bool expectsInlineQos = false;
+
+                for(auto& reader : destination.readers)
+                {
+                    auto it = reader.changes.find(change);
+                    if(it != reader.changes.end() &&
+                            std::find(it->second.begin(), it->second.end(), fragment) != it->second.end())
+                    {
+                        receivers.push_back(&reader);
+                        remote_readers.push_back(reader.proxy->m_att.guid);
+                        expectsInlineQos |= reader.proxy->m_att.expectsInlineQos;
+                    }
+                }
+
+                if(group.add_data_frag(*change, fragment, remote_readers, destination.locators, expectsInlineQos))
+                {
+                    for(auto* reader : receivers)
+                    {
+                        std::lock_guard<std::recursive_mutex> rguard(*reader->proxy->mp_mutex);
+                        reader->proxy->mark_fragment_as_sent_for_change(change, fragment);
+                    }
+                }
+                else
+                {
+                    logError(RTPS_WRITER, "Error sending fragment (" << change->sequenceNumber <<
+                            ", " << fragment << ")");
+                }
+            }
+        }
+        else
+        {
+            receivers.clear();
+            remote_readers.clear();
+            bool expectsInlineQos = false;
+
+            for(auto& reader : destination.readers)
+            {
+                if(reader.changes.find(change) != reader.changes.end())
+                {
+                    receivers.push_back(&reader);
+                    remote_readers.push_back(reader.proxy->m_att.guid);
+                    expectsInlineQos |= reader.proxy->m_att.expectsInlineQos;
+                }
+            }
+
+            if(group.add_data(*change, remote_readers, destination.locators, expectsInlineQos))
+            {
+                for(auto* reader : receivers)
+                {
+                    std::lock_guard<std::recursive_mutex> rguard(*reader->proxy->mp_mutex);
+                    if(reader->proxy->m_att.endpoint.reliabilityKind == RELIABLE)
+                        reader->proxy->set_change_to_status(change->sequenceNumber, UNDERWAY);
+                    else
+                        reader->proxy->set_change_to_status(change->sequenceNumber, ACKNOWLEDGED);
+                }
+            }
+            else
+            {
+                logError(RTPS_WRITER, "Error sending change " << change->sequenceNumber);
+            }
+        }
+    }
+
+    for(auto& reader : destination.readers)
+    {
+        if(!reader.gaps.empty())
+            group.add_gap(reader.gaps, reader.proxy->m_att.guid, destination.locators);
+    }
+}
+
 
 /*
  *	MATCHED_READER-RELATED METHODS
@@ -377,6 +547,7 @@ bool StatefulWriter::matched_reader_add(RemoteReaderAttributes& rdata)
     }
 
     ReaderProxy* rp = new ReaderProxy(rdata,m_times,this);
+    rp->setLocal(is_local_reader(rdata.guid));
     std::vector<SequenceNumber_t> not_relevant_changes;
 
     for(std::vector<CacheChange_t*>::iterator cit = mp_history->changesBegin();
@@ -384,7 +555,7 @@ bool StatefulWriter::matched_reader_add(RemoteReaderAttributes& rdata)
     {
         ChangeForReader_t changeForReader(*cit);
 
-        if(rp->m_att.endpoint.durabilityKind >= TRANSIENT_LOCAL && this->getAttributes()->durabilityKind == TRANSIENT_LOCAL)
+        if(rp->m_att.endpoint.durabilityKind >= TRANSIENT_LOCAL && this->getAttributes()->durabilityKind >= TRANSIENT_LOCAL)
         {
             changeForReader.setRelevance(rp->rtps_is_relevant(*cit));
             if(!rp->rtps_is_relevant(*cit))
@@ -410,10 +581,7 @@ bool StatefulWriter::matched_reader_add(RemoteReaderAttributes& rdata)
     {
         RTPSMessageGroup group(mp_RTPSParticipant, this, RTPSMessageGroup::WRITER, m_cdrmessages);
         //TODO (Ricardo) Temporal
-        LocatorList_t locators(rp->m_att.endpoint.unicastLocatorList);
-        locators.push_back(rp->m_att.endpoint.multicastLocatorList);
-
-        group.add_gap(not_relevant_changes, rp->m_att.guid, locators);
+        group.add_gap(not_relevant_changes, rp->m_att.guid, rp->directed_locators());
     }
 
     // Always activate heartbeat period. We need a confirmation of the reader.
@@ -421,6 +589,7 @@ bool StatefulWriter::matched_reader_add(RemoteReaderAttributes& rdata)
     this->mp_periodicHB->restart_timer();
 
     matched_readers.push_back(rp);
+    matched_readers_by_guid_[rp->m_att.guid] = rp;
     // Invalidate persistent iterator
     m_reader_iterator = matched_readers.begin();
 
@@ -444,6 +613,7 @@ bool StatefulWriter::matched_reader_remove(RemoteReaderAttributes& rdata)
             logInfo(RTPS_WRITER, "Reader Proxy removed: " << (*it)->m_att.guid);
             rproxy = *it;
             matched_readers.erase(it);
+            matched_readers_by_guid_.erase(rdata.guid);
             // Invalidate persistent iterator
             m_reader_iterator = matched_readers.begin();
 
@@ -473,31 +643,18 @@ bool StatefulWriter::matched_reader_remove(RemoteReaderAttributes& rdata)
 bool StatefulWriter::matched_reader_is_matched(RemoteReaderAttributes& rdata)
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-    for(std::vector<ReaderProxy*>::iterator it=matched_readers.begin();it!=matched_readers.end();++it)
-    {
-        std::lock_guard<std::recursive_mutex> rguard(*(*it)->mp_mutex);
-        if((*it)->m_att.guid == rdata.guid)
-        {
-            return true;
-        }
-    }
-    return false;
+    return matched_readers_by_guid_.find(rdata.guid) != matched_readers_by_guid_.end();
 }
 
 bool StatefulWriter::matched_reader_lookup(GUID_t& readerGuid,ReaderProxy** RP)
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
-    std::vector<ReaderProxy*>::iterator it;
-    for(it=matched_readers.begin();it!=matched_readers.end();++it)
-    {
-        std::lock_guard<std::recursive_mutex> rguard(*(*it)->mp_mutex);
-        if((*it)->m_att.guid == readerGuid)
-        {
-            *RP = *it;
-            return true;
-        }
-    }
-    return false;
+    auto it = matched_readers_by_guid_.find(readerGuid);
+    if(it == matched_readers_by_guid_.end())
+        return false;
+
+    *RP = it->second;
+    return true;
 }
 
 bool StatefulWriter::is_acked_by_all(CacheChange_t* change)
@@ -691,12 +848,9 @@ void StatefulWriter::send_heartbeat_to(ReaderProxy& remoteReaderProxy)
 
     this->incrementHBCount();
 
-    LocatorList_t locators(remoteReaderProxy.m_att.endpoint.unicastLocatorList);
-    locators.push_back(remoteReaderProxy.m_att.endpoint.multicastLocatorList);
-
     // FinalFlag is always false because this is a StatefulWriter in Reliable.
     group.add_heartbeat(std::vector<GUID_t>{remoteReaderProxy.m_att.guid},
-            firstSeq, lastSeq, m_heartbeatCount, true, false, locators);
+            firstSeq, lastSeq, m_heartbeatCount, true, false, remoteReaderProxy.directed_locators());
 
     logInfo(RTPS_WRITER, m_guid.entityId << " Sending Heartbeat (" << firstSeq << " - " << lastSeq << ")");
 }
@@ -22,8 +22,10 @@
 #include <fastrtps/rtps/resources/AsyncWriterThread.h>
 #include "../participant/RTPSParticipantImpl.h"
 #include "../flowcontrol/FlowController.h"
+#include "../reader/LocalReaderRegistry.h"
 
 #include <mutex>
+#include <algorithm>
 
 #include <fastrtps/log/Log.h>
 
@@ -55,7 +57,8 @@ std::vector<GUID_t> StatelessWriter::get_remote_readers()
 #endif
     else
         for(auto& reader : m_matched_readers)
-            remote_readers.push_back(reader.guid);
+            if(m_local_readers.find(reader.guid) == m_local_readers.end())
+                remote_readers.push_back(reader.guid);
 
     return remote_readers;
 }
@@ -91,11 +94,16 @@ void StatelessWriter::unsent_change_added_to_history(CacheChange_t* cptr)
                 logError(RTPS_WRITER, "Error sending change " << cptr->sequenceNumber);
             }
         }
+
+        for(auto& local_reader : m_local_readers)
+            LocalReaderRegistry::deliver(local_reader.first, *cptr);
     }
     else
     {
         for(auto& reader_locator : reader_locators)
             reader_locator.unsent_changes.push_back(ChangeForReader_t(cptr));
+        for(auto& local_reader : m_local_readers)
+            local_reader.second.push_back(cptr);
         AsyncWriterThread::wakeUp(this);
     }
 }
@@ -115,6 +123,10 @@ bool StatelessWriter::change_removed_by_history(CacheChange_t* change)
                     }),
                     reader_locator.unsent_changes.end());
 
+    for(auto& local_reader : m_local_readers)
+        local_reader.second.erase(std::remove(local_reader.second.begin(), local_reader.second.end(), change),
+                local_reader.second.end());
+
     return true;
 }
 
@@ -134,10 +146,10 @@ void StatelessWriter::update_unsent_changes(ReaderLocator& reader_locator,
 
         if (change->getFragmentSize() != 0)
         {
-            FragmentNumberSet_t fragment_sns = it->getUnsentFragments();
+            std::set<FragmentNumber_t> fragment_sns = it->getUnsentFragments();
             // We remove the ones we are already sending.
-            auto frag_sn_it = fragment_sns.set.begin();
-            while(frag_sn_it != fragment_sns.set.end())
+            auto frag_sn_it = fragment_sns.begin();
+            while(frag_sn_it != fragment_sns.end())
             {
                 if(change->getDataFragments()->at(*frag_sn_it - 1) == PRESENT)
                 {
@@ -147,7 +159,7 @@ void StatelessWriter::update_unsent_changes(ReaderLocator& reader_locator,
                     break;
             }
 
-            if (frag_sn_it == fragment_sns.set.end())
+            if (frag_sn_it == fragment_sns.end())
                 reader_locator.unsent_changes.erase(it);
         }
         else
@@ -159,6 +171,15 @@ void StatelessWriter::send_any_unsent_changes()
 {
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
 
+    // Readers of this process take the changes directly. They don't consume bandwidth,
+    // so flow controllers don't apply to them.
+    for(auto& local_reader : m_local_readers)
+    {
+        for(auto* change : local_reader.second)
+            LocalReaderRegistry::deliver(local_reader.first, *change);
+        local_reader.second.clear();
+    }
+
     std::vector<GUID_t> remote_readers = get_remote_readers();
 
     for(auto& reader_locator : reader_locators)
@@ -174,9 +195,9 @@ void StatelessWriter::send_any_unsent_changes()
             {
                 cit->getChange()->getDataFragments()->assign(cit->getChange()->getDataFragments()->size(),
                         NOT_PRESENT);
-                FragmentNumberSet_t frag_sns = cit->getUnsentFragments();
+                const std::set<FragmentNumber_t>& frag_sns = cit->getUnsentFragments();
 
-                for(auto sn = frag_sns.get_begin(); sn != frag_sns.get_end(); ++sn)
+                for(auto sn = frag_sns.begin(); sn != frag_sns.end(); ++sn)
                 {
                     assert(*sn <= cit->getChange()->getDataFragments()->size());
                     cit->getChange()->getDataFragments()->at(*sn - 1) = PRESENT;
@@ -261,6 +282,23 @@ bool StatelessWriter::matched_reader_add(RemoteReaderAttributes& rdata)
             }
         }
     }
+
+    // Readers of this process don't need locators. Changes are handed directly to them.
+    if(is_local_reader(rdata.guid))
+    {
+        std::vector<CacheChange_t*>& pending = m_local_readers[rdata.guid];
+
+        if(rdata.endpoint.durabilityKind >= TRANSIENT_LOCAL)
+        {
+            pending.assign(mp_history->changesBegin(), mp_history->changesEnd());
+            AsyncWriterThread::wakeUp(this);
+        }
+
+        this->m_matched_readers.push_back(rdata);
+        logInfo(RTPS_READER,"Local reader " << rdata.guid << " added to "<<m_guid.entityId);
+        return true;
+    }
+
     bool send_any_unsent_changes = false;
     for(std::vector<Locator_t>::iterator lit = rdata.endpoint.unicastLocatorList.begin();
             lit!=rdata.endpoint.unicastLocatorList.end();++lit)
@@ -332,6 +370,11 @@ bool StatelessWriter::matched_reader_remove(RemoteReaderAttributes& rdata)
             }
         }
     }
+    if(found && m_local_readers.erase(rdata.guid) > 0)
+    {
+        logInfo(RTPS_WRITER, "Local reader removed: " << rdata.guid;);
+        return true;
+    }
     if(found)
     {
         logInfo(RTPS_WRITER, "Reader Proxy removed: " << rdata.guid;);
@@ -390,6 +433,9 @@ void StatelessWriter::unsent_changes_reset()
         reader_locator.unsent_changes.assign(mp_history->changesBegin(),
                 mp_history->changesEnd());
 
+    for(auto& local_reader : m_local_readers)
+        local_reader.second.assign(mp_history->changesBegin(), mp_history->changesEnd());
+
     AsyncWriterThread::wakeUp(this);
 }
 
@@ -84,8 +84,7 @@ void InitialHeartbeat::event(EventCode code, const char* msg)
 
         RTPSMessageGroup group(rp_->mp_SFW->getRTPSParticipant(), rp_->mp_SFW, RTPSMessageGroup::WRITER, m_cdrmessages);
 
-        LocatorList_t locators(rp_->m_att.endpoint.unicastLocatorList);
-        locators.push_back(rp_->m_att.endpoint.multicastLocatorList);
+        const LocatorList_t& locators = rp_->directed_locators();
 
         // FinalFlag is always false because this is a StatefulWriter in Reliable.
         group.add_heartbeat(std::vector<GUID_t>{rp_->m_att.guid}, firstSeq, lastSeq, heartbeatCount, false, false, locators);
@@ -77,8 +77,7 @@ void PeriodicHeartbeat::event(EventCode code, const char* msg)
                         unacked_changes= true;
                     }
                 }
-                locList.push_back((*it)->m_att.endpoint.unicastLocatorList);
-                locList.push_back((*it)->m_att.endpoint.multicastLocatorList);
+                locList.push_back((*it)->directed_locators());
                 remote_readers.push_back((*it)->m_att.guid);
             }
 
@@ -44,6 +44,41 @@ bool Subscriber::takeNextData(void* data,SampleInfo_t* info)
 	return mp_impl->takeNextData(data,info);
 }
 
+uint32_t Subscriber::readData(void** data,SampleInfo_t* info,uint32_t max_samples)
+{
+	return mp_impl->readData(data,info,max_samples,nullptr);
+}
+
+uint32_t Subscriber::takeData(void** data,SampleInfo_t* info,uint32_t max_samples)
+{
+	return mp_impl->takeData(data,info,max_samples,nullptr);
+}
+
+uint32_t Subscriber::readInstanceData(void** data,SampleInfo_t* info,uint32_t max_samples,const InstanceHandle_t& handle)
+{
+	return mp_impl->readData(data,info,max_samples,&handle);
+}
+
+uint32_t Subscriber::takeInstanceData(void** data,SampleInfo_t* info,uint32_t max_samples,const InstanceHandle_t& handle)
+{
+	return mp_impl->takeData(data,info,max_samples,&handle);
+}
+
+bool Subscriber::takeNextLoanedPayload(const SerializedPayload_t** payload,SampleInfo_t* info)
+{
+	return mp_impl->takeNextLoanedPayload(payload,info);
+}
+
+bool Subscriber::takeNextLoanedData(const void** data,SampleInfo_t* info)
+{
+	return mp_impl->takeNextLoanedData(data,info);
+}
+
+bool Subscriber::returnLoan(const void* loan)
+{
+	return mp_impl->returnLoan(loan);
+}
+
 bool Subscriber::updateAttributes(SubscriberAttributes& att)
 {
 	return mp_impl->updateAttributes(att);
@@ -32,11 +32,6 @@ namespace eprosima {
 namespace fastrtps {
 
 
-inline bool sort_ReaderHistoryCache(CacheChange_t*c1,CacheChange_t*c2)
-{
-    return c1->sequenceNumber < c2->sequenceNumber;
-}
-
 SubscriberHistory::SubscriberHistory(SubscriberImpl* simpl,uint32_t payloadMaxSize,
         HistoryQosPolicy& history,
         ResourceLimitsQosPolicy& resource,MemoryManagementPolicy_t mempolicy):
@@ -74,20 +69,21 @@ bool SubscriberHistory::received_change(CacheChange_t* a_change, size_t unknown_
         bool add = false;
         if(m_historyQos.kind == KEEP_ALL_HISTORY_QOS)
         {
-            if(m_changes.size() + unknown_missing_changes_up_to < (size_t)m_resourceLimitsQos.max_samples)
+            if(getHistorySize() + unknown_missing_changes_up_to < (size_t)m_resourceLimitsQos.max_samples)
                 add = true;
         }
         else if(m_historyQos.kind == KEEP_LAST_HISTORY_QOS)
         {
-            if(m_changes.size()<(size_t)m_historyQos.depth)
+            if(getHistorySize()<(size_t)m_historyQos.depth)
             {
                 add = true;
             }
             else
             {
                 // Try to substitude a older samples.
-                auto older_sample = m_changes.rend();
-                for(auto it = m_changes.rbegin(); it != m_changes.rend(); ++it)
+                std::vector<CacheChange_t*>::reverse_iterator changes_rend(changesBegin());
+                auto older_sample = changes_rend;
+                for(auto it = m_changes.rbegin(); it != changes_rend; ++it)
                 {
 
                     if((*it)->writerGUID == a_change->writerGUID)
@@ -100,7 +96,7 @@ bool SubscriberHistory::received_change(CacheChange_t* a_change, size_t unknown_
                     }
                 }
 
-                if(older_sample != m_changes.rend())
+                if(older_sample != changes_rend)
                 {
                     bool read = (*older_sample)->isRead;
 
@@ -113,9 +109,10 @@ bool SubscriberHistory::received_change(CacheChange_t* a_change, size_t unknown_
                         add = true;
                     }
                 }
-                // Not discard, but not store and set as received.
+                // Older than the kept samples. It is set as received by the reader, but not stored, so the
+                // reader gives the change back to the pool.
                 else
-                    return true;
+                    return false;
             }
         }
 
@@ -131,10 +128,7 @@ bool SubscriberHistory::received_change(CacheChange_t* a_change, size_t unknown_
             if(this->add_change(a_change))
             {
                 increaseUnreadCount();
-                if(a_change->sequenceNumber < mp_maxSeqCacheChange->sequenceNumber)
-                    sortCacheChanges();
-                updateMaxMinSeqNum();
-                if((int32_t)m_changes.size()==m_resourceLimitsQos.max_samples)
+                if((int32_t)getHistorySize()==m_resourceLimitsQos.max_samples)
                     m_isHistoryFull = true;
                 logInfo(SUBSCRIBER,this->mp_subImpl->getGuid().entityId
                         <<": Change "<< a_change->sequenceNumber << " added from: "
@@ -161,14 +155,15 @@ bool SubscriberHistory::received_change(CacheChange_t* a_change, size_t unknown_
                     << " and no method to obtain it";);
             return false;
         }
-        t_v_Inst_Caches::iterator vit;
+        t_m_Inst_Caches::iterator vit;
         if(find_Key(a_change,&vit))
         {
             //logInfo(RTPS_EDP,"Trying to add change with KEY: "<< vit->first << endl;);
+            RingBuffer<CacheChange_t*>& instance_changes = vit->second.cache_changes;
             bool add = false;
             if(m_historyQos.kind == KEEP_ALL_HISTORY_QOS)
             {
-                if((int32_t)vit->second.size() < m_resourceLimitsQos.max_samples_per_instance)
+                if((int32_t)instance_changes.size() < m_resourceLimitsQos.max_samples_per_instance)
                 {
                     add = true;
                 }
@@ -180,32 +175,32 @@ bool SubscriberHistory::received_change(CacheChange_t* a_change, size_t unknown_
             }
             else if (m_historyQos.kind == KEEP_LAST_HISTORY_QOS)
             {
-                if(vit->second.size()< (size_t)m_historyQos.depth)
+                if(instance_changes.size()< (size_t)m_historyQos.depth)
                 {
                     add = true;
                 }
                 else
                 {
-                    // Try to substitude a older samples.
-                    auto older_sample = m_changes.rend();
-                    for(auto it = m_changes.rbegin(); it != m_changes.rend(); ++it)
+                    // Try to substitude the oldest sample of the writer in this instance.
+                    CacheChange_t* older_sample = nullptr;
+                    for(size_t i = 0; i < instance_changes.size(); ++i)
                     {
-
-                        if((*it)->writerGUID == a_change->writerGUID)
+                        CacheChange_t* change = instance_changes[i];
+                        if(change->writerGUID == a_change->writerGUID)
                         {
-                            if((*it)->sequenceNumber < a_change->sequenceNumber)
-                                older_sample = it;
                             // Already received
-                            else if((*it)->sequenceNumber == a_change->sequenceNumber)
+                            if(change->sequenceNumber == a_change->sequenceNumber)
                                 return false;
+                            else if(older_sample == nullptr && change->sequenceNumber < a_change->sequenceNumber)
+                                older_sample = change;
                         }
                     }
 
-                    if(older_sample != m_changes.rend())
+                    if(older_sample != nullptr)
                     {
-                        bool read = (*older_sample)->isRead;
+                        bool read = older_sample->isRead;
 
-                        if(this->remove_change_sub(*older_sample, &vit))
+                        if(this->remove_change_sub(older_sample, &vit))
                         {
                             if(!read)
                             {
@@ -214,9 +209,10 @@ bool SubscriberHistory::received_change(CacheChange_t* a_change, size_t unknown_
                             add = true;
                         }
                     }
-                    // Not discard, but not store and set as received.
+                    // Older than the kept samples. It is set as received by the reader, but not stored, so the
+                    // reader gives the change back to the pool.
                     else
-                        return true;
+                        return false;
                 }
             }
 
@@ -232,25 +228,9 @@ bool SubscriberHistory::received_change(CacheChange_t* a_change, size_t unknown_
                 if(this->add_change(a_change))
                 {
                     increaseUnreadCount();
-                    if(a_change->sequenceNumber < mp_maxSeqCacheChange->sequenceNumber)
-                        sortCacheChanges();
-                    updateMaxMinSeqNum();
-                    if((int32_t)m_changes.size()==m_resourceLimitsQos.max_samples)
+                    if((int32_t)getHistorySize()==m_resourceLimitsQos.max_samples)
                         m_isHistoryFull = true;
-                    //ADD TO KEY VECTOR
-                    if(vit->second.size() == 0)
-                    {
-                        vit->second.push_back(a_change);
-                    }
-                    else if(vit->second.back()->sequenceNumber < a_change->sequenceNumber)
-                    {
-                        vit->second.push_back(a_change);
-                    }
-                    else
-                    {
-                        vit->second.push_back(a_change);
-                        std::sort(vit->second.begin(),vit->second.end(),sort_ReaderHistoryCache);
-                    }
+                    add_to_instance(a_change, vit);
                     logInfo(SUBSCRIBER,this->mp_reader->getGuid().entityId
                             <<": Change "<< a_change->sequenceNumber << " added from: "
                             << a_change->writerGUID<< " with KEY: "<< a_change->instanceHandle;);
@@ -275,31 +255,10 @@ bool SubscriberHistory::readNextData(void* data, SampleInfo_t* info)
 
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
     CacheChange_t* change;
-    WriterProxy * wp;
+    WriterProxy * wp = nullptr;
     if(this->mp_reader->nextUnreadCache(&change,&wp))
     {
-        change->isRead = true;
-        this->decreaseUnreadCount();
-        logInfo(SUBSCRIBER,this->mp_reader->getGuid().entityId<<": reading "<< change->sequenceNumber );
-        if(change->kind == ALIVE)
-            this->mp_subImpl->getType()->deserialize(&change->serializedPayload,data);
-        if(info!=nullptr)
-        {
-            info->sampleKind = change->kind;
-            info->sample_identity.writer_guid(change->writerGUID);
-            info->sample_identity.sequence_number(change->sequenceNumber);
-            info->sourceTimestamp = change->sourceTimestamp;
-            if(this->mp_subImpl->getAttributes().qos.m_ownership.kind == EXCLUSIVE_OWNERSHIP_QOS)
-                info->ownershipStrength = wp->m_att.ownershipStrength;
-            if(this->mp_subImpl->getAttributes().topic.topicKind == WITH_KEY &&
-                    change->instanceHandle == c_InstanceHandle_Unknown &&
-                    change->kind == ALIVE)
-            {
-                this->mp_subImpl->getType()->getKey(data,&change->instanceHandle);
-            }
-            info->iHandle = change->instanceHandle;
-            info->related_sample_identity = change->write_params.sample_identity();
-        }
+        read_change(change, wp, data, info);
         return true;
     }
     return false;
@@ -317,33 +276,10 @@ bool SubscriberHistory::takeNextData(void* data, SampleInfo_t* info)
 
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
     CacheChange_t* change;
-    WriterProxy * wp;
+    WriterProxy * wp = nullptr;
     if(this->mp_reader->nextUntakenCache(&change,&wp))
     {
-        if(!change->isRead)
-            this->decreaseUnreadCount();
-        change->isRead = true;
-        logInfo(SUBSCRIBER,this->mp_reader->getGuid().entityId<<": taking seqNum"<< change->sequenceNumber <<
-                " from writer: "<< change->writerGUID);
-        if(change->kind == ALIVE)
-            this->mp_subImpl->getType()->deserialize(&change->serializedPayload,data);
-        if(info!=nullptr)
-        {
-            info->sampleKind = change->kind;
-            info->sample_identity.writer_guid(change->writerGUID);
-            info->sample_identity.sequence_number(change->sequenceNumber);
-            info->sourceTimestamp = change->sourceTimestamp;
-            if(this->mp_subImpl->getAttributes().qos.m_ownership.kind == EXCLUSIVE_OWNERSHIP_QOS)
-                info->ownershipStrength = wp->m_att.ownershipStrength;
-            if(this->mp_subImpl->getAttributes().topic.topicKind == WITH_KEY &&
-                    change->instanceHandle == c_InstanceHandle_Unknown &&
-                    change->kind == ALIVE)
-            {
-                this->mp_subImpl->getType()->getKey(data,&change->instanceHandle);
-            }
-            info->iHandle = change->instanceHandle;
-            info->related_sample_identity = change->write_params.sample_identity();
-        }
+        take_change_data(change, wp, data, info);
         this->remove_change_sub(change);
         return true;
     }
@@ -351,51 +287,236 @@ bool SubscriberHistory::takeNextData(void* data, SampleInfo_t* info)
     return false;
 }
 
-bool SubscriberHistory::find_Key(CacheChange_t* a_change, t_v_Inst_Caches::iterator* vit_out)
+uint32_t SubscriberHistory::readData(void** data, SampleInfo_t* info, uint32_t max_samples,
+        const InstanceHandle_t* handle)
 {
-    t_v_Inst_Caches::iterator vit;
-    bool found = false;
-    for (vit = m_keyedChanges.begin(); vit != m_keyedChanges.end(); ++vit)
+
+    if(mp_reader == nullptr || mp_mutex == nullptr)
     {
-        if (a_change->instanceHandle == vit->first)
+        logError(RTPS_HISTORY,"You need to create a Reader with this History before using it");
+        return 0;
+    }
+
+    std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
+    uint32_t count = 0;
+    CacheChange_t* change;
+    WriterProxy * wp = nullptr;
+
+    if(handle == nullptr)
+    {
+        while(count < max_samples && this->mp_reader->nextUnreadCache(&change,&wp))
         {
-            *vit_out = vit;
-            return true;
+            read_change(change, wp, data[count], info != nullptr ? &info[count] : nullptr);
+            ++count;
         }
     }
-    if (!found)
+    else
     {
-        if ((int)m_keyedChanges.size() < m_resourceLimitsQos.max_instances)
+        t_m_Inst_Caches::iterator vit = m_keyedChanges.find(*handle);
+        if(vit == m_keyedChanges.end())
+            return 0;
+
+        RingBuffer<CacheChange_t*>& instance_changes = vit->second.cache_changes;
+        for(size_t i = 0; count < max_samples && i < instance_changes.size(); ++i)
         {
-            t_p_I_Change newpair;
-            newpair.first = a_change->instanceHandle;
-            m_keyedChanges.push_back(newpair);
-            *vit_out = m_keyedChanges.end() - 1;
-            return true;
+            change = instance_changes[i];
+            if(!change->isRead && this->mp_reader->isChangeAvailable(change,&wp))
+            {
+                read_change(change, wp, data[count], info != nullptr ? &info[count] : nullptr);
+                ++count;
+            }
         }
-        else
+    }
+
+    return count;
+}
+
+uint32_t SubscriberHistory::takeData(void** data, SampleInfo_t* info, uint32_t max_samples,
+        const InstanceHandle_t* handle)
+{
+
+    if(mp_reader == nullptr || mp_mutex == nullptr)
+    {
+        logError(RTPS_HISTORY,"You need to create a Reader with this History before using it");
+        return 0;
+    }
+
+    std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
+    uint32_t count = 0;
+    CacheChange_t* change;
+    WriterProxy * wp = nullptr;
+
+    if(handle == nullptr)
+    {
+        while(count < max_samples && this->mp_reader->nextUntakenCache(&change,&wp))
+        {
+            take_change_data(change, wp, data[count], info != nullptr ? &info[count] : nullptr);
+            ++count;
+            if(!this->remove_change_sub(change))
+                break;
+        }
+    }
+    else
+    {
+        t_m_Inst_Caches::iterator vit = m_keyedChanges.find(*handle);
+        if(vit == m_keyedChanges.end())
+            return 0;
+
+        // Taken changes are removed from the instance, so the next one takes their position.
+        RingBuffer<CacheChange_t*>& instance_changes = vit->second.cache_changes;
+        size_t i = 0;
+        while(count < max_samples && i < instance_changes.size())
         {
-            for (vit = m_keyedChanges.begin(); vit != m_keyedChanges.end(); ++vit)
+            change = instance_changes[i];
+            if(this->mp_reader->isChangeAvailable(change,&wp))
             {
-                if (vit->second.size() == 0)
-                {
-                    m_keyedChanges.erase(vit);
-                    t_p_I_Change newpair;
-                    newpair.first = a_change->instanceHandle;
-                    m_keyedChanges.push_back(newpair);
-                    *vit_out = m_keyedChanges.end() - 1;
-                    return true;
-                }
+                take_change_data(change, wp, data[count], info != nullptr ? &info[count] : nullptr);
+                ++count;
+                if(!this->remove_change_sub(change, &vit))
+                    break;
             }
-            logWarning(SUBSCRIBER, "History has reached the maximum number of instances");
+            else
+                ++i;
+        }
+    }
+
+    return count;
+}
+
+void SubscriberHistory::read_change(CacheChange_t* change, WriterProxy* wp, void* data, SampleInfo_t* info)
+{
+    change->isRead = true;
+    this->decreaseUnreadCount();
+    logInfo(SUBSCRIBER,this->mp_reader->getGuid().entityId<<": reading "<< change->sequenceNumber );
+    deserialize_change(change, wp, data, info);
+}
+
+void SubscriberHistory::take_change_data(CacheChange_t* change, WriterProxy* wp, void* data, SampleInfo_t* info)
+{
+    if(!change->isRead)
+        this->decreaseUnreadCount();
+    change->isRead = true;
+    logInfo(SUBSCRIBER,this->mp_reader->getGuid().entityId<<": taking seqNum"<< change->sequenceNumber <<
+            " from writer: "<< change->writerGUID);
+    deserialize_change(change, wp, data, info);
+}
+
+void SubscriberHistory::deserialize_change(CacheChange_t* change, WriterProxy* wp, void* data, SampleInfo_t* info)
+{
+    if(change->kind == ALIVE)
+        this->mp_subImpl->getType()->deserialize(&change->serializedPayload,data);
+    if(info!=nullptr)
+    {
+        info->sampleKind = change->kind;
+        info->sample_identity.writer_guid(change->writerGUID);
+        info->sample_identity.sequence_number(change->sequenceNumber);
+        info->sourceTimestamp = change->sourceTimestamp;
+        if(this->mp_subImpl->getAttributes().qos.m_ownership.kind == EXCLUSIVE_OWNERSHIP_QOS && wp != nullptr)
+            info->ownershipStrength = wp->m_att.ownershipStrength;
+        if(this->mp_subImpl->getAttributes().topic.topicKind == WITH_KEY &&
+                change->instanceHandle == c_InstanceHandle_Unknown &&
+                change->kind == ALIVE)
+        {
+            this->mp_subImpl->getType()->getKey(data,&change->instanceHandle);
         }
+        info->iHandle = change->instanceHandle;
+        info->related_sample_identity = change->write_params.sample_identity();
+    }
+}
+
+bool SubscriberHistory::takeNextChange(CacheChange_t** change, SampleInfo_t* info)
+{
 
+    if(mp_reader == nullptr || mp_mutex == nullptr)
+    {
+        logError(RTPS_HISTORY,"You need to create a Reader with this History before using it");
+        return false;
+    }
+
+    std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
+    WriterProxy * wp = nullptr;
+    if(this->mp_reader->nextUntakenCache(change,&wp))
+    {
+        CacheChange_t* taken = *change;
+        if(!taken->isRead)
+            this->decreaseUnreadCount();
+        taken->isRead = true;
+        logInfo(SUBSCRIBER,this->mp_reader->getGuid().entityId<<": taking seqNum"<< taken->sequenceNumber <<
+                " from writer: "<< taken->writerGUID << " without copy");
+        if(info!=nullptr)
+        {
+            info->sampleKind = taken->kind;
+            info->sample_identity.writer_guid(taken->writerGUID);
+            info->sample_identity.sequence_number(taken->sequenceNumber);
+            info->sourceTimestamp = taken->sourceTimestamp;
+            if(this->mp_subImpl->getAttributes().qos.m_ownership.kind == EXCLUSIVE_OWNERSHIP_QOS && wp != nullptr)
+                info->ownershipStrength = wp->m_att.ownershipStrength;
+            if(this->mp_subImpl->getAttributes().topic.topicKind == WITH_KEY &&
+                    taken->instanceHandle == c_InstanceHandle_Unknown &&
+                    taken->kind == ALIVE)
+            {
+                // Only the key object is deserialized.
+                this->mp_subImpl->getType()->deserialize(&taken->serializedPayload,mp_getKeyObject);
+                this->mp_subImpl->getType()->getKey(mp_getKeyObject,&taken->instanceHandle);
+            }
+            info->iHandle = taken->instanceHandle;
+            info->related_sample_identity = taken->write_params.sample_identity();
+        }
+        return this->remove_change_sub(taken, nullptr, false);
     }
     return false;
 }
 
+bool SubscriberHistory::find_Key(CacheChange_t* a_change, t_m_Inst_Caches::iterator* vit_out)
+{
+    t_m_Inst_Caches::iterator vit = m_keyedChanges.find(a_change->instanceHandle);
+    if(vit != m_keyedChanges.end())
+    {
+        *vit_out = vit;
+        return true;
+    }
 
-bool SubscriberHistory::remove_change_sub(CacheChange_t* change,t_v_Inst_Caches::iterator* vit_in)
+    if((int)m_keyedChanges.size() >= m_resourceLimitsQos.max_instances)
+    {
+        if(m_emptyInstances.empty())
+        {
+            logWarning(SUBSCRIBER, "History has reached the maximum number of instances");
+            return false;
+        }
+
+        // Evict the least recently used instance without changes.
+        m_keyedChanges.erase(m_emptyInstances.front());
+        m_emptyInstances.pop_front();
+    }
+
+    // KEEP_LAST instances never hold more than depth changes.
+    size_t capacity = m_historyQos.kind == KEEP_LAST_HISTORY_QOS && m_historyQos.depth > 0 ?
+        (size_t)m_historyQos.depth : 0;
+    vit = m_keyedChanges.emplace(a_change->instanceHandle, KeyedChanges(capacity)).first;
+    vit->second.empty_it = m_emptyInstances.insert(m_emptyInstances.end(), a_change->instanceHandle);
+    *vit_out = vit;
+    return true;
+}
+
+void SubscriberHistory::add_to_instance(CacheChange_t* a_change, t_m_Inst_Caches::iterator vit)
+{
+    RingBuffer<CacheChange_t*>& instance_changes = vit->second.cache_changes;
+
+    if(instance_changes.empty())
+        m_emptyInstances.erase(vit->second.empty_it);
+
+    // Changes usually arrive in order, so the position is searched from the back.
+    size_t index = instance_changes.size();
+    while(index > 0 && a_change->sequenceNumber < instance_changes[index - 1]->sequenceNumber)
+        --index;
+
+    if(index == instance_changes.size())
+        instance_changes.push_back(a_change);
+    else
+        instance_changes.insert(index, a_change);
+}
+
+bool SubscriberHistory::remove_change_sub(CacheChange_t* change,t_m_Inst_Caches::iterator* vit_in, bool release)
 {
 
     if(mp_reader == nullptr || mp_mutex == nullptr)
@@ -407,7 +528,7 @@ bool SubscriberHistory::remove_change_sub(CacheChange_t* change,t_v_Inst_Caches:
     std::lock_guard<std::recursive_mutex> guard(*mp_mutex);
     if(mp_subImpl->getAttributes().topic.getTopicKind() == NO_KEY)
     {
-        if(this->remove_change(change))
+        if(release ? this->remove_change(change) : this->take_change(change))
         {
             m_isHistoryFull = false;
             return true;
@@ -416,24 +537,31 @@ bool SubscriberHistory::remove_change_sub(CacheChange_t* change,t_v_Inst_Caches:
     }
     else
     {
-        t_v_Inst_Caches::iterator vit;
+        t_m_Inst_Caches::iterator vit;
         if(vit_in!=nullptr)
             vit = *vit_in;
-        else if(this->find_Key(change,&vit))
+        else
         {
-
+            vit = m_keyedChanges.find(change->instanceHandle);
+            if(vit == m_keyedChanges.end())
+            {
+                logError(SUBSCRIBER,"Instance of the change not found, something is wrong");
+                return false;
+            }
         }
-        else
-            return false;
-        for(auto chit = vit->second.begin();
-                chit!= vit->second.end();++chit)
+
+        RingBuffer<CacheChange_t*>& instance_changes = vit->second.cache_changes;
+        for(size_t i = 0; i < instance_changes.size(); ++i)
         {
-            if((*chit)->sequenceNumber == change->sequenceNumber
-                    && (*chit)->writerGUID == change->writerGUID)
+            CacheChange_t* instance_change = instance_changes[i];
+            if(instance_change->sequenceNumber == change->sequenceNumber
+                    && instance_change->writerGUID == change->writerGUID)
             {
-                if(remove_change(change))
+                if(release ? remove_change(change) : take_change(change))
                 {
-                    vit->second.erase(chit);
+                    instance_changes.erase(i);
+                    if(instance_changes.empty())
+                        vit->second.empty_it = m_emptyInstances.insert(m_emptyInstances.end(), vit->first);
                     m_isHistoryFull = false;
                     return true;
                 }
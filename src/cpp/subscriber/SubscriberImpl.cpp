@@ -60,6 +60,16 @@ SubscriberImpl::~SubscriberImpl()
         logInfo(SUBSCRIBER,this->getGuid().entityId << " in topic: "<<this->m_att.topic.topicName);
     }
 
+    // Loans not returned yet are released.
+    for(auto& loan : m_loans)
+    {
+        if(loan.second != nullptr)
+            m_history.release_Cache(loan.second);
+        else
+            mp_type->deleteData(const_cast<void*>(loan.first));
+    }
+    m_loans.clear();
+
     RTPSDomain::removeRTPSReader(mp_reader);
     delete(this->mp_userSubscriber);
 }
@@ -88,6 +98,97 @@ bool SubscriberImpl::takeNextData(void* data,SampleInfo_t* info) {
     return this->m_history.takeNextData(data,info);
 }
 
+uint32_t SubscriberImpl::readData(void** data,SampleInfo_t* info,uint32_t max_samples,const InstanceHandle_t* handle)
+{
+    return this->m_history.readData(data,info,max_samples,handle);
+}
+
+uint32_t SubscriberImpl::takeData(void** data,SampleInfo_t* info,uint32_t max_samples,const InstanceHandle_t* handle)
+{
+    return this->m_history.takeData(data,info,max_samples,handle);
+}
+
+bool SubscriberImpl::takeNextLoanedPayload(const SerializedPayload_t** payload,SampleInfo_t* info)
+{
+    CacheChange_t* change = nullptr;
+    if(!m_history.takeNextChange(&change,info))
+        return false;
+
+    *payload = &change->serializedPayload;
+    add_loan(*payload,change);
+    return true;
+}
+
+bool SubscriberImpl::takeNextLoanedData(const void** data,SampleInfo_t* info)
+{
+    CacheChange_t* change = nullptr;
+    if(!m_history.takeNextChange(&change,info))
+        return false;
+
+    *data = nullptr;
+    if(change->kind != ALIVE)
+    {
+        m_history.release_Cache(change);
+        return true;
+    }
+
+    uint16_t native_encapsulation = DEFAULT_ENDIAN == BIGEND ? CDR_BE : CDR_LE;
+    if(mp_type->is_plain() && change->serializedPayload.length >= mp_type->m_typeSize &&
+            change->serializedPayload.encapsulation == native_encapsulation)
+    {
+        // The object is the payload itself, after the encapsulation.
+        *data = change->serializedPayload.data + 4;
+        add_loan(*data,change);
+        return true;
+    }
+
+    // Out of the history mutex, as the change doesn't belong to it anymore.
+    void* object = mp_type->createData();
+    bool deserialized = object != nullptr && mp_type->deserialize(&change->serializedPayload,object);
+    m_history.release_Cache(change);
+
+    if(!deserialized)
+    {
+        logWarning(SUBSCRIBER,"Taken sample cannot be deserialized");
+        if(object != nullptr)
+            mp_type->deleteData(object);
+        return false;
+    }
+
+    *data = object;
+    add_loan(object,nullptr);
+    return true;
+}
+
+bool SubscriberImpl::returnLoan(const void* loan)
+{
+    CacheChange_t* change = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(m_loansMutex);
+        auto it = m_loans.find(loan);
+        if(it == m_loans.end())
+        {
+            logError(SUBSCRIBER,"Loan was not given by this subscriber");
+            return false;
+        }
+        change = it->second;
+        m_loans.erase(it);
+    }
+
+    if(change != nullptr)
+        m_history.release_Cache(change);
+    else
+        mp_type->deleteData(const_cast<void*>(loan));
+
+    return true;
+}
+
+void SubscriberImpl::add_loan(const void* loan,CacheChange_t* change)
+{
+    std::lock_guard<std::mutex> guard(m_loansMutex);
+    m_loans[loan] = change;
+}
+
 
 
 const GUID_t& SubscriberImpl::getGuid(){
@@ -27,6 +27,9 @@
 #include <fastrtps/subscriber/SubscriberHistory.h>
 #include <fastrtps/rtps/reader/ReaderListener.h>
 
+#include <map>
+#include <mutex>
+
 
 namespace eprosima {
 namespace fastrtps {
@@ -76,6 +79,20 @@ public:
 
 	bool readNextData(void* data,SampleInfo_t* info);
 	bool takeNextData(void* data,SampleInfo_t* info);
+	uint32_t readData(void** data,SampleInfo_t* info,uint32_t max_samples,const InstanceHandle_t* handle);
+	uint32_t takeData(void** data,SampleInfo_t* info,uint32_t max_samples,const InstanceHandle_t* handle);
+
+	///@}
+
+	/** @name Loaned take methods.
+	 * Methods to take data from the History without copying it, until the loan is returned.
+	 */
+
+	///@{
+
+	bool takeNextLoanedPayload(const SerializedPayload_t** payload,SampleInfo_t* info);
+	bool takeNextLoanedData(const void** data,SampleInfo_t* info);
+	bool returnLoan(const void* loan);
 
 	///@}
 	
@@ -139,6 +156,18 @@ private:
 	Subscriber* mp_userSubscriber;
 	//!RTPSParticipant
 		RTPSParticipant* mp_rtpsParticipant;
+
+	/**
+	 * Adds a loan.
+	 * @param loan Address handed to the application.
+	 * @param change Change kept out of the pool, or nullptr if the loan is an object created by the type.
+	 */
+	void add_loan(const void* loan,CacheChange_t* change);
+
+	//!Loans not returned yet. The value is the change they belong to, or nullptr for objects created by the type.
+	std::map<const void*,CacheChange_t*> m_loans;
+	//!Protects the loans.
+	std::mutex m_loansMutex;
 };
 
 
@@ -0,0 +1,675 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fastrtps/transport/SharedMemTransport.h>
+#include <fastrtps/log/Log.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <thread>
+
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(__ANDROID__)
+#define SHAREDMEM_TRANSPORT_SUPPORTED
+#include <cerrno>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace eprosima{
+namespace fastrtps{
+namespace rtps{
+
+static const uint32_t maximumMessageSize = 65500;
+static const uint32_t defaultPortQueueCapacity = 64;
+static const uint32_t maximumPortQueueCapacity = 4096;
+static const uint32_t defaultSegmentPermissions = 0600;
+
+RTPS_DllAPI SharedMemTransportDescriptor::SharedMemTransportDescriptor():
+    TransportDescriptorInterface(maximumMessageSize),
+    portQueueCapacity(defaultPortQueueCapacity),
+    segmentNamePrefix("fastrtps"),
+    segmentPermissions(defaultSegmentPermissions)
+    {
+    }
+
+#if defined(SHAREDMEM_TRANSPORT_SUPPORTED)
+
+static const uint32_t segmentMagic = 0x5348524D; // "SHRM"
+static const size_t cacheLineSize = 64;
+//! Time the owner waits for a claimed slot to be published before checking whether its sender is still alive.
+static const std::chrono::milliseconds claimedSlotCheckPeriod(10);
+//! Set in the sequence of a slot claimed by a sender, whose PID takes the low bits, until its message is published.
+static const uint64_t slotClaimedFlag = 1ULL << 63;
+//! Times Create() starts over when another process replaces the segment while it is taking it.
+static const int segmentCreateAttempts = 8;
+
+/**
+ * Placed at the beginning of every segment, and followed by slotCount slots of slotStride bytes.
+ * Any process can push into the ring, but only the owner of the port pops from it. The owner holds an exclusive
+ * flock() on the segment while it is open, which the system releases when the owner dies.
+ */
+struct SegmentHeader
+{
+    //! Written last by the owner, once the segment is ready. Cleared when the owner closes the port.
+    std::atomic<uint32_t> magic;
+    uint32_t slotCount;
+    uint32_t slotStride;
+    uint32_t slotPayloadSize;
+    //! Counts the messages published and not yet popped.
+    sem_t messagesAvailable;
+    alignas(cacheLineSize) std::atomic<uint64_t> enqueuePos;
+    alignas(cacheLineSize) std::atomic<uint64_t> dequeuePos;
+};
+
+struct SlotHeader
+{
+    /**
+     * Equals pos while the slot waits for the message of position pos, slotClaimedFlag plus the PID of the sender
+     * while it copies that message, and pos + 1 once it holds it.
+     */
+    std::atomic<uint64_t> sequence;
+    uint32_t size;
+    //! Port of the output channel the message was sent from.
+    uint32_t port;
+};
+
+static size_t AlignToCacheLine(size_t size)
+{
+    return (size + cacheLineSize - 1) & ~(cacheLineSize - 1);
+}
+
+class SharedMemTransport::PortSegment
+{
+public:
+
+    PortSegment(const string& name) : mName(name), mFd(-1), mBase(nullptr), mLength(0), mClosing(false)
+    {
+    }
+
+    ~PortSegment()
+    {
+        if(mBase != nullptr)
+            munmap(mBase, mLength);
+        if(mFd >= 0)
+            ::close(mFd);
+    }
+
+    /**
+     * Creates the segment and takes its ownership. Segments left behind by dead processes, whose lock was released
+     * when they died, are replaced.
+     */
+    bool Create(uint32_t slotCount, uint32_t slotPayloadSize, mode_t permissions)
+    {
+        for(int attempt = 0; mFd < 0 && attempt < segmentCreateAttempts; ++attempt)
+        {
+            int fd = shm_open(mName.c_str(), O_RDWR | O_CREAT | O_EXCL, permissions);
+            if(fd < 0)
+            {
+                if(errno != EEXIST)
+                    break;
+
+                int existing = shm_open(mName.c_str(), O_RDWR, 0);
+                if(existing < 0)
+                {
+                    if(errno == ENOENT)
+                        continue; // Removed meanwhile.
+                    break;
+                }
+
+                // Held by its owner for as long as it lives, and by anyone taking it over. Creators take it before
+                // initialising the segment, and check that it was not replaced meanwhile.
+                if(flock(existing, LOCK_EX | LOCK_NB) != 0)
+                {
+                    ::close(existing);
+                    return false;
+                }
+
+                if(IsNamedBy(existing))
+                    shm_unlink(mName.c_str());
+                ::close(existing);
+                continue;
+            }
+
+            // A process that found the segment before it was locked may have removed it already.
+            if(flock(fd, LOCK_EX | LOCK_NB) != 0 || !IsNamedBy(fd))
+            {
+                ::close(fd);
+                std::this_thread::yield();
+                continue;
+            }
+
+            mFd = fd;
+        }
+
+        if(mFd < 0)
+        {
+            logWarning(RTPS_MSG_IN, "Cannot create shared memory segment " << mName << ": " << strerror(errno));
+            return false;
+        }
+
+        uint32_t slotStride = static_cast<uint32_t>(AlignToCacheLine(sizeof(SlotHeader) + slotPayloadSize));
+        mLength = AlignToCacheLine(sizeof(SegmentHeader)) + static_cast<size_t>(slotCount) * slotStride;
+
+        if(ftruncate(mFd, static_cast<off_t>(mLength)) != 0 || !Map())
+        {
+            logWarning(RTPS_MSG_IN, "Cannot map shared memory segment " << mName << ": " << strerror(errno));
+            shm_unlink(mName.c_str());
+            return false;
+        }
+
+        SegmentHeader* header = new (mBase) SegmentHeader();
+        header->slotCount = slotCount;
+        header->slotStride = slotStride;
+        header->slotPayloadSize = slotPayloadSize;
+        header->enqueuePos.store(0, std::memory_order_relaxed);
+        header->dequeuePos.store(0, std::memory_order_relaxed);
+        if(sem_init(&header->messagesAvailable, 1, 0) != 0)
+        {
+            shm_unlink(mName.c_str());
+            return false;
+        }
+
+        for(uint32_t i = 0; i < slotCount; ++i)
+        {
+            SlotHeader* slot = new (Slot(i)) SlotHeader();
+            slot->sequence.store(i, std::memory_order_relaxed);
+            slot->size = 0;
+            slot->port = 0;
+        }
+
+        header->magic.store(segmentMagic, std::memory_order_release);
+        return true;
+    }
+
+    //! Maps the segment of a port owned by another transport.
+    bool Attach()
+    {
+        mFd = shm_open(mName.c_str(), O_RDWR, 0);
+        if(mFd < 0)
+            return false;
+
+        struct stat status;
+        if(fstat(mFd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(SegmentHeader))
+            return false;
+
+        mLength = static_cast<size_t>(status.st_size);
+        if(!Map() || !IsOpen())
+            return false;
+
+        // Geometry is only read after the magic is seen, so it is complete.
+        return AlignToCacheLine(sizeof(SegmentHeader)) +
+            static_cast<size_t>(Header()->slotCount) * Header()->slotStride <= mLength;
+    }
+
+    //! Reports whether the owner has not closed the port yet.
+    bool IsOpen() const
+    {
+        return Header()->magic.load(std::memory_order_acquire) == segmentMagic;
+    }
+
+    /**
+     * Copies the slices of a message into one slot of the ring. Never blocks: fails if the ring is full, or if the
+     * owner discarded the slot because it took this process for dead.
+     */
+    bool Push(const SendBufferSlice* slices, uint32_t sliceCount, uint32_t port)
+    {
+        SegmentHeader* header = Header();
+        uint32_t size = 0;
+        for(uint32_t i = 0; i < sliceCount; ++i)
+            size += slices[i].size;
+
+        if(size > header->slotPayloadSize)
+            return false;
+
+        // The slot is claimed with our PID before the position moves on, so the owner can tell whether the
+        // message may still come. Senders finding a claimed slot move the position on for its claimant.
+        const uint64_t claim = slotClaimedFlag | static_cast<uint32_t>(getpid());
+        uint64_t pos = header->enqueuePos.load(std::memory_order_relaxed);
+        SlotHeader* slot;
+        for(;;)
+        {
+            slot = Slot(pos);
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            int64_t difference = static_cast<int64_t>(sequence - pos);
+            if((sequence & slotClaimedFlag) != 0)
+            {
+                header->enqueuePos.compare_exchange_strong(pos, pos + 1, std::memory_order_relaxed);
+                pos = header->enqueuePos.load(std::memory_order_relaxed);
+            }
+            else if(difference == 0)
+            {
+                if(slot->sequence.compare_exchange_strong(sequence, claim, std::memory_order_acquire,
+                            std::memory_order_relaxed))
+                {
+                    header->enqueuePos.compare_exchange_strong(pos, pos + 1, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            else if(difference < 0)
+                return false; // Full.
+            else
+                pos = header->enqueuePos.load(std::memory_order_relaxed);
+        }
+
+        octet* payload = Payload(slot);
+        for(uint32_t i = 0; i < sliceCount; ++i)
+        {
+            memcpy(payload, slices[i].buffer, slices[i].size);
+            payload += slices[i].size;
+        }
+        slot->size = size;
+        slot->port = port;
+
+        uint64_t expected = claim;
+        if(!slot->sequence.compare_exchange_strong(expected, pos + 1, std::memory_order_release,
+                    std::memory_order_relaxed))
+            return false; // Discarded by the owner.
+
+        sem_post(&header->messagesAvailable);
+        return true;
+    }
+
+    //! Blocks until a message is available, and copies it out of the ring. Only called by the owner.
+    bool Pop(octet* buffer, uint32_t capacity, uint32_t& size, uint32_t& port)
+    {
+        SegmentHeader* header = Header();
+        bool waitMessage = true;
+        for(;;)
+        {
+            if(waitMessage && sem_wait(&header->messagesAvailable) != 0)
+            {
+                if(errno == EINTR)
+                    continue;
+                return false;
+            }
+
+            if(mClosing.load())
+                return false;
+
+            uint64_t pos = header->dequeuePos.load(std::memory_order_relaxed);
+            SlotHeader* slot = Slot(pos);
+
+            // The count may come from a message published ahead of this slot, whose writer is still copying.
+            // A writer that died after claiming the slot never publishes it, so the slot is discarded once its
+            // claimant is known to be dead, and the count is kept for the message that gave it.
+            waitMessage = true;
+            auto nextCheck = std::chrono::steady_clock::now() + claimedSlotCheckPeriod;
+            uint64_t sequence;
+            while((sequence = slot->sequence.load(std::memory_order_acquire)) != pos + 1)
+            {
+                if(mClosing.load())
+                    return false;
+
+                if((sequence & slotClaimedFlag) != 0 && std::chrono::steady_clock::now() >= nextCheck)
+                {
+                    pid_t claimant = static_cast<pid_t>(sequence & ~slotClaimedFlag);
+                    if(kill(claimant, 0) != 0 && errno == ESRCH &&
+                            slot->sequence.compare_exchange_strong(sequence, pos + header->slotCount,
+                                std::memory_order_acq_rel))
+                    {
+                        logWarning(RTPS_MSG_IN, "Sender of a message in " << mName << " died, discarding it");
+                        header->dequeuePos.store(pos + 1, std::memory_order_relaxed);
+                        waitMessage = false;
+                        break;
+                    }
+                    nextCheck = std::chrono::steady_clock::now() + claimedSlotCheckPeriod;
+                }
+
+                std::this_thread::yield();
+            }
+
+            if(!waitMessage)
+                continue;
+
+            bool fits = slot->size <= capacity;
+            if(fits)
+            {
+                memcpy(buffer, Payload(slot), slot->size);
+                size = slot->size;
+                port = slot->port;
+            }
+
+            slot->sequence.store(pos + header->slotCount, std::memory_order_release);
+            header->dequeuePos.store(pos + 1, std::memory_order_relaxed);
+
+            if(fits)
+                return true;
+
+            logWarning(RTPS_MSG_IN, "Message in " << mName << " exceeds the receive buffer, discarding it");
+        }
+    }
+
+    //! Wakes up the reader and removes the segment. Senders drop their mappings on their next send.
+    void Close()
+    {
+        mClosing.store(true);
+        Header()->magic.store(0, std::memory_order_release);
+        sem_post(&Header()->messagesAvailable);
+        shm_unlink(mName.c_str());
+    }
+
+private:
+
+    //! Reports whether the name of the segment still refers to the file open in fd.
+    bool IsNamedBy(int fd) const
+    {
+        int named = shm_open(mName.c_str(), O_RDWR, 0);
+        if(named < 0)
+            return false;
+
+        struct stat namedStatus, status;
+        bool same = fstat(named, &namedStatus) == 0 && fstat(fd, &status) == 0 &&
+            namedStatus.st_dev == status.st_dev && namedStatus.st_ino == status.st_ino;
+        ::close(named);
+        return same;
+    }
+
+    bool Map()
+    {
+        void* base = mmap(nullptr, mLength, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+        if(base == MAP_FAILED)
+            return false;
+        mBase = base;
+        return true;
+    }
+
+    SegmentHeader* Header() const
+    {
+        return static_cast<SegmentHeader*>(mBase);
+    }
+
+    SlotHeader* Slot(uint64_t pos) const
+    {
+        const SegmentHeader* header = Header();
+        size_t index = static_cast<size_t>(pos & (header->slotCount - 1));
+        return reinterpret_cast<SlotHeader*>(static_cast<octet*>(mBase) +
+                AlignToCacheLine(sizeof(SegmentHeader)) + index * header->slotStride);
+    }
+
+    static octet* Payload(SlotHeader* slot)
+    {
+        return reinterpret_cast<octet*>(slot) + sizeof(SlotHeader);
+    }
+
+    string mName;
+    int mFd;
+    void* mBase;
+    size_t mLength;
+    std::atomic<bool> mClosing;
+};
+
+#else
+
+// Platforms without POSIX shared memory. init() fails, so these are never called.
+class SharedMemTransport::PortSegment
+{
+public:
+    PortSegment(const string&) {}
+    bool Create(uint32_t, uint32_t, uint32_t) { return false; }
+    bool Attach() { return false; }
+    bool IsOpen() const { return false; }
+    bool Push(const SendBufferSlice*, uint32_t, uint32_t) { return false; }
+    bool Pop(octet*, uint32_t, uint32_t&, uint32_t&) { return false; }
+    void Close() {}
+};
+
+#endif
+
+SharedMemTransport::SharedMemTransport(const SharedMemTransportDescriptor& descriptor):
+    mMaxMessageSize(descriptor.maxMessageSize),
+    mPortQueueCapacity(descriptor.portQueueCapacity),
+    mSegmentNamePrefix(descriptor.segmentNamePrefix),
+    mSegmentPermissions(descriptor.segmentPermissions)
+    {
+        memset(mHostId, 0, sizeof(mHostId));
+#if defined(SHAREDMEM_TRANSPORT_SUPPORTED)
+        char hostname[256] = {0};
+        gethostname(hostname, sizeof(hostname) - 1);
+        uint64_t hash = std::hash<string>()(string(hostname));
+        memcpy(mHostId, &hash, sizeof(hash) < sizeof(mHostId) ? sizeof(hash) : sizeof(mHostId));
+        // An all-zero address stands for "this host", so the identifier must never be zero.
+        mHostId[0] |= 0x01;
+#endif
+    }
+
+SharedMemTransport::~SharedMemTransport()
+{
+    std::lock_guard<std::mutex> lock(mInputMapMutex);
+    for(auto& segment : mInputSegments)
+        segment.second->Close();
+}
+
+bool SharedMemTransport::init()
+{
+#if !defined(SHAREDMEM_TRANSPORT_SUPPORTED)
+    logError(RTPS_MSG_OUT, "Shared memory transport is not supported on this platform");
+    return false;
+#else
+    if(mMaxMessageSize > maximumMessageSize)
+    {
+        logError(RTPS_MSG_OUT, "maxMessageSize cannot be greater than " << maximumMessageSize);
+        return false;
+    }
+
+    if(mPortQueueCapacity == 0 || mPortQueueCapacity > maximumPortQueueCapacity)
+    {
+        logError(RTPS_MSG_OUT, "portQueueCapacity has to be between 1 and " << maximumPortQueueCapacity);
+        return false;
+    }
+
+    // Ring positions are masked, so the capacity must be a power of two.
+    uint32_t capacity = 1;
+    while(capacity < mPortQueueCapacity)
+        capacity <<= 1;
+    mPortQueueCapacity = capacity;
+
+    std::atomic<uint64_t> position;
+    if(!position.is_lock_free())
+    {
+        logError(RTPS_MSG_OUT, "Shared memory transport needs lock-free 64 bit atomics");
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+bool SharedMemTransport::IsInputChannelOpen(const Locator_t& locator) const
+{
+    std::lock_guard<std::mutex> lock(mInputMapMutex);
+    return IsLocatorSupported(locator) && (mInputSegments.find(locator.port) != mInputSegments.end());
+}
+
+bool SharedMemTransport::IsOutputChannelOpen(const Locator_t& locator) const
+{
+    std::lock_guard<std::mutex> lock(mOutputMapMutex);
+    return IsLocatorSupported(locator) && (mOutputChannels.find(locator.port) != mOutputChannels.end());
+}
+
+bool SharedMemTransport::IsLocatorSupported(const Locator_t& locator) const
+{
+    return locator.kind == LOCATOR_KIND_SHM;
+}
+
+bool SharedMemTransport::DoLocatorsMatch(const Locator_t& left, const Locator_t& right) const
+{
+    return left.kind == right.kind && left.port == right.port;
+}
+
+Locator_t SharedMemTransport::RemoteToMainLocal(const Locator_t& remote) const
+{
+    Locator_t mainLocal(remote);
+    if (!IsLocatorSupported(remote))
+    {
+        LOCATOR_INVALID(mainLocal);
+        return mainLocal;
+    }
+
+    mainLocal.port = 0;
+    memset(mainLocal.address, 0x00, sizeof(mainLocal.address));
+    return mainLocal;
+}
+
+bool SharedMemTransport::OpenInputChannel(const Locator_t& locator)
+{
+    if (!IsLocatorSupported(locator))
+        return false;
+
+    std::lock_guard<std::mutex> lock(mInputMapMutex);
+    if (mInputSegments.find(locator.port) != mInputSegments.end())
+        return false;
+
+    auto segment = std::make_shared<PortSegment>(SegmentName(locator.port));
+    if (!segment->Create(mPortQueueCapacity, mMaxMessageSize, mSegmentPermissions))
+        return false;
+
+    mInputSegments.emplace(locator.port, segment);
+    return true;
+}
+
+bool SharedMemTransport::OpenOutputChannel(Locator_t& locator)
+{
+    if (!IsLocatorSupported(locator))
+        return false;
+
+    std::lock_guard<std::mutex> lock(mOutputMapMutex);
+    return mOutputChannels.insert(locator.port).second;
+}
+
+bool SharedMemTransport::CloseInputChannel(const Locator_t& locator)
+{
+    std::lock_guard<std::mutex> lock(mInputMapMutex);
+    auto it = mInputSegments.find(locator.port);
+    if (!IsLocatorSupported(locator) || it == mInputSegments.end())
+        return false;
+
+    // The segment stays mapped until the thread blocked on it returns.
+    it->second->Close();
+    mInputSegments.erase(it);
+    return true;
+}
+
+bool SharedMemTransport::CloseOutputChannel(const Locator_t& locator)
+{
+    std::lock_guard<std::mutex> lock(mOutputMapMutex);
+    if (!IsLocatorSupported(locator) || mOutputChannels.erase(locator.port) == 0)
+        return false;
+
+    if (mOutputChannels.empty())
+        mRemoteSegments.clear();
+    return true;
+}
+
+bool SharedMemTransport::Send(const octet* sendBuffer, uint32_t sendBufferSize, const Locator_t& localLocator, const Locator_t& remoteLocator)
+{
+    SendBufferSlice slice(sendBuffer, sendBufferSize);
+    return SharedMemTransport::SendGather(&slice, 1, localLocator, remoteLocator);
+}
+
+bool SharedMemTransport::SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& localLocator,
+        const Locator_t& remoteLocator)
+{
+    uint32_t sendBufferSize = 0;
+    for(uint32_t i = 0; i < sliceCount; ++i)
+        sendBufferSize += slices[i].size;
+
+    if (!IsLocatorSupported(remoteLocator) || !IsLocalHost(remoteLocator) ||
+            sendBufferSize > mMaxMessageSize || !IsOutputChannelOpen(localLocator))
+        return false;
+
+    std::shared_ptr<PortSegment> segment = RemoteSegment(remoteLocator.port);
+    if (!segment)
+        return false;
+
+    return segment->Push(slices, sliceCount, localLocator.port);
+}
+
+bool SharedMemTransport::Receive(octet* receiveBuffer, uint32_t receiveBufferCapacity, uint32_t& receiveBufferSize,
+        const Locator_t& localLocator, Locator_t& remoteLocator)
+{
+    std::shared_ptr<PortSegment> segment;
+    {
+        std::lock_guard<std::mutex> lock(mInputMapMutex);
+        auto it = mInputSegments.find(localLocator.port);
+        if (!IsLocatorSupported(localLocator) || it == mInputSegments.end())
+            return false;
+        segment = it->second;
+    }
+
+    uint32_t remotePort = 0;
+    if (!segment->Pop(receiveBuffer, receiveBufferCapacity, receiveBufferSize, remotePort))
+        return false;
+
+    remoteLocator.kind = LOCATOR_KIND_SHM;
+    remoteLocator.port = remotePort;
+    memset(remoteLocator.address, 0x00, sizeof(remoteLocator.address));
+    memcpy(&remoteLocator.address[8], mHostId, sizeof(mHostId));
+    return true;
+}
+
+LocatorList_t SharedMemTransport::NormalizeLocator(const Locator_t& locator)
+{
+    LocatorList_t list;
+    Locator_t newloc(locator);
+    memset(newloc.address, 0x00, sizeof(newloc.address));
+    memcpy(&newloc.address[8], mHostId, sizeof(mHostId));
+    list.push_back(newloc);
+    return list;
+}
+
+std::string SharedMemTransport::SegmentName(uint32_t port) const
+{
+    return "/" + mSegmentNamePrefix + "_shm_" + std::to_string(port);
+}
+
+bool SharedMemTransport::IsLocalHost(const Locator_t& locator) const
+{
+    static const octet anyHost[16] = {0};
+    return memcmp(locator.address, anyHost, sizeof(anyHost)) == 0 ||
+        memcmp(&locator.address[8], mHostId, sizeof(mHostId)) == 0;
+}
+
+std::shared_ptr<SharedMemTransport::PortSegment> SharedMemTransport::RemoteSegment(uint32_t port)
+{
+    std::lock_guard<std::mutex> lock(mOutputMapMutex);
+    auto it = mRemoteSegments.find(port);
+    if (it != mRemoteSegments.end())
+    {
+        if (it->second->IsOpen())
+            return it->second;
+
+        // The owner closed the port. Another transport may have taken it since.
+        mRemoteSegments.erase(it);
+    }
+
+    auto segment = std::make_shared<PortSegment>(SegmentName(port));
+    if (!segment->Attach())
+        return nullptr;
+
+    mRemoteSegments.emplace(port, segment);
+    return segment;
+}
+
+} // namespace rtps
+} // namespace fastrtps
+} // namespace eprosima
@@ -18,7 +18,11 @@
 #include <algorithm>
 #include <fastrtps/utils/IPFinder.h>
 #include <fastrtps/log/Log.h>
-#include <fastrtps/utils/Semaphore.h>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
 
 using namespace std;
 using namespace asio;
@@ -30,6 +34,13 @@ namespace rtps{
 static const uint32_t maximumUDPSocketSize = 65536;
 static const uint32_t maximumMessageSize = 65500;
 static const uint8_t defaultTTL = 1;
+static const uint32_t defaultReceiveBatchSize = 1;
+static const uint32_t maximumReceiveBatchSize = 64;
+static const uint32_t defaultReceiveSocketsPerPort = 1;
+
+#if defined(SO_REUSEPORT)
+typedef asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port;
+#endif
 
 static void GetIP4s(vector<IPFinder::info_IP>& locNames, bool return_loopback = false)
 {
@@ -58,7 +69,9 @@ UDPv4Transport::UDPv4Transport(const UDPv4TransportDescriptor& descriptor):
     mMaxMessageSize(descriptor.maxMessageSize),
     mSendBufferSize(descriptor.sendBufferSize),
     mReceiveBufferSize(descriptor.receiveBufferSize),
-    mTTL(descriptor.TTL)
+    mTTL(descriptor.TTL),
+    mReceiveBatchSize(descriptor.receiveBatchSize),
+    mReceiveSocketsPerPort(descriptor.receiveSocketsPerPort)
     {
         for (const auto& interface : descriptor.interfaceWhiteList)
             mInterfaceWhiteList.emplace_back(ip::address_v4::from_string(interface));
@@ -68,24 +81,23 @@ UDPv4TransportDescriptor::UDPv4TransportDescriptor():
     TransportDescriptorInterface(maximumMessageSize),
     sendBufferSize(maximumUDPSocketSize),
     receiveBufferSize(maximumUDPSocketSize),
-    TTL(defaultTTL)
+    TTL(defaultTTL),
+    receiveBatchSize(defaultReceiveBatchSize),
+    receiveSocketsPerPort(defaultReceiveSocketsPerPort)
     {}
 
 UDPv4Transport::UDPv4Transport() :
     mMaxMessageSize(maximumMessageSize),
     mSendBufferSize(maximumUDPSocketSize),
     mReceiveBufferSize(maximumUDPSocketSize),
-    mTTL(defaultTTL)
+    mTTL(defaultTTL),
+    mReceiveBatchSize(defaultReceiveBatchSize),
+    mReceiveSocketsPerPort(defaultReceiveSocketsPerPort)
     {
     }
 
 UDPv4Transport::~UDPv4Transport()
 {
-    if(ioServiceThread)
-    {
-        mService.stop();
-        ioServiceThread->join();
-    }
 }
 
 bool UDPv4Transport::init()
@@ -108,12 +120,25 @@ bool UDPv4Transport::init()
         return false;
     }
 
-    auto ioServiceFunction = [&]()
+    if(mReceiveBatchSize == 0 || mReceiveBatchSize > maximumReceiveBatchSize)
+    {
+        logError(RTPS_MSG_IN, "receiveBatchSize has to be between 1 and " << maximumReceiveBatchSize);
+        return false;
+    }
+
+    if(mReceiveSocketsPerPort == 0)
     {
-        io_service::work work(mService);
-        mService.run();
-    };
-    ioServiceThread.reset(new std::thread(ioServiceFunction));
+        logError(RTPS_MSG_IN, "receiveSocketsPerPort cannot be 0");
+        return false;
+    }
+
+#if !defined(SO_REUSEPORT)
+    if(mReceiveSocketsPerPort > 1)
+    {
+        logWarning(RTPS_MSG_IN, "SO_REUSEPORT is not supported, so each port is read through a single socket");
+        mReceiveSocketsPerPort = 1;
+    }
+#endif
 
     return true;
 }
@@ -162,18 +187,14 @@ bool UDPv4Transport::OpenInputChannel(const Locator_t& locator)
     {
         // The multicast group will be joined silently, because we do not
         // want to return another resource.
-        auto& socket = mInputSockets.at(locator.port);
+        auto& socket = mInputSockets.at(locator.port).front();
 
         std::vector<IPFinder::info_IP> locNames;
         GetIP4s(locNames, true);
         for (const auto& infoIP : locNames)
         {
             auto ip = asio::ip::address_v4::from_string(infoIP.name);
-#if defined(ASIO_HAS_MOVE)
-            socket.set_option(ip::multicast::join_group(ip::address_v4::from_string(locator.to_IP4_string()), ip));
-#else
             socket->set_option(ip::multicast::join_group(ip::address_v4::from_string(locator.to_IP4_string()), ip));
-#endif
         }
     }
 
@@ -186,18 +207,7 @@ bool UDPv4Transport::CloseOutputChannel(const Locator_t& locator)
     if (!IsOutputChannelOpen(locator))
         return false;
 
-    auto& sockets = mOutputSockets.at(locator.port);
-    for (auto& socket : sockets)
-    {
-#if defined(ASIO_HAS_MOVE)
-        socket.socket_.cancel();
-        socket.socket_.close();
-#else
-        socket.socket_->cancel();
-        socket.socket_->close();
-#endif
-    }
-
+    // Sockets are closed when destroyed, once the last send through them returns.
     mOutputSockets.erase(locator.port);
 
     return true;
@@ -210,14 +220,14 @@ bool UDPv4Transport::CloseInputChannel(const Locator_t& locator)
         return false;
 
 
-    auto& socket = mInputSockets.at(locator.port);
-#if defined(ASIO_HAS_MOVE)
-    socket.cancel();
-    socket.close();
-#else
-    socket->cancel();
-    socket->close();
-#endif
+    for(auto& socket : mInputSockets.at(locator.port))
+    {
+        socket->cancel();
+        // Wakes up the thread blocked on a receive through this socket.
+        asio::error_code error;
+        socket->shutdown(asio::socket_base::shutdown_both, error);
+        socket->close();
+    }
 
     mInputSockets.erase(locator.port);
     return true;
@@ -352,18 +362,34 @@ bool UDPv4Transport::OpenAndBindInputSockets(uint32_t port, bool is_multicast)
 {
     std::unique_lock<std::recursive_mutex> scopedLock(mInputMapMutex);
 
+    // Every socket bound to a multicast port receives all its datagrams, so only unicast ports are shared.
+    uint32_t socketCount = is_multicast ? 1 : mReceiveSocketsPerPort;
+    std::vector<std::shared_ptr<ip::udp::socket>> sockets;
+
     try
     {
-        mInputSockets.emplace(port, OpenAndBindInputSocket(port, is_multicast));
+        // SO_REUSEPORT would let us bind a port already in use by another participant, so we check first
+        // that the port is free.
+        if(socketCount > 1)
+            OpenAndBindInputSocket(port, is_multicast, false);
+
+        for(uint32_t i = 0; i < socketCount; ++i)
+        {
+#if defined(ASIO_HAS_MOVE)
+            sockets.push_back(std::make_shared<ip::udp::socket>(OpenAndBindInputSocket(port, is_multicast, socketCount > 1)));
+#else
+            sockets.push_back(OpenAndBindInputSocket(port, is_multicast, socketCount > 1));
+#endif
+        }
     }
     catch (asio::system_error const& e)
     {
         (void)e;
         logInfo(RTPS_MSG_OUT, "UDPv4 Error binding at port: (" << port << ")" << " with msg: "<<e.what());
-        mInputSockets.erase(port);
         return false;
     }
 
+    mInputSockets.emplace(port, std::move(sockets));
     return true;
 }
 
@@ -401,26 +427,38 @@ std::shared_ptr<asio::ip::udp::socket> UDPv4Transport::OpenAndBindUnicastOutputS
 #endif
 
 #if defined(ASIO_HAS_MOVE)
-asio::ip::udp::socket UDPv4Transport::OpenAndBindInputSocket(uint32_t port, bool is_multicast)
+asio::ip::udp::socket UDPv4Transport::OpenAndBindInputSocket(uint32_t port, bool is_multicast, bool share_port)
 {
     ip::udp::socket socket(mService);
     socket.open(ip::udp::v4());
     socket.set_option(socket_base::receive_buffer_size(mReceiveBufferSize));
     if(is_multicast)
         socket.set_option(ip::udp::socket::reuse_address( true ) );
+#if defined(SO_REUSEPORT)
+    if(share_port)
+        socket.set_option(reuse_port( true ));
+#else
+    (void)share_port;
+#endif
     ip::udp::endpoint endpoint(ip::address_v4::any(), static_cast<uint16_t>(port));
     socket.bind(endpoint);
 
     return socket;
 }
 #else
-std::shared_ptr<asio::ip::udp::socket> UDPv4Transport::OpenAndBindInputSocket(uint32_t port, bool is_multicast)
+std::shared_ptr<asio::ip::udp::socket> UDPv4Transport::OpenAndBindInputSocket(uint32_t port, bool is_multicast, bool share_port)
 {
     std::shared_ptr<ip::udp::socket> socket = std::make_shared<ip::udp::socket>(mService);
     socket->open(ip::udp::v4());
     socket->set_option(socket_base::receive_buffer_size(mReceiveBufferSize));
     if(is_multicast)
         socket->set_option(ip::udp::socket::reuse_address( true ) );
+#if defined(SO_REUSEPORT)
+    if(share_port)
+        socket->set_option(reuse_port( true ));
+#else
+    (void)share_port;
+#endif
     ip::udp::endpoint endpoint(ip::address_v4::any(), static_cast<uint16_t>(port));
     socket->bind(endpoint);
 
@@ -450,21 +488,45 @@ Locator_t UDPv4Transport::RemoteToMainLocal(const Locator_t& remote) const
 
 bool UDPv4Transport::Send(const octet* sendBuffer, uint32_t sendBufferSize, const Locator_t& localLocator, const Locator_t& remoteLocator)
 {
-    std::unique_lock<std::recursive_mutex> scopedLock(mOutputMapMutex);
-    if (!IsOutputChannelOpen(localLocator) ||
+    if (!IsLocatorSupported(remoteLocator) ||
             sendBufferSize > mSendBufferSize)
         return false;
 
     bool success = false;
-    bool is_multicast_remote_address = IsMulticastAddress(remoteLocator);
 
-    auto& sockets = mOutputSockets.at(localLocator.port);
-    for (auto& socket : sockets)
+    // The channel lock is not held while sending, so that sends through the channel don't wait on each other.
+    for (auto& socket : GetOutputSockets(localLocator, IsMulticastAddress(remoteLocator)))
+        success |= SendThroughSocket(asio::buffer(sendBuffer, sendBufferSize), sendBufferSize, remoteLocator, *socket);
+
+    return success;
+}
+
+bool UDPv4Transport::SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& localLocator,
+        const Locator_t& remoteLocator)
+{
+    // Asio gathers at most 64 buffers in a single send operation.
+    if(sliceCount > 64)
+        return TransportInterface::SendGather(slices, sliceCount, localLocator, remoteLocator);
+
+    std::vector<asio::const_buffer> buffers;
+    buffers.reserve(sliceCount);
+    uint32_t sendBufferSize = 0;
+    for(uint32_t i = 0; i < sliceCount; ++i)
     {
-        if(is_multicast_remote_address || !socket.only_multicast_purpose())
-            success |= SendThroughSocket(sendBuffer, sendBufferSize, remoteLocator, socket.socket_);
+        buffers.push_back(asio::buffer(slices[i].buffer, slices[i].size));
+        sendBufferSize += slices[i].size;
     }
 
+    if (!IsLocatorSupported(remoteLocator) ||
+            sendBufferSize > mSendBufferSize)
+        return false;
+
+    bool success = false;
+
+    // The channel lock is not held while sending, so that sends through the channel don't wait on each other.
+    for (auto& socket : GetOutputSockets(localLocator, IsMulticastAddress(remoteLocator)))
+        success |= SendThroughSocket(buffers, sendBufferSize, remoteLocator, *socket);
+
     return success;
 }
 
@@ -478,86 +540,197 @@ static void EndpointToLocator(ip::udp::endpoint& endpoint, Locator_t& locator)
 bool UDPv4Transport::Receive(octet* receiveBuffer, uint32_t receiveBufferCapacity, uint32_t& receiveBufferSize,
         const Locator_t& localLocator, Locator_t& remoteLocator)
 {
-    if (!IsInputChannelOpen(localLocator) ||
-            receiveBufferCapacity < mReceiveBufferSize)
+    ReceiveBufferSlot slot;
+    slot.buffer = receiveBuffer;
+    slot.capacity = receiveBufferCapacity;
+
+    if(ReceiveBatchFromShard(&slot, 1, localLocator, 0) == 0)
+    {
+        receiveBufferSize = 0;
         return false;
+    }
 
-    Semaphore receiveSemaphore(0);
-    bool success = false;
+    receiveBufferSize = slot.size;
+    remoteLocator = slot.remoteLocator;
+    return true;
+}
 
-    auto handler = [&receiveBuffer, &receiveBufferSize, &success, &receiveSemaphore]
-        (const asio::error_code& error, std::size_t bytes_transferred)
-        {
-            if(error)
-            {
-                logInfo(RTPS_MSG_IN, "Error while listening to socket...");
-                receiveBufferSize = 0;
-            }
-            else
-            {
-                logInfo(RTPS_MSG_IN,"Msg processed (" << bytes_transferred << " bytes received), Socket async receive put again to listen ");
-                receiveBufferSize = static_cast<uint32_t>(bytes_transferred);
-                success = true;
-            }
+uint32_t UDPv4Transport::ReceiveBatch(ReceiveBufferSlot* slots, uint32_t slotCount, const Locator_t& localLocator)
+{
+    return ReceiveBatchFromShard(slots, slotCount, localLocator, 0);
+}
+
+uint32_t UDPv4Transport::ReceiveBatchFromShard(ReceiveBufferSlot* slots, uint32_t slotCount, const Locator_t& localLocator,
+        uint32_t shard)
+{
+    if(slotCount == 0 || slots[0].capacity < mReceiveBufferSize)
+        return 0;
 
-            receiveSemaphore.post();
-        };
+    std::shared_ptr<ip::udp::socket> socket = GetInputSocket(localLocator, shard);
+    if(!socket)
+        return 0;
 
+    // The first datagram is awaited as usual.
+    if(!ReceiveThroughSocket(*socket, slots[0]))
+        return 0;
+
+    if(slotCount > mReceiveBatchSize)
+        slotCount = mReceiveBatchSize;
+
+    if(slotCount == 1)
+        return 1;
+
+    return 1 + DrainInputSocket(slots + 1, slotCount - 1, *socket);
+}
+
+uint32_t UDPv4Transport::MaxReceiveBatchSize() const
+{
+    return mReceiveBatchSize;
+}
+
+uint32_t UDPv4Transport::InputChannelShards(const Locator_t& localLocator) const
+{
+    std::unique_lock<std::recursive_mutex> scopedLock(mInputMapMutex);
+    if (!IsInputChannelOpen(localLocator))
+        return 1;
+
+    return static_cast<uint32_t>(mInputSockets.at(localLocator.port).size());
+}
+
+std::vector<std::shared_ptr<asio::ip::udp::socket>> UDPv4Transport::GetOutputSockets(const Locator_t& localLocator,
+        bool is_multicast_remote_address) const
+{
+    std::vector<std::shared_ptr<asio::ip::udp::socket>> sockets;
+
+    std::unique_lock<std::recursive_mutex> scopedLock(mOutputMapMutex);
+    auto channel = mOutputSockets.find(localLocator.port);
+    if (!IsLocatorSupported(localLocator) || channel == mOutputSockets.end())
+        return sockets;
+
+    sockets.reserve(channel->second.size());
+    for (auto& socket : channel->second)
+    {
+        if(is_multicast_remote_address || !socket.only_multicast_purpose())
+            sockets.push_back(socket.socket_);
+    }
+
+    return sockets;
+}
+
+std::shared_ptr<asio::ip::udp::socket> UDPv4Transport::GetInputSocket(const Locator_t& localLocator, uint32_t shard) const
+{
+    std::unique_lock<std::recursive_mutex> scopedLock(mInputMapMutex);
+    if (!IsInputChannelOpen(localLocator))
+        return nullptr;
+
+    auto& sockets = mInputSockets.at(localLocator.port);
+    if(shard >= sockets.size())
+        return nullptr;
+
+    return sockets[shard];
+}
+
+bool UDPv4Transport::ReceiveThroughSocket(ip::udp::socket& socket, ReceiveBufferSlot& slot)
+{
+    // The listening thread reads the socket itself, without handing the operation to the io_service.
     ip::udp::endpoint senderEndpoint;
+    asio::error_code error;
+    size_t bytes_transferred = socket.receive_from(asio::buffer(slot.buffer, slot.capacity),
+            senderEndpoint, 0, error);
 
-    { // lock scope
-        std::unique_lock<std::recursive_mutex> scopedLock(mInputMapMutex);
-        if (!IsInputChannelOpen(localLocator))
-            return false;
+    // A shut down socket returns an empty datagram, which is not a valid message anyway.
+    if(error || bytes_transferred == 0)
+    {
+        logInfo(RTPS_MSG_IN, "Error while listening to socket...");
+        slot.size = 0;
+        return false;
+    }
 
-        auto& socket = mInputSockets.at(localLocator.port);
-#if defined(ASIO_HAS_MOVE)
-        socket.async_receive_from(asio::buffer(receiveBuffer, receiveBufferCapacity),
-                senderEndpoint,
-                handler);
-#else
-        socket->async_receive_from(asio::buffer(receiveBuffer, receiveBufferCapacity),
-                senderEndpoint,
-                handler);
-#endif
+    logInfo(RTPS_MSG_IN,"Msg processed (" << bytes_transferred << " bytes received)");
+    slot.size = static_cast<uint32_t>(bytes_transferred);
+    EndpointToLocator(senderEndpoint, slot.remoteLocator);
+
+    return true;
+}
+
+uint32_t UDPv4Transport::DrainInputSocket(ReceiveBufferSlot* slots, uint32_t slotCount, ip::udp::socket& socket)
+{
+    uint32_t received = 0;
+
+#if defined(__linux__)
+    struct mmsghdr headers[maximumReceiveBatchSize];
+    struct iovec vectors[maximumReceiveBatchSize];
+    struct sockaddr_in addresses[maximumReceiveBatchSize];
+
+    uint32_t count = 0;
+    for(; count < slotCount && count < maximumReceiveBatchSize; ++count)
+    {
+        if(slots[count].capacity < mReceiveBufferSize)
+            break;
+
+        vectors[count].iov_base = slots[count].buffer;
+        vectors[count].iov_len = slots[count].capacity;
+        memset(&headers[count], 0, sizeof(struct mmsghdr));
+        headers[count].msg_hdr.msg_iov = &vectors[count];
+        headers[count].msg_hdr.msg_iovlen = 1;
+        headers[count].msg_hdr.msg_name = &addresses[count];
+        headers[count].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
     }
 
-    receiveSemaphore.wait();
-    if (success)
-        EndpointToLocator(senderEndpoint, remoteLocator);
+    if(count == 0)
+        return 0;
 
-    return success;
+    int result = recvmmsg(socket.native_handle(), headers, count, MSG_DONTWAIT, nullptr);
+
+    for(int i = 0; i < result; ++i)
+    {
+        slots[i].size = static_cast<uint32_t>(headers[i].msg_len);
+        slots[i].remoteLocator.kind = LOCATOR_KIND_UDPv4;
+        slots[i].remoteLocator.port = ntohs(addresses[i].sin_port);
+        memcpy(&slots[i].remoteLocator.address[12], &addresses[i].sin_addr, 4);
+        ++received;
+    }
+#else
+    try
+    {
+        while(received < slotCount && slots[received].capacity >= mReceiveBufferSize)
+        {
+            ip::udp::endpoint senderEndpoint;
+            if(socket.available() == 0)
+                break;
+            size_t bytes = socket.receive_from(asio::buffer(slots[received].buffer, slots[received].capacity), senderEndpoint);
+            slots[received].size = static_cast<uint32_t>(bytes);
+            EndpointToLocator(senderEndpoint, slots[received].remoteLocator);
+            ++received;
+        }
+    }
+    catch (asio::system_error const& e)
+    {
+        (void)e;
+        logInfo(RTPS_MSG_IN, "UDPv4 Error draining input socket with msg: "<<e.what());
+    }
+#endif
+
+    return received;
 }
 
-bool UDPv4Transport::SendThroughSocket(const octet* sendBuffer,
+template<typename ConstBufferSequence>
+bool UDPv4Transport::SendThroughSocket(const ConstBufferSequence& buffers,
         uint32_t sendBufferSize,
         const Locator_t& remoteLocator,
-#if defined(ASIO_HAS_MOVE)
         asio::ip::udp::socket& socket)
-#else
-        std::shared_ptr<asio::ip::udp::socket> socket)
-#endif
 {
 
     asio::ip::address_v4::bytes_type remoteAddress;
     memcpy(&remoteAddress, &remoteLocator.address[12], sizeof(remoteAddress));
     auto destinationEndpoint = ip::udp::endpoint(asio::ip::address_v4(remoteAddress), static_cast<uint16_t>(remoteLocator.port));
     size_t bytesSent = 0;
-#if defined(ASIO_HAS_MOVE)
     logInfo(RTPS_MSG_OUT,"UDPv4: " << sendBufferSize << " bytes TO endpoint: " << destinationEndpoint
             << " FROM " << socket.local_endpoint());
-#else
-    logInfo(RTPS_MSG_OUT,"UDPv4: " << sendBufferSize << " bytes TO endpoint: " << destinationEndpoint
-            << " FROM " << socket->local_endpoint());
-#endif
 
     try
     {
-#if defined(ASIO_HAS_MOVE)
-        bytesSent = socket.send_to(asio::buffer(sendBuffer, sendBufferSize), destinationEndpoint);
-#else
-        bytesSent = socket->send_to(asio::buffer(sendBuffer, sendBufferSize), destinationEndpoint);
-#endif
+        bytesSent = socket.send_to(buffers, destinationEndpoint);
     }
     catch (const std::exception& error)
     {
@@ -566,6 +739,7 @@ bool UDPv4Transport::SendThroughSocket(const octet* sendBuffer,
     }
 
     (void) bytesSent;
+    (void) sendBufferSize;
     logInfo (RTPS_MSG_OUT,"SENT " << bytesSent);
     return true;
 }
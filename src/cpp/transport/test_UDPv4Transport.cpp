@@ -72,6 +72,12 @@ bool test_UDPv4Transport::Send(const octet* sendBuffer, uint32_t sendBufferSize,
         return UDPv4Transport::Send(sendBuffer, sendBufferSize, localLocator, remoteLocator);
 }
 
+bool test_UDPv4Transport::SendGather(const SendBufferSlice* slices, uint32_t sliceCount, const Locator_t& localLocator,
+        const Locator_t& remoteLocator)
+{
+    return TransportInterface::SendGather(slices, sliceCount, localLocator, remoteLocator);
+}
+
 static bool ReadSubmessageHeader(CDRMessage_t& msg, SubmessageHeader_t& smh)
 {
     if(msg.length - msg.pos < 4)
@@ -16,6 +16,7 @@
 #include "types/StringType.h"
 #include "types/Data64kbType.h"
 #include "types/Data1mbType.h"
+#include "types/FixedSizedType.h"
 
 /****** Auxiliary print functions  ******/
 template<class Type>
@@ -220,6 +221,24 @@ std::list<Data1mb> default_data300kb_data_generator(size_t max = 0)
     return returnedValue;
 }
 
+std::list<FixedSized> default_fixed_sized_data_generator(size_t max = 0)
+{
+    uint32_t index = 1;
+    size_t maximum = max ? max : 10;
+    std::list<FixedSized> returnedValue(maximum);
+
+    std::generate(returnedValue.begin(), returnedValue.end(), [&index] {
+            FixedSized data;
+            data.index = index;
+            for(size_t i = 0; i < data.data.size(); ++i)
+            data.data[i] = static_cast<uint8_t>(i + index);
+            ++index;
+            return data;
+            });
+
+    return returnedValue;
+}
+
 /****** Auxiliary lambda functions  ******/
 const std::function<void(const HelloWorld&)>  default_helloworld_print = [](const HelloWorld& hello)
 {
@@ -735,7 +754,8 @@ BLACKBOXTEST(BlackBox, PubSubAsReliableData64kb)
     PubSubWriter<Data64kbType> writer(TEST_TOPIC_NAME);
 
     reader.history_depth(10).
-        reliability(eprosima::fastrtps::RELIABLE_RELIABILITY_QOS).init();
+        reliability(eprosima::fastrtps::RELIABLE_RELIABILITY_QOS).
+        take_loaned(true).init();
 
     ASSERT_TRUE(reader.isInitialized());
 
@@ -1029,6 +1049,223 @@ BLACKBOXTEST(BlackBox, AsyncPubSubAsReliableData300kbInLossyConditions)
 }
 
 
+BLACKBOXTEST(BlackBox, PubSubAsNonReliableHelloworldIntraprocess)
+{
+    PubSubReader<HelloWorldType> reader(TEST_TOPIC_NAME);
+    PubSubWriter<HelloWorldType> writer(TEST_TOPIC_NAME);
+
+    reader.intraprocess_delivery(true).init();
+
+    ASSERT_TRUE(reader.isInitialized());
+
+    // All DATA messages are dropped by the transport. Samples can only arrive
+    // if they are handed directly to the reader.
+    auto testTransport = std::make_shared<test_UDPv4TransportDescriptor>();
+    testTransport->dropDataMessagesPercentage = 100;
+    writer.disable_builtin_transport();
+    writer.add_user_transport_to_pparams(testTransport);
+
+    writer.reliability(eprosima::fastrtps::BEST_EFFORT_RELIABILITY_QOS).
+        intraprocess_delivery(true).init();
+
+    ASSERT_TRUE(writer.isInitialized());
+
+    // Because its volatile the durability
+    // Wait for discovery.
+    writer.waitDiscovery();
+    reader.waitDiscovery();
+
+    auto data = default_helloworld_data_generator();
+
+    reader.startReception(data);
+
+    // Send data
+    writer.send(data);
+    // In this test all data should be sent.
+    ASSERT_TRUE(data.empty());
+    // Block reader until reception finished or timeout.
+    reader.block_for_all();
+}
+
+BLACKBOXTEST(BlackBox, PubSubAsReliableHelloworldIntraprocess)
+{
+    PubSubReader<HelloWorldType> reader(TEST_TOPIC_NAME);
+    PubSubWriter<HelloWorldType> writer(TEST_TOPIC_NAME);
+
+    reader.history_depth(100).
+        reliability(eprosima::fastrtps::RELIABLE_RELIABILITY_QOS).
+        intraprocess_delivery(true).init();
+
+    ASSERT_TRUE(reader.isInitialized());
+
+    // All DATA messages are dropped by the transport. Heartbeats and acknacks
+    // still go through it, so the writer learns the samples were received.
+    auto testTransport = std::make_shared<test_UDPv4TransportDescriptor>();
+    testTransport->dropDataMessagesPercentage = 100;
+    writer.disable_builtin_transport();
+    writer.add_user_transport_to_pparams(testTransport);
+
+    writer.history_depth(100).
+        intraprocess_delivery(true).init();
+
+    ASSERT_TRUE(writer.isInitialized());
+
+    // Because its volatile the durability
+    // Wait for discovery.
+    writer.waitDiscovery();
+    reader.waitDiscovery();
+
+    auto data = default_helloworld_data_generator();
+
+    reader.startReception(data);
+
+    // Send data
+    writer.send(data);
+    // In this test all data should be sent.
+    ASSERT_TRUE(data.empty());
+    // Block reader until reception finished or timeout.
+    reader.block_for_all();
+    // Reliability state is kept, so the writer sees every sample acknowledged.
+    ASSERT_TRUE(writer.waitForAllAcked(std::chrono::seconds(5)));
+}
+
+BLACKBOXTEST(BlackBox, AsyncPubSubAsReliableData300kbIntraprocess)
+{
+    PubSubReader<Data1mbType> reader(TEST_TOPIC_NAME);
+    PubSubWriter<Data1mbType> writer(TEST_TOPIC_NAME);
+
+    reader.history_depth(5).
+        reliability(eprosima::fastrtps::RELIABLE_RELIABILITY_QOS).
+        intraprocess_delivery(true).init();
+
+    ASSERT_TRUE(reader.isInitialized());
+
+    // Fragments are never sent to readers of the same process, so all of them can be dropped.
+    auto testTransport = std::make_shared<test_UDPv4TransportDescriptor>();
+    testTransport->dropDataFragMessagesPercentage = 100;
+    writer.disable_builtin_transport();
+    writer.add_user_transport_to_pparams(testTransport);
+
+    writer.history_depth(5).
+        asynchronously(eprosima::fastrtps::ASYNCHRONOUS_PUBLISH_MODE).
+        intraprocess_delivery(true).init();
+
+    ASSERT_TRUE(writer.isInitialized());
+
+    // Because its volatile the durability
+    // Wait for discovery.
+    writer.waitDiscovery();
+    reader.waitDiscovery();
+
+    auto data = default_data300kb_data_generator(5);
+
+    reader.startReception(data);
+
+    // Send data
+    writer.send(data);
+    // In this test all data should be sent.
+    ASSERT_TRUE(data.empty());
+    // Block reader until reception finished or timeout.
+    reader.block_for_all();
+}
+
+BLACKBOXTEST(BlackBox, PubSubAsReliableFixedSizedLoaned)
+{
+    PubSubReader<FixedSizedType> reader(TEST_TOPIC_NAME);
+    PubSubWriter<FixedSizedType> writer(TEST_TOPIC_NAME);
+
+    reader.history_depth(10).
+        reliability(eprosima::fastrtps::RELIABLE_RELIABILITY_QOS).init();
+
+    ASSERT_TRUE(reader.isInitialized());
+
+    writer.history_depth(10).init();
+
+    ASSERT_TRUE(writer.isInitialized());
+
+    // Because its volatile the durability
+    // Wait for discovery.
+    writer.waitDiscovery();
+    reader.waitDiscovery();
+
+    auto data = default_fixed_sized_data_generator();
+
+    reader.startReception(data);
+
+    // Samples are filled inside the changes of the writer, and read inside the changes of the reader.
+    writer.send_loaned(data);
+    // In this test all data should be sent.
+    ASSERT_TRUE(data.empty());
+    // Block reader until reception finished or timeout.
+    reader.block_for_all();
+}
+
+BLACKBOXTEST(BlackBox, PubSubAsReliableHelloworldTakeLoaned)
+{
+    PubSubReader<HelloWorldType> reader(TEST_TOPIC_NAME);
+    PubSubWriter<HelloWorldType> writer(TEST_TOPIC_NAME);
+
+    // Types which are not plain are deserialized into loaned objects.
+    reader.history_depth(10).
+        reliability(eprosima::fastrtps::RELIABLE_RELIABILITY_QOS).
+        take_loaned(true).init();
+
+    ASSERT_TRUE(reader.isInitialized());
+
+    writer.history_depth(10).init();
+
+    ASSERT_TRUE(writer.isInitialized());
+
+    // Because its volatile the durability
+    // Wait for discovery.
+    writer.waitDiscovery();
+    reader.waitDiscovery();
+
+    auto data = default_helloworld_data_generator();
+
+    reader.startReception(data);
+
+    // Send data
+    writer.send(data);
+    // In this test all data should be sent.
+    ASSERT_TRUE(data.empty());
+    // Block reader until reception finished or timeout.
+    reader.block_for_all();
+}
+
+BLACKBOXTEST(BlackBox, PubSubAsReliableHelloworldTakeBulk)
+{
+    PubSubReader<HelloWorldType> reader(TEST_TOPIC_NAME);
+    PubSubWriter<HelloWorldType> writer(TEST_TOPIC_NAME);
+
+    // Several samples are taken at once.
+    reader.history_depth(10).
+        reliability(eprosima::fastrtps::RELIABLE_RELIABILITY_QOS).
+        take_bulk(4).init();
+
+    ASSERT_TRUE(reader.isInitialized());
+
+    writer.history_depth(10).init();
+
+    ASSERT_TRUE(writer.isInitialized());
+
+    // Because its volatile the durability
+    // Wait for discovery.
+    writer.waitDiscovery();
+    reader.waitDiscovery();
+
+    auto data = default_helloworld_data_generator();
+
+    reader.startReception(data);
+
+    // Send data
+    writer.send(data);
+    // In this test all data should be sent.
+    ASSERT_TRUE(data.empty());
+    // Block reader until reception finished or timeout.
+    reader.block_for_all();
+}
+
 BLACKBOXTEST(BlackBox, AsyncFragmentSizeTest)
 {
     // ThroghputController size large than maxMessageSize.
@@ -32,6 +32,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include <condition_variable>
 #include <asio.hpp>
 #include <gtest/gtest.h>
@@ -112,7 +113,7 @@ class PubSubReader
     public:
 
         PubSubReader(const std::string& topic_name) : participant_listener_(*this), listener_(*this), participant_(nullptr), subscriber_(nullptr),
-        topic_name_(topic_name), initialized_(false), matched_(0), receiving_(false), current_received_count_(0),
+        topic_name_(topic_name), initialized_(false), matched_(0), receiving_(false), take_loaned_(false), take_bulk_(0), current_received_count_(0),
         number_samples_expected_(0), discovery_result_(false), onDiscovery_(nullptr)
 #if HAVE_SECURITY
         , authorized_(0), unauthorized_(0)
@@ -350,6 +351,24 @@ class PubSubReader
             return *this;
         }
 
+        PubSubReader& take_loaned(bool enabled)
+        {
+            take_loaned_ = enabled;
+            return *this;
+        }
+
+        PubSubReader& take_bulk(uint32_t max_samples)
+        {
+            take_bulk_ = max_samples;
+            return *this;
+        }
+
+        PubSubReader& intraprocess_delivery(bool enabled)
+        {
+            participant_attr_.rtps.useIntraprocessDelivery = enabled;
+            return *this;
+        }
+
         PubSubReader& durability_kind(const eprosima::fastrtps::DurabilityQosPolicyKind kind)
         {
             subscriber_attr_.qos.m_durability.kind = kind;
@@ -437,30 +456,66 @@ class PubSubReader
 
             if(receiving_)
             {
+                if(take_bulk_ > 0)
+                {
+                    std::vector<type> datas(take_bulk_);
+                    std::vector<void*> pointers;
+                    for(type& data : datas)
+                        pointers.push_back(&data);
+                    std::vector<SampleInfo_t> infos(take_bulk_);
+
+                    uint32_t taken = subscriber->takeData(pointers.data(), infos.data(), take_bulk_);
+                    ASSERT_LE(taken, take_bulk_);
+                    returnedValue = taken > 0;
+                    for(uint32_t i = 0; i < taken; ++i)
+                        received(datas[i], infos[i]);
+                    return;
+                }
+
                 type data;
                 SampleInfo_t info;
 
-                if(subscriber->takeNextData((void*)&data, &info))
+                if(take_loaned_ ? take_next_loaned(subscriber, data, info) : subscriber->takeNextData((void*)&data, &info))
                 {
                     returnedValue = true;
-
-                    // Check order of changes.
-                    ASSERT_LT(last_seq, info.sample_identity.sequence_number());
-                    last_seq = info.sample_identity.sequence_number();
-
-                    if(info.sampleKind == ALIVE)
-                    {
-                        auto it = std::find(total_msgs_.begin(), total_msgs_.end(), data);
-                        ASSERT_NE(it, total_msgs_.end());
-                        total_msgs_.erase(it);
-                        ++current_received_count_;
-                        default_receive_print<type>(data);
-                        cv_.notify_one();
-                    }
+                    received(data, info);
                 }
             }
         }
 
+        void received(const type& data, const SampleInfo_t& info)
+        {
+            // Check order of changes.
+            ASSERT_LT(last_seq, info.sample_identity.sequence_number());
+            last_seq = info.sample_identity.sequence_number();
+
+            if(info.sampleKind == ALIVE)
+            {
+                auto it = std::find(total_msgs_.begin(), total_msgs_.end(), data);
+                ASSERT_NE(it, total_msgs_.end());
+                total_msgs_.erase(it);
+                ++current_received_count_;
+                default_receive_print<type>(data);
+                cv_.notify_one();
+            }
+        }
+
+        bool take_next_loaned(eprosima::fastrtps::Subscriber* subscriber, type& data, SampleInfo_t& info)
+        {
+            const void* loan = nullptr;
+
+            if(!subscriber->takeNextLoanedData(&loan, &info))
+                return false;
+
+            if(loan != nullptr)
+            {
+                data = *static_cast<const type*>(loan);
+                EXPECT_TRUE(subscriber->returnLoan(loan));
+            }
+
+            return true;
+        }
+
         void matched()
         {
             std::unique_lock<std::mutex> lock(mutexDiscovery_);
@@ -508,6 +563,8 @@ class PubSubReader
         std::condition_variable cvDiscovery_;
         unsigned int matched_;
         bool receiving_;
+        bool take_loaned_;
+        uint32_t take_bulk_;
         type_support type_;
         SequenceNumber_t last_seq;
         size_t current_received_count_;
@@ -181,6 +181,28 @@ class PubSubWriter
         }
     }
 
+    // Fills each sample in a loaned one before writing it.
+    void send_loaned(std::list<type>& msgs)
+    {
+        auto it = msgs.begin();
+
+        while(it != msgs.end())
+        {
+            type* sample = static_cast<type*>(publisher_->loan_sample());
+            if(sample == nullptr)
+                break;
+
+            *sample = *it;
+            if(publisher_->write_loaned(sample))
+            {
+                default_send_print<type>(*it);
+                it = msgs.erase(it);
+            }
+            else
+                break;
+        }
+    }
+
     void waitDiscovery()
     {
         std::unique_lock<std::mutex> lock(mutexDiscovery_);
@@ -288,6 +310,12 @@ class PubSubWriter
         return *this;
     }
 
+    PubSubWriter& intraprocess_delivery(bool enabled)
+    {
+        participant_attr_.rtps.useIntraprocessDelivery = enabled;
+        return *this;
+    }
+
     PubSubWriter& durability_kind(const eprosima::fastrtps::DurabilityQosPolicyKind kind)
     {
         publisher_attr_.qos.m_durability.kind = kind;
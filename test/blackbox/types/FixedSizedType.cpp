@@ -0,0 +1,71 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file FixedSizedType.cpp
+ *
+ */
+
+#include "FixedSizedType.h"
+
+#include <cstring>
+
+FixedSizedType::FixedSizedType() {
+    setName("FixedSizedType");
+    m_typeSize = (uint32_t)sizeof(FixedSized) + 4 /*encapsulation*/;
+    m_isGetKeyDefined = false;
+}
+
+FixedSizedType::~FixedSizedType() {
+}
+
+bool FixedSizedType::serialize(void* data, SerializedPayload_t* payload)
+{
+    if(payload->max_size < m_typeSize)
+        return false;
+
+    // Encapsulation, followed by the object as it is in memory.
+    payload->encapsulation = DEFAULT_ENDIAN == BIGEND ? CDR_BE : CDR_LE;
+    payload->data[0] = 0;
+    payload->data[1] = (octet)payload->encapsulation;
+    payload->data[2] = 0;
+    payload->data[3] = 0;
+    memcpy(payload->data + 4, data, sizeof(FixedSized));
+    payload->length = m_typeSize;
+    return true;
+}
+
+bool FixedSizedType::deserialize(SerializedPayload_t* payload, void* data)
+{
+    if(payload->length < m_typeSize)
+        return false;
+
+    memcpy(data, payload->data + 4, sizeof(FixedSized));
+    return true;
+}
+
+std::function<uint32_t()> FixedSizedType::getSerializedSizeProvider(void* /*data*/)
+{
+    uint32_t size = m_typeSize;
+    return [size]() -> uint32_t { return size; };
+}
+
+void* FixedSizedType::createData()
+{
+    return (void*)new FixedSized();
+}
+void FixedSizedType::deleteData(void* data)
+{
+    delete((FixedSized*)data);
+}
@@ -0,0 +1,60 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file FixedSizedType.h
+ *
+ */
+
+#ifndef FIXEDSIZEDTYPE_H_
+#define FIXEDSIZEDTYPE_H_
+
+#include "fastrtps/TopicDataType.h"
+
+#include <array>
+#include <cstdint>
+
+using namespace eprosima::fastrtps;
+
+/**
+ * Type whose memory layout is its CDR representation, so it can be written and read in place.
+ */
+struct FixedSized
+{
+    FixedSized() : index(0) { data.fill(0); }
+
+    bool operator==(const FixedSized& other) const
+    {
+        return index == other.index && data == other.data;
+    }
+
+    uint32_t index;
+    std::array<uint8_t, 1020> data;
+};
+
+class FixedSizedType:public TopicDataType {
+public:
+    typedef FixedSized type;
+
+	FixedSizedType();
+	virtual ~FixedSizedType();
+	bool serialize(void*data,SerializedPayload_t* payload);
+	bool deserialize(SerializedPayload_t* payload,void * data);
+        std::function<uint32_t()> getSerializedSizeProvider(void *data);
+	void* createData();
+	void deleteData(void* data);
+	bool is_plain() const { return true; }
+};
+
+#endif /* FIXEDSIZEDTYPE_H_ */
@@ -0,0 +1,38 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _RTPS_WRITER_TIMEDEVENT_NACKRESPONSEDELAY_H_
+#define _RTPS_WRITER_TIMEDEVENT_NACKRESPONSEDELAY_H_
+
+namespace eprosima
+{
+    namespace fastrtps
+    {
+        namespace rtps
+        {
+            // Forward declarations
+            class ReaderProxy;
+
+            class NackResponseDelay
+            {
+                public:
+
+                    NackResponseDelay(ReaderProxy* /*rp*/,double /*interval*/)
+                    {
+                    }
+            };
+        } // namespace rtps
+    } // namespace fastrtps
+} // namespace eprosima
+#endif // _RTPS_WRITER_TIMEDEVENT_NACKRESPONSEDELAY_H_
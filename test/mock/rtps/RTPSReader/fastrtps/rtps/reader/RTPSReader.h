@@ -20,6 +20,7 @@
 #define _RTPS_READER_RTPSREADER_H_
 
 #include <fastrtps/rtps/Endpoint.h>
+#include <fastrtps/rtps/attributes/ReaderAttributes.h>
 #include <fastrtps/rtps/history/ReaderHistory.h>
 #include <fastrtps/rtps/reader/ReaderListener.h>
 
@@ -41,6 +42,17 @@ class RTPSReader : public Endpoint
 
         MOCK_CONST_METHOD0(getGuid, const GUID_t&());
 
+        MOCK_METHOD2(reserveCache, bool(CacheChange_t**, uint32_t));
+
+        MOCK_METHOD1(releaseCache, void(CacheChange_t*));
+
+        MOCK_METHOD2(change_removed_by_history_mock, bool(CacheChange_t*, WriterProxy*));
+
+        bool change_removed_by_history(CacheChange_t* change, WriterProxy* prox = nullptr)
+        {
+            return change_removed_by_history_mock(change, prox);
+        }
+
         ReaderHistory* getHistory()
         {
             getHistory_mock();
@@ -43,6 +43,12 @@ class RTPSWriter : public Endpoint
         MOCK_METHOD3(new_change, CacheChange_t*(const std::function<uint32_t()>&,
             ChangeKind_t, InstanceHandle_t));
 
+        MOCK_METHOD1(unsent_change_added_to_history, void(CacheChange_t*));
+
+        MOCK_METHOD1(change_removed_by_history, bool(CacheChange_t*));
+
+        MOCK_CONST_METHOD0(getGuid, const GUID_t&());
+
         WriterHistory* history_;
 };
 
@@ -18,6 +18,7 @@
  */
 
 #include "LatencyTestPublisher.h"
+#include "TransportConfiguration.h"
 #include "fastrtps/log/Log.h"
 #include "fastrtps/log/Colors.h"
 #include <numeric>
@@ -68,12 +69,13 @@ LatencyTestPublisher::~LatencyTestPublisher()
 }
 
 
-bool LatencyTestPublisher::init(int n_sub, int n_sam, bool reliable, uint32_t pid, bool hostname, bool export_csv)
+bool LatencyTestPublisher::init(int n_sub, int n_sam, bool reliable, uint32_t pid, bool hostname, bool export_csv, bool shm)
 {
 	n_samples = n_sam;
 	n_subscribers = n_sub;
 	n_export_csv = export_csv;
     reliable_ = reliable;
+    shm_ = shm;
 
 	//////////////////////////////
 	/*
@@ -163,6 +165,8 @@ bool LatencyTestPublisher::init(int n_sub, int n_sam, bool reliable, uint32_t pi
 	PParam.rtps.sendSocketBufferSize = 65536;
 	PParam.rtps.listenSocketBufferSize = 2*65536;
 	PParam.rtps.setName("Participant_pub");
+	if(shm)
+		useSharedMemTransport(PParam);
 	mp_participant = Domain::createParticipant(PParam);
 	if(mp_participant == nullptr)
 		return false;
@@ -444,6 +448,8 @@ void LatencyTestPublisher::run()
     std::string str_reliable = "besteffort";
     if(reliable_)
         str_reliable = "reliable";
+    if(shm_)
+        str_reliable += "_shm";
 
 	if (n_export_csv)
     {
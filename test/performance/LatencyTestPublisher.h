@@ -66,7 +66,7 @@ public:
 	int m_status;
 	unsigned int n_received;
 	bool n_export_csv;
-	bool init(int n_sub, int n_sam, bool reliable, uint32_t pid, bool hostname, bool export_csv);
+	bool init(int n_sub, int n_sam, bool reliable, uint32_t pid, bool hostname, bool export_csv, bool shm);
 	void run();
 	void analizeTimes(uint32_t datasize);
 	bool test(uint32_t datasize);
@@ -128,6 +128,7 @@ public:
 	std::stringstream output_file_16384;
 
     bool reliable_;
+    bool shm_;
 };
 
 
@@ -18,6 +18,7 @@
  */
 
 #include "LatencyTestSubscriber.h"
+#include "TransportConfiguration.h"
 #include "fastrtps/log/Log.h"
 #include "fastrtps/log/Colors.h"
 
@@ -62,7 +63,7 @@ LatencyTestSubscriber::~LatencyTestSubscriber()
 	Domain::removeParticipant(mp_participant);
 }
 
-bool LatencyTestSubscriber::init(bool echo, int nsam, bool reliable, uint32_t pid, bool hostname)
+bool LatencyTestSubscriber::init(bool echo, int nsam, bool reliable, uint32_t pid, bool hostname, bool shm)
 {
 	m_echo = echo;
 	n_samples = nsam;
@@ -77,6 +78,8 @@ bool LatencyTestSubscriber::init(bool echo, int nsam, bool reliable, uint32_t pi
 	PParam.rtps.sendSocketBufferSize = 65536;
 	PParam.rtps.listenSocketBufferSize = 2*65536;
 	PParam.rtps.setName("Participant_sub");
+	if(shm)
+		useSharedMemTransport(PParam);
 	mp_participant = Domain::createParticipant(PParam);
 	if(mp_participant == nullptr)
 		return false;
@@ -46,7 +46,7 @@ public:
 	int m_status;
 	int n_received;
 	int n_samples;
-	bool init(bool echo, int nsam, bool reliable, uint32_t pid, bool hostname);
+	bool init(bool echo, int nsam, bool reliable, uint32_t pid, bool hostname, bool shm);
 	void run();
 	bool test(uint32_t datasize);
 	class DataPubListener : public PublisherListener
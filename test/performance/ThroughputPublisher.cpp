@@ -18,6 +18,7 @@
  */
 
 #include "ThroughputPublisher.h"
+#include "TransportConfiguration.h"
 
 #include <fastrtps/utils/TimeConversion.h>
 #include <fastrtps/utils/eClock.h>
@@ -100,10 +101,10 @@ void ThroughputPublisher::CommandPubListener::onPublicationMatched(Publisher* /*
     m_up.disc_cond_.notify_one();
 }
 
-ThroughputPublisher::ThroughputPublisher(bool reliable, uint32_t pid, bool hostname, bool export_csv): disc_count_(0),
+ThroughputPublisher::ThroughputPublisher(bool reliable, uint32_t pid, bool hostname, bool export_csv, bool shm): disc_count_(0),
 #pragma warning(disable:4355)
     m_DataPubListener(*this), m_CommandSubListener(*this), m_CommandPubListener(*this),
-    ready(true), m_export_csv(export_csv), reliable_(reliable)
+    ready(true), m_export_csv(export_csv), reliable_(reliable), shm_(shm)
 {
     ParticipantAttributes PParam;
     PParam.rtps.defaultSendPort = 10042;
@@ -116,6 +117,8 @@ ThroughputPublisher::ThroughputPublisher(bool reliable, uint32_t pid, bool hostn
     PParam.rtps.sendSocketBufferSize = 5242882;
     PParam.rtps.listenSocketBufferSize = 2097152;
     PParam.rtps.setName("Participant_publisher");
+    if(shm)
+        useSharedMemTransport(PParam);
     mp_par = Domain::createParticipant(PParam);
     if(mp_par == nullptr)
     {
@@ -282,6 +285,8 @@ void ThroughputPublisher::run(uint32_t test_time, uint32_t recovery_time_ms, int
         std::string str_reliable = "besteffort";
         if(reliable_)
             str_reliable = "reliable";
+        if(shm_)
+            str_reliable += "_shm";
         outFile.open("perf_ThroughputTest_" + std::to_string(payload) + "B_" + str_reliable + ".csv");
         outFile << output_file.str();
         outFile.close();
@@ -351,6 +356,8 @@ bool ThroughputPublisher::test(uint32_t test_time, uint32_t recovery_time_ms, ui
                 std::string str_reliable = "besteffort";
                 if(reliable_)
                     str_reliable = "reliable";
+                if(shm_)
+                    str_reliable += "_shm";
                 std::string fileName = "perf_ThroughputTest_" +
                     std::to_string(result.payload_size) + "B_" + str_reliable + "_" +
                     std::to_string(result.demand) + "demand"
@@ -41,7 +41,7 @@ using namespace std;
 class ThroughputPublisher
 {
 public:
-	ThroughputPublisher(bool reliable, uint32_t pid, bool hostname, bool export_csv);
+	ThroughputPublisher(bool reliable, uint32_t pid, bool hostname, bool export_csv, bool shm);
 	virtual ~ThroughputPublisher();
 	Participant* mp_par;
 	Publisher* mp_datapub;
@@ -107,6 +107,7 @@ public:
 	std::stringstream output_file;
 	uint32_t payload;
     bool reliable_;
+    bool shm_;
 };
 
 
@@ -18,6 +18,7 @@
  */
 
 #include "ThroughputSubscriber.h"
+#include "TransportConfiguration.h"
 
 #include <fastrtps/utils/TimeConversion.h>
 #include <fastrtps/utils/eClock.h>
@@ -205,7 +206,7 @@ void ThroughputSubscriber::CommandPubListener::onPublicationMatched(Publisher* /
 
 ThroughputSubscriber::~ThroughputSubscriber(){Domain::stopAll();}
 
-ThroughputSubscriber::ThroughputSubscriber(bool reliable, uint32_t pid, bool hostname) : disc_count_(0), stop_count_(0),
+ThroughputSubscriber::ThroughputSubscriber(bool reliable, uint32_t pid, bool hostname, bool shm) : disc_count_(0), stop_count_(0),
 #pragma warning(disable:4355)
     m_DataSubListener(*this),m_CommandSubListener(*this),m_CommandPubListener(*this),
     ready(true),m_datasize(0),m_demand(0)
@@ -221,6 +222,8 @@ ThroughputSubscriber::ThroughputSubscriber(bool reliable, uint32_t pid, bool hos
     PParam.rtps.sendSocketBufferSize = 5242882;
     PParam.rtps.listenSocketBufferSize = 2097152;
     PParam.rtps.setName("Participant_subscriber");
+    if(shm)
+        useSharedMemTransport(PParam);
     mp_par = Domain::createParticipant(PParam);
     if(mp_par == nullptr)
     {
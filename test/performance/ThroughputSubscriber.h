@@ -43,7 +43,7 @@ using namespace std;
 class ThroughputSubscriber
 {
 public:
-	ThroughputSubscriber(bool reliable, uint32_t pid, bool hostname);
+	ThroughputSubscriber(bool reliable, uint32_t pid, bool hostname, bool shm);
 	virtual ~ThroughputSubscriber();
 	Participant* mp_par;
 	Subscriber* mp_datasub;
@@ -0,0 +1,48 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file TransportConfiguration.h
+ *
+ */
+
+#ifndef TRANSPORTCONFIGURATION_H_
+#define TRANSPORTCONFIGURATION_H_
+
+#include <fastrtps/attributes/ParticipantAttributes.h>
+#include <fastrtps/transport/SharedMemTransportDescriptor.h>
+#include <memory>
+
+/**
+ * Makes user data travel through the shared memory transport. Discovery keeps using the builtin
+ * UDPv4 transport, so participants find each other as in the UDPv4 runs.
+ */
+inline void useSharedMemTransport(eprosima::fastrtps::ParticipantAttributes& PParam)
+{
+    using namespace eprosima::fastrtps::rtps;
+
+    PParam.rtps.userTransports.push_back(std::make_shared<SharedMemTransportDescriptor>());
+
+    // Port 0 lets the participant calculate the port from its participant ID.
+    Locator_t shmLocator;
+    shmLocator.kind = LOCATOR_KIND_SHM;
+    PParam.rtps.defaultUnicastLocatorList.push_back(shmLocator);
+
+    Locator_t udpSendLocator;
+    udpSendLocator.kind = LOCATOR_KIND_UDPv4;
+    PParam.rtps.defaultOutLocatorList.push_back(udpSendLocator);
+    PParam.rtps.defaultOutLocatorList.push_back(shmLocator);
+}
+
+#endif /* TRANSPORTCONFIGURATION_H_ */
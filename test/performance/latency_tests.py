@@ -30,4 +30,17 @@ publisher_proc = subprocess.Popen([command, "publisher", "-r", "reliable", "--se
 subscriber_proc.communicate()
 publisher_proc.communicate()
 
+# Shared memory, to compare with the UDPv4 runs on the same host
+subscriber_proc = subprocess.Popen([command, "subscriber", "--seed", str(os.getpid()), "--hostname", "--shm"])
+publisher_proc = subprocess.Popen([command, "publisher", "--seed", str(os.getpid()), "--hostname", "--export_csv", "--shm"])
+
+subscriber_proc.communicate()
+publisher_proc.communicate()
+
+subscriber_proc = subprocess.Popen([command, "subscriber", "-r", "reliable", "--seed", str(os.getpid()), "--hostname", "--shm"])
+publisher_proc = subprocess.Popen([command, "publisher", "-r", "reliable", "--seed", str(os.getpid()), "--hostname", "--export_csv", "--shm"])
+
+subscriber_proc.communicate()
+publisher_proc.communicate()
+
 quit()
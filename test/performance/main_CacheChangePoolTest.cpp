@@ -0,0 +1,250 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file main_CacheChangePoolTest.cpp
+ *
+ * Measures how fast several threads reserve and release changes from the same CacheChangePool.
+ * Each thread keeps a number of changes reserved, as a history would, and then reserves a new change and releases
+ * the oldest one as many times as requested.
+ */
+
+#include "optionparser.h"
+
+#include <fastrtps/rtps/history/CacheChangePool.h>
+#include <fastrtps/rtps/common/CacheChange.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#if defined(_MSC_VER)
+#pragma warning (push)
+#pragma warning (disable:4512)
+#endif
+
+using namespace eprosima;
+using namespace fastrtps;
+using namespace fastrtps::rtps;
+
+struct Arg: public option::Arg{
+
+    static void printError(const char* msg1, const option::Option& opt, const char* msg2){
+        fprintf(stderr, "%s", msg1);
+        fwrite(opt.name, opt.namelen, 1, stderr);
+        fprintf(stderr, "%s", msg2);
+    }
+
+    static option::ArgStatus Numeric(const option::Option& option, bool msg){
+        char* endptr = 0;
+        if (option.arg != 0 && strtol(option.arg, &endptr, 10)){};
+        if (endptr != option.arg && *endptr == 0)
+        return option::ARG_OK;
+
+        if (msg) printError("Option '", option, "' requires a numeric argument\n");
+        return option::ARG_ILLEGAL;
+    }
+};
+
+enum  optionIndex {
+    UNKNOWN_OPT,
+    HELP,
+    THREADS,
+    OPERATIONS,
+    HELD,
+    THREAD_CACHE
+};
+
+const option::Descriptor usage[] = {
+    { UNKNOWN_OPT, 0,"", "",                Arg::None,      "Usage: CacheChangePoolTest [options]\n\nOptions:" },
+    { HELP,    0,"h", "help",               Arg::None,      "  -h \t--help  \tProduce help message." },
+    { THREADS,0,"t","threads",              Arg::Numeric,   "  -t <num>, \t--threads=<num>  \tNumber of threads. By default, runs with 1, 2, 4 and 8." },
+    { OPERATIONS,0,"o","operations",        Arg::Numeric,   "  -o <num>, \t--operations=<num>  \tReserve and release operations of each thread." },
+    { HELD,0,"","held",                     Arg::Numeric,   "  \t--held=<num>  \tChanges each thread keeps reserved." },
+    { THREAD_CACHE,0,"","thread_cache",     Arg::Numeric,   "  \t--thread_cache=<num>  \tFree changes each thread may keep. By default, runs with 0 and 32." },
+    { 0, 0, 0, 0, 0, 0 }
+};
+
+static const char* policy_name(MemoryManagementPolicy_t policy)
+{
+    switch(policy)
+    {
+        case PREALLOCATED_MEMORY_MODE:
+            return "PREALLOCATED";
+        case PREALLOCATED_WITH_REALLOC_MEMORY_MODE:
+            return "WITH_REALLOC";
+        case DYNAMIC_RESERVE_MEMORY_MODE:
+            return "DYNAMIC";
+    }
+
+    return "";
+}
+
+static bool run_test(MemoryManagementPolicy_t policy, uint32_t n_threads, uint32_t n_operations, uint32_t n_held,
+        uint32_t thread_cache)
+{
+    CacheChangePool pool(n_threads * n_held, 64, 0, policy, thread_cache);
+    std::atomic<bool> failed(false);
+    std::atomic<uint32_t> ready(0);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+
+    for(uint32_t t = 0; t < n_threads; ++t)
+    {
+        threads.emplace_back([&]()
+                {
+                    std::deque<CacheChange_t*> held;
+                    CacheChange_t* change = nullptr;
+
+                    for(uint32_t i = 0; i < n_held; ++i)
+                    {
+                        if(!pool.reserve_Cache(&change, 64u))
+                        {
+                            failed = true;
+                            break;
+                        }
+                        held.push_back(change);
+                    }
+
+                    ++ready;
+                    while(!start)
+                        std::this_thread::yield();
+
+                    for(uint32_t i = 0; i < n_operations && !failed; ++i)
+                    {
+                        if(!pool.reserve_Cache(&change, 64u))
+                        {
+                            failed = true;
+                            break;
+                        }
+                        held.push_back(change);
+                        pool.release_Cache(held.front());
+                        held.pop_front();
+                    }
+
+                    for(CacheChange_t* ch : held)
+                        pool.release_Cache(ch);
+                });
+    }
+
+    while(ready < n_threads)
+        std::this_thread::yield();
+
+    auto begin = std::chrono::steady_clock::now();
+    start = true;
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+
+    if(failed)
+    {
+        printf("ERROR reserving a change\n");
+        return false;
+    }
+
+    double operations = (double)n_threads * n_operations;
+    printf("%13s,%8u,%5u,%13u,%13.0f,%12.1f\n", policy_name(policy), n_threads, n_held, thread_cache,
+            elapsed.count(), operations / elapsed.count());
+
+    return true;
+}
+
+int main(int argc, char** argv){
+
+    int columns;
+
+#if defined(_WIN32)
+    char* buf = nullptr;
+    size_t sz = 0;
+    if (_dupenv_s(&buf, &sz, "COLUMNS") == 0 && buf != nullptr){
+        columns = strtol(buf, nullptr, 10);
+        free(buf);
+    }
+    else{
+        columns = 80;
+    }
+#else
+    columns = getenv("COLUMNS")? atoi(getenv("COLUMNS")) : 80;
+#endif
+
+    uint32_t n_operations = 1000000;
+    uint32_t n_held = 1000;
+    std::vector<uint32_t> n_threads{1, 2, 4, 8};
+    std::vector<uint32_t> thread_caches{0, 32};
+
+    argc-=(argc>0); argv+=(argc>0); // skip program name argv[0] if present
+    option::Stats stats(usage, argc, argv);
+    std::vector<option::Option> options(stats.options_max);
+    std::vector<option::Option> buffer(stats.buffer_max);
+    option::Parser parse(usage, argc, argv, &options[0], &buffer[0]);
+
+    if (parse.error())
+    return 1;
+
+    if (options[HELP]){
+        option::printUsage(fwrite, stdout, usage, columns);
+        return 0;
+    }
+
+    for (int i = 0; i < parse.optionsCount(); ++i){
+        option::Option& opt = buffer[i];
+        switch (opt.index()){
+            case THREADS:
+                n_threads.assign(1, strtol(opt.arg, nullptr, 10));
+                break;
+            case OPERATIONS:
+                n_operations = strtol(opt.arg, nullptr, 10);
+                break;
+            case HELD:
+                n_held = strtol(opt.arg, nullptr, 10);
+                break;
+            case THREAD_CACHE:
+                thread_caches.assign(1, strtol(opt.arg, nullptr, 10));
+                break;
+            default:
+                option::printUsage(fwrite, stdout, usage, columns);
+                return 0;
+        }
+    }
+
+    printf("[       Policy, Threads, Held, Thread cache, Time(us)     , Ops/us]\n");
+
+    bool success = true;
+    for(MemoryManagementPolicy_t policy : {PREALLOCATED_MEMORY_MODE, PREALLOCATED_WITH_REALLOC_MEMORY_MODE,
+            DYNAMIC_RESERVE_MEMORY_MODE})
+    {
+        for(uint32_t thread_cache : thread_caches)
+        {
+            // Thread caches are not used on DYNAMIC_RESERVE_MEMORY_MODE.
+            if(policy == DYNAMIC_RESERVE_MEMORY_MODE && thread_cache != thread_caches.front())
+                continue;
+
+            for(uint32_t threads : n_threads)
+                success &= run_test(policy, threads, n_operations, n_held, thread_cache);
+        }
+    }
+
+    return success ? 0 : 1;
+}
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
@@ -0,0 +1,415 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file main_FanoutTest.cpp
+ *
+ * Measures how fast an asynchronous writer delivers a burst of samples to several readers at once.
+ * Every reader lives in its own participant, so they only share the writer through the network.
+ */
+
+#include "ThroughputTypes.h"
+
+#include "optionparser.h"
+
+#include <fastrtps/Domain.h>
+#include <fastrtps/participant/Participant.h>
+#include <fastrtps/attributes/ParticipantAttributes.h>
+#include <fastrtps/attributes/PublisherAttributes.h>
+#include <fastrtps/attributes/SubscriberAttributes.h>
+#include <fastrtps/publisher/Publisher.h>
+#include <fastrtps/publisher/PublisherListener.h>
+#include <fastrtps/subscriber/Subscriber.h>
+#include <fastrtps/subscriber/SubscriberListener.h>
+#include <fastrtps/subscriber/SampleInfo.h>
+#include <fastrtps/utils/TimeConversion.h>
+
+#include <stdio.h>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#if defined(_MSC_VER)
+#pragma warning (push)
+#pragma warning (disable:4512)
+#endif
+
+using namespace eprosima;
+using namespace fastrtps;
+using namespace fastrtps::rtps;
+
+struct Arg: public option::Arg{
+
+    static void printError(const char* msg1, const option::Option& opt, const char* msg2){
+        fprintf(stderr, "%s", msg1);
+        fwrite(opt.name, opt.namelen, 1, stderr);
+        fprintf(stderr, "%s", msg2);
+    }
+
+    static option::ArgStatus Required(const option::Option& option, bool msg){
+        if (option.arg != 0 && option.arg[0] != 0)
+        return option::ARG_OK;
+
+        if (msg) printError("Option '", option, "' requires an argument\n");
+        return option::ARG_ILLEGAL;
+    }
+
+    static option::ArgStatus Numeric(const option::Option& option, bool msg){
+        char* endptr = 0;
+        if (option.arg != 0 && strtol(option.arg, &endptr, 10)){};
+        if (endptr != option.arg && *endptr == 0)
+        return option::ARG_OK;
+
+        if (msg) printError("Option '", option, "' requires a numeric argument\n");
+        return option::ARG_ILLEGAL;
+    }
+};
+
+enum  optionIndex {
+    UNKNOWN_OPT,
+    HELP,
+    RELIABILITY,
+    SEED,
+    READERS,
+    SAMPLES,
+    MSG_SIZE,
+    UNICAST
+};
+
+const option::Descriptor usage[] = {
+    { UNKNOWN_OPT, 0,"", "",                Arg::None,      "Usage: FanoutTest [options]\n\nOptions:" },
+    { HELP,    0,"h", "help",               Arg::None,      "  -h \t--help  \tProduce help message." },
+    { RELIABILITY,0,"r","reliability",      Arg::Required,  "  -r <arg>, \t--reliability=<arg>  \tSet reliability (\"reliable\"/\"besteffort\")."},
+    { SEED,0,"","seed",                     Arg::Numeric,   "  \t--seed=<num>  \tSeed to calculate domain and topic, to isolate test." },
+    { READERS,0,"n","readers",              Arg::Numeric,   "  -n <num>, \t--readers=<num>  \tNumber of readers. By default, runs with 1, 10 and 50." },
+    { SAMPLES,0,"c","samples",              Arg::Numeric,   "  -c <num>, \t--samples=<num>  \tSamples written in the burst." },
+    { MSG_SIZE, 0,"s","msg_size",           Arg::Numeric,   "  -s <num>, \t--msg_size=<num>  \tSize of the message." },
+    { UNICAST,0,"","unicast",               Arg::None,      "  \t--unicast  \tReaders do not announce a shared multicast locator." },
+    { 0, 0, 0, 0, 0, 0 }
+};
+
+class FanoutReader : public SubscriberListener
+{
+    public:
+
+        FanoutReader(std::mutex& mutex, std::condition_variable& cond, uint32_t size) :
+            received_(0), matched_(0), mutex_(mutex), cond_(cond), data_(static_cast<uint16_t>(size)) {}
+
+        void onSubscriptionMatched(Subscriber* /*sub*/, MatchingInfo& info)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if(info.status == MATCHED_MATCHING)
+                ++matched_;
+            else
+                --matched_;
+            cond_.notify_all();
+        }
+
+        void onNewDataMessage(Subscriber* sub)
+        {
+            SampleInfo_t info;
+            while(sub->takeNextData(&data_, &info))
+            {
+                if(info.sampleKind == ALIVE)
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ++received_;
+                    cond_.notify_all();
+                }
+            }
+        }
+
+        uint32_t received_;
+        uint32_t matched_;
+
+    private:
+
+        std::mutex& mutex_;
+        std::condition_variable& cond_;
+        ThroughputType data_;
+};
+
+class FanoutWriter : public PublisherListener
+{
+    public:
+
+        FanoutWriter(std::mutex& mutex, std::condition_variable& cond) : matched_(0), mutex_(mutex), cond_(cond) {}
+
+        void onPublicationMatched(Publisher* /*pub*/, MatchingInfo& info)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if(info.status == MATCHED_MATCHING)
+                ++matched_;
+            else
+                --matched_;
+            cond_.notify_all();
+        }
+
+        uint32_t matched_;
+
+    private:
+
+        std::mutex& mutex_;
+        std::condition_variable& cond_;
+};
+
+static bool run_test(uint32_t n_readers, uint32_t n_samples, uint32_t msg_size, bool reliable,
+        bool multicast, uint32_t seed)
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    ThroughputDataType type;
+    // Room for the sequence number and size headers of the sample.
+    type.m_typeSize = msg_size + 8;
+
+    std::ostringstream topic;
+    topic << "FanoutTest_" << seed;
+
+    ParticipantAttributes PParam;
+    PParam.rtps.builtin.domainId = seed % 230;
+    PParam.rtps.builtin.leaseDuration = c_TimeInfinite;
+
+    ParticipantAttributes writer_attributes(PParam);
+    Participant* writer_participant = Domain::createParticipant(writer_attributes);
+    if(writer_participant == nullptr)
+    {
+        printf("ERROR creating participant\n");
+        return false;
+    }
+    Domain::registerType(writer_participant, &type);
+
+    std::vector<Participant*> reader_participants;
+    std::vector<std::unique_ptr<FanoutReader>> readers;
+
+    for(uint32_t i = 0; i < n_readers; ++i)
+    {
+        // Each participant takes a new identifier.
+        ParticipantAttributes reader_attributes(PParam);
+        Participant* participant = Domain::createParticipant(reader_attributes);
+        if(participant == nullptr)
+        {
+            printf("ERROR creating participant\n");
+            Domain::stopAll();
+            return false;
+        }
+        Domain::registerType(participant, &type);
+        reader_participants.push_back(participant);
+
+        SubscriberAttributes Rparam;
+        Rparam.topic.topicDataType = "ThroughputType";
+        Rparam.topic.topicKind = NO_KEY;
+        Rparam.topic.topicName = topic.str();
+        Rparam.topic.historyQos.kind = KEEP_ALL_HISTORY_QOS;
+        Rparam.topic.resourceLimitsQos.max_samples = n_samples + 1;
+        Rparam.topic.resourceLimitsQos.allocated_samples = n_samples < 100 ? n_samples + 1 : 100;
+        Rparam.qos.m_reliability.kind = reliable ? RELIABLE_RELIABILITY_QOS : BEST_EFFORT_RELIABILITY_QOS;
+        if(multicast)
+        {
+            Locator_t locator;
+            locator.set_IP4_address(239, 255, 1, 4);
+            locator.port = 7900 + seed % 1000;
+            Rparam.multicastLocatorList.push_back(locator);
+            // Its own unicast locator receives the repairs and heartbeats directed to it alone.
+            Locator_t unicast;
+            unicast.set_IP4_address(127, 0, 0, 1);
+            unicast.port = 10000 + (seed % 100) * 100 + i;
+            Rparam.unicastLocatorList.push_back(unicast);
+        }
+
+        readers.emplace_back(new FanoutReader(mutex, cond, msg_size));
+        if(Domain::createSubscriber(participant, Rparam, readers.back().get()) == nullptr)
+        {
+            printf("ERROR creating subscriber\n");
+            Domain::stopAll();
+            return false;
+        }
+    }
+
+    PublisherAttributes Wparam;
+    Wparam.topic.topicDataType = "ThroughputType";
+    Wparam.topic.topicKind = NO_KEY;
+    Wparam.topic.topicName = topic.str();
+    Wparam.topic.historyQos.kind = KEEP_ALL_HISTORY_QOS;
+    Wparam.topic.resourceLimitsQos.max_samples = n_samples + 1;
+    Wparam.topic.resourceLimitsQos.allocated_samples = n_samples < 100 ? n_samples + 1 : 100;
+    Wparam.qos.m_publishMode.kind = ASYNCHRONOUS_PUBLISH_MODE;
+    if(reliable)
+    {
+        Wparam.times.heartbeatPeriod = TimeConv::MilliSeconds2Time_t(10);
+        Wparam.times.nackResponseDelay = TimeConv::MilliSeconds2Time_t(0);
+        Wparam.qos.m_reliability.kind = RELIABLE_RELIABILITY_QOS;
+    }
+    else
+        Wparam.qos.m_reliability.kind = BEST_EFFORT_RELIABILITY_QOS;
+
+    FanoutWriter writer(mutex, cond);
+    Publisher* publisher = Domain::createPublisher(writer_participant, Wparam, &writer);
+    if(publisher == nullptr)
+    {
+        printf("ERROR creating publisher\n");
+        Domain::stopAll();
+        return false;
+    }
+
+    bool discovered = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        discovered = cond.wait_for(lock, std::chrono::seconds(30), [&]()
+                {
+                    if(writer.matched_ < n_readers)
+                        return false;
+                    for(auto& reader : readers)
+                        if(reader->matched_ == 0)
+                            return false;
+                    return true;
+                });
+    }
+
+    if(!discovered)
+    {
+        printf("ERROR discovering the readers\n");
+        Domain::stopAll();
+        return false;
+    }
+
+    ThroughputType data(static_cast<uint16_t>(msg_size));
+    auto start = std::chrono::steady_clock::now();
+
+    for(uint32_t i = 1; i <= n_samples; ++i)
+    {
+        data.seqnum = i;
+        publisher->write(&data);
+    }
+
+    uint64_t received = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait_for(lock, std::chrono::seconds(30), [&]()
+                {
+                    for(auto& reader : readers)
+                        if(reader->received_ < n_samples)
+                            return false;
+                    return true;
+                });
+
+        for(auto& reader : readers)
+            received += reader->received_;
+    }
+
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("%7u,%8u,%9u,%13.0f,%12.0f,%10.3f\n", n_readers, msg_size, n_samples, elapsed.count(),
+            (double)received, (double)received * msg_size * 8 / elapsed.count());
+
+    Domain::removePublisher(publisher);
+    for(auto* participant : reader_participants)
+        Domain::removeParticipant(participant);
+    Domain::removeParticipant(writer_participant);
+
+    return received == (uint64_t)n_readers * n_samples;
+}
+
+int main(int argc, char** argv){
+
+    int columns;
+
+#if defined(_WIN32)
+    char* buf = nullptr;
+    size_t sz = 0;
+    if (_dupenv_s(&buf, &sz, "COLUMNS") == 0 && buf != nullptr){
+        columns = strtol(buf, nullptr, 10);
+        free(buf);
+    }
+    else{
+        columns = 80;
+    }
+#else
+    columns = getenv("COLUMNS")? atoi(getenv("COLUMNS")) : 80;
+#endif
+
+    bool reliable = true;
+    bool multicast = true;
+    uint32_t seed = 80;
+    uint32_t n_samples = 1000;
+    uint32_t msg_size = 1024;
+    std::vector<uint32_t> n_readers{1, 10, 50};
+
+    argc-=(argc>0); argv+=(argc>0); // skip program name argv[0] if present
+    option::Stats stats(usage, argc, argv);
+    std::vector<option::Option> options(stats.options_max);
+    std::vector<option::Option> buffer(stats.buffer_max);
+    option::Parser parse(usage, argc, argv, &options[0], &buffer[0]);
+
+    if (parse.error())
+    return 1;
+
+    if (options[HELP]){
+        option::printUsage(fwrite, stdout, usage, columns);
+        return 0;
+    }
+
+    for (int i = 0; i < parse.optionsCount(); ++i){
+        option::Option& opt = buffer[i];
+        switch (opt.index()){
+            case RELIABILITY:
+                if(strcmp(opt.arg, "reliable") == 0){
+                    reliable = true;
+                }
+                else if(strcmp(opt.arg, "besteffort") == 0){
+                    reliable = false;
+                }
+                else{
+                    option::printUsage(fwrite, stdout, usage, columns);
+                    return 0;
+                }
+                break;
+            case SEED:
+                seed = strtol(opt.arg, nullptr, 10);
+                break;
+            case READERS:
+                n_readers.assign(1, strtol(opt.arg, nullptr, 10));
+                break;
+            case SAMPLES:
+                n_samples = strtol(opt.arg, nullptr, 10);
+                break;
+            case MSG_SIZE:
+                msg_size = strtol(opt.arg, nullptr, 10);
+                break;
+            case UNICAST:
+                multicast = false;
+                break;
+            default:
+                option::printUsage(fwrite, stdout, usage, columns);
+                return 0;
+        }
+    }
+
+    printf("[Readers,   Bytes,  Samples, Time(us)     , Received   , MBits/sec]\n");
+
+    bool success = true;
+    for(uint32_t readers : n_readers)
+        success &= run_test(readers, n_samples, msg_size, reliable, multicast, seed++);
+
+    Domain::stopAll();
+
+    return success ? 0 : 1;
+}
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
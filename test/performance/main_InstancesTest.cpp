@@ -0,0 +1,447 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file main_InstancesTest.cpp
+ *
+ * Measures how fast a keyed topic with many instances is delivered. Every sample updates a different instance,
+ * as when each instance is a tracked object, so the cost of finding the instance in the histories dominates.
+ */
+
+#include "optionparser.h"
+
+#include <fastrtps/Domain.h>
+#include <fastrtps/participant/Participant.h>
+#include <fastrtps/attributes/ParticipantAttributes.h>
+#include <fastrtps/attributes/PublisherAttributes.h>
+#include <fastrtps/attributes/SubscriberAttributes.h>
+#include <fastrtps/publisher/Publisher.h>
+#include <fastrtps/publisher/PublisherListener.h>
+#include <fastrtps/subscriber/Subscriber.h>
+#include <fastrtps/subscriber/SubscriberListener.h>
+#include <fastrtps/subscriber/SampleInfo.h>
+#include <fastrtps/TopicDataType.h>
+#include <fastrtps/utils/TimeConversion.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#if defined(_MSC_VER)
+#pragma warning (push)
+#pragma warning (disable:4512)
+#endif
+
+using namespace eprosima;
+using namespace fastrtps;
+using namespace fastrtps::rtps;
+
+struct Arg: public option::Arg{
+
+    static void printError(const char* msg1, const option::Option& opt, const char* msg2){
+        fprintf(stderr, "%s", msg1);
+        fwrite(opt.name, opt.namelen, 1, stderr);
+        fprintf(stderr, "%s", msg2);
+    }
+
+    static option::ArgStatus Required(const option::Option& option, bool msg){
+        if (option.arg != 0 && option.arg[0] != 0)
+        return option::ARG_OK;
+
+        if (msg) printError("Option '", option, "' requires an argument\n");
+        return option::ARG_ILLEGAL;
+    }
+
+    static option::ArgStatus Numeric(const option::Option& option, bool msg){
+        char* endptr = 0;
+        if (option.arg != 0 && strtol(option.arg, &endptr, 10)){};
+        if (endptr != option.arg && *endptr == 0)
+        return option::ARG_OK;
+
+        if (msg) printError("Option '", option, "' requires a numeric argument\n");
+        return option::ARG_ILLEGAL;
+    }
+};
+
+enum  optionIndex {
+    UNKNOWN_OPT,
+    HELP,
+    RELIABILITY,
+    SEED,
+    INSTANCES,
+    ROUNDS,
+    MSG_SIZE,
+    INTRAPROCESS
+};
+
+const option::Descriptor usage[] = {
+    { UNKNOWN_OPT, 0,"", "",                Arg::None,      "Usage: InstancesTest [options]\n\nOptions:" },
+    { HELP,    0,"h", "help",               Arg::None,      "  -h \t--help  \tProduce help message." },
+    { RELIABILITY,0,"r","reliability",      Arg::Required,  "  -r <arg>, \t--reliability=<arg>  \tSet reliability (\"reliable\"/\"besteffort\")."},
+    { SEED,0,"","seed",                     Arg::Numeric,   "  \t--seed=<num>  \tSeed to calculate domain and topic, to isolate test." },
+    { INSTANCES,0,"i","instances",          Arg::Numeric,   "  -i <num>, \t--instances=<num>  \tNumber of instances. By default, runs with 1000, 10000 and 50000." },
+    { ROUNDS,0,"c","rounds",                Arg::Numeric,   "  -c <num>, \t--rounds=<num>  \tSamples written for each instance." },
+    { MSG_SIZE, 0,"s","msg_size",           Arg::Numeric,   "  -s <num>, \t--msg_size=<num>  \tSize of the message." },
+    { INTRAPROCESS,0,"","intraprocess",     Arg::None,      "  \t--intraprocess  \tDeliver the samples without the transports, so only the histories are measured." },
+    { 0, 0, 0, 0, 0, 0 }
+};
+
+//! Sample of an instance. The key is the first field.
+struct InstanceSample
+{
+    uint32_t key;
+    uint32_t seqnum;
+    std::vector<uint8_t> data;
+};
+
+class InstanceSampleDataType : public TopicDataType
+{
+    public:
+
+        InstanceSampleDataType(uint32_t msg_size)
+        {
+            setName("InstanceSample");
+            m_typeSize = msg_size + 8;
+            m_isGetKeyDefined = true;
+        }
+
+        bool serialize(void* data, SerializedPayload_t* payload)
+        {
+            InstanceSample* sample = static_cast<InstanceSample*>(data);
+            memcpy(payload->data, &sample->key, sizeof(uint32_t));
+            memcpy(payload->data + 4, &sample->seqnum, sizeof(uint32_t));
+            if(!sample->data.empty())
+                memcpy(payload->data + 8, sample->data.data(), sample->data.size());
+            payload->length = static_cast<uint32_t>(8 + sample->data.size());
+            payload->encapsulation = CDR_LE;
+            return true;
+        }
+
+        bool deserialize(SerializedPayload_t* payload, void* data)
+        {
+            InstanceSample* sample = static_cast<InstanceSample*>(data);
+            memcpy(&sample->key, payload->data, sizeof(uint32_t));
+            memcpy(&sample->seqnum, payload->data + 4, sizeof(uint32_t));
+            sample->data.assign(payload->data + 8, payload->data + payload->length);
+            return true;
+        }
+
+        std::function<uint32_t()> getSerializedSizeProvider(void* data)
+        {
+            InstanceSample* sample = static_cast<InstanceSample*>(data);
+            return [sample]() { return static_cast<uint32_t>(8 + sample->data.size()); };
+        }
+
+        bool getKey(void* data, InstanceHandle_t* ihandle)
+        {
+            InstanceSample* sample = static_cast<InstanceSample*>(data);
+            *ihandle = InstanceHandle_t();
+            memcpy(ihandle->value, &sample->key, sizeof(uint32_t));
+            return true;
+        }
+
+        void* createData() { return new InstanceSample(); }
+
+        void deleteData(void* data) { delete(static_cast<InstanceSample*>(data)); }
+};
+
+class InstancesReader : public SubscriberListener
+{
+    public:
+
+        InstancesReader(std::mutex& mutex, std::condition_variable& cond) :
+            received_(0), matched_(0), mutex_(mutex), cond_(cond) {}
+
+        void onSubscriptionMatched(Subscriber* /*sub*/, MatchingInfo& info)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if(info.status == MATCHED_MATCHING)
+                ++matched_;
+            else
+                --matched_;
+            cond_.notify_all();
+        }
+
+        void onNewDataMessage(Subscriber* sub)
+        {
+            SampleInfo_t info;
+            while(sub->takeNextData(&data_, &info))
+            {
+                if(info.sampleKind == ALIVE)
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ++received_;
+                    cond_.notify_all();
+                }
+            }
+        }
+
+        uint32_t received_;
+        uint32_t matched_;
+
+    private:
+
+        std::mutex& mutex_;
+        std::condition_variable& cond_;
+        InstanceSample data_;
+};
+
+class InstancesWriter : public PublisherListener
+{
+    public:
+
+        InstancesWriter(std::mutex& mutex, std::condition_variable& cond) : matched_(0), mutex_(mutex), cond_(cond) {}
+
+        void onPublicationMatched(Publisher* /*pub*/, MatchingInfo& info)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if(info.status == MATCHED_MATCHING)
+                ++matched_;
+            else
+                --matched_;
+            cond_.notify_all();
+        }
+
+        uint32_t matched_;
+
+    private:
+
+        std::mutex& mutex_;
+        std::condition_variable& cond_;
+};
+
+static bool run_test(uint32_t n_instances, uint32_t n_rounds, uint32_t msg_size, bool reliable, bool intraprocess,
+        uint32_t seed)
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    InstanceSampleDataType type(msg_size);
+    uint32_t n_samples = n_instances * n_rounds;
+
+    std::ostringstream topic;
+    topic << "InstancesTest_" << seed;
+
+    ParticipantAttributes PParam;
+    PParam.rtps.builtin.domainId = seed % 230;
+    PParam.rtps.builtin.leaseDuration = c_TimeInfinite;
+    PParam.rtps.useIntraprocessDelivery = intraprocess;
+
+    // Each participant takes a new identifier.
+    ParticipantAttributes writer_attributes(PParam), reader_attributes(PParam);
+    Participant* writer_participant = Domain::createParticipant(writer_attributes);
+    Participant* reader_participant = Domain::createParticipant(reader_attributes);
+    if(writer_participant == nullptr || reader_participant == nullptr)
+    {
+        printf("ERROR creating participant\n");
+        Domain::stopAll();
+        return false;
+    }
+    Domain::registerType(writer_participant, &type);
+    Domain::registerType(reader_participant, &type);
+
+    // All the samples are kept, so every one of them is delivered.
+    SubscriberAttributes Rparam;
+    Rparam.topic.topicDataType = "InstanceSample";
+    Rparam.topic.topicKind = WITH_KEY;
+    Rparam.topic.topicName = topic.str();
+    Rparam.topic.historyQos.kind = KEEP_ALL_HISTORY_QOS;
+    Rparam.topic.resourceLimitsQos.max_instances = n_instances;
+    Rparam.topic.resourceLimitsQos.max_samples_per_instance = n_rounds;
+    Rparam.topic.resourceLimitsQos.max_samples = n_samples + 1;
+    Rparam.topic.resourceLimitsQos.allocated_samples = 100;
+    Rparam.qos.m_reliability.kind = reliable ? RELIABLE_RELIABILITY_QOS : BEST_EFFORT_RELIABILITY_QOS;
+
+    InstancesReader reader(mutex, cond);
+    if(Domain::createSubscriber(reader_participant, Rparam, &reader) == nullptr)
+    {
+        printf("ERROR creating subscriber\n");
+        Domain::stopAll();
+        return false;
+    }
+
+    PublisherAttributes Wparam;
+    Wparam.topic.topicDataType = "InstanceSample";
+    Wparam.topic.topicKind = WITH_KEY;
+    Wparam.topic.topicName = topic.str();
+    Wparam.topic.historyQos.kind = KEEP_ALL_HISTORY_QOS;
+    Wparam.topic.resourceLimitsQos.max_instances = n_instances;
+    Wparam.topic.resourceLimitsQos.max_samples_per_instance = n_rounds;
+    Wparam.topic.resourceLimitsQos.max_samples = n_samples + 1;
+    Wparam.topic.resourceLimitsQos.allocated_samples = 100;
+    Wparam.qos.m_publishMode.kind = ASYNCHRONOUS_PUBLISH_MODE;
+    if(reliable)
+    {
+        Wparam.times.heartbeatPeriod = TimeConv::MilliSeconds2Time_t(10);
+        Wparam.times.nackResponseDelay = TimeConv::MilliSeconds2Time_t(0);
+        Wparam.qos.m_reliability.kind = RELIABLE_RELIABILITY_QOS;
+    }
+    else
+        Wparam.qos.m_reliability.kind = BEST_EFFORT_RELIABILITY_QOS;
+
+    InstancesWriter writer(mutex, cond);
+    Publisher* publisher = Domain::createPublisher(writer_participant, Wparam, &writer);
+    if(publisher == nullptr)
+    {
+        printf("ERROR creating publisher\n");
+        Domain::stopAll();
+        return false;
+    }
+
+    bool discovered = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        discovered = cond.wait_for(lock, std::chrono::seconds(30), [&]()
+                {
+                    return writer.matched_ > 0 && reader.matched_ > 0;
+                });
+    }
+
+    if(!discovered)
+    {
+        printf("ERROR discovering the reader\n");
+        Domain::stopAll();
+        return false;
+    }
+
+    InstanceSample data;
+    data.data.assign(msg_size, 0);
+    auto start = std::chrono::steady_clock::now();
+
+    for(uint32_t round = 0; round < n_rounds; ++round)
+    {
+        for(uint32_t key = 0; key < n_instances; ++key)
+        {
+            data.key = key;
+            ++data.seqnum;
+            publisher->write(&data);
+        }
+    }
+
+    std::chrono::duration<double, std::micro> writing = std::chrono::steady_clock::now() - start;
+
+    uint32_t received = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait_for(lock, std::chrono::seconds(60), [&]()
+                {
+                    return reader.received_ >= n_samples;
+                });
+        received = reader.received_;
+    }
+
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("%9u,%8u,%9u,%13.0f,%13.0f,%10u,%12.0f\n", n_instances, msg_size, n_samples, writing.count(),
+            elapsed.count(), received, received * 1000000.0 / elapsed.count());
+
+    Domain::removeParticipant(writer_participant);
+    Domain::removeParticipant(reader_participant);
+
+    return !reliable || received == n_samples;
+}
+
+int main(int argc, char** argv){
+
+    int columns;
+
+#if defined(_WIN32)
+    char* buf = nullptr;
+    size_t sz = 0;
+    if (_dupenv_s(&buf, &sz, "COLUMNS") == 0 && buf != nullptr){
+        columns = strtol(buf, nullptr, 10);
+        free(buf);
+    }
+    else{
+        columns = 80;
+    }
+#else
+    columns = getenv("COLUMNS")? atoi(getenv("COLUMNS")) : 80;
+#endif
+
+    bool reliable = true;
+    bool intraprocess = false;
+    uint32_t seed = 90;
+    uint32_t n_rounds = 5;
+    uint32_t msg_size = 64;
+    std::vector<uint32_t> n_instances{1000, 10000, 50000};
+
+    argc-=(argc>0); argv+=(argc>0); // skip program name argv[0] if present
+    option::Stats stats(usage, argc, argv);
+    std::vector<option::Option> options(stats.options_max);
+    std::vector<option::Option> buffer(stats.buffer_max);
+    option::Parser parse(usage, argc, argv, &options[0], &buffer[0]);
+
+    if (parse.error())
+    return 1;
+
+    if (options[HELP]){
+        option::printUsage(fwrite, stdout, usage, columns);
+        return 0;
+    }
+
+    for (int i = 0; i < parse.optionsCount(); ++i){
+        option::Option& opt = buffer[i];
+        switch (opt.index()){
+            case RELIABILITY:
+                if(strcmp(opt.arg, "reliable") == 0){
+                    reliable = true;
+                }
+                else if(strcmp(opt.arg, "besteffort") == 0){
+                    reliable = false;
+                }
+                else{
+                    option::printUsage(fwrite, stdout, usage, columns);
+                    return 0;
+                }
+                break;
+            case SEED:
+                seed = strtol(opt.arg, nullptr, 10);
+                break;
+            case INSTANCES:
+                n_instances.assign(1, strtol(opt.arg, nullptr, 10));
+                break;
+            case ROUNDS:
+                n_rounds = strtol(opt.arg, nullptr, 10);
+                break;
+            case MSG_SIZE:
+                msg_size = strtol(opt.arg, nullptr, 10);
+                break;
+            case INTRAPROCESS:
+                intraprocess = true;
+                break;
+            default:
+                option::printUsage(fwrite, stdout, usage, columns);
+                return 0;
+        }
+    }
+
+    printf("[Instances,   Bytes,  Samples, Write(us)    , Time(us)     , Received , Samples/sec]\n");
+
+    bool success = true;
+    for(uint32_t instances : n_instances)
+        success &= run_test(instances, n_rounds, msg_size, reliable, intraprocess, seed++);
+
+    Domain::stopAll();
+
+    return success ? 0 : 1;
+}
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
@@ -90,7 +90,8 @@ enum  optionIndex {
     SUBSCRIBERS,
     ECHO_OPT,
     HOSTNAME,
-    EXPORT_CSV
+    EXPORT_CSV,
+    SHM
 };
 
 const option::Descriptor usage[] = {
@@ -99,6 +100,7 @@ const option::Descriptor usage[] = {
     { RELIABILITY,0,"r","reliability",  Arg::Required,  "  -r <arg>, \t--reliability=<arg>  \tSet reliability (\"reliable\"/\"besteffort\")."},
     { SAMPLES,0,"s","samples",          Arg::Numeric,  "  -s <num>, \t--samples=<num>  \tNumber of samples." },
     { SEED,0,"","seed",                 Arg::Numeric,  "  \t--seed=<num>  \tNumber of subscribers." },
+    { SHM,0,"","shm",                   Arg::None,     "  \t--shm  \tSend user data through the shared memory transport." },
     { UNKNOWN_OPT, 0,"", "",            Arg::None,      "\nPublisher options:"},
     { SUBSCRIBERS,0,"n","subscribers",  Arg::Numeric,  "  -n <num>,   \t--subscribers=<arg>  \tSeed to calculate domain and topic, to isolate test." },
     { UNKNOWN_OPT, 0,"", "",            Arg::None,      "\nSubscriber options:"},
@@ -136,6 +138,7 @@ int main(int argc, char** argv){
     uint32_t seed = 80;
     bool hostname = false;
     bool export_csv = false;
+    bool shm = false;
 
     argc-=(argc>0); argv+=(argc>0); // skip program name argv[0] if present
     if(argc){
@@ -220,6 +223,10 @@ int main(int argc, char** argv){
                 export_csv = true;
                 break;
 
+            case SHM:
+                shm = true;
+                break;
+
             case UNKNOWN_OPT:
                 option::printUsage(fwrite, stdout, usage, columns);
                 return 0;
@@ -230,12 +237,12 @@ int main(int argc, char** argv){
     if (pub_sub){
         cout << "Performing test with "<< sub_number << " subscribers and "<<n_samples << " samples" <<endl;
         LatencyTestPublisher latencyPub;
-        latencyPub.init(sub_number,n_samples, reliable, seed, hostname, export_csv);
+        latencyPub.init(sub_number,n_samples, reliable, seed, hostname, export_csv, shm);
         latencyPub.run();
     }
     else {
         LatencyTestSubscriber latencySub;
-		latencySub.init(echo, n_samples, reliable, seed, hostname);
+		latencySub.init(echo, n_samples, reliable, seed, hostname, shm);
         latencySub.run();
     }
 
@@ -0,0 +1,240 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file main_ReaderHistoryTest.cpp
+ *
+ * Measures how fast a ReaderHistory takes the changes of many writers whose samples arrive interleaved.
+ * The writers publish at the same rate, but each one started later than the previous one, so their sequence
+ * numbers are apart and most changes are inserted before the last one. The history keeps a number of changes, and
+ * the oldest one is removed for each change added, as a reader taking its samples would.
+ */
+
+#include "optionparser.h"
+
+#include <fastrtps/rtps/RTPSDomain.h>
+#include <fastrtps/rtps/participant/RTPSParticipant.h>
+#include <fastrtps/rtps/attributes/RTPSParticipantAttributes.h>
+#include <fastrtps/rtps/attributes/ReaderAttributes.h>
+#include <fastrtps/rtps/attributes/HistoryAttributes.h>
+#include <fastrtps/rtps/history/ReaderHistory.h>
+#include <fastrtps/rtps/reader/RTPSReader.h>
+#include <fastrtps/rtps/common/CacheChange.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <chrono>
+
+#if defined(_MSC_VER)
+#pragma warning (push)
+#pragma warning (disable:4512)
+#endif
+
+using namespace eprosima;
+using namespace fastrtps;
+using namespace fastrtps::rtps;
+
+struct Arg: public option::Arg{
+
+    static void printError(const char* msg1, const option::Option& opt, const char* msg2){
+        fprintf(stderr, "%s", msg1);
+        fwrite(opt.name, opt.namelen, 1, stderr);
+        fprintf(stderr, "%s", msg2);
+    }
+
+    static option::ArgStatus Numeric(const option::Option& option, bool msg){
+        char* endptr = 0;
+        if (option.arg != 0 && strtol(option.arg, &endptr, 10)){};
+        if (endptr != option.arg && *endptr == 0)
+        return option::ARG_OK;
+
+        if (msg) printError("Option '", option, "' requires a numeric argument\n");
+        return option::ARG_ILLEGAL;
+    }
+};
+
+enum  optionIndex {
+    UNKNOWN_OPT,
+    HELP,
+    WRITERS,
+    OPERATIONS,
+    HELD,
+    DELAY
+};
+
+const option::Descriptor usage[] = {
+    { UNKNOWN_OPT, 0,"", "",                Arg::None,      "Usage: ReaderHistoryTest [options]\n\nOptions:" },
+    { HELP,    0,"h", "help",               Arg::None,      "  -h \t--help  \tProduce help message." },
+    { WRITERS,0,"w","writers",              Arg::Numeric,   "  -w <num>, \t--writers=<num>  \tNumber of writers. By default, runs with 1, 8, 64 and 256." },
+    { OPERATIONS,0,"o","operations",        Arg::Numeric,   "  -o <num>, \t--operations=<num>  \tChanges added, and removed, after the history is filled." },
+    { HELD,0,"","held",                     Arg::Numeric,   "  \t--held=<num>  \tChanges kept in the history. By default, runs with 1000 and 10000." },
+    { DELAY,0,"","delay",                   Arg::Numeric,   "  \t--delay=<num>  \tChanges each writer published before the next one started." },
+    { 0, 0, 0, 0, 0, 0 }
+};
+
+static bool run_test(RTPSParticipant* participant, uint32_t n_writers, uint32_t n_operations, uint32_t n_held,
+        uint32_t delay)
+{
+    ReaderHistory history(HistoryAttributes(PREALLOCATED_MEMORY_MODE, 64, n_held + 1, n_held + 1));
+    ReaderAttributes reader_attributes;
+    RTPSReader* reader = RTPSDomain::createRTPSReader(participant, reader_attributes, &history);
+    if(reader == nullptr)
+    {
+        printf("ERROR creating reader\n");
+        return false;
+    }
+
+    std::vector<GUID_t> writers(n_writers);
+    for(uint32_t w = 0; w < n_writers; ++w)
+    {
+        writers[w].guidPrefix.value[0] = 1;
+        memcpy(&writers[w].guidPrefix.value[4], &w, sizeof(w));
+        writers[w].entityId.value[3] = 3;
+    }
+
+    // Writer w sent its first change when the first writer sent change w * delay + 1.
+    bool failed = false;
+    uint32_t added = 0;
+    auto add = [&]()
+    {
+        uint32_t w = added % n_writers;
+        uint32_t round = added / n_writers;
+        CacheChange_t* change = nullptr;
+        if(!history.reserve_Cache(&change, 64u))
+        {
+            failed = true;
+            return;
+        }
+        change->writerGUID = writers[w];
+        change->sequenceNumber = SequenceNumber_t(0, round + 1 + (n_writers - 1 - w) * delay);
+        change->serializedPayload.length = 64;
+        history.add_change(change);
+        ++added;
+    };
+
+    for(uint32_t i = 0; i < n_held && !failed; ++i)
+        add();
+
+    auto begin = std::chrono::steady_clock::now();
+
+    for(uint32_t i = 0; i < n_operations && !failed; ++i)
+    {
+        add();
+        CacheChange_t* oldest = nullptr;
+        history.get_min_change(&oldest);
+        history.remove_change(oldest);
+    }
+
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+
+    RTPSDomain::removeRTPSReader(reader);
+
+    if(failed)
+    {
+        printf("ERROR reserving a change\n");
+        return false;
+    }
+
+    printf("%8u,%6u,%13.0f,%12.3f\n", n_writers, n_held, elapsed.count(), n_operations / elapsed.count());
+
+    return true;
+}
+
+int main(int argc, char** argv){
+
+    int columns;
+
+#if defined(_WIN32)
+    char* buf = nullptr;
+    size_t sz = 0;
+    if (_dupenv_s(&buf, &sz, "COLUMNS") == 0 && buf != nullptr){
+        columns = strtol(buf, nullptr, 10);
+        free(buf);
+    }
+    else{
+        columns = 80;
+    }
+#else
+    columns = getenv("COLUMNS")? atoi(getenv("COLUMNS")) : 80;
+#endif
+
+    uint32_t n_operations = 200000;
+    uint32_t delay = 100;
+    std::vector<uint32_t> n_writers{1, 8, 64, 256};
+    std::vector<uint32_t> n_held{1000, 10000};
+
+    argc-=(argc>0); argv+=(argc>0); // skip program name argv[0] if present
+    option::Stats stats(usage, argc, argv);
+    std::vector<option::Option> options(stats.options_max);
+    std::vector<option::Option> buffer(stats.buffer_max);
+    option::Parser parse(usage, argc, argv, &options[0], &buffer[0]);
+
+    if (parse.error())
+    return 1;
+
+    if (options[HELP]){
+        option::printUsage(fwrite, stdout, usage, columns);
+        return 0;
+    }
+
+    for (int i = 0; i < parse.optionsCount(); ++i){
+        option::Option& opt = buffer[i];
+        switch (opt.index()){
+            case WRITERS:
+                n_writers.assign(1, strtol(opt.arg, nullptr, 10));
+                break;
+            case OPERATIONS:
+                n_operations = strtol(opt.arg, nullptr, 10);
+                break;
+            case HELD:
+                n_held.assign(1, strtol(opt.arg, nullptr, 10));
+                break;
+            case DELAY:
+                delay = strtol(opt.arg, nullptr, 10);
+                break;
+            default:
+                option::printUsage(fwrite, stdout, usage, columns);
+                return 0;
+        }
+    }
+
+    RTPSParticipantAttributes participant_attributes;
+    participant_attributes.builtin.use_SIMPLE_RTPSParticipantDiscoveryProtocol = false;
+    participant_attributes.builtin.use_WriterLivelinessProtocol = false;
+    RTPSParticipant* participant = RTPSDomain::createParticipant(participant_attributes);
+    if(participant == nullptr)
+    {
+        printf("ERROR creating participant\n");
+        return 1;
+    }
+
+    printf("[Writers,  Held, Time(us)     , Ops/us]\n");
+
+    bool success = true;
+    for(uint32_t held : n_held)
+    {
+        for(uint32_t writers : n_writers)
+            success &= run_test(participant, writers, n_operations, held, delay);
+    }
+
+    RTPSDomain::removeRTPSParticipant(participant);
+
+    return success ? 0 : 1;
+}
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
@@ -93,7 +93,8 @@ enum  optionIndex {
     MSG_SIZE,
     FILE_R,
     HOSTNAME,
-    EXPORT_CSV
+    EXPORT_CSV,
+    SHM
 };
 
 const option::Descriptor usage[] = {
@@ -101,6 +102,7 @@ const option::Descriptor usage[] = {
     { HELP,    0,"h", "help",               Arg::None,      "  -h \t--help  \tProduce help message." },
     { RELIABILITY,0,"r","reliability",      Arg::Required,  "  -r <arg>, \t--reliability=<arg>  \tSet reliability (\"reliable\"/\"besteffort\")."},
     { SEED,0,"s","seed",                    Arg::Numeric,   "  \t--seed=<num>  \tSeed to calculate domain and topic, to isolate test." },
+    { SHM,0,"","shm",                       Arg::None,      "  \t--shm  \tSend user data through the shared memory transport." },
     { UNKNOWN_OPT, 0,"", "",                Arg::None,      "\nPublisher options:"},
     { TIME, 0,"t","time",                   Arg::Numeric,   "  -t <num>, \t--time=<num>  \tTime of the test in seconds." },
     { RECOVERY_TIME, 0,"","recovery_time",  Arg::Numeric,   "  \t--recovery_time=<num>  \tHow long to sleep after writing a demand in milliseconds." },
@@ -141,6 +143,7 @@ int main(int argc, char** argv){
     uint32_t seed = 80;
     bool hostname = false;
     bool export_csv = false;
+    bool shm = false;
     std::string file_name = "";
 
     argc-=(argc>0); argv+=(argc>0); // skip program name argv[0] if present
@@ -226,6 +229,10 @@ int main(int argc, char** argv){
                 export_csv = true;
                 break;
 
+            case SHM:
+                shm = true;
+                break;
+
             case UNKNOWN_OPT:
                 option::printUsage(fwrite, stdout, usage, columns);
                 return 0;
@@ -236,12 +243,12 @@ int main(int argc, char** argv){
     cout << "Starting Throughput Test"<< endl;
 
     if(pub_sub){
-        ThroughputPublisher tpub(reliable, seed, hostname, export_csv);
+        ThroughputPublisher tpub(reliable, seed, hostname, export_csv, shm);
         tpub.m_file_name = file_name;
         tpub.run(test_time_sec, recovery_time_ms, demand, msg_size);
     }
     else{
-        ThroughputSubscriber tsub(reliable, seed, hostname);
+        ThroughputSubscriber tsub(reliable, seed, hostname, shm);
         tsub.run();
     }
 
@@ -37,4 +37,17 @@ publisher_proc = subprocess.Popen([command, "publisher", "-r", "reliable", "--fi
 subscriber_proc.communicate()
 publisher_proc.communicate()
 
+# Shared memory, to compare with the UDPv4 runs on the same host
+subscriber_proc = subprocess.Popen([command, "subscriber", "--hostname", "--shm"])
+publisher_proc = subprocess.Popen([command, "publisher", "--file", payload_demands, "--hostname", "--export_csv", "--shm"])
+
+subscriber_proc.communicate()
+publisher_proc.communicate()
+
+subscriber_proc = subprocess.Popen([command, "subscriber", "-r", "reliable", "--hostname", "--shm"])
+publisher_proc = subprocess.Popen([command, "publisher", "-r", "reliable", "--file", payload_demands, "--hostname", "--export_csv", "--shm"])
+
+subscriber_proc.communicate()
+publisher_proc.communicate()
+
 quit()
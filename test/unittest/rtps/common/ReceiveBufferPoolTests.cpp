@@ -0,0 +1,199 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fastrtps/rtps/common/ReceiveBufferPool.h>
+#include <fastrtps/rtps/common/CacheChange.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace eprosima::fastrtps::rtps;
+
+TEST(ReceiveBufferPool, released_buffers_are_reused)
+{
+    std::shared_ptr<ReceiveBufferPool> pool = std::make_shared<ReceiveBufferPool>(1024, 2);
+
+    ReceiveBuffer* first = pool->take();
+    ReceiveBuffer* second = pool->take();
+    ReceiveBuffer* third = pool->take();
+    ASSERT_EQ(1024u, first->capacity());
+    ASSERT_EQ(1u, first->references());
+
+    first->remove_reference();
+    second->remove_reference();
+    // Only two free buffers are kept.
+    third->remove_reference();
+    ASSERT_EQ(2u, pool->free_buffers());
+
+    ReceiveBuffer* again = pool->take();
+    ASSERT_TRUE(again == first || again == second);
+    ASSERT_EQ(1u, pool->free_buffers());
+    again->remove_reference();
+}
+
+TEST(ReceiveBufferPool, buffer_is_recycled_when_the_last_reference_is_removed)
+{
+    std::shared_ptr<ReceiveBufferPool> pool = std::make_shared<ReceiveBufferPool>(1024, 4);
+    ReceiveBuffer* buffer = pool->take();
+
+    buffer->add_reference();
+    buffer->add_reference();
+    buffer->remove_reference();
+    buffer->remove_reference();
+    ASSERT_EQ(0u, pool->free_buffers());
+
+    buffer->remove_reference();
+    ASSERT_EQ(1u, pool->free_buffers());
+}
+
+TEST(ReceiveBufferPool, buffers_outlive_the_owner_of_the_pool)
+{
+    std::shared_ptr<ReceiveBufferPool> pool = std::make_shared<ReceiveBufferPool>(1024, 4);
+    std::weak_ptr<ReceiveBufferPool> weak_pool = pool;
+    ReceiveBuffer* buffer = pool->take();
+
+    pool.reset();
+    ASSERT_FALSE(weak_pool.expired());
+    memset(buffer->buffer(), 0xAA, buffer->capacity());
+
+    buffer->remove_reference();
+    ASSERT_TRUE(weak_pool.expired());
+}
+
+TEST(ReceiveBufferPool, bigger_buffers_are_taken_by_size)
+{
+    std::shared_ptr<ReceiveBufferPool> pool = std::make_shared<ReceiveBufferPool>(1024, 4);
+
+    ReceiveBuffer* big = pool->take(3000);
+    ASSERT_EQ(4096u, big->capacity());
+    ReceiveBuffer* small = pool->take(100);
+    ASSERT_EQ(1024u, small->capacity());
+    big->remove_reference();
+    small->remove_reference();
+
+    // The smallest free buffer that fits is reused.
+    ReceiveBuffer* again = pool->take(1000);
+    ASSERT_EQ(small, again);
+    again->remove_reference();
+    again = pool->take(2000);
+    ASSERT_EQ(big, again);
+    again->remove_reference();
+    ASSERT_EQ(5120u, pool->allocated_bytes());
+}
+
+TEST(ReceiveBufferPool, memory_is_limited)
+{
+    std::shared_ptr<ReceiveBufferPool> pool = std::make_shared<ReceiveBufferPool>(1024, 4, 4096);
+
+    ReceiveBuffer* first = pool->take(2048);
+    ReceiveBuffer* second = pool->take();
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    ASSERT_EQ(nullptr, pool->take(2048));
+
+    // Free buffers that are too small are freed to make room.
+    second->remove_reference();
+    ASSERT_EQ(1u, pool->free_buffers());
+    ReceiveBuffer* third = pool->take(2048);
+    ASSERT_NE(nullptr, third);
+    ASSERT_EQ(0u, pool->free_buffers());
+    ASSERT_EQ(4096u, pool->allocated_bytes());
+    first->remove_reference();
+    third->remove_reference();
+}
+
+TEST(ReceiveBufferPool, payloads_reference_the_buffer)
+{
+    std::shared_ptr<ReceiveBufferPool> pool = std::make_shared<ReceiveBufferPool>(1024, 4);
+    ReceiveBuffer* buffer = pool->take();
+    for(uint32_t i = 0; i < buffer->capacity(); ++i)
+        buffer->buffer()[i] = static_cast<octet>(i);
+
+    CacheChange_t received(100);
+    octet* own_data = received.serializedPayload.data;
+    received.serializedPayload.reference(buffer, buffer->buffer() + 100, 600);
+    ASSERT_EQ(2u, buffer->references());
+    ASSERT_EQ(buffer->buffer() + 100, received.serializedPayload.data);
+    ASSERT_EQ(600u, received.serializedPayload.length);
+
+    // Big payloads are shared by the copies.
+    CacheChange_t kept(1024);
+    ASSERT_TRUE(kept.copy(&received));
+    ASSERT_EQ(3u, buffer->references());
+    ASSERT_EQ(received.serializedPayload.data, kept.serializedPayload.data);
+
+    // The payload goes back to its own buffer.
+    received.serializedPayload.release_reference();
+    ASSERT_EQ(own_data, received.serializedPayload.data);
+    ASSERT_EQ(100u, received.serializedPayload.max_size);
+    ASSERT_EQ(2u, buffer->references());
+
+    // Payloads smaller than half the buffer are copied.
+    received.serializedPayload.reference(buffer, buffer->buffer() + 10, 500);
+    CacheChange_t small(1024);
+    ASSERT_TRUE(small.copy(&received));
+    ASSERT_EQ(nullptr, small.serializedPayload.receive_buffer);
+    ASSERT_EQ(0, memcmp(buffer->buffer() + 10, small.serializedPayload.data, 500));
+    received.serializedPayload.release_reference();
+
+    // Payloads that don't fit the own buffer are rejected, as when they are copied.
+    received.serializedPayload.reference(buffer, buffer->buffer(), 1000);
+    CacheChange_t too_small(512);
+    ASSERT_FALSE(too_small.copy(&received));
+    received.serializedPayload.release_reference();
+
+    // Growing the payload copies the referenced contents into the own buffer.
+    kept.serializedPayload.reserve(2048);
+    ASSERT_EQ(nullptr, kept.serializedPayload.receive_buffer);
+    ASSERT_EQ(600u, kept.serializedPayload.length);
+    ASSERT_EQ(0, memcmp(buffer->buffer() + 100, kept.serializedPayload.data, 600));
+
+    ASSERT_EQ(1u, buffer->references());
+    buffer->remove_reference();
+    ASSERT_EQ(1u, pool->free_buffers());
+}
+
+TEST(ReceiveBufferPool, references_are_removed_from_several_threads)
+{
+    std::shared_ptr<ReceiveBufferPool> pool = std::make_shared<ReceiveBufferPool>(256, 16);
+
+    for(uint32_t round = 0; round < 100; ++round)
+    {
+        ReceiveBuffer* buffer = pool->take();
+        std::vector<CacheChange_t*> changes;
+        for(uint32_t i = 0; i < 8; ++i)
+        {
+            changes.push_back(new CacheChange_t(256));
+            changes.back()->serializedPayload.reference(buffer, buffer->buffer(), 128);
+        }
+        buffer->remove_reference();
+
+        std::vector<std::thread> threads;
+        for(CacheChange_t* change : changes)
+            threads.emplace_back([change]() { delete(change); });
+        for(std::thread& thread : threads)
+            thread.join();
+
+        ASSERT_EQ(1u, pool->free_buffers());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
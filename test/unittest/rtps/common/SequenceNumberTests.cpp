@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <fastrtps/rtps/common/SequenceNumber.h>
+#include <fastrtps/rtps/common/FragmentNumber.h>
+#include <fastrtps/rtps/messages/CDRMessage.h>
 
 #include <climits>
 #include <gtest/gtest.h>
@@ -493,6 +495,145 @@ TEST(SequenceNumberSet, GetMaxSeqNumOperation)
     ASSERT_EQ(set.get_maxSeqNum(), expected_seq);
 }
 
+/*!
+ * @fn TEST(SequenceNumberSet, IterateOperation)
+ * @brief This test checks the sequence numbers of the set are visited in increasing order.
+ */
+TEST(SequenceNumberSet, IterateOperation)
+{
+    SequenceNumberSet_t set;
+
+    set.base = SequenceNumber_t(3, UINT32_MAX - 31);
+
+    ASSERT_TRUE(set.isSetEmpty());
+    ASSERT_TRUE(set.get_begin() == set.get_end());
+
+    std::vector<SequenceNumber_t> expected = { SequenceNumber_t(3, UINT32_MAX - 31), SequenceNumber_t(3, UINT32_MAX),
+        SequenceNumber_t(4, 0), SequenceNumber_t(4, 200) };
+
+    for(auto it = expected.rbegin(); it != expected.rend(); ++it)
+        ASSERT_TRUE(set.add(*it));
+
+    std::vector<SequenceNumber_t> visited(set.get_begin(), set.get_end());
+
+    ASSERT_EQ(visited, expected);
+    ASSERT_EQ(set.get_size(), 4u);
+    ASSERT_TRUE(set.contains(SequenceNumber_t(4, 0)));
+    ASSERT_FALSE(set.contains(SequenceNumber_t(4, 1)));
+    ASSERT_FALSE(set.contains(SequenceNumber_t(3, 0)));
+}
+
+/*!
+ * @fn TEST(SequenceNumberSet, MergeOperation)
+ * @brief This test checks the merge of two sets with different bases.
+ */
+TEST(SequenceNumberSet, MergeOperation)
+{
+    SequenceNumberSet_t set, other;
+
+    set.base = SequenceNumber_t(0, 10);
+    ASSERT_TRUE(set.add(SequenceNumber_t(0, 10)));
+
+    other.base = SequenceNumber_t(0, 50);
+    ASSERT_TRUE(other.add(SequenceNumber_t(0, 50)));
+    ASSERT_TRUE(other.add(SequenceNumber_t(0, 83)));
+
+    ASSERT_TRUE(set.add(other));
+    std::vector<SequenceNumber_t> visited(set.get_begin(), set.get_end());
+    ASSERT_EQ(visited, std::vector<SequenceNumber_t>({ SequenceNumber_t(0, 10), SequenceNumber_t(0, 50),
+                SequenceNumber_t(0, 83) }));
+
+    // Sequence numbers out of the range of the set are left out.
+    other.base = SequenceNumber_t(0, 200);
+    ASSERT_TRUE(other.add(SequenceNumber_t(0, 260)));
+    ASSERT_TRUE(other.add(SequenceNumber_t(0, 270)));
+    ASSERT_FALSE(set.add(other));
+    ASSERT_TRUE(set.contains(SequenceNumber_t(0, 260)));
+    ASSERT_FALSE(set.contains(SequenceNumber_t(0, 270)));
+    ASSERT_EQ(set.get_maxSeqNum(), SequenceNumber_t(0, 260));
+}
+
+/*!
+ * @fn TEST(SequenceNumberSet, SerializeOperation)
+ * @brief This test checks a set keeps its sequence numbers through the wire.
+ */
+TEST(SequenceNumberSet, SerializeOperation)
+{
+    SequenceNumberSet_t set, result;
+
+    set.base = SequenceNumber_t(1, 100);
+    ASSERT_TRUE(set.add(SequenceNumber_t(1, 100)));
+    ASSERT_TRUE(set.add(SequenceNumber_t(1, 131)));
+    ASSERT_TRUE(set.add(SequenceNumber_t(1, 132)));
+    ASSERT_TRUE(set.add(SequenceNumber_t(1, 354)));
+
+    CDRMessage_t msg;
+    ASSERT_TRUE(CDRMessage::addSequenceNumberSet(&msg, &set));
+    // Base, numBits and eight words.
+    ASSERT_EQ(msg.length, 8u + 4u + 32u);
+
+    msg.pos = 0;
+    ASSERT_TRUE(CDRMessage::readSequenceNumberSet(&msg, &result));
+    ASSERT_EQ(result.base, set.base);
+    ASSERT_TRUE(result.bitmap() == set.bitmap());
+
+    // Empty sets only write their base and numBits.
+    SequenceNumberSet_t empty;
+    empty.base = SequenceNumber_t(0, 5);
+    CDRMessage_t empty_msg;
+    ASSERT_TRUE(CDRMessage::addSequenceNumberSet(&empty_msg, &empty));
+    ASSERT_EQ(empty_msg.length, 12u);
+    empty_msg.pos = 0;
+    ASSERT_TRUE(CDRMessage::readSequenceNumberSet(&empty_msg, &result));
+    ASSERT_TRUE(result.isSetEmpty());
+}
+
+/*!
+ * @fn TEST(FragmentNumberSet, SubtractOperation)
+ * @brief This test checks the removal of fragment numbers from a set.
+ */
+TEST(FragmentNumberSet, SubtractOperation)
+{
+    FragmentNumberSet_t set(std::set<FragmentNumber_t>({ 1, 2, 3, 40, 256, 257 }));
+
+    ASSERT_EQ(set.base, 1u);
+    ASSERT_EQ(set.get_size(), 5u);
+    ASSERT_FALSE(set.contains(257));
+
+    FragmentNumberSet_t sent(std::set<FragmentNumber_t>({ 1, 3 }));
+    set -= sent;
+    set -= FragmentNumberSet_t(std::set<FragmentNumber_t>({ 40, 41 }));
+
+    std::vector<FragmentNumber_t> visited(set.get_begin(), set.get_end());
+    ASSERT_EQ(visited, std::vector<FragmentNumber_t>({ 2, 256 }));
+
+    set += FragmentNumberSet_t(std::set<FragmentNumber_t>({ 10, 20 }));
+    ASSERT_EQ(set.get_size(), 4u);
+    ASSERT_EQ(set.get_maxFragNum(), 256u);
+}
+
+/*!
+ * @fn TEST(FragmentNumberSet, SerializeOperation)
+ * @brief This test checks a set keeps its fragment numbers through the wire.
+ */
+TEST(FragmentNumberSet, SerializeOperation)
+{
+    FragmentNumberSet_t set(std::set<FragmentNumber_t>({ 5, 6, 37, 260 })), result;
+
+    CDRMessage_t msg;
+    ASSERT_TRUE(CDRMessage::addFragmentNumberSet(&msg, &set));
+    msg.pos = 0;
+    ASSERT_TRUE(CDRMessage::readFragmentNumberSet(&msg, &result));
+    ASSERT_TRUE(result == set);
+
+    // More bits than the set can hold are rejected.
+    CDRMessage_t wrong_msg;
+    CDRMessage::addUInt32(&wrong_msg, 1);
+    CDRMessage::addUInt32(&wrong_msg, 257);
+    wrong_msg.pos = 0;
+    ASSERT_FALSE(CDRMessage::readFragmentNumberSet(&wrong_msg, &result));
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
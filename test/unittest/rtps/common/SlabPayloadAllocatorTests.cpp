@@ -0,0 +1,200 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fastrtps/rtps/common/SlabPayloadAllocator.h>
+#include <fastrtps/rtps/common/SerializedPayload.h>
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace eprosima::fastrtps::rtps;
+
+TEST(SlabPayloadAllocator, sizes_are_rounded_up_to_powers_of_two)
+{
+    SlabPayloadAllocator allocator;
+
+    uint32_t size = 1;
+    octet* buffer = allocator.allocate(size);
+    ASSERT_EQ(64u, size);
+    allocator.release(buffer, size);
+
+    size = 65;
+    buffer = allocator.allocate(size);
+    ASSERT_EQ(128u, size);
+    allocator.release(buffer, size);
+
+    size = 4096;
+    buffer = allocator.allocate(size);
+    ASSERT_EQ(4096u, size);
+    allocator.release(buffer, size);
+
+    // Too big for the size classes.
+    size = 3 * 1024 * 1024;
+    buffer = allocator.allocate(size);
+    ASSERT_EQ(3u * 1024 * 1024, size);
+    allocator.release(buffer, size);
+}
+
+TEST(SlabPayloadAllocator, released_buffers_are_reused)
+{
+    SlabPayloadAllocator allocator(1024);
+    std::set<octet*> buffers;
+
+    for(int i = 0; i < 16; ++i)
+    {
+        uint32_t size = 100;
+        octet* buffer = allocator.allocate(size);
+        ASSERT_TRUE(buffers.insert(buffer).second);
+        memset(buffer, i, size);
+    }
+
+    PayloadAllocatorStats stats = allocator.get_stats();
+    ASSERT_EQ(16u, stats.buffers);
+    ASSERT_EQ(16u * 128, stats.used_bytes);
+    ASSERT_EQ(2u * 1024, stats.system_bytes);
+
+    for(octet* buffer : buffers)
+        allocator.release(buffer, 128);
+
+    for(int i = 0; i < 16; ++i)
+    {
+        uint32_t size = 128;
+        octet* buffer = allocator.allocate(size);
+        ASSERT_EQ(1u, buffers.count(buffer));
+    }
+
+    stats = allocator.get_stats();
+    ASSERT_EQ(2u * 1024, stats.system_bytes);
+    ASSERT_EQ(32u, stats.total_allocations);
+}
+
+TEST(SlabPayloadAllocator, statistics)
+{
+    SlabPayloadAllocator allocator(1024);
+
+    uint32_t size_a = 96;
+    octet* buffer_a = allocator.allocate(size_a);
+    uint32_t size_b = 32;
+    octet* buffer_b = allocator.allocate(size_b);
+
+    PayloadAllocatorStats stats = allocator.get_stats();
+    ASSERT_EQ(2u, stats.buffers);
+    ASSERT_EQ(128u + 64u, stats.used_bytes);
+    ASSERT_EQ(128u + 64u, stats.high_water_bytes);
+    ASSERT_EQ(2u * 1024, stats.system_bytes);
+    ASSERT_EQ(96u + 32u, stats.total_requested_bytes);
+    ASSERT_DOUBLE_EQ(1.0 - 128.0 / 192.0, stats.internal_fragmentation());
+    ASSERT_DOUBLE_EQ(1.0 - 192.0 / 2048.0, stats.external_fragmentation());
+
+    allocator.release(buffer_a, size_a);
+    allocator.release(buffer_b, size_b);
+
+    stats = allocator.get_stats();
+    ASSERT_EQ(0u, stats.buffers);
+    ASSERT_EQ(0u, stats.used_bytes);
+    ASSERT_EQ(128u + 64u, stats.high_water_bytes);
+}
+
+TEST(SlabPayloadAllocator, payload_keeps_contents_when_growing)
+{
+    SlabPayloadAllocator allocator;
+    SerializedPayload_t payload;
+    payload.allocator = &allocator;
+
+    payload.reserve(50);
+    ASSERT_EQ(64u, payload.max_size);
+    for(uint32_t i = 0; i < 50; ++i)
+        payload.data[i] = (octet)i;
+    payload.length = 50;
+
+    payload.reserve(1000);
+    ASSERT_EQ(1024u, payload.max_size);
+    for(uint32_t i = 0; i < 50; ++i)
+        ASSERT_EQ((octet)i, payload.data[i]);
+
+    payload.empty();
+    ASSERT_EQ(0u, allocator.get_stats().buffers);
+}
+
+TEST(SlabPayloadAllocator, fragmented_payload_releases_previous_buffer)
+{
+    SlabPayloadAllocator allocator;
+    SerializedPayload_t payload;
+    payload.allocator = &allocator;
+
+    SerializedPayload_t first(100);
+    first.length = 100;
+    ASSERT_TRUE(payload.reserve_fragmented(&first));
+    ASSERT_EQ(1u, allocator.get_stats().buffers);
+
+    SerializedPayload_t second(3000);
+    second.length = 3000;
+    ASSERT_TRUE(payload.reserve_fragmented(&second));
+    ASSERT_EQ(1u, allocator.get_stats().buffers);
+    ASSERT_EQ(4096u, allocator.get_stats().used_bytes);
+
+    payload.empty();
+    ASSERT_EQ(0u, allocator.get_stats().buffers);
+    ASSERT_EQ(0u, allocator.get_stats().used_bytes);
+}
+
+TEST(SlabPayloadAllocator, concurrent_allocations)
+{
+    SlabPayloadAllocator allocator(4096);
+    std::vector<std::thread> threads;
+    std::vector<bool> success(4, true);
+
+    for(uint32_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&allocator, &success, t]()
+                {
+                    std::vector<std::pair<octet*, uint32_t>> buffers;
+                    for(uint32_t round = 0; round < 100; ++round)
+                    {
+                        for(uint32_t i = 0; i < 50; ++i)
+                        {
+                            uint32_t size = 64 + (i * 37) % 2000;
+                            octet* buffer = allocator.allocate(size);
+                            memset(buffer, (int)t, size);
+                            buffers.emplace_back(buffer, size);
+                        }
+
+                        for(auto& buffer : buffers)
+                        {
+                            for(uint32_t i = 0; i < buffer.second; ++i)
+                                if(buffer.first[i] != (octet)t)
+                                    success[t] = false;
+                            allocator.release(buffer.first, buffer.second);
+                        }
+                        buffers.clear();
+                    }
+                });
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    for(uint32_t t = 0; t < 4; ++t)
+        ASSERT_TRUE(success[t]);
+    ASSERT_EQ(0u, allocator.get_stats().used_bytes);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
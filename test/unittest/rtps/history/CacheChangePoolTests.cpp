@@ -0,0 +1,237 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fastrtps/rtps/history/CacheChangePool.h>
+#include <fastrtps/rtps/common/CacheChange.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+#include <set>
+
+using namespace eprosima::fastrtps::rtps;
+
+class CacheChangePoolTests : public ::testing::TestWithParam<MemoryManagementPolicy_t>
+{
+};
+
+/*!
+ * @brief Reserves and releases changes from several threads at once, checking that a change is never given to two
+ * threads at the same time.
+ */
+static void reserve_and_release_concurrently(CacheChangePool& pool, uint32_t threads, uint32_t changes_per_thread)
+{
+    std::vector<std::thread> workers;
+    std::vector<bool> success(threads, true);
+
+    for(uint32_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&pool, &success, t, changes_per_thread]()
+                {
+                    std::vector<CacheChange_t*> changes;
+
+                    for(uint32_t round = 0; round < 200; ++round)
+                    {
+                        for(uint32_t i = 0; i < changes_per_thread; ++i)
+                        {
+                            CacheChange_t* change = nullptr;
+                            if(!pool.reserve_Cache(&change, 16u))
+                            {
+                                success[t] = false;
+                                return;
+                            }
+                            change->sequenceNumber.high = (int32_t)t;
+                            change->sequenceNumber.low = i;
+                            changes.push_back(change);
+                        }
+
+                        for(uint32_t i = 0; i < changes_per_thread; ++i)
+                        {
+                            if(changes[i]->sequenceNumber.high != (int32_t)t || changes[i]->sequenceNumber.low != i)
+                                success[t] = false;
+                            pool.release_Cache(changes[i]);
+                        }
+                        changes.clear();
+                    }
+                });
+    }
+
+    for(std::thread& worker : workers)
+        worker.join();
+
+    for(uint32_t t = 0; t < threads; ++t)
+        ASSERT_TRUE(success[t]);
+}
+
+TEST_P(CacheChangePoolTests, reserved_changes_are_different)
+{
+    CacheChangePool pool(10, 100, 0, GetParam());
+    std::set<CacheChange_t*> reserved;
+
+    for(int i = 0; i < 25; ++i)
+    {
+        CacheChange_t* change = nullptr;
+        ASSERT_TRUE(pool.reserve_Cache(&change, 100u));
+        ASSERT_TRUE(reserved.insert(change).second);
+    }
+
+    for(CacheChange_t* change : reserved)
+        pool.release_Cache(change);
+}
+
+TEST_P(CacheChangePoolTests, maximum_pool_size_is_honored)
+{
+    CacheChangePool pool(5, 100, 20, GetParam());
+    std::vector<CacheChange_t*> reserved;
+
+    CacheChange_t* change = nullptr;
+    while(reserved.size() < 30 && pool.reserve_Cache(&change, 100u))
+        reserved.push_back(change);
+
+    ASSERT_EQ(20u, reserved.size());
+    ASSERT_EQ(20u, pool.get_allCachesSize());
+
+    // Once a change is released, another one can be reserved.
+    pool.release_Cache(reserved.back());
+    ASSERT_TRUE(pool.reserve_Cache(&change, 100u));
+    reserved.back() = change;
+
+    for(CacheChange_t* ch : reserved)
+        pool.release_Cache(ch);
+}
+
+TEST_P(CacheChangePoolTests, released_changes_are_reset)
+{
+    CacheChangePool pool(1, 100, 1, GetParam());
+
+    CacheChange_t* change = nullptr;
+    ASSERT_TRUE(pool.reserve_Cache(&change, 100u));
+    change->sequenceNumber.low = 7;
+    change->serializedPayload.length = 50;
+    change->isRead = true;
+    pool.release_Cache(change);
+
+    ASSERT_TRUE(pool.reserve_Cache(&change, 100u));
+    ASSERT_EQ(0u, change->sequenceNumber.low);
+    ASSERT_EQ(0u, change->serializedPayload.length);
+    ASSERT_FALSE(change->isRead);
+    pool.release_Cache(change);
+}
+
+TEST_P(CacheChangePoolTests, changes_from_other_pools_are_not_released)
+{
+    CacheChangePool pool(2, 100, 2, GetParam());
+    CacheChangePool other_pool(2, 100, 2, GetParam());
+
+    CacheChange_t* change = nullptr;
+    CacheChange_t* other_change = nullptr;
+    ASSERT_TRUE(pool.reserve_Cache(&change, 100u));
+    ASSERT_TRUE(other_pool.reserve_Cache(&other_change, 100u));
+
+    CacheChange_t unpooled_change;
+    pool.release_Cache(&unpooled_change);
+    pool.release_Cache(other_change);
+
+    // Only the reserved change can be given back.
+    CacheChange_t* last_change = nullptr;
+    ASSERT_TRUE(pool.reserve_Cache(&last_change, 100u));
+    ASSERT_FALSE(pool.reserve_Cache(&other_change, 100u));
+
+    pool.release_Cache(last_change);
+    pool.release_Cache(change);
+}
+
+TEST_P(CacheChangePoolTests, concurrent_reserve_and_release)
+{
+    CacheChangePool pool(10, 100, 0, GetParam());
+    reserve_and_release_concurrently(pool, 8, 20);
+
+    if(GetParam() == DYNAMIC_RESERVE_MEMORY_MODE)
+        ASSERT_EQ(0u, pool.get_allCachesSize());
+    else
+        ASSERT_EQ(pool.get_allCachesSize(), pool.get_freeCachesSize());
+}
+
+TEST_P(CacheChangePoolTests, concurrent_reserve_and_release_with_thread_caches)
+{
+    CacheChangePool pool(10, 100, 0, GetParam(), 8);
+    reserve_and_release_concurrently(pool, 8, 20);
+
+    // Finished threads give their cached changes back.
+    if(GetParam() == DYNAMIC_RESERVE_MEMORY_MODE)
+        ASSERT_EQ(0u, pool.get_allCachesSize());
+    else
+        ASSERT_EQ(pool.get_allCachesSize(), pool.get_freeCachesSize());
+}
+
+TEST_P(CacheChangePoolTests, concurrent_reserve_and_release_on_limited_pool)
+{
+    CacheChangePool pool(16, 100, 16, GetParam());
+    reserve_and_release_concurrently(pool, 4, 4);
+    ASSERT_LE(pool.get_allCachesSize(), 16u);
+}
+
+TEST_P(CacheChangePoolTests, payloads_are_taken_from_the_allocator)
+{
+    CacheChangePool pool(2, 100, 0, GetParam());
+
+    CacheChange_t* change = nullptr;
+    ASSERT_TRUE(pool.reserve_Cache(&change, 300u));
+    PayloadAllocatorStats stats = pool.get_payloadAllocatorStats();
+
+    if(GetParam() == PREALLOCATED_MEMORY_MODE)
+    {
+        ASSERT_EQ(0u, stats.buffers);
+        ASSERT_EQ(100u, change->serializedPayload.max_size);
+    }
+    else
+    {
+        ASSERT_EQ(512u, change->serializedPayload.max_size);
+        ASSERT_NE(nullptr, change->serializedPayload.allocator);
+        ASSERT_LE(512u, stats.used_bytes);
+        ASSERT_LE(stats.used_bytes, stats.high_water_bytes);
+    }
+
+    pool.release_Cache(change);
+
+    if(GetParam() == DYNAMIC_RESERVE_MEMORY_MODE)
+        ASSERT_EQ(0u, pool.get_payloadAllocatorStats().buffers);
+}
+
+TEST(CacheChangePool, payloads_are_taken_from_a_given_allocator)
+{
+    SlabPayloadAllocator allocator;
+
+    {
+        CacheChangePool pool(0, 100, 0, DYNAMIC_RESERVE_MEMORY_MODE, 0, &allocator);
+
+        CacheChange_t* change = nullptr;
+        ASSERT_TRUE(pool.reserve_Cache(&change, 1000u));
+        ASSERT_EQ(1u, allocator.get_stats().buffers);
+        ASSERT_EQ(1024u, allocator.get_stats().used_bytes);
+        ASSERT_EQ(1u, pool.get_payloadAllocatorStats().buffers);
+    }
+
+    ASSERT_EQ(0u, allocator.get_stats().buffers);
+}
+
+INSTANTIATE_TEST_CASE_P(CacheChangePool, CacheChangePoolTests,
+        ::testing::Values(PREALLOCATED_MEMORY_MODE, PREALLOCATED_WITH_REALLOC_MEMORY_MODE, DYNAMIC_RESERVE_MEMORY_MODE));
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
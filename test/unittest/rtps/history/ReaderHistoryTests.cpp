@@ -0,0 +1,192 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fastrtps/rtps/history/ReaderHistory.h>
+#include <fastrtps/rtps/reader/RTPSReader.h>
+
+#include <algorithm>
+#include <mutex>
+
+using namespace eprosima::fastrtps::rtps;
+using ::testing::_;
+using ::testing::Return;
+
+class ReaderMock : public RTPSReader
+{
+    public:
+
+        bool matched_writer_add(RemoteWriterAttributes&) { return true; }
+
+        bool matched_writer_remove(RemoteWriterAttributes&) { return true; }
+};
+
+//! Gives the history a reader and a mutex, as RTPSReader does.
+class TestReaderHistory : public ReaderHistory
+{
+    public:
+
+        TestReaderHistory(RTPSReader* reader, std::recursive_mutex* mutex) :
+            ReaderHistory(HistoryAttributes(PREALLOCATED_MEMORY_MODE, 16, 10, 100))
+        {
+            mp_reader = reader;
+            mp_mutex = mutex;
+        }
+};
+
+class ReaderHistoryTests : public ::testing::Test
+{
+    protected:
+
+        ReaderHistoryTests() : history_(&reader_, &mutex_)
+        {
+            first_writer_.guidPrefix.value[0] = 1;
+            first_writer_.entityId.value[3] = 3;
+            second_writer_.guidPrefix.value[0] = 2;
+            second_writer_.entityId.value[3] = 3;
+            ON_CALL(reader_, change_removed_by_history_mock(_, _)).WillByDefault(Return(true));
+        }
+
+        CacheChange_t* add(const GUID_t& writer, int32_t sequence_number)
+        {
+            CacheChange_t* change = nullptr;
+            history_.reserve_Cache(&change, 16);
+            change->writerGUID = writer;
+            change->sequenceNumber = SequenceNumber_t(0, sequence_number);
+            history_.add_change(change);
+            return change;
+        }
+
+        bool is_ordered()
+        {
+            return std::is_sorted(history_.changesBegin(), history_.changesEnd(),
+                    [](const CacheChange_t* c1, const CacheChange_t* c2)
+                    {
+                        return c1->sequenceNumber < c2->sequenceNumber;
+                    });
+        }
+
+        ::testing::NiceMock<ReaderMock> reader_;
+        std::recursive_mutex mutex_;
+        TestReaderHistory history_;
+        GUID_t first_writer_;
+        GUID_t second_writer_;
+};
+
+TEST_F(ReaderHistoryTests, changes_are_kept_in_order)
+{
+    for(int32_t sequence_number : {1, 2, 6, 3, 5, 4})
+        add(first_writer_, sequence_number);
+    for(int32_t sequence_number : {4, 1, 7})
+        add(second_writer_, sequence_number);
+
+    ASSERT_EQ(9u, history_.getHistorySize());
+    ASSERT_TRUE(is_ordered());
+
+    CacheChange_t* change = nullptr;
+    ASSERT_TRUE(history_.get_min_change(&change));
+    ASSERT_EQ(SequenceNumber_t(0, 1), change->sequenceNumber);
+    ASSERT_TRUE(history_.get_max_change(&change));
+    ASSERT_EQ(SequenceNumber_t(0, 7), change->sequenceNumber);
+    ASSERT_EQ(second_writer_, change->writerGUID);
+}
+
+TEST_F(ReaderHistoryTests, changes_are_found_by_writer)
+{
+    CacheChange_t* first = add(first_writer_, 4);
+    CacheChange_t* second = add(second_writer_, 4);
+    add(first_writer_, 2);
+    add(second_writer_, 5);
+
+    SequenceNumber_t sequence_number(0, 4);
+    CacheChange_t* change = nullptr;
+    ASSERT_TRUE(history_.get_change(sequence_number, first_writer_, &change));
+    ASSERT_EQ(first, change);
+    ASSERT_TRUE(history_.get_change(sequence_number, second_writer_, &change));
+    ASSERT_EQ(second, change);
+
+    sequence_number = SequenceNumber_t(0, 3);
+    ASSERT_FALSE(history_.get_change(sequence_number, first_writer_, &change));
+    sequence_number = SequenceNumber_t(0, 5);
+    ASSERT_FALSE(history_.get_change(sequence_number, first_writer_, &change));
+}
+
+TEST_F(ReaderHistoryTests, changes_are_removed_by_writer)
+{
+    CacheChange_t* first = add(first_writer_, 4);
+    CacheChange_t* second = add(second_writer_, 4);
+    add(first_writer_, 3);
+    add(first_writer_, 5);
+
+    EXPECT_CALL(reader_, change_removed_by_history_mock(_, _)).Times(::testing::AnyNumber());
+    EXPECT_CALL(reader_, change_removed_by_history_mock(first, _)).Times(1);
+    ASSERT_TRUE(history_.remove_change(first));
+    ASSERT_EQ(3u, history_.getHistorySize());
+    ASSERT_TRUE(is_ordered());
+
+    SequenceNumber_t sequence_number(0, 4);
+    CacheChange_t* change = nullptr;
+    ASSERT_TRUE(history_.get_change(sequence_number, second_writer_, &change));
+    ASSERT_EQ(second, change);
+    ASSERT_FALSE(history_.get_change(sequence_number, first_writer_, &change));
+
+    // The change is no longer in the history.
+    CacheChange_t missing;
+    missing.writerGUID = first_writer_;
+    missing.sequenceNumber = sequence_number;
+    ASSERT_FALSE(history_.remove_change(&missing));
+
+    ASSERT_TRUE(history_.remove_all_changes());
+    ASSERT_EQ(0u, history_.getHistorySize());
+    ASSERT_FALSE(history_.get_min_change(&change));
+}
+
+TEST_F(ReaderHistoryTests, oldest_changes_are_removed_while_others_arrive)
+{
+    // Two writers whose changes arrive interleaved, while the reader takes the oldest ones.
+    for(int32_t sequence_number = 1; sequence_number <= 60; ++sequence_number)
+    {
+        add(first_writer_, sequence_number);
+        add(second_writer_, sequence_number > 2 ? sequence_number - 2 : sequence_number);
+        if(sequence_number % 3 == 0)
+        {
+            CacheChange_t* oldest = nullptr;
+            ASSERT_TRUE(history_.get_min_change(&oldest));
+            ASSERT_TRUE(history_.remove_change(oldest));
+            ASSERT_TRUE(history_.get_min_change(&oldest));
+            ASSERT_TRUE(history_.remove_change(oldest));
+        }
+        ASSERT_TRUE(is_ordered());
+    }
+
+    ASSERT_EQ(80u, history_.getHistorySize());
+    CacheChange_t* change = nullptr;
+    ASSERT_TRUE(history_.get_min_change(&change));
+    ASSERT_EQ(*history_.changesBegin(), change);
+    ASSERT_TRUE(history_.get_max_change(&change));
+    ASSERT_EQ(SequenceNumber_t(0, 60), change->sequenceNumber);
+
+    SequenceNumber_t sequence_number(0, 58);
+    ASSERT_TRUE(history_.get_change(sequence_number, second_writer_, &change));
+    ASSERT_TRUE(history_.remove_all_changes());
+    ASSERT_EQ(0u, history_.getHistorySize());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,211 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fastrtps/rtps/history/WriterHistory.h>
+#include <fastrtps/rtps/writer/RTPSWriter.h>
+#include <rtps/persistence/MappedChangeLog.h>
+
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+using namespace eprosima::fastrtps::rtps;
+using ::testing::_;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+class WriterMock : public RTPSWriter
+{
+    public:
+
+        bool matched_reader_add(RemoteReaderAttributes&) { return true; }
+
+        bool matched_reader_remove(RemoteReaderAttributes&) { return true; }
+};
+
+//! Gives the history a writer and a mutex, as RTPSWriter does.
+class TestWriterHistory : public WriterHistory
+{
+    public:
+
+        TestWriterHistory(RTPSWriter* writer, std::recursive_mutex* mutex) :
+            WriterHistory(HistoryAttributes(PREALLOCATED_MEMORY_MODE, 16, 10, 0))
+        {
+            mp_writer = writer;
+            mp_mutex = mutex;
+        }
+
+        using WriterHistory::restore_persistent_changes;
+};
+
+class WriterHistoryTests : public ::testing::Test
+{
+    protected:
+
+        WriterHistoryTests() : history_(&writer_, &mutex_)
+        {
+            guid_.guidPrefix.value[0] = 1;
+            guid_.entityId.value[3] = 3;
+            ON_CALL(writer_, getGuid()).WillByDefault(ReturnRef(guid_));
+            ON_CALL(writer_, change_removed_by_history(_)).WillByDefault(Return(true));
+        }
+
+        CacheChange_t* add()
+        {
+            CacheChange_t* change = nullptr;
+            history_.reserve_Cache(&change, 16);
+            change->writerGUID = guid_;
+            history_.add_change(change);
+            return change;
+        }
+
+        std::vector<int32_t> sequence_numbers()
+        {
+            std::vector<int32_t> numbers;
+            for(auto it = history_.changesBegin(); it != history_.changesEnd(); ++it)
+                numbers.push_back((*it)->sequenceNumber.low);
+            return numbers;
+        }
+
+        ::testing::NiceMock<WriterMock> writer_;
+        std::recursive_mutex mutex_;
+        TestWriterHistory history_;
+        GUID_t guid_;
+};
+
+TEST_F(WriterHistoryTests, changes_are_removed_by_sequence_number)
+{
+    for(int i = 0; i < 10; ++i)
+        add();
+
+    ASSERT_TRUE(history_.remove_change(SequenceNumber_t(0, 5)));
+    ASSERT_TRUE(history_.remove_change(SequenceNumber_t(0, 9)));
+    // The changes after the removed ones are no longer at their distance from the first one.
+    ASSERT_TRUE(history_.remove_change(SequenceNumber_t(0, 10)));
+    ASSERT_TRUE(history_.remove_change(SequenceNumber_t(0, 6)));
+    ASSERT_FALSE(history_.remove_change(SequenceNumber_t(0, 5)));
+    ASSERT_FALSE(history_.remove_change(SequenceNumber_t(0, 11)));
+    ASSERT_EQ(std::vector<int32_t>({1, 2, 3, 4, 7, 8}), sequence_numbers());
+
+    CacheChange_t* change = history_.remove_change_and_reuse(SequenceNumber_t(0, 7));
+    ASSERT_NE(nullptr, change);
+    ASSERT_EQ(SequenceNumber_t(0, 7), change->sequenceNumber);
+    history_.release_Cache(change);
+    ASSERT_EQ(5u, history_.getHistorySize());
+}
+
+TEST_F(WriterHistoryTests, first_changes_are_removed_without_moving_the_rest)
+{
+    for(int i = 0; i < 10; ++i)
+        add();
+
+    EXPECT_CALL(writer_, change_removed_by_history(_)).Times(::testing::AnyNumber());
+    CacheChange_t** third = &*(history_.changesBegin() + 2);
+    ASSERT_TRUE(history_.remove_min_change());
+    ASSERT_TRUE(history_.remove_min_change());
+    ASSERT_EQ(third, &*history_.changesBegin());
+    CacheChange_t* change = nullptr;
+    ASSERT_TRUE(history_.get_min_change(&change));
+    ASSERT_EQ(SequenceNumber_t(0, 3), change->sequenceNumber);
+    ASSERT_EQ(8u, history_.getHistorySize());
+
+    // New changes keep being found after the removed ones, also once their room is reused.
+    for(int round = 0; round < 100; ++round)
+    {
+        add();
+        ASSERT_TRUE(history_.remove_min_change());
+    }
+    ASSERT_EQ(8u, history_.getHistorySize());
+    ASSERT_TRUE(history_.get_min_change(&change));
+    ASSERT_EQ(SequenceNumber_t(0, 103), change->sequenceNumber);
+    ASSERT_TRUE(history_.get_max_change(&change));
+    ASSERT_EQ(SequenceNumber_t(0, 110), change->sequenceNumber);
+
+    SequenceNumber_t sequence_number(0, 105);
+    ASSERT_TRUE(history_.get_change(sequence_number, guid_, &change));
+    ASSERT_EQ(sequence_number, change->sequenceNumber);
+    ASSERT_TRUE(history_.remove_change(change));
+    ASSERT_EQ(std::vector<int32_t>({103, 104, 106, 107, 108, 109, 110}), sequence_numbers());
+
+    ASSERT_TRUE(history_.remove_all_changes());
+    ASSERT_EQ(0u, history_.getHistorySize());
+    ASSERT_FALSE(history_.get_min_change(&change));
+}
+
+#if !defined(_WIN32)
+TEST_F(WriterHistoryTests, changes_are_restored_from_the_persistence_log)
+{
+    char directory[] = "/tmp/WriterHistoryTestsXXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(directory));
+    std::string path = std::string(directory) + "/history";
+
+    {
+        TestWriterHistory history(&writer_, &mutex_);
+        ASSERT_TRUE(history.restore_persistent_changes(new MappedChangeLog(path, 4096, MappedChangeLog::SYNC_NONE)));
+        for(octet i = 1; i <= 5; ++i)
+        {
+            CacheChange_t* change = nullptr;
+            history.reserve_Cache(&change, 16);
+            change->writerGUID = guid_;
+            change->instanceHandle.value[0] = i;
+            change->serializedPayload.length = 4;
+            memset(change->serializedPayload.data, i, 4);
+            ASSERT_TRUE(history.add_change(change));
+        }
+        ASSERT_TRUE(history.remove_min_change());
+        ASSERT_TRUE(history.remove_change(SequenceNumber_t(0, 4)));
+        history.release_Cache(history.remove_change_and_reuse(SequenceNumber_t(0, 5)));
+    }
+
+    // The changes not removed keep their sequence numbers, and the new ones follow the last one of the log.
+    TestWriterHistory history(&writer_, &mutex_);
+    ASSERT_TRUE(history.restore_persistent_changes(new MappedChangeLog(path, 4096, MappedChangeLog::SYNC_NONE)));
+    ASSERT_EQ(2u, history.getHistorySize());
+    for(auto it = history.changesBegin(); it != history.changesEnd(); ++it)
+    {
+        octet i = static_cast<octet>((*it)->sequenceNumber.low);
+        ASSERT_EQ(guid_, (*it)->writerGUID);
+        ASSERT_EQ(i, (*it)->instanceHandle.value[0]);
+        ASSERT_EQ(4u, (*it)->serializedPayload.length);
+        ASSERT_EQ(i, (*it)->serializedPayload.data[3]);
+    }
+    ASSERT_EQ(SequenceNumber_t(0, 2), (*history.changesBegin())->sequenceNumber);
+    ASSERT_EQ(SequenceNumber_t(0, 6), history.next_sequence_number());
+
+    ASSERT_TRUE(history.remove_all_changes());
+    DIR* dir = opendir(directory);
+    while(struct dirent* entry = readdir(dir))
+    {
+        if(entry->d_name[0] != '.')
+            unlink((std::string(directory) + "/" + entry->d_name).c_str());
+    }
+    closedir(dir);
+    rmdir(directory);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
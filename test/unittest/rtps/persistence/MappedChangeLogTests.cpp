@@ -0,0 +1,346 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rtps/persistence/MappedChangeLog.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace eprosima::fastrtps::rtps;
+
+//! Change read back from the log, with a copy of its payload.
+struct RestoredChange
+{
+    ChangeKind_t kind;
+    SequenceNumber_t sequence_number;
+    InstanceHandle_t instance;
+    std::vector<octet> payload;
+};
+
+class MappedChangeLogTests : public ::testing::Test
+{
+    protected:
+
+        MappedChangeLogTests()
+        {
+            char directory[] = "/tmp/MappedChangeLogTestsXXXXXX";
+            directory_ = mkdtemp(directory);
+            path_ = directory_ + "/history";
+        }
+
+        ~MappedChangeLogTests()
+        {
+            for(const std::string& file : files())
+                unlink((directory_ + "/" + file).c_str());
+            rmdir(directory_.c_str());
+        }
+
+        std::vector<std::string> files()
+        {
+            std::vector<std::string> names;
+            DIR* dir = opendir(directory_.c_str());
+            while(struct dirent* entry = readdir(dir))
+            {
+                if(entry->d_name[0] != '.')
+                    names.push_back(entry->d_name);
+            }
+            closedir(dir);
+            return names;
+        }
+
+        std::vector<RestoredChange> open(MappedChangeLog& log)
+        {
+            std::vector<RestoredChange> restored;
+            EXPECT_TRUE(log.open([&restored](const LoggedChange& logged)
+            {
+                RestoredChange change;
+                change.kind = logged.kind;
+                change.sequence_number = logged.sequenceNumber;
+                change.instance = logged.instanceHandle;
+                change.payload.assign(logged.data, logged.data + logged.length);
+                restored.push_back(change);
+            }));
+            return restored;
+        }
+
+        bool add(MappedChangeLog& log, int32_t sequence_number, uint32_t length)
+        {
+            CacheChange_t change(length);
+            change.sequenceNumber = SequenceNumber_t(0, sequence_number);
+            change.instanceHandle.value[0] = static_cast<octet>(sequence_number % 3);
+            change.kind = sequence_number % 2 ? ALIVE : NOT_ALIVE_DISPOSED;
+            change.serializedPayload.length = length;
+            for(uint32_t i = 0; i < length; ++i)
+                change.serializedPayload.data[i] = static_cast<octet>(sequence_number + i);
+            return log.add(change);
+        }
+
+        std::string directory_;
+        std::string path_;
+};
+
+TEST_F(MappedChangeLogTests, changes_not_removed_are_restored)
+{
+    {
+        MappedChangeLog log(path_, 64 * 1024, MappedChangeLog::SYNC_SEGMENT);
+        ASSERT_TRUE(open(log).empty());
+        for(int32_t i = 1; i <= 6; ++i)
+            ASSERT_TRUE(add(log, i, 10 * i));
+        ASSERT_TRUE(log.remove(SequenceNumber_t(0, 1)));
+        ASSERT_TRUE(log.remove(SequenceNumber_t(0, 4)));
+        ASSERT_TRUE(log.remove(SequenceNumber_t(0, 6)));
+        // Changes not in the log are ignored.
+        ASSERT_TRUE(log.remove(SequenceNumber_t(0, 9)));
+        ASSERT_EQ(3u, log.changes());
+    }
+
+    MappedChangeLog log(path_, 64 * 1024, MappedChangeLog::SYNC_SEGMENT);
+    std::vector<RestoredChange> restored = open(log);
+    ASSERT_EQ(3u, restored.size());
+    int32_t expected[] = {2, 3, 5};
+    for(size_t i = 0; i < restored.size(); ++i)
+    {
+        int32_t sequence_number = expected[i];
+        ASSERT_EQ(SequenceNumber_t(0, sequence_number), restored[i].sequence_number);
+        ASSERT_EQ(sequence_number % 2 ? ALIVE : NOT_ALIVE_DISPOSED, restored[i].kind);
+        ASSERT_EQ(sequence_number % 3, restored[i].instance.value[0]);
+        ASSERT_EQ(10u * sequence_number, restored[i].payload.size());
+        for(size_t j = 0; j < restored[i].payload.size(); ++j)
+            ASSERT_EQ(static_cast<octet>(sequence_number + j), restored[i].payload[j]);
+    }
+    // The removed last change still counts.
+    ASSERT_EQ(SequenceNumber_t(0, 6), log.last_sequence_number());
+}
+
+TEST_F(MappedChangeLogTests, segments_without_changes_are_deleted)
+{
+    MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+    open(log);
+    for(int32_t i = 1; i <= 20; ++i)
+        ASSERT_TRUE(add(log, i, 1000));
+    ASSERT_GE(log.segments(), 5u);
+    // And the lock file.
+    ASSERT_EQ(log.segments() + 1, files().size());
+
+    for(int32_t i = 1; i <= 19; ++i)
+        ASSERT_TRUE(log.remove(SequenceNumber_t(0, i)));
+    ASSERT_EQ(1u, log.segments());
+    ASSERT_EQ(2u, files().size());
+}
+
+TEST_F(MappedChangeLogTests, changes_never_removed_are_copied_to_the_end)
+{
+    {
+        MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+        open(log);
+        ASSERT_TRUE(add(log, 1, 100));
+        for(int32_t i = 2; i <= 200; ++i)
+        {
+            ASSERT_TRUE(add(log, i, 500));
+            if(i > 2)
+                ASSERT_TRUE(log.remove(SequenceNumber_t(0, i - 1)));
+        }
+        // The first change doesn't keep all the segments written after it.
+        ASSERT_LE(log.segments(), 3u);
+    }
+
+    MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+    std::vector<RestoredChange> restored = open(log);
+    ASSERT_EQ(2u, restored.size());
+    ASSERT_EQ(SequenceNumber_t(0, 1), restored[0].sequence_number);
+    ASSERT_EQ(100u, restored[0].payload.size());
+    ASSERT_EQ(SequenceNumber_t(0, 200), restored[1].sequence_number);
+    ASSERT_EQ(static_cast<octet>(200 + 499), restored[1].payload.back());
+}
+
+TEST_F(MappedChangeLogTests, big_changes_get_their_own_segment)
+{
+    {
+        MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_CHANGE);
+        open(log);
+        ASSERT_TRUE(add(log, 1, 10));
+        ASSERT_TRUE(add(log, 2, 20000));
+        ASSERT_TRUE(add(log, 3, 10));
+    }
+
+    MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_CHANGE);
+    std::vector<RestoredChange> restored = open(log);
+    ASSERT_EQ(3u, restored.size());
+    ASSERT_EQ(20000u, restored[1].payload.size());
+    ASSERT_EQ(static_cast<octet>(2 + 19999), restored[1].payload.back());
+}
+
+TEST_F(MappedChangeLogTests, changes_can_be_removed_while_restored)
+{
+    {
+        MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+        open(log);
+        for(int32_t i = 1; i <= 20; ++i)
+            ASSERT_TRUE(add(log, i, 1000));
+    }
+
+    {
+        // Only the last five changes are kept, as a history with less room would do.
+        MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+        std::vector<SequenceNumber_t> kept;
+        ASSERT_TRUE(log.open([&](const LoggedChange& logged)
+        {
+            ASSERT_EQ(1000u, logged.length);
+            ASSERT_EQ(static_cast<octet>(logged.sequenceNumber.low + 999), logged.data[999]);
+            kept.push_back(logged.sequenceNumber);
+            if(kept.size() > 5)
+            {
+                ASSERT_TRUE(log.remove(kept.front()));
+                kept.erase(kept.begin());
+            }
+        }));
+        ASSERT_EQ(5u, log.changes());
+        ASSERT_TRUE(add(log, 21, 10));
+    }
+
+    MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+    std::vector<RestoredChange> restored = open(log);
+    ASSERT_EQ(6u, restored.size());
+    ASSERT_EQ(SequenceNumber_t(0, 16), restored.front().sequence_number);
+    ASSERT_EQ(SequenceNumber_t(0, 21), restored.back().sequence_number);
+}
+
+TEST_F(MappedChangeLogTests, interrupted_records_are_ignored)
+{
+    {
+        MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+        open(log);
+        ASSERT_TRUE(add(log, 1, 10));
+        ASSERT_TRUE(add(log, 2, 10));
+    }
+
+    // Write the header of a record without its size, as an append interrupted before its end.
+    int fd = ::open((path_ + ".0.log").c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    octet record[48] = {};
+    record[4] = 1;
+    record[12] = 3;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(record)), pwrite(fd, record, sizeof(record), 8 + 2 * 64));
+    close(fd);
+
+    {
+        MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+        std::vector<RestoredChange> restored = open(log);
+        ASSERT_EQ(2u, restored.size());
+        ASSERT_EQ(SequenceNumber_t(0, 2), log.last_sequence_number());
+
+        // The record is written again.
+        ASSERT_TRUE(add(log, 3, 10));
+    }
+
+    MappedChangeLog reopened(path_, 4096, MappedChangeLog::SYNC_NONE);
+    ASSERT_EQ(3u, open(reopened).size());
+}
+
+TEST_F(MappedChangeLogTests, corrupted_segments_are_compacted)
+{
+    {
+        MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+        open(log);
+        ASSERT_TRUE(add(log, 1, 100));
+        ASSERT_TRUE(add(log, 2, 500));
+        ASSERT_TRUE(add(log, 3, 500));
+    }
+
+    // Give the second record an unknown type. The rest of the first segment, after the third record, is zeros.
+    int fd = ::open((path_ + ".0.log").c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    octet type = 9;
+    ASSERT_EQ(1, pwrite(fd, &type, 1, 8 + 152 + 4));
+    close(fd);
+
+    {
+        MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_SEGMENT);
+        std::vector<RestoredChange> restored = open(log);
+        ASSERT_EQ(1u, restored.size());
+
+        // Roll the log at least twice, so the first segment is compacted.
+        for(int32_t i = 4; i <= 30; ++i)
+        {
+            ASSERT_TRUE(add(log, i, 500));
+            if(i > 4)
+                ASSERT_TRUE(log.remove(SequenceNumber_t(0, i - 1)));
+        }
+        ASSERT_LE(log.segments(), 3u);
+        ASSERT_FALSE(::access((path_ + ".0.log").c_str(), F_OK) == 0);
+    }
+
+    MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_SEGMENT);
+    std::vector<RestoredChange> restored = open(log);
+    ASSERT_EQ(2u, restored.size());
+    ASSERT_EQ(SequenceNumber_t(0, 1), restored[0].sequence_number);
+    ASSERT_EQ(static_cast<octet>(1 + 99), restored[0].payload.back());
+    ASSERT_EQ(SequenceNumber_t(0, 30), restored[1].sequence_number);
+}
+
+TEST_F(MappedChangeLogTests, log_is_configured_by_properties)
+{
+    PropertyPolicy properties;
+    ASSERT_EQ(nullptr, MappedChangeLog::create(properties));
+
+    properties.properties().emplace_back("dds.persistence.directory", directory_);
+    properties.properties().emplace_back("dds.persistence.name", "history");
+    properties.properties().emplace_back("dds.persistence.sync", "SOMETIMES");
+    ASSERT_EQ(nullptr, MappedChangeLog::create(properties));
+
+    properties.properties().back().value("CHANGE");
+    properties.properties().emplace_back("dds.persistence.segment_size", "12");
+    ASSERT_EQ(nullptr, MappedChangeLog::create(properties));
+
+    properties.properties().back().value("8192");
+    MappedChangeLog* log = MappedChangeLog::create(properties);
+    ASSERT_NE(nullptr, log);
+    open(*log);
+    ASSERT_TRUE(add(*log, 1, 10));
+    delete(log);
+    std::vector<std::string> names = files();
+    std::sort(names.begin(), names.end());
+    ASSERT_EQ(std::vector<std::string>({"history.0.log", "history.lock"}), names);
+}
+
+TEST_F(MappedChangeLogTests, log_is_opened_by_a_single_writer)
+{
+    MappedChangeLog log(path_, 4096, MappedChangeLog::SYNC_NONE);
+    open(log);
+    ASSERT_TRUE(add(log, 1, 10));
+
+    {
+        MappedChangeLog other(path_, 4096, MappedChangeLog::SYNC_NONE);
+        ASSERT_FALSE(other.open([](const LoggedChange&) {}));
+    }
+
+    // The failed opening doesn't change the log.
+    ASSERT_TRUE(add(log, 2, 10));
+    ASSERT_EQ(2u, log.changes());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,176 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fastrtps/rtps/reader/RTPSReader.h>
+#include "../../../../src/cpp/rtps/reader/FragmentedChangePitStop.h"
+
+using namespace eprosima::fastrtps::rtps;
+using ::testing::_;
+using ::testing::Invoke;
+
+static const uint32_t c_fragment_size = 1000;
+static const uint32_t c_sample_size = 100500;
+
+class ReaderMock : public RTPSReader
+{
+    public:
+
+        ReaderMock()
+        {
+            ON_CALL(*this, reserveCache(_, _)).WillByDefault(Invoke([](CacheChange_t** change, uint32_t size)
+                        {
+                            *change = new CacheChange_t(size);
+                            return true;
+                        }));
+            ON_CALL(*this, releaseCache(_)).WillByDefault(Invoke([](CacheChange_t* change) { delete(change); }));
+        }
+
+        bool matched_writer_add(RemoteWriterAttributes&) { return true; }
+
+        bool matched_writer_remove(RemoteWriterAttributes&) { return true; }
+};
+
+class FragmentedChangePitStopTests : public ::testing::Test
+{
+    protected:
+
+        FragmentedChangePitStopTests() : sample_(c_sample_size), fragments_(c_sample_size)
+        {
+            writer_guid_.guidPrefix.value[0] = 1;
+            writer_guid_.entityId.value[3] = 2;
+            for(uint32_t i = 0; i < c_sample_size; ++i)
+                sample_[i] = static_cast<octet>(i * 7);
+        }
+
+        //! Gives the fragments [first, first + count) of the sample to the pit.
+        CacheChange_t* process(FragmentedChangePitStop& pit, const SequenceNumber_t& sequence_number, uint32_t first,
+                uint32_t count)
+        {
+            uint32_t start = (first - 1) * c_fragment_size;
+            uint32_t end = std::min(start + count * c_fragment_size, c_sample_size);
+
+            fragments_.writerGUID = writer_guid_;
+            fragments_.sequenceNumber = sequence_number;
+            fragments_.serializedPayload.length = end - start;
+            memcpy(fragments_.serializedPayload.data, &sample_[start], end - start);
+            fragments_.setFragmentSize(c_fragment_size);
+            fragments_.getDataFragments()->assign(count, ChangeFragmentStatus_t::PRESENT);
+
+            return pit.process(&fragments_, c_sample_size, first);
+        }
+
+        ::testing::NiceMock<ReaderMock> reader_;
+        GUID_t writer_guid_;
+        std::vector<octet> sample_;
+        CacheChange_t fragments_;
+};
+
+TEST_F(FragmentedChangePitStopTests, reassembles_the_fragments_in_any_order)
+{
+    FragmentedChangePitStop pit(&reader_, 1024 * 1024);
+    SequenceNumber_t sequence_number(0, 1);
+
+    ASSERT_EQ(nullptr, process(pit, sequence_number, 51, 50));
+    ASSERT_EQ(nullptr, process(pit, sequence_number, 101, 1));
+    // Repeated fragments don't count.
+    ASSERT_EQ(nullptr, process(pit, sequence_number, 51, 50));
+    ASSERT_EQ(nullptr, process(pit, sequence_number, 1, 25));
+    ASSERT_TRUE(pit.find(sequence_number, writer_guid_) != nullptr);
+
+    CacheChange_t* change = process(pit, sequence_number, 20, 31);
+    ASSERT_NE(nullptr, change);
+    ASSERT_EQ(nullptr, pit.find(sequence_number, writer_guid_));
+    ASSERT_EQ(c_sample_size, change->serializedPayload.length);
+    ASSERT_EQ(0, memcmp(sample_.data(), change->serializedPayload.data, c_sample_size));
+    delete(change);
+}
+
+TEST_F(FragmentedChangePitStopTests, completed_buffers_go_back_to_the_arena)
+{
+    FragmentedChangePitStop pit(&reader_, 1024 * 1024);
+
+    CacheChange_t* first = process(pit, SequenceNumber_t(0, 1), 1, 101);
+    ASSERT_NE(nullptr, first);
+    // The sample is in a buffer of the arena, referenced by the payload.
+    ReceiveBuffer* buffer = first->serializedPayload.receive_buffer;
+    ASSERT_NE(nullptr, buffer);
+    ASSERT_GE(buffer->capacity(), c_sample_size);
+    ASSERT_EQ(1u, buffer->references());
+
+    octet* data = first->serializedPayload.data;
+    delete(first);
+
+    // The next sample reuses the buffer.
+    CacheChange_t* second = process(pit, SequenceNumber_t(0, 2), 1, 101);
+    ASSERT_NE(nullptr, second);
+    ASSERT_EQ(data, second->serializedPayload.data);
+    ASSERT_EQ(0, memcmp(sample_.data(), second->serializedPayload.data, c_sample_size));
+    delete(second);
+}
+
+TEST_F(FragmentedChangePitStopTests, full_arena_reassembles_in_the_history)
+{
+    // Room for a single sample.
+    FragmentedChangePitStop pit(&reader_, 200000);
+
+    ASSERT_EQ(nullptr, process(pit, SequenceNumber_t(0, 1), 1, 10));
+    ASSERT_EQ(nullptr, process(pit, SequenceNumber_t(0, 2), 1, 10));
+
+    CacheChange_t* first = process(pit, SequenceNumber_t(0, 1), 11, 91);
+    CacheChange_t* second = process(pit, SequenceNumber_t(0, 2), 11, 91);
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    ASSERT_NE(nullptr, first->serializedPayload.receive_buffer);
+    ASSERT_EQ(nullptr, second->serializedPayload.receive_buffer);
+    ASSERT_EQ(0, memcmp(sample_.data(), first->serializedPayload.data, c_sample_size));
+    ASSERT_EQ(0, memcmp(sample_.data(), second->serializedPayload.data, c_sample_size));
+    delete(first);
+    delete(second);
+}
+
+TEST_F(FragmentedChangePitStopTests, no_arena)
+{
+    FragmentedChangePitStop pit(&reader_);
+
+    CacheChange_t* change = process(pit, SequenceNumber_t(0, 1), 1, 101);
+    ASSERT_NE(nullptr, change);
+    ASSERT_EQ(nullptr, change->serializedPayload.receive_buffer);
+    ASSERT_EQ(0, memcmp(sample_.data(), change->serializedPayload.data, c_sample_size));
+    delete(change);
+}
+
+TEST_F(FragmentedChangePitStopTests, removed_changes_are_released)
+{
+    FragmentedChangePitStop pit(&reader_, 1024 * 1024);
+
+    ASSERT_EQ(nullptr, process(pit, SequenceNumber_t(0, 1), 1, 10));
+    ASSERT_EQ(nullptr, process(pit, SequenceNumber_t(0, 2), 1, 10));
+    ASSERT_EQ(nullptr, process(pit, SequenceNumber_t(0, 3), 1, 10));
+
+    EXPECT_CALL(reader_, releaseCache(_)).Times(3);
+    ASSERT_TRUE(pit.try_to_remove(SequenceNumber_t(0, 2), writer_guid_));
+    ASSERT_FALSE(pit.try_to_remove(SequenceNumber_t(0, 2), writer_guid_));
+    ASSERT_TRUE(pit.try_to_remove_until(SequenceNumber_t(0, 4), writer_guid_));
+    ASSERT_EQ(nullptr, pit.find(SequenceNumber_t(0, 1), writer_guid_));
+    ASSERT_EQ(nullptr, pit.find(SequenceNumber_t(0, 3), writer_guid_));
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
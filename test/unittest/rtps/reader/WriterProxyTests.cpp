@@ -41,24 +41,24 @@ namespace eprosima
                 // Update MISSING changes util sequence number 3.
                 wproxy.missing_changes_update(SequenceNumber_t(0, 3));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 0));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 3);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 1))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 2))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 3))->getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 3);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 1)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 2)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 3)).getStatus(), ChangeFromWriterStatus_t::MISSING);
 
                 // Add two UNKNOWN with sequence numberes 4 and 5.
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0,4)));
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0,5)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0,4)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0,5)));
 
                 // Update MISSING changes util sequence number 5.
                 wproxy.missing_changes_update(SequenceNumber_t(0,5));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 0));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 5);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 1))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 2))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 3))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 5);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 1)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 2)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 3)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::MISSING);
 
                 // Set all as received.
                 wproxy.received_change_set(SequenceNumber_t(0, 1));
@@ -67,39 +67,39 @@ namespace eprosima
                 wproxy.received_change_set(SequenceNumber_t(0, 4));
                 wproxy.received_change_set(SequenceNumber_t(0, 5));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 5));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 0);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0);
 
                 // Try to update MISSING changes util sequence number 4.
                 wproxy.missing_changes_update(SequenceNumber_t(0, 4));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 5));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 0);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0);
 
                 // Add three UNKNOWN changes with sequence number 6, 7 and 9.
                 // Add one RECEIVED change with sequence number 8.
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0, 6)));
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0, 7)));
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0, 8)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0, 6)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0, 7)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0, 8)));
                 wproxy.received_change_set(SequenceNumber_t(0, 8));
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0, 9)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0, 9)));
 
                 // Update MISSING changes util sequence number 8.
                 wproxy.missing_changes_update(SequenceNumber_t(0, 8));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 5));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 4);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 7))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 9))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 4);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 7)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 9)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
 
                 // Update MISSING changes util sequence number 10.
                 wproxy.missing_changes_update(SequenceNumber_t(0, 10));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 5));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 5);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 7))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 9))->getStatus(), ChangeFromWriterStatus_t::MISSING);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 10))->getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 5);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 7)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 9)).getStatus(), ChangeFromWriterStatus_t::MISSING);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 10)).getStatus(), ChangeFromWriterStatus_t::MISSING);
             }
 
             TEST(WriterProxyTests, LostChangesUpdate)
@@ -111,43 +111,43 @@ namespace eprosima
                 // Update LOST changes util sequence number 3.
                 wproxy.lost_changes_update(SequenceNumber_t(0, 3));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 2));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 0);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0);
 
                 // Add two UNKNOWN with sequence numberes 3 and 4.
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0,3)));
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0,4)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0,3)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0,4)));
 
                 // Update LOST changes util sequence number 5.
                 wproxy.lost_changes_update(SequenceNumber_t(0, 5));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 4));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 0);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0);
 
                 // Try to update LOST changes util sequence number 4.
                 wproxy.lost_changes_update(SequenceNumber_t(0, 3));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 4));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 0);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0);
 
                 // Add two UNKNOWN changes with sequence number 5 and 8.
                 // Add one MISSING change with sequence number 6.
                 // Add one RECEIVED change with sequence number 7.
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0, 5)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0, 5)));
                 ChangeFromWriter_t missing_aux_change_from_w(SequenceNumber_t(0, 6));
                 missing_aux_change_from_w.setStatus(ChangeFromWriterStatus_t::MISSING);
-                wproxy.m_changesFromW.insert(missing_aux_change_from_w);
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0, 7)));
+                wproxy.add_change_from_writer(missing_aux_change_from_w);
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0, 7)));
                 wproxy.received_change_set(SequenceNumber_t(0, 7));
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0, 8)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0, 8)));
 
                 // Update LOST changes util sequence number 8.
                 wproxy.lost_changes_update(SequenceNumber_t(0, 8));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 7));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 1);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 1);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
 
                 // Update LOST changes util sequence number 10.
                 wproxy.lost_changes_update(SequenceNumber_t(0, 10));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 9));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 0);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0);
             }
 
             TEST(WriterProxyTests, ReceivedChangeSet)
@@ -159,77 +159,77 @@ namespace eprosima
                 // Set received change with sequence number 3.
                 wproxy.received_change_set(SequenceNumber_t(0, 3));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 0));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 3);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 1))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 2))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 3))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 3);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 1)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 2)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 3)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
 
                 // Add two UNKNOWN with sequence numberes 4 and 5.
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0,4)));
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0,5)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0,4)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0,5)));
 
                 // Set received change with sequence number 2
                 wproxy.received_change_set(SequenceNumber_t(0, 2));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 0));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 5);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 1))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 2))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 3))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 5);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 1)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 2)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 3)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
 
                 // Set received change with sequence number 1
                 wproxy.received_change_set(SequenceNumber_t(0, 1));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 3));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 2);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 2);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
 
                 // Try to update LOST changes util sequence number 3.
                 wproxy.received_change_set(SequenceNumber_t(0, 3));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 3));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 2);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 2);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
 
                 // Add received change with sequence number 6
                 wproxy.received_change_set(SequenceNumber_t(0, 6));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 3));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 3);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 3);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
 
                 // Add received change with sequence number 8
                 wproxy.received_change_set(SequenceNumber_t(0, 8));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 3));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 5);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 7))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 5);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 7)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
 
                 // Add received change with sequence number 4
                 wproxy.received_change_set(SequenceNumber_t(0, 4));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 4));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 4);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 7))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 4);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 7)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
 
                 // Add received change with sequence number 5
                 wproxy.received_change_set(SequenceNumber_t(0, 5));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 6));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 2);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 7))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 2);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 7)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
 
                 // Add received change with sequence number 7
                 wproxy.received_change_set(SequenceNumber_t(0, 7));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 8));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 0);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0);
             }
 
             TEST(WriterProxyTests, IrrelevantChangeSet)
@@ -241,88 +241,205 @@ namespace eprosima
                 // Set irrelevant change with sequence number 3.
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 3));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 0));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 3);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 1))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 2))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 3))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 3))->isRelevant(), false);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 3);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 1)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 2)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 3)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 3)).isRelevant(), false);
 
                 // Add two UNKNOWN with sequence numberes 4 and 5.
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0,4)));
-                wproxy.m_changesFromW.insert(ChangeFromWriter_t(SequenceNumber_t(0,5)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0,4)));
+                wproxy.add_change_from_writer(ChangeFromWriter_t(SequenceNumber_t(0,5)));
 
                 // Set irrelevant change with sequence number 2
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 2));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 0));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 5);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 1))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 2))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 2))->isRelevant(), false);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 3))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 3))->isRelevant(), false);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 5);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 1)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 2)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 2)).isRelevant(), false);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 3)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 3)).isRelevant(), false);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
 
                 // Set irrelevant change with sequence number 1
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 1));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 3));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 2);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 2);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
 
                 // Try to update LOST changes util sequence number 3.
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 3));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 3));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 2);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 2);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
 
                 // Add irrelevant change with sequence number 6
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 6));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 3));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 3);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->isRelevant(), false);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 3);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).isRelevant(), false);
 
                 // Add irrelevant change with sequence number 8
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 8));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 3));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 5);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 4))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->isRelevant(), false);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 7))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->isRelevant(), false);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 5);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 4)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).isRelevant(), false);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 7)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).isRelevant(), false);
 
                 // Add irrelevant change with sequence number 4
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 4));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 4));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 4);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 5))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 6))->isRelevant(), false);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 7))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->isRelevant(), false);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 4);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 5)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 6)).isRelevant(), false);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 7)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).isRelevant(), false);
 
                 // Add irrelevant change with sequence number 5
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 5));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 6));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 2);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 7))->getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->getStatus(), ChangeFromWriterStatus_t::RECEIVED);
-                ASSERT_EQ(wproxy.m_changesFromW.find(SequenceNumber_t(0, 8))->isRelevant(), false);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 2);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 7)).getStatus(), ChangeFromWriterStatus_t::UNKNOWN);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).getStatus(), ChangeFromWriterStatus_t::RECEIVED);
+                ASSERT_EQ(wproxy.change_from_writer(SequenceNumber_t(0, 8)).isRelevant(), false);
 
                 // Add irrelevant change with sequence number 7
                 wproxy.irrelevant_change_set(SequenceNumber_t(0, 7));
                 ASSERT_EQ(wproxy.changesFromWLowMark_, SequenceNumber_t(0, 8));
-                ASSERT_EQ(wproxy.m_changesFromW.size(), 0);
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0);
             }
 
+            TEST(WriterProxyTests, MissingChangesSet)
+            {
+                RemoteWriterAttributes wattr;
+                StatefulReader readerMock;
+                WriterProxy wproxy(wattr, &readerMock);
+
+                // Without missing changes the set is empty.
+                SequenceNumberSet_t sns;
+                ASSERT_FALSE(wproxy.missing_changes(sns));
+                ASSERT_EQ(sns.base, SequenceNumber_t(0, 1));
+                ASSERT_TRUE(sns.isSetEmpty());
+
+                // A heartbeat announces a range bigger than the set.
+                wproxy.missing_changes_update(SequenceNumber_t(0, 1000));
+                wproxy.received_change_set(SequenceNumber_t(0, 3));
+                wproxy.received_change_set(SequenceNumber_t(0, 4));
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 1000u);
+                ASSERT_EQ(wproxy.unknown_missing_changes_up_to(SequenceNumber_t(0, 10)), 7u);
+
+                ASSERT_TRUE(wproxy.missing_changes(sns));
+                ASSERT_EQ(sns.base, SequenceNumber_t(0, 1));
+                std::vector<SequenceNumber_t> set = sns.get_set();
+                ASSERT_EQ(set.size(), 254u);
+                ASSERT_EQ(set[0], SequenceNumber_t(0, 1));
+                ASSERT_EQ(set[1], SequenceNumber_t(0, 2));
+                ASSERT_EQ(set[2], SequenceNumber_t(0, 5));
+                ASSERT_EQ(set.back(), SequenceNumber_t(0, 256));
+
+                // The base moves with the first change not received.
+                wproxy.lost_changes_update(SequenceNumber_t(0, 900));
+                ASSERT_EQ(wproxy.available_changes_max(), SequenceNumber_t(0, 899));
+                ASSERT_TRUE(wproxy.missing_changes(sns));
+                ASSERT_EQ(sns.base, SequenceNumber_t(0, 900));
+                ASSERT_EQ(sns.get_set().size(), 101u);
+                ASSERT_EQ(sns.get_set().back(), SequenceNumber_t(0, 1000));
+            }
+
+            TEST(WriterProxyTests, WindowWrapsAround)
+            {
+                RemoteWriterAttributes wattr;
+                StatefulReader readerMock;
+                WriterProxy wproxy(wattr, &readerMock);
+
+                // Keep some changes pending while the window moves forward several times its size.
+                for(uint32_t seq = 1; seq <= 1000; ++seq)
+                {
+                    wproxy.missing_changes_update(SequenceNumber_t(0, seq + 10));
+                    ASSERT_FALSE(wproxy.change_was_received(SequenceNumber_t(0, seq + 10)));
+
+                    ASSERT_TRUE(wproxy.received_change_set(SequenceNumber_t(0, seq)));
+                    ASSERT_EQ(wproxy.available_changes_max(), SequenceNumber_t(0, seq));
+                    ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 10u);
+
+                    SequenceNumberSet_t sns;
+                    ASSERT_TRUE(wproxy.missing_changes(sns));
+                    ASSERT_EQ(sns.base, SequenceNumber_t(0, seq + 1));
+                    ASSERT_EQ(sns.get_set().size(), 10u);
+                    ASSERT_EQ(sns.get_set().back(), SequenceNumber_t(0, seq + 10));
+                }
+
+                ASSERT_EQ(wproxy.unknown_missing_changes_up_to(SequenceNumber_t(0, 1005)), 4u);
+                ASSERT_TRUE(wproxy.received_change_set(SequenceNumber_t(0, 1005)));
+                ASSERT_TRUE(wproxy.change_was_received(SequenceNumber_t(0, 1005)));
+                wproxy.lost_changes_update(SequenceNumber_t(0, 1011));
+                ASSERT_EQ(wproxy.numberOfChangeFromWriter(), 0u);
+                ASSERT_EQ(wproxy.available_changes_max(), SequenceNumber_t(0, 1010));
+            }
+
+            TEST(WriterProxyTests, AvailableChanges)
+            {
+                RemoteWriterAttributes wattr;
+                StatefulReader readerMock;
+                WriterProxy wproxy(wattr, &readerMock);
+                CacheChange_t changes[6];
+                for(int32_t i = 0; i < 6; ++i)
+                    changes[i].sequenceNumber = SequenceNumber_t(0, i + 1);
+
+                // Changes 2, 5 and 3 are received before 1.
+                for(int32_t i : {1, 4, 2})
+                {
+                    ASSERT_TRUE(wproxy.received_change_set(changes[i].sequenceNumber));
+                    wproxy.history_change_added(&changes[i]);
+                }
+                ASSERT_EQ(wproxy.next_available_change(), nullptr);
+                ASSERT_EQ(wproxy.next_unread_available_change(), nullptr);
+
+                ASSERT_TRUE(wproxy.received_change_set(changes[0].sequenceNumber));
+                wproxy.history_change_added(&changes[0]);
+                ASSERT_EQ(wproxy.next_available_change(), &changes[0]);
+
+                // Read changes are skipped, but they can still be taken.
+                changes[0].isRead = true;
+                ASSERT_EQ(wproxy.next_unread_available_change(), &changes[1]);
+                changes[1].isRead = true;
+                ASSERT_EQ(wproxy.next_unread_available_change(), &changes[2]);
+                changes[2].isRead = true;
+                // Change 5 waits for change 4.
+                ASSERT_EQ(wproxy.next_unread_available_change(), nullptr);
+                ASSERT_EQ(wproxy.next_available_change(), &changes[0]);
+
+                wproxy.history_change_removed(&changes[0]);
+                wproxy.history_change_removed(&changes[2]);
+                ASSERT_EQ(wproxy.next_available_change(), &changes[1]);
+
+                // Change 4 is lost.
+                wproxy.lost_changes_update(changes[4].sequenceNumber);
+                ASSERT_EQ(wproxy.next_unread_available_change(), &changes[4]);
+
+                wproxy.history_change_removed(&changes[1]);
+                ASSERT_EQ(wproxy.next_available_change(), &changes[4]);
+                ASSERT_EQ(wproxy.next_unread_available_change(), &changes[4]);
+
+                // Changes not in the history are ignored.
+                wproxy.history_change_removed(&changes[5]);
+                wproxy.history_change_removed(&changes[4]);
+                ASSERT_EQ(wproxy.next_available_change(), nullptr);
+            }
         } // namespace rtps
     } // namespace fastrtps
 } // namespace eprosima
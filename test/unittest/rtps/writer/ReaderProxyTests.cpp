@@ -0,0 +1,271 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fastrtps/rtps/writer/ReaderProxy.h>
+#include <fastrtps/rtps/writer/StatefulWriter.h>
+
+#include <deque>
+
+namespace eprosima
+{
+    namespace fastrtps
+    {
+        namespace rtps
+        {
+            class ReaderProxyTests : public ::testing::Test
+            {
+                protected:
+
+                    ReaderProxyTests() : writer_(nullptr), proxy_(reader_attributes(), times_, &writer_)
+                    {
+                    }
+
+                    static RemoteReaderAttributes& reader_attributes()
+                    {
+                        static RemoteReaderAttributes rattr;
+                        rattr.endpoint.reliabilityKind = RELIABLE;
+                        return rattr;
+                    }
+
+                    void add_change(uint32_t seq, ChangeForReaderStatus_t status = UNSENT)
+                    {
+                        changes_.emplace_back();
+                        changes_.back().sequenceNumber = SequenceNumber_t(0, seq);
+                        ChangeForReader_t change(&changes_.back());
+                        change.setStatus(status);
+                        proxy_.addChange(change);
+                    }
+
+                    std::vector<uint32_t> unsent_changes()
+                    {
+                        std::vector<uint32_t> seqs;
+                        for(auto change : proxy_.get_unsent_changes())
+                            seqs.push_back(change->getSequenceNumber().low);
+                        return seqs;
+                    }
+
+                    std::vector<uint32_t> requested_changes()
+                    {
+                        std::vector<uint32_t> seqs;
+                        for(auto change : proxy_.get_requested_changes())
+                            seqs.push_back(change->getSequenceNumber().low);
+                        return seqs;
+                    }
+
+                    std::vector<uint32_t> range(uint32_t first, uint32_t last)
+                    {
+                        std::vector<uint32_t> seqs;
+                        for(uint32_t seq = first; seq <= last; ++seq)
+                            seqs.push_back(seq);
+                        return seqs;
+                    }
+
+                    WriterTimes times_;
+                    StatefulWriter writer_;
+                    ReaderProxy proxy_;
+                    std::deque<CacheChange_t> changes_;
+            };
+
+            TEST_F(ReaderProxyTests, AddChangesGrowsWindow)
+            {
+                for(uint32_t seq = 1; seq <= 200; ++seq)
+                    add_change(seq);
+
+                ASSERT_EQ(proxy_.countChangesForReader(), 200u);
+                ASSERT_EQ(unsent_changes(), range(1, 200));
+                ASSERT_FALSE(proxy_.change_is_acked(SequenceNumber_t(0, 1)));
+            }
+
+            TEST_F(ReaderProxyTests, AckedChangesSet)
+            {
+                for(uint32_t seq = 1; seq <= 100; ++seq)
+                    add_change(seq);
+
+                ASSERT_FALSE(proxy_.acked_changes_set(SequenceNumber_t(0, 51)));
+                ASSERT_EQ(proxy_.countChangesForReader(), 50u);
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 50)));
+                ASSERT_FALSE(proxy_.change_is_acked(SequenceNumber_t(0, 51)));
+                ASSERT_EQ(unsent_changes(), range(51, 100));
+
+                // An older acknowledgement changes nothing.
+                ASSERT_FALSE(proxy_.acked_changes_set(SequenceNumber_t(0, 10)));
+                ASSERT_EQ(proxy_.countChangesForReader(), 50u);
+
+                ASSERT_TRUE(proxy_.acked_changes_set(SequenceNumber_t(0, 101)));
+                ASSERT_EQ(proxy_.countChangesForReader(), 0u);
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 100)));
+            }
+
+            TEST_F(ReaderProxyTests, WindowWrapsAround)
+            {
+                for(uint32_t seq = 1; seq <= 64; ++seq)
+                    add_change(seq);
+                proxy_.acked_changes_set(SequenceNumber_t(0, 41));
+
+                // These reuse the positions freed by the acknowledged changes.
+                for(uint32_t seq = 65; seq <= 100; ++seq)
+                    add_change(seq);
+
+                ASSERT_EQ(proxy_.countChangesForReader(), 60u);
+                ASSERT_EQ(unsent_changes(), range(41, 100));
+
+                proxy_.set_change_to_status(SequenceNumber_t(0, 70), UNDERWAY);
+                std::vector<uint32_t> expected = range(41, 100);
+                expected.erase(expected.begin() + (70 - 41));
+                ASSERT_EQ(unsent_changes(), expected);
+
+                // Growing keeps the order of the changes.
+                for(uint32_t seq = 101; seq <= 110; ++seq)
+                    add_change(seq);
+                expected = range(41, 110);
+                expected.erase(expected.begin() + (70 - 41));
+                ASSERT_EQ(unsent_changes(), expected);
+            }
+
+            TEST_F(ReaderProxyTests, StatusTransitions)
+            {
+                for(uint32_t seq = 1; seq <= 10; ++seq)
+                    add_change(seq);
+
+                proxy_.convert_status_on_all_changes(UNSENT, UNDERWAY);
+                ASSERT_TRUE(unsent_changes().empty());
+                ASSERT_FALSE(proxy_.thereIsUnacknowledged());
+
+                SequenceNumberSet_t requested;
+                requested.base = SequenceNumber_t(0, 3);
+                requested.add(SequenceNumber_t(0, 3));
+                requested.add(SequenceNumber_t(0, 7));
+                requested.add(SequenceNumber_t(0, 20));
+                ASSERT_TRUE(proxy_.requested_changes_set(requested));
+                ASSERT_EQ(requested_changes(), std::vector<uint32_t>({ 3, 7 }));
+
+                proxy_.convert_status_on_all_changes(REQUESTED, UNSENT);
+                ASSERT_TRUE(requested_changes().empty());
+                ASSERT_EQ(unsent_changes(), std::vector<uint32_t>({ 3, 7 }));
+
+                proxy_.convert_status_on_all_changes(UNDERWAY, UNACKNOWLEDGED);
+                ASSERT_TRUE(proxy_.thereIsUnacknowledged());
+                proxy_.convert_status_on_all_changes(UNACKNOWLEDGED, UNDERWAY);
+                ASSERT_FALSE(proxy_.thereIsUnacknowledged());
+            }
+
+            TEST_F(ReaderProxyTests, AcknowledgedChangesAreRemovedFromTheStart)
+            {
+                for(uint32_t seq = 1; seq <= 5; ++seq)
+                    add_change(seq, UNDERWAY);
+                proxy_.set_change_to_status(SequenceNumber_t(0, 3), UNACKNOWLEDGED);
+
+                // Only the changes before the first one that stays are removed.
+                proxy_.convert_status_on_all_changes(UNDERWAY, ACKNOWLEDGED);
+                ASSERT_EQ(proxy_.countChangesForReader(), 3u);
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 2)));
+                ASSERT_FALSE(proxy_.change_is_acked(SequenceNumber_t(0, 3)));
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 4)));
+
+                proxy_.set_change_to_status(SequenceNumber_t(0, 3), ACKNOWLEDGED);
+                ASSERT_EQ(proxy_.countChangesForReader(), 2u);
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 3)));
+
+                ASSERT_TRUE(proxy_.acked_changes_set(SequenceNumber_t(0, 6)));
+            }
+
+            TEST_F(ReaderProxyTests, AcknowledgedChangeOnEmptyWindow)
+            {
+                add_change(5, ACKNOWLEDGED);
+                ASSERT_EQ(proxy_.countChangesForReader(), 0u);
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 5)));
+
+                add_change(6);
+                add_change(7, ACKNOWLEDGED);
+                ASSERT_EQ(proxy_.countChangesForReader(), 2u);
+                ASSERT_FALSE(proxy_.change_is_acked(SequenceNumber_t(0, 6)));
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 7)));
+            }
+
+            TEST_F(ReaderProxyTests, SequenceNumbersWithHoles)
+            {
+                add_change(1);
+                add_change(5);
+                add_change(1000);
+                add_change(1001);
+
+                ASSERT_EQ(proxy_.countChangesForReader(), 4u);
+                ASSERT_EQ(unsent_changes(), std::vector<uint32_t>({ 1, 5, 1000, 1001 }));
+
+                proxy_.set_change_to_status(SequenceNumber_t(0, 1000), UNDERWAY);
+                proxy_.set_change_to_status(SequenceNumber_t(0, 500), UNDERWAY);
+                ASSERT_EQ(unsent_changes(), std::vector<uint32_t>({ 1, 5, 1001 }));
+
+                SequenceNumberSet_t requested;
+                requested.base = SequenceNumber_t(0, 999);
+                requested.add(SequenceNumber_t(0, 999));
+                requested.add(SequenceNumber_t(0, 1000));
+                ASSERT_TRUE(proxy_.requested_changes_set(requested));
+                ASSERT_EQ(requested_changes(), std::vector<uint32_t>({ 1000 }));
+
+                proxy_.acked_changes_set(SequenceNumber_t(0, 1000));
+                ASSERT_EQ(proxy_.countChangesForReader(), 2u);
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 999)));
+                ASSERT_FALSE(proxy_.change_is_acked(SequenceNumber_t(0, 1000)));
+            }
+
+            TEST_F(ReaderProxyTests, SetNotValid)
+            {
+                for(uint32_t seq = 1; seq <= 3; ++seq)
+                    add_change(seq, UNDERWAY);
+
+                proxy_.setNotValid(&changes_[1]);
+                ASSERT_TRUE(proxy_.thereIsUnacknowledged());
+                ASSERT_TRUE(proxy_.change_is_acked(SequenceNumber_t(0, 2)));
+
+                // Not valid changes can't be requested.
+                SequenceNumberSet_t requested;
+                requested.base = SequenceNumber_t(0, 2);
+                requested.add(SequenceNumber_t(0, 2));
+                ASSERT_FALSE(proxy_.requested_changes_set(requested));
+            }
+
+            TEST_F(ReaderProxyTests, RequestedChangesAreRepairs)
+            {
+                for(uint32_t seq = 1; seq <= 4; ++seq)
+                    add_change(seq, UNDERWAY);
+                add_change(5);
+                ASSERT_FALSE(proxy_.is_repair(SequenceNumber_t(0, 1)));
+
+                SequenceNumberSet_t requested;
+                requested.base = SequenceNumber_t(0, 2);
+                requested.add(SequenceNumber_t(0, 2));
+                requested.add(SequenceNumber_t(0, 3));
+                ASSERT_TRUE(proxy_.requested_changes_set(requested));
+                ASSERT_FALSE(proxy_.is_repair(SequenceNumber_t(0, 3)));
+
+                // Requested changes become repairs when they are made unsent again. Changes never sent are not.
+                proxy_.convert_status_on_all_changes(REQUESTED, UNSENT);
+                ASSERT_EQ(std::vector<uint32_t>({2, 3, 5}), unsent_changes());
+                ASSERT_TRUE(proxy_.is_repair(SequenceNumber_t(0, 2)));
+                ASSERT_TRUE(proxy_.is_repair(SequenceNumber_t(0, 3)));
+                ASSERT_FALSE(proxy_.is_repair(SequenceNumber_t(0, 5)));
+            }
+        } // namespace rtps
+    } // namespace fastrtps
+} // namespace eprosima
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,451 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fastrtps/transport/SharedMemTransport.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <fastrtps/log/Log.h>
+#include <memory>
+#include <string>
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <atomic>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace eprosima::fastrtps;
+using namespace eprosima::fastrtps::rtps;
+
+const uint32_t ReceiveBufferCapacity = 65536;
+
+static uint32_t g_default_port = 7400;
+
+class SharedMemTests: public ::testing::Test
+{
+    public:
+        SharedMemTests()
+        {
+            HELPER_SetDescriptorDefaults();
+        }
+
+        ~SharedMemTests()
+        {
+            Log::KillThread();
+        }
+
+        void HELPER_SetDescriptorDefaults();
+
+        SharedMemTransportDescriptor descriptor;
+        std::unique_ptr<std::thread> senderThread;
+        std::unique_ptr<std::thread> receiverThread;
+};
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+TEST_F(SharedMemTests, locators_with_kind_shm_supported)
+{
+    // Given
+    SharedMemTransport transportUnderTest(descriptor);
+    ASSERT_TRUE(transportUnderTest.init());
+
+    Locator_t supportedLocator;
+    supportedLocator.kind = LOCATOR_KIND_SHM;
+    Locator_t unsupportedLocator;
+    unsupportedLocator.kind = LOCATOR_KIND_UDPv4;
+
+    // Then
+    ASSERT_TRUE(transportUnderTest.IsLocatorSupported(supportedLocator));
+    ASSERT_FALSE(transportUnderTest.IsLocatorSupported(unsupportedLocator));
+}
+
+TEST_F(SharedMemTests, opening_and_closing_output_channel)
+{
+    // Given
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t genericOutputChannelLocator;
+    genericOutputChannelLocator.kind = LOCATOR_KIND_SHM;
+    genericOutputChannelLocator.port = g_default_port; // arbitrary
+
+    // Then
+    ASSERT_FALSE (transportUnderTest.IsOutputChannelOpen(genericOutputChannelLocator));
+    ASSERT_TRUE  (transportUnderTest.OpenOutputChannel(genericOutputChannelLocator));
+    ASSERT_TRUE  (transportUnderTest.IsOutputChannelOpen(genericOutputChannelLocator));
+    ASSERT_TRUE  (transportUnderTest.CloseOutputChannel(genericOutputChannelLocator));
+    ASSERT_FALSE (transportUnderTest.IsOutputChannelOpen(genericOutputChannelLocator));
+    ASSERT_FALSE (transportUnderTest.CloseOutputChannel(genericOutputChannelLocator));
+}
+
+TEST_F(SharedMemTests, opening_and_closing_input_channel)
+{
+    // Given
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port; // arbitrary
+
+    // Then
+    ASSERT_FALSE (transportUnderTest.IsInputChannelOpen(inputChannelLocator));
+    ASSERT_TRUE  (transportUnderTest.OpenInputChannel(inputChannelLocator));
+    ASSERT_TRUE  (transportUnderTest.IsInputChannelOpen(inputChannelLocator));
+    ASSERT_TRUE  (transportUnderTest.CloseInputChannel(inputChannelLocator));
+    ASSERT_FALSE (transportUnderTest.IsInputChannelOpen(inputChannelLocator));
+    ASSERT_FALSE (transportUnderTest.CloseInputChannel(inputChannelLocator));
+}
+
+TEST_F(SharedMemTests, input_port_is_owned_by_a_single_transport)
+{
+    SharedMemTransport firstTransport(descriptor);
+    firstTransport.init();
+    SharedMemTransport secondTransport(descriptor);
+    secondTransport.init();
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port;
+
+    ASSERT_TRUE(firstTransport.OpenInputChannel(inputChannelLocator));
+    ASSERT_FALSE(secondTransport.OpenInputChannel(inputChannelLocator));
+    ASSERT_TRUE(firstTransport.CloseInputChannel(inputChannelLocator));
+    ASSERT_TRUE(secondTransport.OpenInputChannel(inputChannelLocator));
+    ASSERT_TRUE(secondTransport.CloseInputChannel(inputChannelLocator));
+}
+
+TEST_F(SharedMemTests, segments_are_only_accessible_by_their_owner_by_default)
+{
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    std::string name = "/" + descriptor.segmentNamePrefix + "_shm_" + std::to_string(g_default_port);
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    struct stat status;
+    ASSERT_EQ(fstat(fd, &status), 0);
+    close(fd);
+    ASSERT_EQ(status.st_mode & 0077, 0u);
+    ASSERT_TRUE(transportUnderTest.CloseInputChannel(inputChannelLocator));
+}
+
+TEST_F(SharedMemTests, segment_left_incomplete_is_replaced)
+{
+    // A segment whose owner died before finishing it.
+    std::string name = "/" + descriptor.segmentNamePrefix + "_shm_" + std::to_string(g_default_port);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(ftruncate(fd, 16), 0);
+    close(fd);
+
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+    ASSERT_TRUE(transportUnderTest.CloseInputChannel(inputChannelLocator));
+}
+
+TEST_F(SharedMemTests, segment_still_being_created_is_not_replaced)
+{
+    // A live owner that has not initialised its segment yet holds its lock.
+    std::string name = "/" + descriptor.segmentNamePrefix + "_shm_" + std::to_string(g_default_port);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(flock(fd, LOCK_EX | LOCK_NB), 0);
+
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port;
+    ASSERT_FALSE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    // Once it dies, its segment is replaced.
+    close(fd);
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+    ASSERT_TRUE(transportUnderTest.CloseInputChannel(inputChannelLocator));
+}
+
+TEST_F(SharedMemTests, message_claimed_by_a_dead_sender_is_skipped)
+{
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.kind = LOCATOR_KIND_SHM;
+    outputChannelLocator.port = g_default_port + 1;
+    ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator));
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if(child == 0)
+        _exit(0);
+    ASSERT_EQ(waitpid(child, nullptr, 0), child);
+
+    // Claim the first slot on behalf of the dead process. Offsets follow the layout of the segment header: four
+    // 32 bit fields and the semaphore, then the enqueue and dequeue positions on their own cache lines.
+    std::string name = "/" + descriptor.segmentNamePrefix + "_shm_" + std::to_string(g_default_port);
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    const size_t headerSize = 192;
+    void* base = mmap(nullptr, headerSize + sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(base, MAP_FAILED);
+    auto enqueuePos = reinterpret_cast<std::atomic<uint64_t>*>(static_cast<char*>(base) + 64);
+    auto firstSlotSequence = reinterpret_cast<std::atomic<uint64_t>*>(static_cast<char*>(base) + headerSize);
+    ASSERT_EQ(firstSlotSequence->load(), 0u);
+    firstSlotSequence->store((1ULL << 63) | static_cast<uint32_t>(child));
+    enqueuePos->store(1);
+    munmap(base, headerSize + sizeof(uint64_t));
+
+    octet message[5] = { 'H','e','l','l','o' };
+    ASSERT_TRUE(transportUnderTest.Send(message, 5, outputChannelLocator, inputChannelLocator));
+
+    octet receiveBuffer[5];
+    uint32_t receiveBufferSize = 0;
+    Locator_t remoteLocatorToReceive;
+    ASSERT_TRUE(transportUnderTest.Receive(receiveBuffer, 5, receiveBufferSize, inputChannelLocator, remoteLocatorToReceive));
+    ASSERT_EQ(receiveBufferSize, 5u);
+    ASSERT_EQ(memcmp(message, receiveBuffer, 5), 0);
+    ASSERT_TRUE(transportUnderTest.CloseInputChannel(inputChannelLocator));
+}
+
+TEST_F(SharedMemTests, received_messages_carry_the_port_they_were_sent_from)
+{
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.kind = LOCATOR_KIND_SHM;
+    outputChannelLocator.port = g_default_port + 1;
+    ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator));
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    octet message[5] = { 'H','e','l','l','o' };
+    ASSERT_TRUE(transportUnderTest.Send(message, 5, outputChannelLocator, inputChannelLocator));
+
+    octet receiveBuffer[5];
+    uint32_t receiveBufferSize = 0;
+    Locator_t remoteLocatorToReceive;
+    ASSERT_TRUE(transportUnderTest.Receive(receiveBuffer, 5, receiveBufferSize, inputChannelLocator, remoteLocatorToReceive));
+    ASSERT_EQ(remoteLocatorToReceive.kind, LOCATOR_KIND_SHM);
+    ASSERT_EQ(remoteLocatorToReceive.port, g_default_port + 1);
+}
+
+TEST_F(SharedMemTests, send_and_receive_between_transports)
+{
+    SharedMemTransport senderTransport(descriptor);
+    senderTransport.init();
+    SharedMemTransport receiverTransport(descriptor);
+    receiverTransport.init();
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.port = g_default_port;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator = *receiverTransport.NormalizeLocator(inputChannelLocator).begin();
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.port = 0;
+    outputChannelLocator.kind = LOCATOR_KIND_SHM;
+    ASSERT_TRUE(senderTransport.OpenOutputChannel(outputChannelLocator));
+    ASSERT_TRUE(receiverTransport.OpenInputChannel(inputChannelLocator));
+    octet message[5] = { 'H','e','l','l','o' };
+
+    auto sendThreadFunction = [&]()
+    {
+        EXPECT_TRUE(senderTransport.Send(message, 5, outputChannelLocator, inputChannelLocator));
+    };
+
+    auto receiveThreadFunction = [&]()
+    {
+        std::vector<octet> receiveBuffer(ReceiveBufferCapacity);
+        uint32_t receiveBufferSize = 0;
+
+        Locator_t remoteLocatorToReceive;
+        EXPECT_TRUE(receiverTransport.Receive(receiveBuffer.data(), ReceiveBufferCapacity, receiveBufferSize,
+                    inputChannelLocator, remoteLocatorToReceive));
+        EXPECT_EQ(receiveBufferSize, 5u);
+        EXPECT_EQ(memcmp(message, receiveBuffer.data(), 5), 0);
+        EXPECT_EQ(remoteLocatorToReceive.kind, LOCATOR_KIND_SHM);
+    };
+
+    receiverThread.reset(new std::thread(receiveThreadFunction));
+    senderThread.reset(new std::thread(sendThreadFunction));
+
+    senderThread->join();
+    receiverThread->join();
+}
+
+TEST_F(SharedMemTests, send_fails_when_port_has_no_listener)
+{
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.kind = LOCATOR_KIND_SHM;
+    ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator));
+
+    Locator_t destinationLocator;
+    destinationLocator.kind = LOCATOR_KIND_SHM;
+    destinationLocator.port = g_default_port;
+
+    octet message[5] = { 'H','e','l','l','o' };
+    ASSERT_FALSE(transportUnderTest.Send(message, 5, outputChannelLocator, destinationLocator));
+
+    // A port closed after it was used must not keep receiving messages.
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(destinationLocator));
+    ASSERT_TRUE(transportUnderTest.Send(message, 5, outputChannelLocator, destinationLocator));
+    ASSERT_TRUE(transportUnderTest.CloseInputChannel(destinationLocator));
+    ASSERT_FALSE(transportUnderTest.Send(message, 5, outputChannelLocator, destinationLocator));
+}
+
+TEST_F(SharedMemTests, send_to_locator_of_another_host_fails)
+{
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.kind = LOCATOR_KIND_SHM;
+    ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator));
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    Locator_t remoteHostLocator = *transportUnderTest.NormalizeLocator(inputChannelLocator).begin();
+    remoteHostLocator.address[15] ^= 0xFF;
+
+    octet message[5] = { 'H','e','l','l','o' };
+    ASSERT_FALSE(transportUnderTest.Send(message, 5, outputChannelLocator, remoteHostLocator));
+}
+
+TEST_F(SharedMemTests, full_port_queue_drops_messages)
+{
+    descriptor.portQueueCapacity = 4;
+    SharedMemTransport transportUnderTest(descriptor);
+    ASSERT_TRUE(transportUnderTest.init());
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.kind = LOCATOR_KIND_SHM;
+    ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator));
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    inputChannelLocator.port = g_default_port;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    for(octet i = 0; i < 4; ++i)
+        ASSERT_TRUE(transportUnderTest.Send(&i, 1, outputChannelLocator, inputChannelLocator));
+    octet dropped = 4;
+    ASSERT_FALSE(transportUnderTest.Send(&dropped, 1, outputChannelLocator, inputChannelLocator));
+
+    // Messages are received in order, and popping one makes room for another.
+    octet receiveBuffer[5];
+    uint32_t receiveBufferSize = 0;
+    Locator_t remoteLocatorToReceive;
+    ASSERT_TRUE(transportUnderTest.Receive(receiveBuffer, 5, receiveBufferSize, inputChannelLocator, remoteLocatorToReceive));
+    ASSERT_EQ(receiveBuffer[0], 0);
+    ASSERT_TRUE(transportUnderTest.Send(&dropped, 1, outputChannelLocator, inputChannelLocator));
+
+    for(octet i = 1; i <= 4; ++i)
+    {
+        ASSERT_TRUE(transportUnderTest.Receive(receiveBuffer, 5, receiveBufferSize, inputChannelLocator, remoteLocatorToReceive));
+        ASSERT_EQ(receiveBufferSize, 1u);
+        ASSERT_EQ(receiveBuffer[0], i);
+    }
+}
+
+TEST_F(SharedMemTests, closing_input_channel_wakes_up_blocked_receive)
+{
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.port = g_default_port;
+    inputChannelLocator.kind = LOCATOR_KIND_SHM;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    auto receiveThreadFunction = [&]()
+    {
+        octet receiveBuffer[5];
+        uint32_t receiveBufferSize;
+
+        Locator_t remoteLocatorToReceive;
+        EXPECT_FALSE(transportUnderTest.Receive(receiveBuffer, 5, receiveBufferSize, inputChannelLocator, remoteLocatorToReceive));
+    };
+
+    receiverThread.reset(new std::thread(receiveThreadFunction));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_TRUE(transportUnderTest.CloseInputChannel(inputChannelLocator));
+    receiverThread->join();
+}
+
+TEST_F(SharedMemTests, send_to_wrong_kind_fails)
+{
+    SharedMemTransport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.kind = LOCATOR_KIND_SHM;
+    ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator));
+
+    Locator_t udpLocator;
+    udpLocator.kind = LOCATOR_KIND_UDPv4;
+    udpLocator.port = g_default_port;
+
+    octet message[5] = { 'H','e','l','l','o' };
+    ASSERT_FALSE(transportUnderTest.Send(message, 5, outputChannelLocator, udpLocator));
+}
+#endif
+
+void SharedMemTests::HELPER_SetDescriptorDefaults()
+{
+    descriptor.maxMessageSize = 5;
+    descriptor.segmentNamePrefix = "fastrtps_test_" + std::to_string(g_default_port);
+}
+
+int main(int argc, char **argv)
+{
+    Log::SetVerbosity(Log::Info);
+
+    if(const char* env_p = std::getenv("PORT_RANDOM_NUMBER"))
+        g_default_port = std::stoi(env_p);
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -18,6 +18,7 @@
 #include <fastrtps/utils/IPFinder.h>
 #include <fastrtps/log/Log.h>
 #include <memory>
+#include <atomic>
 #include <asio.hpp>
 
 
@@ -185,6 +186,205 @@ TEST_F(UDPv4Tests, send_to_loopback)
     senderThread->join();
     receiverThread->join();
 }
+
+TEST_F(UDPv4Tests, send_gather_delivers_slices_as_one_datagram)
+{
+    UDPv4Transport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t multicastLocator;
+    multicastLocator.port = g_default_port;
+    multicastLocator.kind = LOCATOR_KIND_UDPv4;
+    multicastLocator.set_IP4_address(239, 255, 0, 1);
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.port = g_default_port + 1;
+    outputChannelLocator.kind = LOCATOR_KIND_UDPv4;
+    ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator)); // Includes loopback
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(multicastLocator));
+    octet header[3] = { 'H','e','l' };
+    octet payload[2] = { 'l','o' };
+    octet message[5] = { 'H','e','l','l','o' };
+
+    auto sendThreadFunction = [&]()
+    {
+        SendBufferSlice slices[2] = { SendBufferSlice(header, 3), SendBufferSlice(payload, 2) };
+        EXPECT_TRUE(transportUnderTest.SendGather(slices, 2, outputChannelLocator, multicastLocator));
+    };
+
+    auto receiveThreadFunction = [&]()
+    {
+        octet receiveBuffer[ReceiveBufferCapacity];
+        uint32_t receiveBufferSize;
+
+        Locator_t remoteLocatorToReceive;
+        EXPECT_TRUE(transportUnderTest.Receive(receiveBuffer, ReceiveBufferCapacity, receiveBufferSize, multicastLocator, remoteLocatorToReceive));
+        EXPECT_EQ(receiveBufferSize, 5u);
+        EXPECT_EQ(memcmp(message,receiveBuffer,5), 0);
+    };
+
+    receiverThread.reset(new std::thread(receiveThreadFunction));
+    senderThread.reset(new std::thread(sendThreadFunction));
+    senderThread->join();
+    receiverThread->join();
+}
+
+TEST_F(UDPv4Tests, closing_input_channel_wakes_up_blocked_receive)
+{
+    UDPv4Transport transportUnderTest(descriptor);
+    transportUnderTest.init();
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.port = g_default_port;
+    inputChannelLocator.kind = LOCATOR_KIND_UDPv4;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    auto receiveThreadFunction = [&]()
+    {
+        octet receiveBuffer[ReceiveBufferCapacity];
+        uint32_t receiveBufferSize;
+
+        Locator_t remoteLocatorToReceive;
+        EXPECT_FALSE(transportUnderTest.Receive(receiveBuffer, ReceiveBufferCapacity, receiveBufferSize, inputChannelLocator, remoteLocatorToReceive));
+    };
+
+    receiverThread.reset(new std::thread(receiveThreadFunction));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_TRUE(transportUnderTest.CloseInputChannel(inputChannelLocator));
+    receiverThread->join();
+}
+
+TEST_F(UDPv4Tests, receive_batch_drains_queued_datagrams)
+{
+    descriptor.receiveBatchSize = 8;
+    descriptor.receiveBufferSize = ReceiveBufferCapacity; // Room for all queued datagrams
+    UDPv4Transport transportUnderTest(descriptor);
+    ASSERT_TRUE(transportUnderTest.init());
+    ASSERT_EQ(transportUnderTest.MaxReceiveBatchSize(), 8u);
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.port = g_default_port;
+    inputChannelLocator.kind = LOCATOR_KIND_UDPv4;
+
+    Locator_t outputChannelLocator;
+    outputChannelLocator.port = g_default_port + 1;
+    outputChannelLocator.kind = LOCATOR_KIND_UDPv4;
+    outputChannelLocator.set_IP4_address(127,0,0,1); // Loopback
+
+    Locator_t destinationLocator(inputChannelLocator);
+    destinationLocator.set_IP4_address(127,0,0,1);
+
+    ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator));
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+
+    // All datagrams are queued before the receive is issued.
+    const uint32_t numberOfMessages = 5;
+    for(octet i = 0; i < numberOfMessages; ++i)
+    {
+        octet message[5] = { 'H','e','l','l', i };
+        ASSERT_TRUE(transportUnderTest.Send(message, 5, outputChannelLocator, destinationLocator));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<std::vector<octet>> buffers(descriptor.receiveBatchSize, std::vector<octet>(ReceiveBufferCapacity));
+    std::vector<ReceiveBufferSlot> slots(descriptor.receiveBatchSize);
+    for(size_t i = 0; i < slots.size(); ++i)
+    {
+        slots[i].buffer = buffers[i].data();
+        slots[i].capacity = ReceiveBufferCapacity;
+    }
+
+    uint32_t received = transportUnderTest.ReceiveBatch(slots.data(), static_cast<uint32_t>(slots.size()), inputChannelLocator);
+    ASSERT_EQ(received, numberOfMessages);
+    for(octet i = 0; i < numberOfMessages; ++i)
+    {
+        octet message[5] = { 'H','e','l','l', i };
+        EXPECT_EQ(slots[i].size, 5u);
+        EXPECT_EQ(memcmp(message, slots[i].buffer, 5), 0);
+        EXPECT_EQ(slots[i].remoteLocator.port, outputChannelLocator.port);
+    }
+}
+
+#if defined(SO_REUSEPORT)
+TEST_F(UDPv4Tests, sharded_input_channel_spreads_datagrams_among_sockets)
+{
+    descriptor.receiveSocketsPerPort = 4;
+    descriptor.receiveBufferSize = ReceiveBufferCapacity; // Room for all queued datagrams
+    UDPv4Transport transportUnderTest(descriptor);
+    ASSERT_TRUE(transportUnderTest.init());
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.port = g_default_port;
+    inputChannelLocator.kind = LOCATOR_KIND_UDPv4;
+    ASSERT_TRUE(transportUnderTest.OpenInputChannel(inputChannelLocator));
+    ASSERT_EQ(transportUnderTest.InputChannelShards(inputChannelLocator), 4u);
+
+    std::atomic<uint32_t> receivedPerShard[4];
+    std::vector<std::thread> shardThreads;
+    for(uint32_t shard = 0; shard < 4; ++shard)
+    {
+        receivedPerShard[shard] = 0;
+        shardThreads.emplace_back([&, shard]()
+        {
+            std::vector<octet> buffer(ReceiveBufferCapacity);
+            ReceiveBufferSlot slot;
+            slot.buffer = buffer.data();
+            slot.capacity = ReceiveBufferCapacity;
+            while(transportUnderTest.ReceiveBatchFromShard(&slot, 1, inputChannelLocator, shard) == 1)
+                ++receivedPerShard[shard];
+        });
+    }
+
+    Locator_t destinationLocator(inputChannelLocator);
+    destinationLocator.set_IP4_address(127,0,0,1);
+
+    // The kernel picks the socket from the address of the sender, so each datagram is sent from a different port.
+    const uint32_t numberOfSenders = 16;
+    for(uint32_t i = 0; i < numberOfSenders; ++i)
+    {
+        Locator_t outputChannelLocator;
+        outputChannelLocator.port = g_default_port + 1 + i;
+        outputChannelLocator.kind = LOCATOR_KIND_UDPv4;
+        outputChannelLocator.set_IP4_address(127,0,0,1);
+        ASSERT_TRUE(transportUnderTest.OpenOutputChannel(outputChannelLocator));
+
+        octet message[5] = { 'H','e','l','l','o' };
+        ASSERT_TRUE(transportUnderTest.Send(message, 5, outputChannelLocator, destinationLocator));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(transportUnderTest.CloseInputChannel(inputChannelLocator));
+    for(auto& thread : shardThreads)
+        thread.join();
+
+    uint32_t total = 0, usedShards = 0;
+    for(uint32_t shard = 0; shard < 4; ++shard)
+    {
+        total += receivedPerShard[shard];
+        if(receivedPerShard[shard] > 0)
+            ++usedShards;
+    }
+    EXPECT_EQ(total, numberOfSenders);
+    EXPECT_GT(usedShards, 1u);
+}
+
+TEST_F(UDPv4Tests, sharded_input_channel_is_not_opened_on_a_port_in_use)
+{
+    descriptor.receiveSocketsPerPort = 2;
+    UDPv4Transport firstTransport(descriptor);
+    ASSERT_TRUE(firstTransport.init());
+    UDPv4Transport secondTransport(descriptor);
+    ASSERT_TRUE(secondTransport.init());
+
+    Locator_t inputChannelLocator;
+    inputChannelLocator.port = g_default_port;
+    inputChannelLocator.kind = LOCATOR_KIND_UDPv4;
+
+    ASSERT_TRUE(firstTransport.OpenInputChannel(inputChannelLocator));
+    EXPECT_FALSE(secondTransport.OpenInputChannel(inputChannelLocator));
+    EXPECT_FALSE(secondTransport.IsInputChannelOpen(inputChannelLocator));
+}
+#endif
 #endif
 
 TEST_F(UDPv4Tests, send_is_rejected_if_buffer_size_is_bigger_to_size_specified_in_descriptor)
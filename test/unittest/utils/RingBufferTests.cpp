@@ -0,0 +1,113 @@
+// Copyright 2016 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fastrtps/utils/RingBuffer.h>
+#include <gtest/gtest.h>
+
+#include <deque>
+
+using namespace eprosima::fastrtps;
+
+TEST(RingBufferTests, wraps_without_growing)
+{
+    RingBuffer<int> ring(4);
+
+    for(int i = 0; i < 100; ++i)
+    {
+        ring.push_back(i);
+        if(ring.size() == 4)
+        {
+            ASSERT_EQ(i - 3, ring.front());
+            ASSERT_EQ(i, ring.back());
+            ring.pop_front();
+        }
+    }
+
+    ASSERT_EQ(4u, ring.capacity());
+}
+
+TEST(RingBufferTests, grows_when_full)
+{
+    RingBuffer<int> ring;
+
+    for(int i = 0; i < 3; ++i)
+        ring.push_back(i);
+    ring.pop_front();
+    for(int i = 3; i < 10; ++i)
+        ring.push_back(i);
+
+    ASSERT_EQ(9u, ring.size());
+    ASSERT_GE(ring.capacity(), 9u);
+    for(size_t i = 0; i < ring.size(); ++i)
+        ASSERT_EQ((int)i + 1, ring[i]);
+}
+
+TEST(RingBufferTests, behaves_as_a_deque)
+{
+    RingBuffer<int> ring(3);
+    std::deque<int> expected;
+    unsigned int seed = 7;
+
+    for(int i = 0; i < 5000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        unsigned int operation = (seed >> 16) % 6;
+        size_t index = expected.empty() ? 0 : (seed >> 8) % (expected.size() + 1);
+
+        if(operation == 0 || expected.empty())
+        {
+            ring.push_back(i);
+            expected.push_back(i);
+        }
+        else if(operation == 1)
+        {
+            ring.push_front(i);
+            expected.push_front(i);
+        }
+        else if(operation == 2)
+        {
+            ring.insert(index, i);
+            expected.insert(expected.begin() + index, i);
+        }
+        else if(operation == 3)
+        {
+            ring.pop_front();
+            expected.pop_front();
+        }
+        else if(operation == 4)
+        {
+            ring.pop_back();
+            expected.pop_back();
+        }
+        else
+        {
+            index = index % expected.size();
+            ring.erase(index);
+            expected.erase(expected.begin() + index);
+        }
+
+        ASSERT_EQ(expected.size(), ring.size());
+        for(size_t j = 0; j < expected.size(); ++j)
+            ASSERT_EQ(expected[j], ring[j]);
+    }
+
+    ring.clear();
+    ASSERT_TRUE(ring.empty());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}